@@ -0,0 +1,235 @@
+#!/usr/bin/env python3
+"""
+Benchmark di scalabilità in tempo di compilazione dei pass degli assignment.
+
+Per ogni pass e per ogni asse della forma dell'IR (blocks, insts, loops,
+depth, functions: vedi genIR.py) genera moduli di dimensione crescente, li
+passa a opt e misura tempo reale e picco di memoria del processo. Il tempo
+del pass è il tempo totale meno quello di una pipeline di riferimento sullo
+stesso input (parsing, verifica e, per i pass di loop, la canonicalizzazione
+aggiunta dall'adattatore loop(...)). Su ogni serie stima l'esponente di crescita k
+(tempo ~ istruzioni^k, regressione log-log): k vicino a 1 è lineare, k vicino
+a 2 segnala un comportamento quadratico.
+
+Il report (JSON) contiene una misura per ogni punto e un riassunto per
+serie; con --max-exponent il benchmark fallisce (exit 1) se una serie cresce
+più velocemente della soglia.
+
+Uso:
+  benchmark.py --opt path/to/opt [--plugin plugin.so] [--passes localopts,licmpass]
+               [--sweep loops=50,100,200] [--repeat 3] [-o report.json]
+"""
+import argparse
+import json
+import math
+import os
+import platform
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import genIR  # noqa: E402
+
+# Pipeline di opt per ogni pass, pipeline di riferimento da sottrarre e serie
+# misurate di default: (asse, valori, forma di base su cui varia l'asse)
+PASSES = {
+    "localopts": {
+        "pipeline": "localopts",
+        "baseline": "verify",
+        "sweeps": [("blocks", [250, 500, 1000, 2000, 4000], dict(insts=20)),
+                   ("insts", [250, 500, 1000, 2000, 4000], dict(blocks=8)),
+                   ("functions", [8, 16, 32, 64, 128], dict(blocks=50, insts=20))],
+    },
+    "testloop": {
+        "pipeline": "loop(testloop)",
+        "baseline": "loop(no-op-loop)",
+        "sweeps": [("loops", [50, 100, 200, 400, 800], dict(insts=20)),
+                   ("insts", [250, 500, 1000, 2000, 4000], dict(loops=4)),
+                   ("depth", [2, 4, 8, 16, 32], dict(loops=4, insts=20))],
+    },
+    "licmpass": {
+        "pipeline": "loop(licmpass)",
+        "baseline": "loop(no-op-loop)",
+        "sweeps": [("loops", [50, 100, 200, 400, 800], dict(insts=20)),
+                   ("insts", [250, 500, 1000, 2000, 4000], dict(loops=4)),
+                   ("depth", [2, 4, 8, 16, 32], dict(loops=4, insts=20))],
+    },
+    "ivstrengthreduction": {
+        "pipeline": "loop(ivstrengthreduction)",
+        "baseline": "loop(no-op-loop)",
+        "sweeps": [("loops", [50, 100, 200, 400, 800], dict(insts=20, depth=2)),
+                   ("insts", [250, 500, 1000, 2000, 4000], dict(loops=4, depth=2)),
+                   ("depth", [2, 4, 8, 16, 32], dict(loops=4, insts=20))],
+    },
+    "loopfusionpass": {
+        "pipeline": "loopfusionpass",
+        "baseline": "verify",
+        "sweeps": [("loops", [25, 50, 100, 200, 400], dict(insts=20)),
+                   ("insts", [250, 500, 1000, 2000, 4000], dict(loops=4)),
+                   ("depth", [2, 3, 4, 6, 8], dict(loops=8, insts=20))],
+    },
+    "dataflow": {
+        "pipeline": "function(require<liveness>,require<reaching-defs>,"
+                    "require<available-exprs>,require<very-busy-exprs>)",
+        "baseline": "verify",
+        "sweeps": [("blocks", [250, 500, 1000, 2000, 4000], dict(insts=20)),
+                   ("insts", [250, 500, 1000, 2000, 4000], dict(blocks=8))],
+    },
+    "lazycodemotion": {
+        "pipeline": "lazycodemotion",
+        "baseline": "verify",
+        "sweeps": [("blocks", [250, 500, 1000, 2000, 4000], dict(insts=20)),
+                   ("insts", [250, 500, 1000, 2000, 4000], dict(blocks=8)),
+                   ("loops", [50, 100, 200, 400, 800], dict(insts=20))],
+    },
+}
+SCALABLE = ("blocks", "insts", "loops", "functions")                 # Assi su cui agisce --scale
+
+
+def runOpt(args, pipeline, path):
+    """Esegue opt una volta; restituisce (secondi, picco RSS in KiB, errore)."""
+    cmd = [args.opt] + args.opt_arg + [f"-load-pass-plugin={p}" for p in args.plugin]
+    cmd += ["-disable-output", f"-passes={pipeline}", path]
+    with tempfile.TemporaryFile() as err:
+        killed = []
+        start = time.perf_counter()
+        proc = subprocess.Popen(cmd, stdout=subprocess.DEVNULL, stderr=err)
+        timer = threading.Timer(args.timeout, lambda: (killed.append(True), proc.kill()))
+        timer.start()
+        _, status, usage = os.wait4(proc.pid, 0)                      # wait4: rusage del solo figlio
+        elapsed = time.perf_counter() - start
+        timer.cancel()
+        proc.returncode = os.waitstatus_to_exitcode(status)
+        if killed:
+            return None, None, "timeout"
+        if proc.returncode:
+            err.seek(0)
+            lines = err.read().decode(errors="replace").strip().splitlines()
+            return elapsed, usage.ru_maxrss, lines[-1] if lines else f"exit {proc.returncode}"
+    return elapsed, usage.ru_maxrss, None
+
+
+def measure(args, pipeline, path):
+    """Minimo del tempo e massimo della memoria su --repeat esecuzioni."""
+    best, peak = None, 0
+    for _ in range(args.repeat):
+        elapsed, rss, error = runOpt(args, pipeline, path)
+        if error:
+            return elapsed, rss, error
+        best = elapsed if best is None else min(best, elapsed)
+        peak = max(peak, rss or 0)
+    return best, peak, None
+
+
+def growth(points):
+    """Esponente k di tempo ~ istruzioni^k (minimi quadrati su scala log-log)."""
+    pts = [(math.log(x), math.log(y)) for x, y in points if x > 0 and y > 0]
+    if len(pts) < 3:
+        return None
+    mx = sum(x for x, _ in pts) / len(pts)
+    my = sum(y for _, y in pts) / len(pts)
+    sxx = sum((x - mx) ** 2 for x, _ in pts)
+    if sxx == 0:
+        return None
+    return sum((x - mx) * (y - my) for x, y in pts) / sxx
+
+
+def parseSweeps(specs):
+    sweeps = []
+    for spec in specs:
+        axis, _, values = spec.partition("=")
+        if axis not in ("blocks", "insts", "loops", "depth", "functions") or not values:
+            sys.exit(f"--sweep non valido: {spec}")
+        sweeps.append((axis, [int(v) for v in values.split(",")], {}))
+    return sweeps
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("--opt", default="opt", help="eseguibile opt con i pass registrati")
+    ap.add_argument("--plugin", action="append", default=[], help="plugin da caricare con -load-pass-plugin")
+    ap.add_argument("--opt-arg", action="append", default=[], help="argomento aggiuntivo per opt")
+    ap.add_argument("--passes", default=",".join(PASSES), help="pass da misurare (default: tutti)")
+    ap.add_argument("--sweep", action="append", default=[], help="serie asse=v1,v2,... al posto di quelle di default")
+    ap.add_argument("--scale", type=float, default=1.0, help="moltiplica i valori delle serie (es. 0.1 per una prova veloce)")
+    ap.add_argument("--repeat", type=int, default=3)
+    ap.add_argument("--timeout", type=float, default=600)
+    ap.add_argument("--min-time", type=float, default=0.005, help="tempi del pass sotto questa soglia (s) non entrano nella stima")
+    ap.add_argument("--max-exponent", type=float, help="fallisce se una serie cresce più di istruzioni^k")
+    ap.add_argument("--keep", help="directory in cui conservare gli .ll generati")
+    ap.add_argument("-o", "--output", default="-", help="report JSON (default: stdout)")
+    args = ap.parse_args()
+
+    names = [p for p in args.passes.split(",") if p]
+    for name in names:
+        if name not in PASSES:
+            sys.exit(f"pass sconosciuto: {name} (disponibili: {', '.join(PASSES)})")
+    workdir = args.keep or tempfile.mkdtemp(prefix="bench-")
+    os.makedirs(workdir, exist_ok=True)
+
+    report = {"opt": args.opt, "plugins": args.plugin, "host": platform.node(),
+              "repeat": args.repeat, "measures": [], "series": []}
+    generated = {}                                                    # Forma -> (file, istruzioni)
+    baselines = {}                                                    # (file, pipeline) -> misura
+    failed = False
+    for name in names:
+        for axis, values, base in parseSweeps(args.sweep) or PASSES[name]["sweeps"]:
+            points = []
+            if axis in SCALABLE:
+                values = sorted(set(max(1, int(round(v * args.scale))) for v in values))
+            for value in values:
+                shape = dict(dict(blocks=0, insts=20, loops=0, depth=1, functions=1), **base)
+                shape[axis] = value
+                key = tuple(sorted(shape.items()))
+                if key not in generated:
+                    text, count = genIR.generate(**shape)
+                    path = os.path.join(workdir, "b{blocks}_i{insts}_l{loops}_d{depth}_f{functions}.ll".format(**shape))
+                    with open(path, "w") as f:
+                        f.write(text)
+                    generated[key] = (path, count)
+                path, count = generated[key]
+                baseline = PASSES[name]["baseline"]
+                if (path, baseline) not in baselines:
+                    baselines[path, baseline] = measure(args, baseline, path)
+                base_time, base_rss, error = baselines[path, baseline]
+                if not error:
+                    total, rss, error = measure(args, PASSES[name]["pipeline"], path)
+                record = {"pass": name, "axis": axis, "value": value, "shape": shape, "instructions": count}
+                if error:
+                    record["error"] = error
+                else:
+                    record.update(total_s=round(total, 6), baseline_s=round(base_time, 6),
+                                  pass_s=round(max(total - base_time, 0.0), 6),
+                                  peak_rss_kib=rss, baseline_rss_kib=base_rss)
+                    if record["pass_s"] >= args.min_time:
+                        points.append((count, record["pass_s"]))
+                report["measures"].append(record)
+                print(f"{name:15} {axis}={value:<6} {count:>8} istr. "
+                      + (f"errore: {error}" if error else
+                         f"{record['pass_s']:9.4f} s  {rss:>9} KiB"), file=sys.stderr)
+            k = growth(points)
+            series = {"pass": name, "axis": axis, "points": len(points),
+                      "exponent": round(k, 3) if k is not None else None}
+            if k is not None and args.max_exponent is not None and k > args.max_exponent:
+                series["over_threshold"] = True
+                failed = True
+            report["series"].append(series)
+
+    text = json.dumps(report, indent=2)
+    if args.output == "-":
+        print(text)
+    else:
+        with open(args.output, "w") as f:
+            f.write(text + "\n")
+    for s in report["series"]:
+        mark = "  <-- oltre la soglia" if s.get("over_threshold") else ""
+        exp = "n/d" if s["exponent"] is None else f"{s['exponent']:.2f}"
+        print(f"{s['pass']:15} {s['axis']:10} k={exp}{mark}", file=sys.stderr)
+    sys.exit(1 if failed else 0)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,177 @@
+#!/usr/bin/env python3
+"""
+Generatore di IR sintetico (LLVM, puntatori opachi) a forma controllata per
+misurare come scalano i pass degli assignment:
+
+  --blocks N     blocchi in linea retta (con archi in avanti che saltano un
+                 blocco), ognuno con --insts istruzioni: identità algebriche,
+                 moltiplicazioni/divisioni per costante ed espressioni
+                 ridondanti per localopts e per le analisi di dataflow
+  --insts M      istruzioni per blocco e nel corpo di ogni loop più interno
+  --loops K      nidi di loop in sequenza, adiacenti e con lo stesso trip
+                 count (%n): candidati alla fusione a coppie
+  --depth D      profondità di ogni nido di loop
+  --functions F  copie della funzione nel modulo
+
+I loop hanno la forma prodotta da clang -O0 + mem2reg (header con phi e
+confronto, corpo, latch), già in loop-simplify form: preheader, un solo
+latch ed exit dedicati. Il corpo più interno alterna istruzioni invarianti
+(solo argomenti e IV esterne, da spostare con LICM) e istruzioni che
+dipendono dall'IV, legge A[i] (B[i] nei nidi dispari) e scrive B[i].
+
+Uso: genIR.py --blocks 1000 --insts 20 --loops 0 -o out.ll
+"""
+import argparse
+import sys
+
+
+def straightLine(blocks, insts, exit_label, out):
+    """Blocchi in linea retta; restituisce il numero di istruzioni emesse."""
+    count = 0
+    for i in range(blocks):
+        p = f"s{i}"
+        out.append(f"{p}:")
+        prev = f"%{p}.x0"
+        out.append(f"  {prev} = add i32 %a, {i}")
+        count += 1
+        for j in range(1, max(insts - 3, 1)):
+            v = f"%{p}.x{j}"
+            k = j % 7
+            if k == 0:
+                out.append(f"  {v} = add i32 {prev}, 0")                  # x+0
+            elif k == 1:
+                out.append(f"  {v} = mul i32 {prev}, {8 if j % 2 else 12}")  # Shift / shift+add
+            elif k == 2:
+                out.append(f"  {v} = add i32 {prev}, %b")
+            elif k == 3:
+                out.append(f"  {v} = sub i32 {prev}, %b")                 # (x+b)-b
+            elif k == 4:
+                out.append(f"  {v} = add i32 %a, %b")                     # Ridondante (LVN)
+                out.append(f"  {v}.r = add i32 %b, %a")
+                out.append(f"  {v}.s = xor i32 {prev}, {v}.r")
+                count += 2
+                v = f"{v}.s"
+            elif k == 5:
+                out.append(f"  {v} = sdiv i32 {prev}, {4 if j % 2 else 7}")
+            else:
+                out.append(f"  {v} = xor i32 {prev}, %n")
+            prev = v
+            count += 1
+        nxt = f"s{i + 1}" if i + 1 < blocks else exit_label
+        skip = f"s{i + 2}" if i + 2 < blocks else exit_label
+        out.append(f"  %{p}.p = getelementptr inbounds i32, ptr %B, i64 {i % 64}")
+        out.append(f"  store i32 {prev}, ptr %{p}.p, align 4")
+        out.append(f"  %{p}.c = icmp slt i32 {prev}, %n")
+        out.append(f"  br i1 %{p}.c, label %{nxt}, label %{skip}")
+        count += 4
+    return count
+
+
+def loopBody(p, insts, ivs, array, out):
+    """Corpo del loop più interno; ivs = IV dall'esterno all'interno."""
+    iv = ivs[-1]
+    out.append(f"  {p}.idx = sext i32 {iv} to i64")
+    out.append(f"  {p}.pa = getelementptr inbounds i32, ptr %{array}, i64 {p}.idx")
+    out.append(f"  {p}.v = load i32, ptr {p}.pa, align 4")
+    count = 3
+    var, inv = f"{p}.v", "%a"
+    for j in range(max(insts - 5, 1)):
+        v = f"{p}.t{j}"
+        k = j % 3
+        if k == 0:                                                    # Invariante nel loop più interno
+            src = ivs[-2] if len(ivs) > 1 and j % 2 else "%a"
+            out.append(f"  {v} = mul i32 {src}, {j + 3}")
+            inv = v
+        elif k == 1:
+            out.append(f"  {v} = add i32 {var}, {inv}")
+            var = v
+        else:
+            out.append(f"  {v} = xor i32 {var}, {iv}")
+            var = v
+        count += 1
+    out.append(f"  {p}.pb = getelementptr inbounds i32, ptr %B, i64 {p}.idx")
+    out.append(f"  store i32 {var}, ptr {p}.pb, align 4")
+    return count + 2
+
+
+def loopNest(k, level, depth, insts, pre, exit_label, ivs, md, out):
+    """Livello level del nido k; restituisce il numero di istruzioni emesse."""
+    p = f"l{k}.{level}"
+    iv = f"%{p}.i"
+    out.append(f"{p}.h:")
+    out.append(f"  {iv} = phi i32 [ 0, %{pre} ], [ %{p}.inc, %{p}.latch ]")
+    out.append(f"  %{p}.c = icmp slt i32 {iv}, %n")
+    out.append(f"  br i1 %{p}.c, label %{p}.b, label %{exit_label}")
+    out.append(f"{p}.b:")
+    count = 3
+    if level + 1 < depth:
+        out.append(f"  br label %l{k}.{level + 1}.h")
+        count += 1 + loopNest(k, level + 1, depth, insts, f"{p}.b", f"{p}.latch", ivs + [iv], md, out)
+    else:
+        count += loopBody(f"%{p}", insts, ivs + [iv], "A" if k % 2 == 0 else "B", out)
+        out.append(f"  br label %{p}.latch")
+        count += 1
+    out.append(f"{p}.latch:")
+    out.append(f"  %{p}.inc = add nsw i32 {iv}, 1")
+    md.append(len(md) + 1)                                            # Metadati llvm.loop distinti per ogni loop
+    out.append(f"  br label %{p}.h, !llvm.loop !{md[-1]}")
+    return count + 2
+
+
+def function(name, blocks, insts, loops, depth, md, out):
+    out.append(f"define dso_local void @{name}(ptr noundef %A, ptr noundef %B, i32 noundef %n, "
+               f"i32 noundef %a, i32 noundef %b) {{")
+    out.append("entry:")
+    out.append(f"  br label %{'s0' if blocks else 'nests'}")
+    count = 1 + straightLine(blocks, insts, "nests", out)
+    out.append("nests:")
+    out.append(f"  br label %{'l0.0.h' if loops else 'ret'}")
+    count += 1
+    depth = max(depth, 1)
+    for k in range(loops):
+        pre = "nests" if k == 0 else f"l{k - 1}.exit"
+        count += loopNest(k, 0, depth, insts, pre, f"l{k}.exit", [], md, out)
+        out.append(f"l{k}.exit:")
+        out.append(f"  br label %{f'l{k + 1}.0.h' if k + 1 < loops else 'ret'}")
+        count += 1
+    out.append("ret:")
+    out.append("  ret void")
+    out.append("}")
+    return count + 1
+
+
+def generate(blocks=0, insts=20, loops=0, depth=1, functions=1):
+    """Restituisce (testo del modulo, numero di istruzioni)."""
+    out = [f"; genIR.py --blocks {blocks} --insts {insts} --loops {loops} "
+           f"--depth {depth} --functions {functions}",
+           'target datalayout = "e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-i128:128-f80:128-n8:16:32:64-S128"',
+           'target triple = "x86_64-pc-linux-gnu"', ""]
+    count, md = 0, []
+    for f in range(functions):
+        count += function(f"bench{f}", blocks, insts, loops, depth, md, out)
+        out.append("")
+    out.append('!0 = !{!"llvm.loop.mustprogress"}')
+    out.extend(f"!{i} = distinct !{{!{i}, !0}}" for i in md)
+    return "\n".join(out) + "\n", count
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("--blocks", type=int, default=0)
+    ap.add_argument("--insts", type=int, default=20)
+    ap.add_argument("--loops", type=int, default=0)
+    ap.add_argument("--depth", type=int, default=1)
+    ap.add_argument("--functions", type=int, default=1)
+    ap.add_argument("-o", "--output", default="-")
+    args = ap.parse_args()
+    text, count = generate(args.blocks, args.insts, args.loops, args.depth, args.functions)
+    if args.output == "-":
+        sys.stdout.write(text)
+    else:
+        with open(args.output, "w") as f:
+            f.write(text)
+    print(f"{count} istruzioni", file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
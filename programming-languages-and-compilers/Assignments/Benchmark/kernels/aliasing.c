@@ -0,0 +1,43 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#define N 8192
+
+int x[N], y[N], z[N];
+long total;
+
+/* Due passate adiacenti su puntatori che potrebbero sovrapporsi: fondibili solo
+   dietro un controllo a runtime sugli intervalli di src, mid e dst */
+void sweep(int *dst, int *mid, int *src, int n, int k){
+    for (int i = 0; i < n; i++)
+        mid[i] = src[i] * k + 1;
+    for (int i = 0; i < n; i++)
+        dst[i] = mid[i] - src[i];
+}
+
+/* Accumulo in *acc e store in out[]: senza controllo a runtime *acc resta in memoria */
+void accumulate(int *out, const int *in, long *acc, int n){
+    int i = 0;
+    do {
+        *acc += in[i];
+        out[i] = in[i] >> 1;
+        i++;
+    } while (i < n);
+}
+
+int main(int argc, char **argv){
+    int reps = argc > 1 ? atoi(argv[1]) : 20000;
+    for (int i = 0; i < N; i++)
+        x[i] = i % 97 - 48;
+    unsigned long checksum = 0;
+    for (int r = 0; r < reps; r++){
+        sweep(z, y, x, N, r % 7 + 1);
+        accumulate(x, z, &total, N);
+        /* Una volta su otto gli intervalli si sovrappongono: gira la copia originale */
+        if (r % 8 == 0)
+            sweep(x + 1, x, x + 2, N - 2, 3);
+        checksum = checksum * 31 + (unsigned long)total + (unsigned long)z[r % N];
+    }
+    printf("%lu\n", checksum);
+    return 0;
+}
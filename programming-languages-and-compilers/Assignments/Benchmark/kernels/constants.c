@@ -0,0 +1,31 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#define N 4096
+
+/* Aritmetica con costanti: identità algebriche, moltiplicazioni e divisioni per costante, (v + b) - b */
+unsigned arith(unsigned x, unsigned b){
+    unsigned r = 0;
+    for (int i = 0; i < N; i++){
+        unsigned v = x + i;
+        unsigned t0 = v * 16;
+        unsigned t1 = t0 + 0;
+        unsigned t2 = t1 * 1;
+        unsigned t3 = (t2 + b) - b;
+        unsigned t4 = t3 / 8;
+        unsigned t5 = v * 15;
+        unsigned t6 = t5 * 9;
+        unsigned t7 = (v + b) * 1 - b;
+        r ^= t4 + t6 + t7 / 4;
+    }
+    return r;
+}
+
+int main(int argc, char **argv){
+    int reps = argc > 1 ? atoi(argv[1]) : 40000;
+    unsigned checksum = 0;
+    for (int r = 0; r < reps; r++)
+        checksum = checksum * 31 + arith(r, r * 7 + 3);
+    printf("%u\n", checksum);
+    return 0;
+}
@@ -0,0 +1,30 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#define N 4096
+
+unsigned a[N], b[N], c[N], d[N], p[N];
+
+/* Una ricorrenza tra iterazioni (p) in mezzo a store indipendenti: candidato alla distribuzione */
+void kernel(unsigned k){
+    for (int i = 1; i < N; i++){
+        a[i] = b[i] * k + c[i];
+        p[i] = p[i-1] * 3 + a[i];
+        d[i] = a[i] - b[i];
+    }
+}
+
+int main(int argc, char **argv){
+    int reps = argc > 1 ? atoi(argv[1]) : 20000;
+    for (int i = 0; i < N; i++){
+        b[i] = i % 17;
+        c[i] = i % 5;
+    }
+    unsigned checksum = 0;
+    for (int r = 0; r < reps; r++){
+        kernel(r);
+        checksum = checksum * 31 + p[N-1] + d[r % N];
+    }
+    printf("%u\n", checksum);
+    return 0;
+}
@@ -0,0 +1,46 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#define M 96
+
+unsigned A[M][M], B[M][M], P[M][M];
+
+/* Prodotto di matrici: nel loop più interno gli indirizzi di riga sono invarianti */
+void matmul(void){
+    for (int i = 0; i < M; i++)
+        for (int j = 0; j < M; j++){
+            unsigned s = 0;
+            for (int k = 0; k < M; k++)
+                s += A[i][k] * B[k][j];
+            P[i][j] = s;
+        }
+}
+
+/* Due nidi adiacenti con gli stessi trip count che leggono gli stessi elementi: fusione di interi nidi */
+void update(unsigned k){
+    for (int i = 0; i < M; i++)
+        for (int j = 0; j < M; j++)
+            A[i][j] = (A[i][j] * k + P[i][j]) % 1000;
+    for (int i = 0; i < M; i++)
+        for (int j = 0; j < M; j++)
+            B[i][j] = (B[i][j] + A[i][j]) % 1000;
+}
+
+int main(int argc, char **argv){
+    int reps = argc > 1 ? atoi(argv[1]) : 150;
+    for (int i = 0; i < M; i++)
+        for (int j = 0; j < M; j++){
+            A[i][j] = (i + j) % 10;
+            B[i][j] = (i * j) % 10;
+        }
+    for (int r = 0; r < reps; r++){
+        matmul();
+        update(r % 9 + 1);
+    }
+    unsigned checksum = 0;
+    for (int i = 0; i < M; i++)
+        for (int j = 0; j < M; j++)
+            checksum = checksum * 31 + P[i][j] + B[i][j];
+    printf("%u\n", checksum);
+    return 0;
+}
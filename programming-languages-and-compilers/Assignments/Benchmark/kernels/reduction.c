@@ -0,0 +1,30 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#define N 8192
+
+int x[N], y[N];
+
+/* Prodotto scalare pesato: scale e bias sono invarianti, da spostare fuori dal loop */
+long reduce(int n, int k){
+    long s = 0;
+    for (int i = 0; i < N; i++){
+        int scale = k * 3 + n;
+        int bias = (k << 2) ^ n;
+        s += (long)x[i] * y[i] * scale + bias;
+    }
+    return s;
+}
+
+int main(int argc, char **argv){
+    int reps = argc > 1 ? atoi(argv[1]) : 20000;
+    for (int i = 0; i < N; i++){
+        x[i] = i % 101 - 50;
+        y[i] = i % 37;
+    }
+    unsigned long checksum = 0;
+    for (int r = 0; r < reps; r++)
+        checksum = checksum * 31 + (unsigned long)reduce(r % 64, r % 5);
+    printf("%lu\n", checksum);
+    return 0;
+}
@@ -0,0 +1,44 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#define N 8192
+
+int a[N], b[N];
+
+/* Come in LICM.c: c + 3 e c * 7 sono calcolati su un solo ramo e ricalcolati dopo il join */
+long branches(int c){
+    long s = 0;
+    for (int i = 0; i < N; i++){
+        int v = a[i], h;
+        if (v & 1)
+            h = (c + 3) * v;
+        else
+            h = (c * 7) ^ v;
+        s += h + (c + 3) * (c * 7);
+    }
+    return s;
+}
+
+/* Loop do-while: le espressioni invarianti sono anticipabili già all'ingresso del loop */
+long invariant(int c, int k){
+    long s = 0;
+    int i = 0;
+    do {
+        s += (long)b[i] * (k * 3 + c) + ((k << 2) ^ c);
+        i++;
+    } while (i < N);
+    return s;
+}
+
+int main(int argc, char **argv){
+    int reps = argc > 1 ? atoi(argv[1]) : 20000;
+    for (int i = 0; i < N; i++){
+        a[i] = i % 113 - 56;
+        b[i] = i % 41;
+    }
+    unsigned long checksum = 0;
+    for (int r = 0; r < reps; r++)
+        checksum = checksum * 31 + (unsigned long)(branches(r % 97) + invariant(r % 64, r % 5));
+    printf("%lu\n", checksum);
+    return 0;
+}
@@ -0,0 +1,32 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#define R 256
+#define C 256
+
+unsigned in[R][C], out[R][C];
+
+/* Stencil a 5 punti: il divisore e l'offset sono invarianti nei loop, i due nidi non si possono fondere */
+void stencil(unsigned w){
+    for (int i = 1; i < R - 1; i++)
+        for (int j = 1; j < C - 1; j++)
+            out[i][j] = (in[i-1][j] + in[i+1][j] + in[i][j-1] + in[i][j+1] + w * in[i][j]) / (w + 4);
+    for (int i = 1; i < R - 1; i++)
+        for (int j = 1; j < C - 1; j++)
+            in[i][j] = out[i][j] + (w & 3);
+}
+
+int main(int argc, char **argv){
+    int reps = argc > 1 ? atoi(argv[1]) : 700;
+    for (int i = 0; i < R; i++)
+        for (int j = 0; j < C; j++)
+            in[i][j] = (i * 31 + j * 17) % 256;
+    for (int r = 0; r < reps; r++)
+        stencil(r % 7 + 1);
+    unsigned checksum = 0;
+    for (int i = 0; i < R; i++)
+        for (int j = 0; j < C; j++)
+            checksum = checksum * 31 + in[i][j];
+    printf("%u\n", checksum);
+    return 0;
+}
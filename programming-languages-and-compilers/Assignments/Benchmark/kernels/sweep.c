@@ -0,0 +1,29 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#define N 4096
+
+unsigned a[N], b[N], c[N];
+
+/* Tre passate adiacenti sugli stessi array: candidati alla fusione, con riuso */
+unsigned sweep(unsigned k){
+    unsigned s = 0;
+    for (int i = 0; i < N; i++)
+        a[i] = b[i] * k;
+    for (int i = 0; i < N; i++)
+        c[i] = a[i] + b[i];
+    for (int i = 0; i < N; i++)
+        s += c[i] ^ a[i];
+    return s;
+}
+
+int main(int argc, char **argv){
+    int reps = argc > 1 ? atoi(argv[1]) : 20000;
+    for (int i = 0; i < N; i++)
+        b[i] = i * 7 % 13;
+    unsigned checksum = 0;
+    for (int r = 0; r < reps; r++)
+        checksum = checksum * 31 + sweep(r);
+    printf("%u\n", checksum);
+    return 0;
+}
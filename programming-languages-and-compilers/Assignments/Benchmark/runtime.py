@@ -0,0 +1,220 @@
+#!/usr/bin/env python3
+"""
+Benchmark delle prestazioni a runtime del codice prodotto dai pass degli assignment.
+
+Ogni kernel (kernels/*.c, oppure un .ll già prodotto da clang -O0) viene portato in IR con
+clang -O0 senza optnone, poi compilato con la pipeline di riferimento (mem2reg e la stessa
+canonicalizzazione del pass) e con la pipeline che aggiunge il pass, con llc e il linker di sistema.
+Gli eseguibili vengono eseguiti in locale: l'output di ogni variante deve coincidere con quello
+della pipeline di riferimento, altrimenti il pass ha cambiato il comportamento del programma.
+
+Per ogni variante misura cicli e istruzioni con perf stat (se disponibile) e il tempo reale,
+minimo su --repeat esecuzioni; lo speedup è il rapporto tra la misura di riferimento e quella
+con il pass (cicli se perf funziona, altrimenti tempo), più la media geometrica per pass.
+
+Uso:
+  runtime.py --opt path/to/opt --clang clang [--plugin plugin.so] [--passes localopts,licmpass]
+             [--kernels kernels/] [--repeat 5] [--min-speedup 0.95] [-o report.json]
+"""
+import argparse
+import json
+import math
+import os
+import platform
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+# Pipeline di opt per ogni pass e pipeline di riferimento con la stessa canonicalizzazione
+PASSES = {
+    "localopts": {"pipeline": "function(mem2reg),localopts", "baseline": "function(mem2reg)"},
+    "licmpass": {"pipeline": "function(mem2reg,loop(licmpass))", "baseline": "function(mem2reg,loop(no-op-loop))"},
+    "ivstrengthreduction": {"pipeline": "function(mem2reg,loop(ivstrengthreduction))",
+                            "baseline": "function(mem2reg,loop(no-op-loop))"},
+    "loopfusionpass": {"pipeline": "function(mem2reg,loopfusionpass)", "baseline": "function(mem2reg)"},
+    "loopdistributionpass": {"pipeline": "function(mem2reg,loopdistributionpass)", "baseline": "function(mem2reg)"},
+    "lazycodemotion": {"pipeline": "function(mem2reg,lazycodemotion)", "baseline": "function(mem2reg)"},
+}
+
+
+def run(cmd, **kwargs):
+    """Esegue un comando; restituisce (stdout, errore o None)."""
+    try:
+        proc = subprocess.run(cmd, stdout=subprocess.PIPE, stderr=subprocess.PIPE, **kwargs)
+    except subprocess.TimeoutExpired:
+        return None, "timeout"
+    except OSError as e:
+        return None, f"{cmd[0]}: {e.strerror}"
+    if proc.returncode:
+        lines = proc.stderr.decode(errors="replace").strip().splitlines()
+        return None, lines[-1] if lines else f"{os.path.basename(cmd[0])}: exit {proc.returncode}"
+    return proc.stdout, None
+
+
+def frontend(args, kernel, workdir):
+    """IR di partenza del kernel (clang -O0 senza optnone, come gli input degli assignment)."""
+    name, ext = os.path.splitext(os.path.basename(kernel))
+    path = os.path.join(workdir, name + ".ll")
+    if ext == ".ll":
+        shutil.copyfile(kernel, path)
+        return path, None
+    _, error = run([args.clang, "-O0", "-Xclang", "-disable-O0-optnone", "-S", "-emit-llvm"]
+                   + args.cflag + ["-o", path, kernel])
+    return path, error
+
+
+def build(args, source, pipeline, tag):
+    """opt + llc + link di una variante; restituisce (eseguibile, errore)."""
+    base = os.path.splitext(source)[0] + "." + tag
+    cmd = [args.opt] + args.opt_arg + [f"-load-pass-plugin={p}" for p in args.plugin]
+    _, error = run(cmd + ["-S", f"-passes={pipeline}", source, "-o", base + ".ll"])
+    if not error:
+        _, error = run([args.llc] + args.llc_arg + ["-filetype=obj", base + ".ll", "-o", base + ".o"])
+    if not error:
+        _, error = run([args.cc, base + ".o", "-o", base, "-lm"])
+    return base, error
+
+
+def perfCounters(args, exe):
+    """Cicli e istruzioni di un'esecuzione con perf stat (None se perf non è disponibile)."""
+    if not args.perf:
+        return None
+    with tempfile.NamedTemporaryFile("r") as out:
+        _, error = run([args.perf, "stat", "-x", ",", "-e", "cycles,instructions", "-o", out.name, "--", exe]
+                       + args.run_arg)
+        if error:
+            return None
+        counters = {}
+        for line in out.read().splitlines():
+            fields = line.split(",")
+            if len(fields) > 2 and fields[0].strip().isdigit():
+                counters[fields[2].split(":")[0]] = int(fields[0])
+    if "cycles" not in counters or "instructions" not in counters:
+        return None
+    return counters
+
+
+def measure(args, exe):
+    """Output del programma (da una prima esecuzione, non misurata) e misure minime su --repeat esecuzioni."""
+    output, error = run([exe] + args.run_arg, timeout=args.timeout)
+    if error:
+        return None, None, error
+    best, counters = None, None
+    for _ in range(args.repeat):
+        start = time.perf_counter()
+        _, error = run([exe] + args.run_arg, timeout=args.timeout)
+        elapsed = time.perf_counter() - start
+        if error:
+            return None, None, error
+        best = elapsed if best is None else min(best, elapsed)
+        sample = perfCounters(args, exe)
+        if sample and (counters is None or sample["cycles"] < counters["cycles"]):
+            counters = sample
+    result = {"time_s": round(best, 6)}
+    if counters:
+        result.update(cycles=counters["cycles"], instructions=counters["instructions"])
+    return output, result, None
+
+
+def speedup(reference, variant):
+    key = "cycles" if "cycles" in reference and "cycles" in variant else "time_s"
+    return round(reference[key] / variant[key], 4) if variant[key] else None
+
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("--opt", default="opt", help="eseguibile opt con i pass registrati")
+    ap.add_argument("--plugin", action="append", default=[], help="plugin da caricare con -load-pass-plugin")
+    ap.add_argument("--opt-arg", action="append", default=[], help="argomento aggiuntivo per opt")
+    ap.add_argument("--clang", default="clang", help="front-end per i kernel in C")
+    ap.add_argument("--cflag", action="append", default=[], help="argomento aggiuntivo per clang")
+    ap.add_argument("--llc", default="llc")
+    ap.add_argument("--llc-arg", action="append", default=None,
+                    help="argomento per llc (default -O0: si misura il pass, non il backend)")
+    ap.add_argument("--cc", default="cc", help="linker (compilatore C di sistema)")
+    ap.add_argument("--perf", default=shutil.which("perf"), help="perf per cicli e istruzioni (default: dal PATH)")
+    ap.add_argument("--passes", default=",".join(PASSES), help="pass da misurare (default: tutti)")
+    ap.add_argument("--kernels", default=os.path.join(here, "kernels"), help="directory o file dei kernel (.c o .ll)")
+    ap.add_argument("--run-arg", action="append", default=[], help="argomento per gli eseguibili (es. ripetizioni)")
+    ap.add_argument("--repeat", type=int, default=5)
+    ap.add_argument("--timeout", type=float, default=600)
+    ap.add_argument("--min-speedup", type=float, help="fallisce se un pass rallenta un kernel sotto questa soglia")
+    ap.add_argument("--keep", help="directory in cui conservare IR ed eseguibili")
+    ap.add_argument("-o", "--output", default="-", help="report JSON (default: stdout)")
+    args = ap.parse_args()
+    if args.llc_arg is None:
+        args.llc_arg = ["-O0"]
+
+    names = [p for p in args.passes.split(",") if p]
+    for name in names:
+        if name not in PASSES:
+            sys.exit(f"pass sconosciuto: {name} (disponibili: {', '.join(PASSES)})")
+    if os.path.isdir(args.kernels):
+        kernels = sorted(os.path.join(args.kernels, f) for f in os.listdir(args.kernels) if f.endswith((".c", ".ll")))
+    else:
+        kernels = [args.kernels]
+    workdir = args.keep or tempfile.mkdtemp(prefix="runtime-")
+    os.makedirs(workdir, exist_ok=True)
+
+    report = {"opt": args.opt, "plugins": args.plugin, "host": platform.node(), "repeat": args.repeat,
+              "counters": "perf" if args.perf else "time", "measures": [], "summary": []}
+    failed = False
+    ratios = {name: [] for name in names}
+    for kernel in kernels:
+        kname = os.path.splitext(os.path.basename(kernel))[0]
+        source, error = frontend(args, kernel, workdir)
+        variants = {}                                                 # Pipeline -> (output, misura, errore)
+
+        def variant(pipeline):
+            if pipeline not in variants:
+                tag = f"v{len(variants)}"
+                exe, err = build(args, source, pipeline, tag)
+                variants[pipeline] = (None, None, err) if err else measure(args, exe)
+            return variants[pipeline]
+
+        for name in names:
+            record = {"kernel": kname, "pass": name}
+            if error:
+                record["error"] = error
+            else:
+                ref_out, ref, ref_err = variant(PASSES[name]["baseline"])
+                out, res, err = variant(PASSES[name]["pipeline"])
+                if ref_err or err:
+                    record["error"] = ref_err or err
+                elif out != ref_out:
+                    record["error"] = "output diverso dalla pipeline di riferimento"
+                else:
+                    record.update(baseline=ref, optimized=res, speedup=speedup(ref, res))
+                    ratios[name].append(record["speedup"])
+                    if args.min_speedup is not None and record["speedup"] < args.min_speedup:
+                        record["under_threshold"] = True
+                        failed = True
+            if "error" in record:
+                failed = True
+            report["measures"].append(record)
+            print(f"{kname:12} {name:21} " + (f"errore: {record['error']}" if "error" in record else
+                  f"speedup {record['speedup']:6.3f}  ({record['baseline']['time_s']:.4f} s -> "
+                  f"{record['optimized']['time_s']:.4f} s)" + ("  <-- sotto la soglia" if record.get("under_threshold") else "")),
+                  file=sys.stderr)
+
+    for name in names:
+        values = [r for r in ratios[name] if r]
+        mean = math.exp(sum(math.log(r) for r in values) / len(values)) if values else None
+        report["summary"].append({"pass": name, "kernels": len(values),
+                                  "geomean_speedup": round(mean, 4) if mean else None})
+        print(f"{name:21} media geometrica " + ("n/d" if mean is None else f"{mean:.3f}"), file=sys.stderr)
+
+    text = json.dumps(report, indent=2)
+    if args.output == "-":
+        print(text)
+    else:
+        with open(args.output, "w") as f:
+            f.write(text + "\n")
+    sys.exit(1 if failed else 0)
+
+
+if __name__ == "__main__":
+    main()
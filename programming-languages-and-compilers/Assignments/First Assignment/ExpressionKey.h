@@ -0,0 +1,69 @@
+#ifndef LLVM_TRANSFORMS_EXPRESSIONKEY_H
+#define LLVM_TRANSFORMS_EXPRESSIONKEY_H
+#include "llvm/ADT/DenseMapInfo.h"
+#include "llvm/ADT/Hashing.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/IR/InstrTypes.h"
+#include "llvm/IR/Instructions.h"
+
+namespace llvm {
+  /*
+    Chiave di un'espressione: opcode, predicato (per i confronti), tipo del
+    risultato, tipo sorgente (per le GEP) e operandi, ordinati per le
+    operazioni commutative. Due istruzioni con la stessa chiave calcolano lo
+    stesso valore. Usata dal local value numbering di LocalOpts e dal dominio
+    delle espressioni dell'analisi di dataflow
+  */
+  struct ExpressionKey {
+    unsigned Opcode;
+    unsigned Predicate=0;
+    Type *Ty=nullptr;
+    Type *SourceTy=nullptr;
+    SmallVector<const Value*,2> Operands;
+
+    ExpressionKey(unsigned Opcode=~0U) : Opcode(Opcode) {}
+
+    bool operator==(const ExpressionKey &other) const {
+      return Opcode==other.Opcode and Predicate==other.Predicate and Ty==other.Ty and
+             SourceTy==other.SourceTy and Operands==other.Operands;
+    }
+
+    /*
+      Solo le istruzioni senza effetti collaterali e che non leggono memoria
+      possono avere una chiave
+    */
+    static bool isCandidate(const Instruction *I){
+      return isa<BinaryOperator>(I) or isa<CmpInst>(I) or isa<CastInst>(I) or
+             isa<GetElementPtrInst>(I) or isa<SelectInst>(I);
+    }
+
+    static ExpressionKey get(const Instruction *I){
+      ExpressionKey e(I->getOpcode());
+      e.Ty=I->getType();
+      for(const Value *op : I->operands())
+        e.Operands.push_back(op);
+      if(const CmpInst *cmp=dyn_cast<CmpInst>(I))
+        e.Predicate=cmp->getPredicate();
+      if(const GetElementPtrInst *gep=dyn_cast<GetElementPtrInst>(I))
+        e.SourceTy=gep->getSourceElementType();
+      if(I->isCommutative() and e.Operands[1]<e.Operands[0]){     // Ordino gli operandi delle operazioni commutative
+        std::swap(e.Operands[0],e.Operands[1]);
+      }else if(isa<CmpInst>(I) and e.Operands[1]<e.Operands[0]){  // Per i confronti scambio anche il predicato: a<b == b>a
+        std::swap(e.Operands[0],e.Operands[1]);
+        e.Predicate=CmpInst::getSwappedPredicate(CmpInst::Predicate(e.Predicate));
+      }
+      return e;
+    }
+  };
+
+  template <> struct DenseMapInfo<ExpressionKey> {
+    static ExpressionKey getEmptyKey() { return ExpressionKey(~0U); }
+    static ExpressionKey getTombstoneKey() { return ExpressionKey(~1U); }
+    static unsigned getHashValue(const ExpressionKey &e) {
+      return hash_combine(e.Opcode, e.Predicate, e.Ty, e.SourceTy,
+                          hash_combine_range(e.Operands.begin(), e.Operands.end()));
+    }
+    static bool isEqual(const ExpressionKey &a, const ExpressionKey &b) { return a==b; }
+  };
+}
+#endif
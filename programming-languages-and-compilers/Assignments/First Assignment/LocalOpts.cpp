@@ -5,132 +5,781 @@
 */
 
 #include "llvm/Transforms/Utils/LocalOpts.h"
+#include "llvm/Transforms/Utils/ExpressionKey.h"
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/InstrTypes.h"
+#include "llvm/IR/PatternMatch.h"
+#include "llvm/Analysis/ConstantFolding.h"
+#include "llvm/Transforms/Utils/Local.h"
 #include <llvm/IR/Constants.h>
-#include "cmath"
+#define DEBUG_TYPE "localopts"                                    // Richiesto da InstructionWorklist per LLVM_DEBUG
+#include "llvm/Transforms/Utils/InstructionWorklist.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/Bitcode/BitcodeReader.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/Transforms/Utils/Cloning.h"
+#include "llvm/Transforms/Utils/ValueMapper.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Timer.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Analysis/OptimizationRemarkEmitter.h"
+#include "llvm/Pass.h"
+#include <algorithm>
+#include <vector>
 
 using namespace llvm;
+using namespace llvm::PatternMatch;
+
+STATISTIC(NumRedundant, "Numero di espressioni ridondanti eliminate dal value numbering");
+STATISTIC(NumRounds, "Numero totale di round del motore a punto fisso");
+STATISTIC(NumPartitioned, "Numero di funzioni ottimizzate nelle partizioni parallele");
+STATISTIC(NumSCCPConstants, "Numero di istruzioni sostituite da una costante dalla propagazione");
+STATISTIC(NumSCCPBranches, "Numero di branch con condizione costante ripiegati");
+STATISTIC(NumSCCPBlocks, "Numero di blocchi mai eseguiti eliminati");
+
+// Un contatore per ogni regola di LocalOptsRules.def
+#define RULE(NAME, PATTERN, CONSTRAINT, RESULT, DESC) STATISTIC(Num##NAME, "Regola " #NAME ": " DESC);
+#define ACTION(NAME, PATTERN, CONSTRAINT, APPLY, DESC) STATISTIC(Num##NAME, "Regola " #NAME ": " DESC);
+#include "LocalOptsRules.def"
+
+static const char *TimerGroupName="localopts";
+static const char *TimerGroupDesc="LocalOpts";
+
+/*
+  Numero massimo di round del motore a punto fisso: ogni round visita tutte le
+  istruzioni della funzione, quindi il limite serve solo come protezione
+*/
+static cl::opt<unsigned> MaxRounds("localopts-max-rounds", cl::init(8), cl::Hidden,
+                                   cl::desc("Numero massimo di round di LocalOpts per funzione"));
+
+/*
+  Propagazione delle costanti tra blocchi all'inizio di ogni round: a
+  differenza delle regole locali può ripiegare i branch ed eliminare blocchi,
+  quindi è disattivata di default e localopts non modifica il CFG. Di norma
+  la pipeline compone i due pass (localsccp,localopts)
+*/
+static cl::opt<bool> UseSCCP("localopts-sccp", cl::init(false), cl::Hidden,
+                             cl::desc("Esegue la propagazione sparsa delle costanti prima delle regole di LocalOpts"));
 
 /*
-  Funzione di controllo per verificare l'esistenza di un valore numerico
-  costante all'interno dell'istruzione
+  Modalità a partizioni del pass di modulo: con più di un thread e almeno
+  ParallelThreshold funzioni definite, il modulo viene diviso in partizioni
+  ottimizzate in parallelo, ognuna nel proprio LLVMContext
 */
-bool check(BinaryOperator *instr,ConstantInt *&num,Value *&op){
-  num=dyn_cast<ConstantInt>(instr->getOperand(0));
-  op=instr->getOperand(1);
-  if(not num){                                                    // Nel caso non si sia trovato il valore numerico al primo operando,
-    num=dyn_cast<ConstantInt>(instr->getOperand(1));              // controllo l'esistenza di esso all'interno del secondo.
-    op=instr->getOperand(0);
+static cl::opt<unsigned> Threads("localopts-threads", cl::init(1), cl::Hidden,
+                                 cl::desc("Thread di LocalOpts a livello di modulo (0 = tutti i core, 1 = seriale)"));
+static cl::opt<unsigned> ParallelThreshold("localopts-parallel-threshold", cl::init(64), cl::Hidden,
+                                           cl::desc("Numero minimo di funzioni per partizionare il modulo"));
+
+/*
+  CPU di cui usare la tabella dei costi. Se vuota si usa l'attributo
+  "target-cpu" della funzione, e in sua assenza la riga "generic"
+*/
+static cl::opt<std::string> TargetCPU("localopts-cpu", cl::init(""), cl::Hidden,
+                                      cl::desc("CPU per la tabella dei costi di LocalOpts"));
+
+/*
+  Costante intera dell'operando: uno scalare oppure uno splat vettoriale
+  (<4 x i32> <i32 8, i32 8, i32 8, i32 8>), che vale uguale in ogni corsia
+*/
+ConstantInt *getSplatInt(Value *V){
+  if(ConstantInt *num=dyn_cast<ConstantInt>(V))
+    return num;
+  if(Constant *C=dyn_cast<Constant>(V))
+    if(C->getType()->isVectorTy())
+      return dyn_cast_or_null<ConstantInt>(C->getSplatValue());
+  return nullptr;
+}
+
+/*
+  Valori delle singole corsie di una costante intera, scalare o vettoriale
+  anche non uniforme (<4 x i32> <i32 2, i32 4, i32 8, i32 16>). Fallisce se
+  una corsia è undef/poison o se il vettore è scalabile
+*/
+bool getLaneValues(Value *V, SmallVectorImpl<APInt> &lanes){
+  if(ConstantInt *num=dyn_cast<ConstantInt>(V)){
+    lanes.push_back(num->getValue());
+    return true;
   }
-  if(not num){                                                      
-    return false;                                                 // Restituiamo false in caso non esista alcun valore costante,
+  Constant *C=dyn_cast<Constant>(V);
+  auto *vecType=C?dyn_cast<FixedVectorType>(C->getType()):nullptr;
+  if(not vecType)
+    return false;
+  for(unsigned l=0; l<vecType->getNumElements(); l++){
+    ConstantInt *lane=dyn_cast_or_null<ConstantInt>(C->getAggregateElement(l));
+    if(not lane)
+      return false;
+    lanes.push_back(lane->getValue());
   }
-  return true;                                                    // true nel caso si sia trovato almeno in un operando
+  return true;
 }
 
 /*
-------------------- 1. Algebraic Identity -------------------
-                        x+0 = 0+x => x
-                        x*1 = 1*x => x
--------------------------------------------------------------
+  Costante di tipo 'type' con i valori dati per corsia: con un solo valore
+  ConstantInt::get crea lo splat, altrimenti costruisco il vettore corsia per corsia
 */
-bool algebraicIdentity(llvm::BasicBlock::iterator &i) {
-  ConstantInt *num=nullptr;                                       // Valore numerico costante passato successivamente dalla funzione check
-  Value *op=nullptr;                                              // Variabile passata successivamente dalla funzione check
-  if(i->getOpcode()==BinaryOperator::Add){                        // Caso di addizione
-    BinaryOperator *add=nullptr;
-    add=dyn_cast<BinaryOperator>(i);
-    if(check(add,num,op)){
-      if(num->getValue().isZero()){                               // Controlliamo se la costante è zero
-        add->replaceAllUsesWith(op);                              // Sostituisco in tutte le istruzioni in cui viene utilizzato il valore restituito 
-                                                                  // dall'istruzione 'add', con la variabile utilizzata all'interno di essa.
-                                                                  // Quindi se Y=X+0 (o 0+X) => X=Y
-        i++;                                                      // Dopo aver incrementato l'iteratore del BasicBlock,
-        add->eraseFromParent();                                   // eliminiamo l'istruzione 'add', ormai inutilizzata
-        return true;
-      }
+Constant *getLaneConstant(Type *type, ArrayRef<APInt> lanes){
+  if(lanes.size()==1)
+    return ConstantInt::get(type, lanes[0]);
+  SmallVector<Constant*,8> elements;
+  for(const APInt &lane : lanes)
+    elements.push_back(ConstantInt::get(type->getContext(), lane));
+  return ConstantVector::get(elements);
+}
+
+/*
+  Sostituisce tutti gli usi di 'instr' con 'val' ed elimina l'istruzione.
+  Gli utilizzatori di 'instr' vengono reinseriti nella worklist, perché la
+  sostituzione potrebbe aver esposto nuove ottimizzazioni su di essi
+*/
+void replaceAndErase(Instruction *instr, Value *val, InstructionWorklist &worklist){
+  worklist.pushUsersToWorkList(*instr);                           // Gli utilizzatori vedranno 'val' al posto di 'instr'
+  worklist.pushValue(val);                                        // Anche la nuova istruzione (se lo è) va visitata
+  instr->replaceAllUsesWith(val);
+  worklist.remove(instr);                                         // L'istruzione non deve più essere estratta dalla worklist
+  instr->eraseFromParent();
+}
+
+/*
+  Strumentazione di un'esecuzione su una funzione: emettitore dei remark
+  (nullptr nei thread delle partizioni, il cui contesto non ha un output per
+  i remark), timer per fase (non thread-safe, quindi spenti nei thread) e
+  istruzioni già segnalate come non ottimizzate, per non ripetere lo stesso
+  remark a ogni round
+*/
+struct Instrumentation {
+  OptimizationRemarkEmitter *ORE=nullptr;
+  bool Timers=false;
+  SmallPtrSet<const Instruction*,16> Missed;
+};
+
+void remarkApplied(Instrumentation &instr, StringRef name, Instruction *i, const Twine &msg){
+  if(instr.ORE)
+    instr.ORE->emit([&](){ return OptimizationRemark(DEBUG_TYPE, name, i) << msg.str(); });
+}
+
+void remarkMissed(Instrumentation &instr, StringRef name, Instruction *i, const Twine &msg){
+  if(instr.ORE and instr.Missed.insert(i).second)
+    instr.ORE->emit([&](){ return OptimizationRemarkMissed(DEBUG_TYPE, name, i) << msg.str(); });
+}
+
+/*
+  Tabella dei costi per CPU (in cicli): latenza e reciproco del throughput
+  della moltiplicazione intera e delle operazioni ALU semplici (add, sub, shl).
+  La prima riga è quella usata per le CPU non presenti in tabella
+*/
+struct TargetCost {
+  const char *CPU;
+  unsigned MulLatency;                                            // mul fino a i32
+  unsigned MulLatency64;                                          // mul su i64 (e tipi più larghi)
+  double MulRecipThroughput;
+  unsigned AluLatency;
+  double AluRecipThroughput;
+  unsigned DivLatency;                                            // div/rem fino a i32 (caso peggiore)
+  unsigned DivLatency64;                                          // div/rem su i64 (e tipi più larghi)
+};
+
+static const TargetCost CostTable[]={
+  {"generic",    3, 3, 1.0, 1, 0.33, 26, 40},
+  {"x86-64",     3, 3, 1.0, 1, 0.33, 26, 40},
+  {"haswell",    3, 3, 1.0, 1, 0.25, 26, 40},
+  {"skylake",    3, 3, 1.0, 1, 0.25, 26, 42},
+  {"znver2",     3, 3, 1.0, 1, 0.25, 30, 45},
+  {"znver3",     3, 3, 1.0, 1, 0.25, 12, 18},
+  {"silvermont", 3, 5, 1.0, 1, 0.5,  30, 60},
+  {"cortex-a53", 3, 5, 1.0, 1, 0.5,  12, 20},
+  {"cortex-a72", 3, 4, 1.0, 1, 0.5,  12, 20},
+};
+
+const TargetCost &getTargetCost(Function &F){
+  StringRef cpu=TargetCPU;
+  if(cpu.empty())
+    cpu=F.getFnAttribute("target-cpu").getValueAsString();
+  for(const TargetCost &cost : CostTable)
+    if(cpu==cost.CPU)
+      return cost;
+  return CostTable[0];
+}
+
+/*
+  Forma canonica con cifre con segno (CSD/NAF) della costante: ogni termine
+  (shift, negativo) vale ±2^shift e la somma dei termini è uguale a C modulo 2^w.
+  La NAF non ha mai due cifre non nulle adiacenti, quindi minimizza il numero
+  di add/sub necessari. Le cifre oltre la larghezza del tipo sono nulle modulo 2^w
+*/
+SmallVector<std::pair<unsigned,bool>> getCSDTerms(const APInt &C){
+  SmallVector<std::pair<unsigned,bool>> terms;
+  unsigned width=C.getBitWidth();
+  APInt n=C.sext(width+2);                                        // Due bit in più per non andare in overflow con n±1
+  for(unsigned shift=0; not n.isZero() and shift<width; shift++){
+    if(n[0]){                                                     // Se n è dispari la cifra è +1 (n mod 4 = 1) o -1 (n mod 4 = 3)
+      bool negative=n[1] and shift<width-1;                       // -2^(w-1) e +2^(w-1) coincidono modulo 2^w
+      if(negative)
+        n+=1;
+      else
+        n-=1;
+      terms.push_back({shift,negative});
+    }
+    n.ashrInPlace(1);
+  }
+  return terms;
+}
+
+/*
+  Confronta la catena shift/add/sub con il 'mul' sulla CPU scelta: gli shift
+  sono indipendenti tra loro (una sola latenza ALU), mentre le add/sub sono
+  in sequenza. La catena deve avere latenza minore, oppure uguale ma con un
+  costo in throughput minore
+*/
+bool isChainCheaper(const TargetCost &cost, unsigned width, ArrayRef<std::pair<unsigned,bool>> terms){
+  unsigned shifts=0;
+  bool allNegative=true;
+  for(auto &term : terms){
+    if(term.first>0)
+      shifts++;
+    if(not term.second)
+      allNegative=false;
+  }
+  unsigned ops=shifts+terms.size()-1+(allNegative?1:0);
+  unsigned latency=((shifts>0?1:0)+terms.size()-1+(allNegative?1:0))*cost.AluLatency;
+  unsigned mulLatency=width>32?cost.MulLatency64:cost.MulLatency;
+  if(latency!=mulLatency)
+    return latency<mulLatency;
+  return ops*cost.AluRecipThroughput<cost.MulRecipThroughput;
+}
+
+/*
+  Riscrive x*C come catena di shift/add/sub ottenuta dalla forma CSD di C,
+  se sulla CPU della funzione è più economica del 'mul'
+*/
+bool reduceMul(BinaryOperator *mul, ConstantInt *num, Value *op, InstructionWorklist &worklist, Instrumentation &instr){
+  SmallVector<std::pair<unsigned,bool>> terms=getCSDTerms(num->getValue());
+  if(terms.empty())                                               // x*0 non è compito della strength reduction
+    return false;
+  const TargetCost &cost=getTargetCost(*mul->getFunction());
+  if(not isChainCheaper(cost, num->getBitWidth(), terms)){
+    remarkMissed(instr, "MulNotReduced", mul, "moltiplicazione per "+toString(num->getValue(),10,true)+
+                 " non ridotta: "+Twine(terms.size())+" termini CSD non sono più economici del 'mul' su "+cost.CPU);
+    return false;
+  }
+  remarkApplied(instr, "MulReduced", mul, "moltiplicazione per "+toString(num->getValue(),10,true)+
+                " scomposta in "+Twine(terms.size())+" termini CSD");
+
+  for(unsigned t=0; t<terms.size(); t++){                         // Metto in testa un termine positivo, così non serve negare il risultato
+    if(not terms[t].second){
+      std::swap(terms[0],terms[t]);
+      break;
     }
-  }else if(i->getOpcode()==BinaryOperator::Mul){                  // Caso di Moltiplicazione
-    BinaryOperator *mul=nullptr;
-    mul=dyn_cast<BinaryOperator>(i);
-    if(check(mul,num,op)){
-      if(num->getValue().isOne()){                                // Controlliamo se la costante è uno                    
-        mul->replaceAllUsesWith(op);                              // Sostituisco in tutte le istruzioni in cui viene utilizzato il valore restituito 
-                                                                  // dall'istruzione 'mul', con la variabile utilizzata all'interno di essa.
-                                                                  // Quindi se Y=X*1 (o 1*X) => X=Y
-        i++;                                                      // Dopo aver incrementato l'iteratore del BasicBlock,
-        mul->eraseFromParent();                                   // eliminiamo l'istruzione 'mul', ormai inutilizzata
-        return true;
+  }
+
+  Value *acc=nullptr;
+  for(auto &term : terms){
+    Value *shifted=op;
+    if(term.first>0){                                             // x<<shift
+      Instruction *shiftSx=BinaryOperator::Create(BinaryOperator::Shl, op, ConstantInt::get(mul->getType(), term.first));
+      shiftSx->insertBefore(mul);
+      worklist.push(shiftSx);
+      shifted=shiftSx;
+    }
+    Instruction *next=nullptr;
+    if(not acc){
+      if(not term.second){
+        acc=shifted;
+        continue;
       }
+      next=BinaryOperator::Create(BinaryOperator::Sub, ConstantInt::get(mul->getType(), 0), shifted);   // Tutti i termini negativi: 0-(x<<shift)
+    }else{
+      next=BinaryOperator::Create(term.second?BinaryOperator::Sub:BinaryOperator::Add, acc, shifted);
     }
+    next->insertBefore(mul);
+    worklist.push(next);
+    acc=next;
   }
-  return false;
+  replaceAndErase(mul,acc,worklist);                              // Sostituisco le occorrenze di 'mul' con il risultato della catena
+  return true;
+}
+
+/*
+  Numero magico per la divisione per costante (Hacker's Delight, cap. 10):
+  x/d = mulhi(x, Magic) >> Shift, con le correzioni descritte in emitDiv
+*/
+struct MagicInfo {
+  APInt Magic;
+  unsigned Shift;
+  bool IsAdd;                                                     // Solo senza segno: il magic ha w+1 bit, serve la correzione con add
+};
+
+MagicInfo getSignedMagic(const APInt &d){
+  unsigned width=d.getBitWidth();
+  APInt signedMin=APInt::getSignedMinValue(width);
+  APInt ad=d.abs();
+  APInt t=signedMin+d.lshr(width-1);
+  APInt anc=t-1-t.urem(ad);                                       // |nc|, il più grande multiplo di d meno 1 rappresentabile
+  unsigned p=width-1;
+  APInt q1=signedMin.udiv(anc);                                   // q1 = 2^p/|nc|, r1 = rem(2^p, |nc|)
+  APInt r1=signedMin-q1*anc;
+  APInt q2=signedMin.udiv(ad);                                    // q2 = 2^p/|d|, r2 = rem(2^p, |d|)
+  APInt r2=signedMin-q2*ad;
+  APInt delta(width,0);
+  do{
+    p++;
+    q1<<=1;
+    r1<<=1;
+    if(r1.uge(anc)){
+      ++q1;
+      r1-=anc;
+    }
+    q2<<=1;
+    r2<<=1;
+    if(r2.uge(ad)){
+      ++q2;
+      r2-=ad;
+    }
+    delta=ad-r2;
+  }while(q1.ult(delta) or (q1==delta and r1.isZero()));
+  APInt magic=q2+1;
+  if(d.isNegative())
+    magic.negate();
+  return {magic, p-width, false};
+}
+
+MagicInfo getUnsignedMagic(const APInt &d){
+  unsigned width=d.getBitWidth();
+  bool isAdd=false;
+  APInt allOnes=APInt::getAllOnes(width);
+  APInt signedMin=APInt::getSignedMinValue(width);
+  APInt signedMax=APInt::getSignedMaxValue(width);
+  APInt nc=allOnes-(allOnes-d).urem(d);
+  unsigned p=width-1;
+  APInt q1=signedMin.udiv(nc);                                    // q1 = 2^p/nc, r1 = rem(2^p, nc)
+  APInt r1=signedMin-q1*nc;
+  APInt q2=signedMax.udiv(d);                                     // q2 = (2^p-1)/d, r2 = rem(2^p-1, d)
+  APInt r2=signedMax-q2*d;
+  APInt delta(width,0);
+  do{
+    p++;
+    if(r1.uge(nc-r1)){
+      q1=q1+q1+1;
+      r1=r1+r1-nc;
+    }else{
+      q1=q1+q1;
+      r1=r1+r1;
+    }
+    if((r2+1).uge(d-r2)){
+      if(q2.uge(signedMax))
+        isAdd=true;
+      q2=q2+q2+1;
+      r2=r2+r2+1-d;
+    }else{
+      if(q2.uge(signedMin))
+        isAdd=true;
+      q2=q2+q2;
+      r2=r2+r2+1;
+    }
+    delta=d-1-r2;
+  }while(p<width*2 and (q1.ult(delta) or (q1==delta and r1.isZero())));
+  return {q2+1, p-width, isAdd};
+}
+
+/*
+  Inserisce la nuova istruzione prima di 'pos' e la aggiunge alla worklist
+*/
+Instruction *insertNew(Instruction *newInstr, Instruction *pos, InstructionWorklist &worklist){
+  newInstr->insertBefore(pos);
+  worklist.push(newInstr);
+  return newInstr;
+}
+
+/*
+  Parte alta del prodotto x*magic: estendo entrambi a 2w bit, moltiplico,
+  e tengo i w bit più significativi. Con i vettori il magic può essere
+  diverso in ogni corsia
+*/
+Value *emitMulHigh(Instruction *pos, Value *x, ArrayRef<APInt> magic, bool isSigned, InstructionWorklist &worklist){
+  Type *type=x->getType();
+  unsigned width=magic[0].getBitWidth();
+  Type *wideType=type->getWithNewBitWidth(width*2);
+  Instruction *wideX=CastInst::Create(isSigned?Instruction::SExt:Instruction::ZExt, x, wideType);
+  insertNew(wideX, pos, worklist);
+  SmallVector<APInt,8> wideLanes;
+  for(const APInt &lane : magic)
+    wideLanes.push_back(isSigned?lane.sext(width*2):lane.zext(width*2));
+  Constant *wideMagic=getLaneConstant(wideType, wideLanes);
+  Instruction *product=insertNew(BinaryOperator::Create(BinaryOperator::Mul, wideX, wideMagic), pos, worklist);
+  Instruction *high=insertNew(BinaryOperator::Create(BinaryOperator::LShr, product, ConstantInt::get(wideType, width)), pos, worklist);
+  return insertNew(CastInst::Create(Instruction::Trunc, high, type), pos, worklist);
+}
+
+/*
+  Latenza stimata della sequenza che sostituisce la divisione: serve a
+  decidere, con la stessa tabella dei costi del 'mul', se conviene riscriverla
+*/
+unsigned getDivChainLatency(const TargetCost &cost, const APInt &d, bool isSigned, bool isRem){
+  unsigned width=d.getBitWidth();
+  unsigned mulLatency=width>32?cost.MulLatency64:cost.MulLatency;
+  unsigned mulHighLatency=width*2>32?cost.MulLatency64:cost.MulLatency;
+  unsigned aluOps=0;
+  bool usesMulHigh=false;
+  if(d.isOne() or (isSigned and d.isAllOnes())){                  // x/1 = x, x/-1 = -x
+    aluOps=1;
+  }else if(not isSigned and d.isPowerOf2()){                      // lshr per il quoziente, and per il resto
+    return cost.AluLatency;
+  }else if(isSigned and d.abs().isPowerOf2()){                    // ashr, lshr, add, ashr (più l'eventuale negazione)
+    aluOps=4+(d.isNegative()?1:0);
+  }else if(not isSigned and d.isNegative()){                      // d >= 2^(w-1): icmp, zext
+    aluOps=2;
+  }else if(isSigned){
+    MagicInfo info=getSignedMagic(d);
+    usesMulHigh=true;
+    aluOps=1+(d.isStrictlyPositive()==info.Magic.isNegative()?1:0)+(info.Shift>0?1:0)+2;
+  }else{
+    MagicInfo info=getUnsignedMagic(d);
+    usesMulHigh=true;
+    aluOps=1+(info.IsAdd?3+(info.Shift>1?1:0):(info.Shift>0?1:0));
+  }
+  unsigned latency=aluOps*cost.AluLatency+(usesMulHigh?mulHighLatency:0);
+  if(isRem)                                                       // x - (x/d)*d
+    latency+=mulLatency+cost.AluLatency;
+  return latency;
+}
+
+/*
+  Quoziente x/d senza istruzioni di divisione
+*/
+Value *emitDiv(Instruction *pos, Value *x, const APInt &d, bool isSigned, InstructionWorklist &worklist){
+  Type *type=x->getType();
+  unsigned width=d.getBitWidth();
+  if(d.isOne())                                                   // x/1 = x
+    return x;
+  if(isSigned and d.isAllOnes())                                  // x/-1 = 0-x
+    return insertNew(BinaryOperator::Create(BinaryOperator::Sub, ConstantInt::get(type, 0), x), pos, worklist);
+
+  if(not isSigned){
+    if(d.isPowerOf2())                                            // x/2^k = x>>k (senza segno)
+      return insertNew(BinaryOperator::Create(BinaryOperator::LShr, x, ConstantInt::get(type, d.exactLogBase2())), pos, worklist);
+    if(d.isNegative()){                                           // d >= 2^(w-1): il quoziente può essere solo 0 o 1
+      Instruction *cmp=insertNew(new ICmpInst(ICmpInst::ICMP_UGE, x, ConstantInt::get(type, d)), pos, worklist);
+      return insertNew(CastInst::Create(Instruction::ZExt, cmp, type), pos, worklist);
+    }
+    MagicInfo info=getUnsignedMagic(d);
+    Value *q=emitMulHigh(pos, x, info.Magic, false, worklist);
+    if(info.IsAdd){                                               // q = (((x-q)>>1)+q) >> (s-1)
+      Instruction *diff=insertNew(BinaryOperator::Create(BinaryOperator::Sub, x, q), pos, worklist);
+      Instruction *half=insertNew(BinaryOperator::Create(BinaryOperator::LShr, diff, ConstantInt::get(type, 1)), pos, worklist);
+      q=insertNew(BinaryOperator::Create(BinaryOperator::Add, half, q), pos, worklist);
+      if(info.Shift>1)
+        q=insertNew(BinaryOperator::Create(BinaryOperator::LShr, q, ConstantInt::get(type, info.Shift-1)), pos, worklist);
+    }else if(info.Shift>0){
+      q=insertNew(BinaryOperator::Create(BinaryOperator::LShr, q, ConstantInt::get(type, info.Shift)), pos, worklist);
+    }
+    return q;
+  }
+
+  APInt ad=d.abs();
+  if(ad.isPowerOf2()){                                            // x/2^k con segno: lo shift aritmetico arrotonda verso -inf,
+    unsigned k=ad.countTrailingZeros();                           // quindi ai valori negativi aggiungo il bias 2^k-1
+    Value *sign=x;
+    if(k>1)
+      sign=insertNew(BinaryOperator::Create(BinaryOperator::AShr, x, ConstantInt::get(type, k-1)), pos, worklist);
+    Instruction *bias=insertNew(BinaryOperator::Create(BinaryOperator::LShr, sign, ConstantInt::get(type, width-k)), pos, worklist);
+    Instruction *sum=insertNew(BinaryOperator::Create(BinaryOperator::Add, x, bias), pos, worklist);
+    Instruction *q=insertNew(BinaryOperator::Create(BinaryOperator::AShr, sum, ConstantInt::get(type, k)), pos, worklist);
+    if(d.isNegative())
+      return insertNew(BinaryOperator::Create(BinaryOperator::Sub, ConstantInt::get(type, 0), q), pos, worklist);
+    return q;
+  }
+
+  MagicInfo info=getSignedMagic(d);
+  Value *q=emitMulHigh(pos, x, info.Magic, true, worklist);
+  if(d.isStrictlyPositive() and info.Magic.isNegative())          // Correzione quando il magic non sta in w bit con segno
+    q=insertNew(BinaryOperator::Create(BinaryOperator::Add, q, x), pos, worklist);
+  else if(d.isNegative() and info.Magic.isStrictlyPositive())
+    q=insertNew(BinaryOperator::Create(BinaryOperator::Sub, q, x), pos, worklist);
+  if(info.Shift>0)
+    q=insertNew(BinaryOperator::Create(BinaryOperator::AShr, q, ConstantInt::get(type, info.Shift)), pos, worklist);
+  Instruction *signBit=insertNew(BinaryOperator::Create(BinaryOperator::LShr, q, ConstantInt::get(type, width-1)), pos, worklist);
+  return insertNew(BinaryOperator::Create(BinaryOperator::Add, q, signBit), pos, worklist);   // Arrotondo verso zero i quozienti negativi
+}
+
+/*
+  Riscrive sdiv/udiv/srem/urem per costante con moltiplicazione per il
+  numero magico, shift e correzioni di segno, se più economico della divisione
+*/
+bool reduceDiv(BinaryOperator *div, ConstantInt *num, Value *op, InstructionWorklist &worklist, Instrumentation &instr){
+  unsigned opcode=div->getOpcode();
+  bool isSigned=opcode==BinaryOperator::SDiv or opcode==BinaryOperator::SRem;
+  bool isRem=opcode==BinaryOperator::SRem or opcode==BinaryOperator::URem;
+  const APInt &d=num->getValue();
+  const TargetCost &cost=getTargetCost(*div->getFunction());
+  unsigned divLatency=d.getBitWidth()>32?cost.DivLatency64:cost.DivLatency;
+  if(getDivChainLatency(cost, d, isSigned, isRem)>=divLatency){
+    remarkMissed(instr, "DivNotReduced", div, Twine(div->getOpcodeName())+" per "+toString(d,10,isSigned)+
+                 " non riscritta: la sequenza non è più veloce della divisione su "+cost.CPU);
+    return false;
+  }
+  remarkApplied(instr, "DivReduced", div, Twine(div->getOpcodeName())+" per "+toString(d,10,isSigned)+
+                " riscritta con moltiplicazione per il numero magico");
+
+  Value *result=nullptr;
+  if(isRem and not isSigned and d.isPowerOf2()){                  // x%2^k = x&(2^k-1) (senza segno)
+    result=insertNew(BinaryOperator::Create(BinaryOperator::And, op, ConstantInt::get(div->getType(), d-1)), div, worklist);
+  }else if(isRem){                                                // x%d = x-(x/d)*d: il 'mul' viene poi ridotto dalla strength reduction
+    Value *q=emitDiv(div, op, d, isSigned, worklist);
+    Instruction *product=insertNew(BinaryOperator::Create(BinaryOperator::Mul, q, div->getOperand(1)), div, worklist);
+    result=insertNew(BinaryOperator::Create(BinaryOperator::Sub, op, product), div, worklist);
+  }else{
+    result=emitDiv(div, op, d, isSigned, worklist);
+  }
+  replaceAndErase(div,result,worklist);                           // Sostituisco le occorrenze della divisione con la nuova sequenza
+  return true;
+}
+
+/*
+  Corsie che emitDivPerLane divide con i soli shift: tutte potenze di due,
+  e con segno almeno 2 (per d=1 lo shift del bias sarebbe w bit)
+*/
+bool isShiftPerLane(ArrayRef<APInt> d, bool isSigned){
+  return all_of(d, [&](const APInt &lane){ return lane.isPowerOf2() and not (isSigned and lane.isOne()); });
+}
+
+/*
+  Divisori per corsia gestiti da emitDivPerLane: senza segno tutte potenze
+  di due, oppure tutti in [1, 2^(w-1)) con un magic che non richiede la
+  correzione con add; con segno qualunque divisore tranne 0 e -2^(w-1)
+*/
+bool canDivPerLane(ArrayRef<APInt> d, bool isSigned){
+  if(not isSigned and all_of(d, [](const APInt &lane){ return lane.isPowerOf2(); }))
+    return true;
+  for(const APInt &lane : d){
+    if(lane.isZero())
+      return false;
+    if(isSigned and lane.isMinSignedValue())
+      return false;
+    if(not isSigned and (lane.isNegative() or (not lane.isOne() and getUnsignedMagic(lane).IsAdd)))
+      return false;
+  }
+  return true;
+}
+
+/*
+  Latenza stimata della sequenza di emitDivPerLane, come getDivChainLatency
+*/
+unsigned getDivPerLaneLatency(const TargetCost &cost, ArrayRef<APInt> d, bool isSigned, bool isRem){
+  unsigned width=d[0].getBitWidth();
+  unsigned mulLatency=width>32?cost.MulLatency64:cost.MulLatency;
+  unsigned mulHighLatency=width*2>32?cost.MulLatency64:cost.MulLatency;
+  bool shiftOnly=isShiftPerLane(d, isSigned);
+  unsigned latency=0;
+  if(shiftOnly)                                                   // lshr, oppure ashr, lshr, add, ashr con segno
+    latency=(isSigned?4:1)*cost.AluLatency;
+  else                                                            // mulhi, and+add, and+sub, shift, lshr+and+add
+    latency=mulHighLatency+(isSigned?8:3)*cost.AluLatency;
+  if(isRem and not (shiftOnly and not isSigned))                  // x - (x/d)*d
+    latency+=mulLatency+cost.AluLatency;
+  return latency;
+}
+
+/*
+  Quoziente x/d con un divisore diverso in ogni corsia (vedi canDivPerLane).
+  Le correzioni che nel caso uniforme dipendono dal divisore qui valgono
+  solo per alcune corsie: le applico con una maschera che è tutta a uno
+  nelle corsie interessate e nulla nelle altre. Nelle corsie con d=±1 il
+  magic è 0 e il quoziente è ±x, aggiunto dalla stessa correzione
+*/
+Value *emitDivPerLane(Instruction *pos, Value *x, ArrayRef<APInt> d, bool isSigned, InstructionWorklist &worklist){
+  Type *type=x->getType();
+  unsigned width=d[0].getBitWidth();
+  auto create=[&](Instruction::BinaryOps opcode, Value *lhs, Value *rhs){
+    return insertNew(BinaryOperator::Create(opcode, lhs, rhs), pos, worklist);
+  };
+  SmallVector<APInt,8> shift;
+  if(isShiftPerLane(d, isSigned)){
+    SmallVector<APInt,8> signShift, biasShift;
+    for(const APInt &lane : d){
+      unsigned k=lane.exactLogBase2();
+      shift.push_back(APInt(width, k));
+      signShift.push_back(APInt(width, isSigned?k-1:0));          // Con segno k>=1 (vedi isShiftPerLane)
+      biasShift.push_back(APInt(width, width-k));
+    }
+    if(not isSigned)                                              // x/2^k = x>>k, con k diverso per corsia
+      return create(BinaryOperator::LShr, x, getLaneConstant(type, shift));
+    Value *sign=create(BinaryOperator::AShr, x, getLaneConstant(type, signShift));
+    Value *bias=create(BinaryOperator::LShr, sign, getLaneConstant(type, biasShift));
+    Value *sum=create(BinaryOperator::Add, x, bias);
+    return create(BinaryOperator::AShr, sum, getLaneConstant(type, shift));
+  }
+
+  SmallVector<APInt,8> magic, addMask, subMask, signMask;
+  bool anyShift=false, anyAdd=false, anySub=false, anyUnit=false;
+  for(const APInt &lane : d){
+    bool unit=lane.isOne() or (isSigned and lane.isAllOnes());
+    MagicInfo info={APInt(width, 0), 0, false};
+    if(not unit)
+      info=isSigned?getSignedMagic(lane):getUnsignedMagic(lane);
+    magic.push_back(info.Magic);
+    shift.push_back(APInt(width, info.Shift));
+    anyShift|=info.Shift>0;
+    bool add=lane.isOne() or (isSigned and lane.isStrictlyPositive() and info.Magic.isNegative());
+    bool sub=(isSigned and lane.isAllOnes()) or (isSigned and lane.isNegative() and info.Magic.isStrictlyPositive());
+    addMask.push_back(add?APInt::getAllOnes(width):APInt(width, 0));
+    subMask.push_back(sub?APInt::getAllOnes(width):APInt(width, 0));
+    signMask.push_back(unit?APInt(width, 0):APInt(width, 1));     // ±x è già esatto, niente arrotondamento
+    anyAdd|=add;
+    anySub|=sub;
+    anyUnit|=unit;
+  }
+  Value *q=emitMulHigh(pos, x, magic, isSigned, worklist);
+  if(anyAdd)
+    q=create(BinaryOperator::Add, q, create(BinaryOperator::And, x, getLaneConstant(type, addMask)));
+  if(anySub)
+    q=create(BinaryOperator::Sub, q, create(BinaryOperator::And, x, getLaneConstant(type, subMask)));
+  if(anyShift)
+    q=create(isSigned?BinaryOperator::AShr:BinaryOperator::LShr, q, getLaneConstant(type, shift));
+  if(isSigned){                                                   // Arrotondo verso zero i quozienti negativi
+    Value *signBit=create(BinaryOperator::LShr, q, ConstantInt::get(type, width-1));
+    if(anyUnit)
+      signBit=create(BinaryOperator::And, signBit, getLaneConstant(type, signMask));
+    q=create(BinaryOperator::Add, q, signBit);
+  }
+  return q;
+}
+
+/*
+  Operazioni vettoriali con una costante non uniforme (corsie diverse):
+  x*<2,4,8,16> diventa x<<<1,2,3,4>, mentre divisioni e resti usano un
+  numero magico e uno shift per corsia
+*/
+bool reduceNonUniform(BinaryOperator *i, InstructionWorklist &worklist, Instrumentation &instr){
+  unsigned opcode=i->getOpcode();
+  Type *type=i->getType();
+  if(not type->isVectorTy())
+    return false;
+  Value *op=i->getOperand(0);
+  Value *C=i->getOperand(1);
+  SmallVector<APInt,8> lanes;
+  if(not getLaneValues(C, lanes)){
+    if(opcode!=BinaryOperator::Mul)                               // Solo nel 'mul' la costante può stare al primo operando
+      return false;
+    std::swap(op, C);
+    lanes.clear();
+    if(not getLaneValues(C, lanes))
+      return false;
+  }
+  unsigned width=lanes[0].getBitWidth();
+
+  Value *result=nullptr;
+  if(opcode==BinaryOperator::Mul){
+    if(not all_of(lanes, [](const APInt &lane){ return lane.isPowerOf2(); })){
+      remarkMissed(instr, "MulNotReduced", i, "moltiplicazione per un vettore non uniforme non ridotta: "
+                   "non tutte le corsie sono potenze di due");
+      return false;
+    }
+    SmallVector<APInt,8> shifts;
+    for(const APInt &lane : lanes)
+      shifts.push_back(APInt(width, lane.exactLogBase2()));
+    remarkApplied(instr, "MulReduced", i, "moltiplicazione per un vettore di potenze di due riscritta con uno shift per corsia");
+    result=insertNew(BinaryOperator::Create(BinaryOperator::Shl, op, getLaneConstant(type, shifts)), i, worklist);
+    replaceAndErase(i,result,worklist);
+    return true;
+  }
+
+  bool isSigned=opcode==BinaryOperator::SDiv or opcode==BinaryOperator::SRem;
+  bool isRem=opcode==BinaryOperator::SRem or opcode==BinaryOperator::URem;
+  if(not canDivPerLane(lanes, isSigned)){
+    remarkMissed(instr, "DivNotReduced", i, Twine(i->getOpcodeName())+" per un vettore non uniforme non riscritta: "
+                 "divisore non gestito in almeno una corsia");
+    return false;
+  }
+  const TargetCost &cost=getTargetCost(*i->getFunction());
+  unsigned divLatency=width>32?cost.DivLatency64:cost.DivLatency;
+  if(getDivPerLaneLatency(cost, lanes, isSigned, isRem)>=divLatency){
+    remarkMissed(instr, "DivNotReduced", i, Twine(i->getOpcodeName())+" per un vettore non uniforme non riscritta: "
+                 "la sequenza non è più veloce della divisione su "+cost.CPU);
+    return false;
+  }
+  remarkApplied(instr, "DivReduced", i, Twine(i->getOpcodeName())+" per un vettore non uniforme riscritta con "
+                "numero magico e shift per corsia");
+
+  if(isRem and not isSigned and all_of(lanes, [](const APInt &lane){ return lane.isPowerOf2(); })){
+    SmallVector<APInt,8> masks;                                   // x%2^k = x&(2^k-1), con k diverso per corsia
+    for(const APInt &lane : lanes)
+      masks.push_back(lane-1);
+    result=insertNew(BinaryOperator::Create(BinaryOperator::And, op, getLaneConstant(type, masks)), i, worklist);
+  }else if(isRem){                                                // x%d = x-(x/d)*d
+    Value *q=emitDivPerLane(i, op, lanes, isSigned, worklist);
+    Instruction *product=insertNew(BinaryOperator::Create(BinaryOperator::Mul, q, C), i, worklist);
+    result=insertNew(BinaryOperator::Create(BinaryOperator::Sub, op, product), i, worklist);
+  }else{
+    result=emitDivPerLane(i, op, lanes, isSigned, worklist);
+  }
+  replaceAndErase(i,result,worklist);
+  return true;
 }
 
 /*
 ------------------- 2. Strength Reduction -------------------
                     15*x=x*15 => (x<<4)-x
-                    y=x/8 => y=x>>3
+                100*x => (x<<7)-(x<<5)+(x<<2)
+            (solo se più economico del 'mul' sulla CPU)
+          y=x/8 => y=(x+7)>>3 se x<0, y=x>>3 altrimenti
+              y=x/d => y=mulhi(x,M)>>s (+ correzioni)
+      (anche udiv, srem e urem; solo se più economico)
+   vettori: splat come gli scalari, x*<2,4> => x<<<1,2>
 -------------------------------------------------------------
 */
-bool StrengthReduction(llvm::BasicBlock::iterator &i){
-  ConstantInt *num=nullptr;
-  Value *op=nullptr;
-  if(i->getOpcode()==BinaryOperator::Mul){                                                          // Caso di moltiplicazione
-    BinaryOperator *mul=nullptr;
-    mul=dyn_cast<BinaryOperator>(i);                                                                
-    if(check(mul,num,op)){
-      if(num->getValue().isPowerOf2()){                                                             // Nel caso in cui il valore costante è una potenza di 2,
-        ConstantInt *shiftValue=ConstantInt::get(num->getType(),num->getValue().exactLogBase2());   // calcolo il valore dello shift estraendo il log2 del valore
-        Instruction *shiftSx=BinaryOperator::Create(BinaryOperator::Shl,op,shiftValue);             // e creo la nuova operazione con shift SX.
-        shiftSx->insertAfter(mul);                                                                  // Inserisco l'operazione dopo l'istruzione di moltiplicazione,
-        mul->replaceAllUsesWith(shiftSx);                                                           // sostituendo le occorrenze di 'mul' con la nuova operazione di shift
-        i++;                                                                                        // e dopo aver incrementato l'iteratore del BasicBlock,
-        mul->eraseFromParent();                                                                     // elimino l'istruzione di 'mul', ormai inutilizzata
-        return true;
-      }else{
-        unsigned int ceilLog=num->getValue().ceilLogBase2();                                        // Nel caso in cui il valore costante non è una potenza di 2, calcolo il log2 più vicino,
-        ConstantInt *shiftValue=ConstantInt::get(num->getType(), ceilLog);                          // assegnandolo ad un puntatore di tipo ConstantInt
-        Instruction *shiftSx=BinaryOperator::Create(BinaryOperator::Shl, op, shiftValue);           // e creo la nuova operazione con shift DX
-        shiftSx->insertAfter(mul);                                                                  // Inserisco l'istruzione appena creata dopo quella di 'mul'
-        int difference=(pow(2, ceilLog))-(num->getSExtValue());                                     // Calcolo la differenza 2^log2(x) e x, trovando il resto
-        ConstantInt *subValue=ConstantInt::get(num->getType(), difference);                         // e assegno ad una variabile intera la differenza
-        Instruction *sub=BinaryOperator::Create(BinaryOperator::Sub,shiftSx,subValue);              // Creo la nuova operazione 'sub' tra il valore di shiftSX e la differenza precedente
-        sub->insertAfter(shiftSx);                                                                  
-        mul->replaceAllUsesWith(sub);
-        i++;
-        mul->eraseFromParent();
-        return true;
-      }
+bool reduceMulConst(Instruction *I, Value *X, Constant *C, InstructionWorklist &worklist, Instrumentation &instr){
+  BinaryOperator *mul=cast<BinaryOperator>(I);
+  if(ConstantInt *num=getSplatInt(C))                             // Scalare o splat: scompongo x*C secondo la forma CSD di C
+    return reduceMul(mul,num,X,worklist,instr);
+  return reduceNonUniform(mul,worklist,instr);                    // Vettore con corsie diverse
+}
+
+bool reduceDivConst(Instruction *I, Value *X, Constant *C, InstructionWorklist &worklist, Instrumentation &instr){
+  BinaryOperator *div=cast<BinaryOperator>(I);
+  ConstantInt *num=getSplatInt(C);
+  if(num and not num->isZero())                                   // La divisione per zero è indefinita, non la tocchiamo
+    return reduceDiv(div,num,X,worklist,instr);
+  return reduceNonUniform(div,worklist,instr);                    // Vettore con corsie diverse
+}
+
+/*
+------------------- Motore delle regole -------------------
+  Le regole di LocalOptsRules.def (identità algebriche, operazioni inverse
+  e strength reduction) vengono espanse qui in un unico switch sull'opcode:
+  ogni istruzione estratta dalla worklist prova solo le regole del proprio
+  opcode, e la prima che si applica la riscrive
+-----------------------------------------------------------
+*/
+bool applyRules(Instruction *I, InstructionWorklist &worklist, Instrumentation &instr){
+  Value *X=nullptr, *Y=nullptr, *Z=nullptr;                       // Valori catturati dai pattern
+  Constant *C=nullptr;
+  switch(I->getOpcode()){
+#define OPCODE(OP) case Instruction::OP:
+#define END_OPCODE break;
+#define RULE(NAME, PATTERN, CONSTRAINT, RESULT, DESC)              \
+    if(match(I, PATTERN) and (CONSTRAINT)){                        \
+      remarkApplied(instr, #NAME, I, DESC);                        \
+      ++Num##NAME;                                                 \
+      replaceAndErase(I, RESULT, worklist);                        \
+      return true;                                                 \
     }
-  }else if(i->getOpcode()==BinaryOperator::SDiv){                                                   // Caso di divisione                               
-    BinaryOperator *sdiv=nullptr;
-    sdiv=dyn_cast<BinaryOperator>(i);
-    if(check(sdiv,num,op)){
-      if(num->getValue().isPowerOf2()){                                                             // Nel caso in cui il valore costante è una potenza di 2,
-        ConstantInt *shiftValue=ConstantInt::get(num->getType(),num->getValue().exactLogBase2());   // calcolo il valore dello shift estraendo il log2 del valore
-        Instruction *shiftDx=BinaryOperator::Create(BinaryOperator::LShr, op, shiftValue);          // e creo la nuova operazione con shift DX.
-        shiftDx->insertAfter(sdiv);                                                                 // Inserisco l'operazione dopo l'istruzione di divisione,
-        sdiv->replaceAllUsesWith(shiftDx);                                                          // sostituendo le occorrenze di 'sdiv' con la nuova operazione di shift
-        i++;                                                                                        // e dopo aver incrementato l'iteratore del BasicBlock,
-        sdiv->eraseFromParent();                                                                    // elimino l'istruzione di 'sdiv', ormai inutilizzata
-        return true;
-      }else{
-        unsigned int ceilLog=num->getValue().ceilLogBase2();                                        // Nel caso in cui il valore costante non è una potenza di 2, calcolo il log2 più vicino,
-        ConstantInt *shiftValue=ConstantInt::get(num->getType(), ceilLog);                          // assegnandolo ad un puntatore di tipo ConstantInt
-        Instruction *shiftDx=BinaryOperator::Create(BinaryOperator::LShr, op, shiftValue);          // e creo la nuova operazione con shift DX
-        shiftDx->insertAfter(sdiv);                                                                 // Inserisco l'istruzione appena creata dopo quella di 'sdiv'
-        int difference=(pow(2, ceilLog))-(num->getSExtValue());                                     // Calcolo la differenza 2^log2(x) e x, trovando il resto
-        ConstantInt *addValue=ConstantInt::get(num->getType(), difference);                         // e assegno ad una variabile intera la differenza
-        Instruction *add=BinaryOperator::Create(BinaryOperator::Add, shiftDx, addValue);            // Creo la nuova operazione 'add' tra il valore di shiftDX e la differenza precedente
-        add->insertAfter(shiftDx);
-        sdiv->replaceAllUsesWith(add);
-        i++;
-        sdiv->eraseFromParent();
-        return true;
-      }
+#define ACTION(NAME, PATTERN, CONSTRAINT, APPLY, DESC)             \
+    if(match(I, PATTERN) and (CONSTRAINT) and (APPLY)){            \
+      ++Num##NAME;                                                 \
+      return true;                                                 \
     }
+#include "LocalOptsRules.def"
+    default:
+      break;
   }
   return false;
 }
@@ -138,88 +787,671 @@ bool StrengthReduction(llvm::BasicBlock::iterator &i){
 /*
 ------------------- 3. Multi-Instruction Optimization -------------------
                         a=b+(x), c=a-(x) => a=b+(x), c=b
+                        a=b+c, d=c+b     => a=b+c, d=a
 -------------------------------------------------------------------------
+  Local value numbering: ogni blocco viene scandito una sola volta tenendo
+  una tabella delle espressioni già calcolate. Un'espressione uguale (a meno
+  della commutatività) a una precedente viene sostituita da quest'ultima.
+  Le operazioni che annullano quella che definisce il loro operando sono
+  invece regole di LocalOptsRules.def (AddSubInverse, SubAddInverse, ...)
+*/
+
+/*
+  Le chiavi (ExpressionKey.h) confrontano gli operandi per identità: qui sono
+  già i rappresentanti dei propri valori, perché i duplicati vengono
+  sostituiti non appena trovati
+*/
+bool multiInstOpt(BasicBlock &B, Instrumentation &instr){
+  DenseMap<ExpressionKey,Instruction*> table;                     // Espressioni già calcolate nel blocco
+  bool Changed=false;
+  for(Instruction &i : make_early_inc_range(B)){
+    if(not ExpressionKey::isCandidate(&i))
+      continue;
+    ExpressionKey e=ExpressionKey::get(&i);
+    auto found=table.find(e);
+    if(found!=table.end()){                                       // Espressione già calcolata: riuso la prima occorrenza,
+      remarkApplied(instr, "RedundantExpression", &i, Twine(i.getOpcodeName())+" già calcolata nel blocco");
+      ++NumRedundant;
+      found->second->andIRFlags(&i);                              // tenendo solo i flag (nsw, nuw, exact, ...) comuni alle due
+      i.replaceAllUsesWith(found->second);
+      i.eraseFromParent();
+      Changed=true;
+      continue;
+    }
+    table.insert({e,&i});
+  }
+  return Changed;
+}
+
+/*
+------------------- 4. Sparse Conditional Constant Propagation -------------------
+              a=3, b=a+4, br (b>5), T, F => br T (F eliminato)
+              x=phi [1, A], [1, B] => 1 (solo archi eseguibili)
+---------------------------------------------------------------------------------
+  Propagazione delle costanti su tutta la funzione (Wegman-Zadeck): ogni
+  valore ha uno stato nel reticolo sconosciuto < costante < variabile, e
+  ogni arco del CFG è eseguibile o no. Un blocco viene visitato solo quando
+  un arco eseguibile lo raggiunge, una PHI considera solo gli archi
+  eseguibili e un branch con condizione costante rende eseguibile un solo
+  successore. Alla fine le istruzioni costanti vengono sostituite, i branch
+  ripiegati e i blocchi mai raggiunti eliminati: le regole dei round
+  successivi vedono operandi costanti che prima arrivavano da altri blocchi
 */
-bool multiInstOpt(llvm::BasicBlock::iterator &i, Value *&opFound, Value *&found, ConstantInt *&val){
-  ConstantInt *num=nullptr;
-  Value *op=nullptr;
-  if(i->getOpcode()==BinaryOperator::Add and not found){                              // Caso di addizione, senza averne già trovata una
-    BinaryOperator *add=nullptr;
-    add=dyn_cast<BinaryOperator>(i);
-    if(check(add,num,op)){
-      val=num;                                                                        // Salvo la costante numerica,
-      found=add;                                                                      // l'istruzione add
-      opFound=op;                                                                     // e la variabile usata nell'addizione
-      i++;
-      return true;
-    }
-  }else if(i->getOpcode()==BinaryOperator::Sub and found){                            // Caso di sottrazione, avendo già trovato il caso in cui a=b+(x)
-    BinaryOperator *sub=nullptr;
-    sub=dyn_cast<BinaryOperator>(i);
-    if(check(sub,num,op)){  
-      if(val->getSExtValue()==num->getSExtValue() and op==found){                     // Se la costante numerica è uguale a quella della sottrazione e la variabile utilizzata nell'operazione 
-                                                                                      // è la stessa utilizzata per salvare il valore dell'addizione trovata precedentemente,
-        sub->replaceAllUsesWith(opFound);                                             // sostituisco le occorrenze di 'sub' con la variabile utilizzata nell'operazione 'add'
-        i++;                                                                          
-        sub->eraseFromParent();
-        opFound=nullptr;                                                              // Rinizializzo le variabili di controllo, avendo eseguito l'ottimizzazione 
-        found=nullptr;
-        val=nullptr;
-        return true;
+struct LatticeValue {
+  enum State { Unknown, Const, Overdefined };
+  State Kind=Unknown;
+  Constant *C=nullptr;
+};
+
+class ConstantPropagation {
+  Function &F;
+  const DataLayout &DL;
+  DenseMap<Value*,LatticeValue> Values;
+  SmallPtrSet<BasicBlock*,32> Executable;
+  DenseSet<std::pair<BasicBlock*,BasicBlock*>> ExecutableEdges;
+  SmallVector<Instruction*,64> InstWorklist;                      // Istruzioni con un operando cambiato
+  SmallVector<BasicBlock*,32> BlockWorklist;                      // Blocchi appena diventati eseguibili
+
+  /*
+    Solo le istruzioni senza effetti collaterali che non leggono memoria
+    possono diventare costanti
+  */
+  static bool isFoldable(Instruction *i){
+    return isa<BinaryOperator>(i) or isa<UnaryOperator>(i) or isa<CastInst>(i) or isa<CmpInst>(i) or
+           isa<SelectInst>(i) or isa<GetElementPtrInst>(i) or isa<ExtractValueInst>(i) or isa<InsertValueInst>(i) or
+           isa<ExtractElementInst>(i) or isa<InsertElementInst>(i) or isa<ShuffleVectorInst>(i);
+  }
+
+  /*
+    undef e poison possono valere qualunque cosa a ogni uso: li tratto come
+    variabili, così una PHI con un ingresso undef non diventa mai costante
+  */
+  LatticeValue getValue(Value *V){
+    if(Constant *C=dyn_cast<Constant>(V))
+      if(not isa<UndefValue>(C) and not isa<ConstantExpr>(C))
+        return {LatticeValue::Const, C};
+    if(not isa<Instruction>(V))
+      return {LatticeValue::Overdefined, nullptr};
+    return Values.lookup(V);
+  }
+
+  void pushUsers(Instruction *i){
+    for(User *U : i->users()){
+      Instruction *user=cast<Instruction>(U);
+      if(Executable.count(user->getParent()))
+        InstWorklist.push_back(user);
+    }
+  }
+
+  void markConstant(Instruction *i, Constant *C){
+    LatticeValue &value=Values[i];
+    if(value.Kind==LatticeValue::Overdefined or (value.Kind==LatticeValue::Const and value.C==C))
+      return;
+    if(value.Kind==LatticeValue::Const)                           // Due costanti diverse: il valore è variabile
+      value={LatticeValue::Overdefined, nullptr};
+    else
+      value={LatticeValue::Const, C};
+    pushUsers(i);
+  }
+
+  void markOverdefined(Instruction *i){
+    LatticeValue &value=Values[i];
+    if(value.Kind==LatticeValue::Overdefined)
+      return;
+    value={LatticeValue::Overdefined, nullptr};
+    pushUsers(i);
+  }
+
+  void markEdge(BasicBlock *from, BasicBlock *to){
+    if(not ExecutableEdges.insert({from,to}).second)
+      return;
+    if(Executable.insert(to).second)
+      BlockWorklist.push_back(to);
+    else                                                          // Blocco già visitato: cambiano solo le PHI
+      for(PHINode &phi : to->phis())
+        InstWorklist.push_back(&phi);
+  }
+
+  void visitPHI(PHINode *phi){
+    Constant *C=nullptr;
+    for(unsigned in=0; in<phi->getNumIncomingValues(); in++){
+      if(not ExecutableEdges.count({phi->getIncomingBlock(in), phi->getParent()}))
+        continue;
+      LatticeValue value=getValue(phi->getIncomingValue(in));
+      if(value.Kind==LatticeValue::Unknown)
+        continue;
+      if(value.Kind==LatticeValue::Overdefined or (C and C!=value.C))
+        return markOverdefined(phi);
+      C=value.C;
+    }
+    if(C)
+      markConstant(phi, C);
+  }
+
+  void visitTerminator(Instruction *term){
+    BasicBlock *BB=term->getParent();
+    Value *cond=nullptr;
+    if(BranchInst *br=dyn_cast<BranchInst>(term))
+      cond=br->isConditional()?br->getCondition():nullptr;
+    else if(SwitchInst *sw=dyn_cast<SwitchInst>(term))
+      cond=sw->getCondition();
+    if(not term->getType()->isVoidTy())                           // invoke, callbr
+      markOverdefined(term);
+    if(not cond){
+      for(BasicBlock *succ : successors(BB))
+        markEdge(BB, succ);
+      return;
+    }
+    LatticeValue value=getValue(cond);
+    if(value.Kind==LatticeValue::Unknown)                         // Si decide quando la condizione sarà nota
+      return;
+    ConstantInt *num=value.Kind==LatticeValue::Const?dyn_cast<ConstantInt>(value.C):nullptr;
+    if(not num){
+      for(BasicBlock *succ : successors(BB))
+        markEdge(BB, succ);
+    }else if(BranchInst *br=dyn_cast<BranchInst>(term)){
+      markEdge(BB, br->getSuccessor(num->isZero()?1:0));
+    }else{
+      SwitchInst *sw=cast<SwitchInst>(term);
+      markEdge(BB, sw->findCaseValue(num)->getCaseSuccessor());
+    }
+  }
+
+  void visit(Instruction *i){
+    if(PHINode *phi=dyn_cast<PHINode>(i))
+      return visitPHI(phi);
+    if(i->isTerminator())
+      return visitTerminator(i);
+    if(i->getType()->isVoidTy())
+      return;
+    if(not isFoldable(i))
+      return markOverdefined(i);
+    if(SelectInst *sel=dyn_cast<SelectInst>(i)){                  // Con la condizione nota conta solo il valore scelto
+      LatticeValue cond=getValue(sel->getCondition());
+      if(cond.Kind==LatticeValue::Const and isa<ConstantInt>(cond.C)){
+        LatticeValue chosen=getValue(cast<ConstantInt>(cond.C)->isZero()?sel->getFalseValue():sel->getTrueValue());
+        if(chosen.Kind==LatticeValue::Const)
+          markConstant(i, chosen.C);
+        else if(chosen.Kind==LatticeValue::Overdefined)
+          markOverdefined(i);
+        return;
       }
     }
+    SmallVector<Constant*,4> operands;
+    for(Value *op : i->operands()){
+      LatticeValue value=getValue(op);
+      if(value.Kind==LatticeValue::Overdefined)
+        return markOverdefined(i);
+      if(value.Kind==LatticeValue::Unknown)
+        return;
+      operands.push_back(value.C);
+    }
+    Constant *C=nullptr;
+    if(CmpInst *cmp=dyn_cast<CmpInst>(i))
+      C=ConstantFoldCompareInstOperands(cmp->getPredicate(), operands[0], operands[1], DL);
+    else
+      C=ConstantFoldInstOperands(i, operands, DL);
+    if(C and not isa<UndefValue>(C) and not isa<ConstantExpr>(C))  // Divisioni per zero e shift troppo larghi danno poison
+      markConstant(i, C);
+    else
+      markOverdefined(i);
   }
-  return false;
+
+  void solve(){
+    while(not InstWorklist.empty() or not BlockWorklist.empty()){
+      while(not InstWorklist.empty())
+        visit(InstWorklist.pop_back_val());
+      while(not BlockWorklist.empty())
+        for(Instruction &i : *BlockWorklist.pop_back_val())
+          visit(&i);
+    }
+  }
+
+  /*
+    Una condizione ancora sconosciuta alla fine dipende solo da valori mai
+    definiti su un percorso eseguibile: la considero variabile e rendo
+    eseguibili tutti i successori, altrimenti verrebbero eliminati
+  */
+  bool resolveUnknownBranches(){
+    bool resolved=false;
+    for(BasicBlock &BB : F){
+      if(not Executable.count(&BB))
+        continue;
+      Instruction *term=BB.getTerminator();
+      BranchInst *br=dyn_cast<BranchInst>(term);
+      Value *cond=br?(br->isConditional()?br->getCondition():nullptr):isa<SwitchInst>(term)?cast<SwitchInst>(term)->getCondition():nullptr;
+      if(not cond or getValue(cond).Kind!=LatticeValue::Unknown)
+        continue;
+      markOverdefined(cast<Instruction>(cond));
+      for(BasicBlock *succ : successors(&BB))
+        markEdge(&BB, succ);
+      resolved=true;
+    }
+    return resolved;
+  }
+
+public:
+  ConstantPropagation(Function &F) : F(F), DL(F.getParent()->getDataLayout()) {}
+
+  /*
+    Restituisce true se la funzione è cambiata; 'CFGChanged' indica se sono
+    stati ripiegati branch o eliminati blocchi
+  */
+  bool run(Instrumentation &instr, bool &CFGChanged){
+    Executable.insert(&F.getEntryBlock());
+    BlockWorklist.push_back(&F.getEntryBlock());
+    do
+      solve();
+    while(resolveUnknownBranches());
+
+    bool Changed=false;
+    SmallVector<WeakTrackingVH,16> dead;                          // Operandi delle istruzioni sostituite, forse senza più usi
+    for(BasicBlock &BB : F){
+      if(not Executable.count(&BB))
+        continue;
+      for(Instruction &i : make_early_inc_range(BB)){
+        LatticeValue value=Values.lookup(&i);
+        if(value.Kind!=LatticeValue::Const)
+          continue;
+        remarkApplied(instr, "ConstantPropagated", &i, Twine(i.getOpcodeName())+" vale sempre una costante");
+        ++NumSCCPConstants;
+        for(Value *op : i.operands())
+          if(isa<Instruction>(op))
+            dead.push_back(op);
+        i.replaceAllUsesWith(value.C);
+        i.eraseFromParent();
+        Changed=true;
+      }
+    }
+    RecursivelyDeleteTriviallyDeadInstructionsPermissive(dead);
+
+    for(BasicBlock &BB : F){
+      if(not Executable.count(&BB))
+        continue;
+      Instruction *term=BB.getTerminator();
+      if(not isa<BranchInst>(term) and not isa<SwitchInst>(term))
+        continue;
+      unsigned successors=term->getNumSuccessors();
+      if(successors<2 or not isa<Constant>(term->getOperand(0)))
+        continue;
+      if(ConstantFoldTerminator(&BB, true)){
+        remarkApplied(instr, "BranchFolded", BB.getTerminator(), "branch con condizione costante ripiegato");
+        ++NumSCCPBranches;
+        CFGChanged=true;
+      }
+    }
+    size_t blocks=F.size();
+    if(removeUnreachableBlocks(F)){
+      NumSCCPBlocks+=blocks-F.size();
+      CFGChanged=true;
+    }
+    return Changed or CFGChanged;
+  }
+};
+
+/*
+  Esegue un round del motore a punto fisso: dopo il value numbering di ogni
+  blocco, la worklist viene inizializzata con tutte le istruzioni della
+  funzione e svuotata applicando le ottimizzazioni. Ogni riscrittura reinserisce
+  nella worklist gli utilizzatori del valore sostituito, quindi le opportunità
+  esposte vengono colte nello stesso round. La propagazione delle costanti,
+  se attiva, apre il round, perché solo lei modifica il CFG
+*/
+bool runRound(Function &F, Instrumentation &instr, bool &CFGChanged) {
+  InstructionWorklist worklist;
+  bool Changed=false;
+  if(UseSCCP){
+    NamedRegionTimer T("sccp", "Propagazione sparsa delle costanti", TimerGroupName, TimerGroupDesc, instr.Timers);
+    ConstantPropagation solver(F);
+    if(solver.run(instr, CFGChanged))
+      Changed=true;
+  }
+  {
+    NamedRegionTimer T("lvn", "Local value numbering", TimerGroupName, TimerGroupDesc, instr.Timers);
+    for(BasicBlock &BB : F)
+      if(multiInstOpt(BB, instr))
+        Changed=true;
+  }
+
+  NamedRegionTimer T("worklist", "Regole peephole (LocalOptsRules.def)", TimerGroupName, TimerGroupDesc, instr.Timers);
+  for(BasicBlock &BB : reverse(F))                           // Inserisco le istruzioni in ordine inverso, così
+    for(Instruction &i : reverse(BB))                         // vengono estratte nell'ordine del programma
+      worklist.push(&i);
+
+  while(Instruction *i=worklist.removeOne()){                 // Per ogni istruzione nella worklist, ne richiamo le funzioni di ottimizzazione
+    if(applyRules(i, worklist, instr))
+      Changed=true;
+  }
+  return Changed;
 }
 
+/*
+  Ripete i round finché la funzione non cambia più, entro il limite MaxRounds.
+  In 'rounds' viene restituito il numero di round eseguiti, in 'CFGChanged'
+  se qualche round ha modificato il CFG
+*/
+bool runToFixedPoint(Function &F, unsigned &rounds, Instrumentation &instr, bool &CFGChanged){
+  bool Transformed=false;
+  rounds=0;
+  while(rounds<MaxRounds){
+    rounds++;
+    if(not runRound(F, instr, CFGChanged))
+      break;
+    Transformed=true;
+  }
+  NumRounds+=rounds;
+  return Transformed;
+}
 
+/*
+  Il codice prima e dopo le ottimizzazioni viene stampato solo con
+  -debug-only=localopts, il numero di round come remark di analisi
+*/
+bool runOnFunction(Function &F, OptimizationRemarkEmitter &ORE, bool &CFGChanged){
+  LLVM_DEBUG(dbgs()<<"\nCodice originale:\n"<<F);
+  Instrumentation instr;
+  instr.ORE=&ORE;
+  instr.Timers=TimePassesIsEnabled;
+  unsigned rounds=0;
+  bool Transformed=runToFixedPoint(F, rounds, instr, CFGChanged);
+  ORE.emit([&](){
+    return OptimizationRemarkAnalysis(DEBUG_TYPE, "Rounds", &F)<<"punto fisso raggiunto in "<<ore::NV("Rounds", rounds)<<" round";
+  });
+  LLVM_DEBUG(dbgs()<<"\nCodice aggiornato ("<<rounds<<" round):\n"<<F);
+  return Transformed;
+}
 
-bool runOnBasicBlock(BasicBlock &B) {
-  auto i=B.begin();                                       
-  Value *found=nullptr;                                       // Variabile che conterrà l'istruzione da sostituire in MultiInstOpt
-  Value *opFound=nullptr;                                     // Variabile che conterrà l'operatore dell'istruzione da sostituire in MultiInstOpt
-  ConstantInt *val=nullptr;                                   // Variabile che conterrà la costante numerica dell'istruzione in MultiInstOpt
+/*
+  Una partizione del modulo: le funzioni che contiene (come indici nella lista
+  delle funzioni del modulo) e il bitcode del modulo clonato, che il thread
+  sostituisce con quello ottimizzato
+*/
+struct Partition {
+  std::vector<unsigned> Functions;
+  uint64_t Size=0;                                                // Numero di istruzioni, per bilanciare il carico
+  SmallString<0> Bitcode;
+  std::vector<unsigned> Changed;                                  // Indici delle funzioni modificate
+  bool Done=false;
+};
 
-  while(i!=B.end()){                                          // Per ogni istruzione del BasicBlock, ne richiamo le funzioni di ottimizzazione
-    if(algebraicIdentity(i)){
-      continue;
+/*
+  Le funzioni vengono ricollegate al modulo per posizione e i loro blocchi
+  spostati: sono escluse quelle con informazioni di debug (i nodi distinct
+  verrebbero duplicati) e quelle con blocchi di cui è preso l'indirizzo
+*/
+bool canPartition(Function &F){
+  if(F.isDeclaration() or F.getSubprogram())
+    return false;
+  for(BasicBlock &BB : F)
+    if(BB.hasAddressTaken())
+      return false;
+  return true;
+}
+
+/*
+  Eseguita da un thread: carica la partizione in un contesto privato (il
+  contesto non è thread-safe, a partire dai use-list delle costanti), la
+  ottimizza e ne riscrive il bitcode
+*/
+void optimizePartition(Partition &part){
+  LLVMContext context;
+  Expected<std::unique_ptr<Module>> moduleOrErr=parseBitcodeFile(MemoryBufferRef(part.Bitcode.str(), "localopts-partition"), context);
+  if(not moduleOrErr){
+    consumeError(moduleOrErr.takeError());
+    return;
+  }
+  unsigned index=0;
+  for(Function &F : **moduleOrErr){
+    unsigned rounds=0;
+    bool CFGChanged=false;                                        // Le funzioni trapiantate perdono comunque tutte le analisi
+    Instrumentation instr;                                        // Nessun remark né timer nei thread
+    if(not F.isDeclaration() and runToFixedPoint(F, rounds, instr, CFGChanged))
+      part.Changed.push_back(index);
+    index++;
+  }
+  part.Bitcode.clear();
+  raw_svector_ostream OS(part.Bitcode);
+  WriteBitcodeToFile(**moduleOrErr, OS);
+  part.Done=true;
+}
+
+/*
+  Tipi della partizione -> tipi del modulo. Le struct con nome non sono
+  uniche nel contesto: rileggendo la partizione nel contesto del modulo il
+  reader crea una copia di ognuna con un suffisso (%struct.S diventa
+  %struct.S.0), che va riportata sulla struct originale prima di spostare i
+  corpi. I tipi composti (puntatori, array, funzioni...) si ricostruiscono
+*/
+class PartitionTypeMapper : public ValueMapTypeRemapper {
+  DenseMap<Type*,Type*> Mapped;
+
+public:
+  /*
+    Associa le struct della partizione a quelle del modulo con il nome senza
+    il suffisso; falso se una non ha corrispondente o ha un corpo diverso
+  */
+  bool mapStructs(Module &P){
+    std::vector<StructType*> structs=P.getIdentifiedStructTypes();
+    for(StructType *ST : structs){
+      StringRef name=ST->getName().rsplit('.').first;
+      StructType *original=ST->hasName()?StructType::getTypeByName(ST->getContext(), name):nullptr;
+      if(not original or original==ST)
+        return false;
+      Mapped[ST]=original;
     }
-    if(multiInstOpt(i, opFound, found, val)){
-      continue;
+    for(StructType *ST : structs){
+      StructType *original=cast<StructType>(Mapped[ST]);
+      if(ST->isOpaque() or original->isOpaque()){
+        if(ST->isOpaque()!=original->isOpaque())
+          return false;
+        continue;
+      }
+      if(ST->isPacked()!=original->isPacked() or ST->getNumElements()!=original->getNumElements())
+        return false;
+      for(unsigned e=0; e<ST->getNumElements(); e++)
+        if(remapType(ST->getElementType(e))!=original->getElementType(e))
+          return false;
     }
-    if(StrengthReduction(i)){
-      continue;
+    return true;
+  }
+
+  Type *remapType(Type *T) override {
+    if(Type *mapped=Mapped.lookup(T))
+      return mapped;
+    if(isa<StructType>(T) and not cast<StructType>(T)->isLiteral())
+      return T;
+    SmallVector<Type*,8> elements;
+    bool changed=false;
+    for(Type *E : T->subtypes()){
+      elements.push_back(remapType(E));
+      changed|=elements.back()!=E;
     }
-    
-    i++;
+    Type *result=T;
+    if(changed){
+      switch(T->getTypeID()){
+        case Type::PointerTyID:   result=PointerType::get(elements[0], T->getPointerAddressSpace()); break;
+        case Type::ArrayTyID:     result=ArrayType::get(elements[0], T->getArrayNumElements()); break;
+        case Type::FixedVectorTyID:
+        case Type::ScalableVectorTyID:
+                                  result=VectorType::get(elements[0], cast<VectorType>(T)->getElementCount()); break;
+        case Type::FunctionTyID:  result=FunctionType::get(elements[0], ArrayRef<Type*>(elements).drop_front(), T->isFunctionVarArg()); break;
+        case Type::StructTyID:    result=StructType::get(T->getContext(), elements, cast<StructType>(T)->isPacked()); break;
+        default:                  break;
+      }
+    }
+    Mapped[T]=result;
+    return result;
+  }
+};
+
+/*
+  Sostituisce il corpo di MF con quello di PF, già caricato nel contesto del
+  modulo. VMap porta i valori globali e gli argomenti della partizione su
+  quelli del modulo, types le struct della partizione su quelle del modulo
+*/
+void transplantBody(Function *MF, Function *PF, ValueToValueMapTy &VMap, PartitionTypeMapper &types){
+  for(BasicBlock &BB : *MF)
+    BB.dropAllReferences();
+  while(not MF->empty())
+    MF->begin()->eraseFromParent();
+  for(unsigned a=0; a<MF->arg_size(); a++)
+    VMap[PF->getArg(a)]=MF->getArg(a);
+  while(not PF->empty()){
+    BasicBlock *BB=&PF->front();
+    BB->removeFromParent();
+    BB->insertInto(MF);
+  }
+  for(BasicBlock &BB : *MF)                                       // Le istruzioni locali non sono in VMap e restano
+    for(Instruction &I : BB)
+      RemapInstruction(&I, VMap, RF_IgnoreMissingLocals | RF_ReuseAndMutateDistinctMDs, &types);
+}
+
+/*
+  Riporta nel modulo le funzioni modificate di una partizione. Il clone ha le
+  stesse variabili globali e funzioni del modulo, nello stesso ordine, quindi
+  i valori globali della partizione vengono sostituiti da quelli del modulo
+*/
+bool mergePartition(Module &M, Partition &part, std::vector<Function*> &transplanted){
+  Expected<std::unique_ptr<Module>> partOrErr=parseBitcodeFile(MemoryBufferRef(part.Bitcode.str(), "localopts-partition"), M.getContext());
+  if(not partOrErr){
+    consumeError(partOrErr.takeError());
+    return false;
+  }
+  Module &P=**partOrErr;
+  std::vector<Function*> moduleFunctions, partFunctions;
+  for(Function &F : M)
+    moduleFunctions.push_back(&F);
+  for(Function &F : P)
+    partFunctions.push_back(&F);
+  PartitionTypeMapper types;
+  if(moduleFunctions.size()!=partFunctions.size() or M.global_size()!=P.global_size() or not types.mapStructs(P))
+    return false;
+
+  ValueToValueMapTy VMap;
+  for(unsigned index=0; index<partFunctions.size(); index++)
+    VMap[partFunctions[index]]=moduleFunctions[index];
+  for(auto globals : zip(P.globals(), M.globals()))
+    VMap[&std::get<0>(globals)]=&std::get<1>(globals);
+  for(unsigned index : part.Changed){
+    ++NumPartitioned;
+    transplantBody(moduleFunctions[index], partFunctions[index], VMap, types);
+    transplanted.push_back(moduleFunctions[index]);
   }
   return true;
 }
 
-bool runOnFunction(Function &F){
-  bool Transformed = false;
-  for(auto Iter=F.begin();Iter!=F.end();++Iter){
-    outs()<<"\n";
-    outs()<<"Codice originale:";
-    outs()<<"\n";
-    for(auto i=Iter->begin();i!=Iter->end();++i)                                 // Istruzioni prima della modifica
-      outs()<<*i<<"\n";
-    outs()<<"\n";
-    if (runOnBasicBlock(*Iter)) {
-      Transformed = true;
-    }
-    outs()<<"\n";
-    outs()<<"Codice aggiornato: ";
-    outs()<<"\n";
-    for(auto i=Iter->begin();i!=Iter->end();++i)                                 // Istruzioni dopo la modifica
-      outs()<<*i<<"\n";
+/*
+  Ottimizza in parallelo le funzioni 'candidates', divise in partizioni
+  bilanciate per numero di istruzioni. Le funzioni di partizioni fallite
+  vengono aggiunte a 'serial'
+*/
+void runPartitioned(Module &M, std::vector<Function*> &candidates, unsigned threads,
+                    std::vector<Function*> &transplanted, std::vector<Function*> &serial){
+  DenseMap<Function*,unsigned> indexOf;
+  for(Function &F : M)
+    indexOf.insert({&F, indexOf.size()});
+
+  std::vector<Partition> partitions(threads);
+  std::vector<Function*> sorted=candidates;                       // Prima le funzioni più grandi, ognuna nella partizione più scarica
+  std::stable_sort(sorted.begin(), sorted.end(), [](Function *a, Function *b){
+    return a->getInstructionCount()>b->getInstructionCount();
+  });
+  for(Function *F : sorted){
+    Partition &part=*std::min_element(partitions.begin(), partitions.end(), [](const Partition &a, const Partition &b){
+      return a.Size<b.Size;
+    });
+    part.Functions.push_back(indexOf[F]);
+    part.Size+=F->getInstructionCount();
   }
-  return Transformed;
+
+  std::vector<Function*> moduleFunctions;
+  for(Function &F : M)
+    moduleFunctions.push_back(&F);
+  for(Partition &part : partitions){                              // Il clone e la scrittura del bitcode leggono il contesto del modulo:
+    SmallPtrSet<const GlobalValue*,32> defined;                   // vengono fatti nel thread principale
+    for(unsigned index : part.Functions)
+      defined.insert(moduleFunctions[index]);
+    ValueToValueMapTy VMap;
+    std::unique_ptr<Module> clone=CloneModule(M, VMap, [&](const GlobalValue *GV){
+      return not isa<Function>(GV) or defined.count(GV);
+    });
+    raw_svector_ostream OS(part.Bitcode);
+    WriteBitcodeToFile(*clone, OS);
+  }
+
+  ThreadPool pool(hardware_concurrency(threads));
+  for(Partition &part : partitions)
+    pool.async([&part](){ optimizePartition(part); });
+  pool.wait();
+
+  for(Partition &part : partitions){
+    if(part.Done and mergePartition(M, part, transplanted))
+      continue;
+    for(unsigned index : part.Functions)
+      serial.push_back(moduleFunctions[index]);
+  }
+}
+
+PreservedAnalyses LocalOptsFunction::run(Function &F, FunctionAnalysisManager &AM){
+  bool CFGChanged=false;
+  if(not runOnFunction(F, AM.getResult<OptimizationRemarkEmitterAnalysis>(F), CFGChanged))
+    return PreservedAnalyses::all();
+  PreservedAnalyses PA;                                           // Le regole locali non toccano il CFG, la propagazione sì
+  if(not CFGChanged)
+    PA.preserveSet<CFGAnalyses>();
+  return PA;
+}
+
+PreservedAnalyses LocalSCCP::run(Function &F, FunctionAnalysisManager &AM){
+  Instrumentation instr;
+  instr.ORE=&AM.getResult<OptimizationRemarkEmitterAnalysis>(F);
+  bool CFGChanged=false;
+  ConstantPropagation solver(F);
+  if(not solver.run(instr, CFGChanged))
+    return PreservedAnalyses::all();
+  PreservedAnalyses PA;
+  if(not CFGChanged)
+    PA.preserveSet<CFGAnalyses>();
+  return PA;
 }
 
 PreservedAnalyses LocalOpts::run(Module &M, ModuleAnalysisManager &AM){
-  for(auto Fiter=M.begin();Fiter!=M.end();++Fiter)
-    if(runOnFunction(*Fiter))
-      return PreservedAnalyses::none();
-  return PreservedAnalyses::all();
+  FunctionAnalysisManager &FAM=AM.getResult<FunctionAnalysisManagerModuleProxy>(M).getManager();
+  std::vector<Function*> serial, candidates, transplanted;
+  for(Function &F : M){
+    if(canPartition(F))
+      candidates.push_back(&F);
+    else if(not F.isDeclaration())
+      serial.push_back(&F);
+  }
+
+  unsigned threads=hardware_concurrency(Threads).compute_thread_count();
+  LLVMContext &context=M.getContext();
+  bool remarks=context.getLLVMRemarkStreamer() or context.getDiagHandlerPtr()->isAnyRemarkEnabled();
+  if(threads>1 and candidates.size()>=ParallelThreshold and M.alias_empty() and M.ifunc_empty() and not remarks){
+    NamedRegionTimer T("partitions", "Ottimizzazione delle partizioni in parallelo", TimerGroupName, TimerGroupDesc, TimePassesIsEnabled);
+    runPartitioned(M, candidates, threads, transplanted, serial);
+  }else{                                                          // I remark richiesti sono emessi solo nel percorso seriale
+    serial.insert(serial.end(), candidates.begin(), candidates.end());
+  }
+
+  bool Changed=not transplanted.empty();
+  PreservedAnalyses CFGPreserved;
+  CFGPreserved.preserveSet<CFGAnalyses>();
+  for(Function *F : serial){                                      // Invalido le analisi solo delle funzioni modificate
+    bool CFGChanged=false;
+    if(runOnFunction(*F, FAM.getResult<OptimizationRemarkEmitterAnalysis>(*F), CFGChanged)){
+      FAM.invalidate(*F, CFGChanged?PreservedAnalyses::none():CFGPreserved);
+      Changed=true;
+    }
+  }
+  for(Function *F : transplanted)                                 // I blocchi delle funzioni trapiantate sono nuovi: nessuna analisi è valida
+    FAM.invalidate(*F, PreservedAnalyses::none());
+
+  if(not Changed)
+    return PreservedAnalyses::all();
+  PreservedAnalyses PA;                                           // Le analisi di funzione sono già state invalidate sopra
+  PA.preserve<FunctionAnalysisManagerModuleProxy>();
+  PA.preserveSet<CFGAnalyses>();
+  return PA;
 }
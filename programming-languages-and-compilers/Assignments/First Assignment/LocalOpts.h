@@ -8,5 +8,13 @@ namespace llvm {
     public:
       PreservedAnalyses run(Module &M, ModuleAnalysisManager &AM);
   };
+  class LocalOptsFunction : public PassInfoMixin<LocalOptsFunction> {
+    public:
+      PreservedAnalyses run(Function &F, FunctionAnalysisManager &AM);
+  };
+  class LocalSCCP : public PassInfoMixin<LocalSCCP> {
+    public:
+      PreservedAnalyses run(Function &F, FunctionAnalysisManager &AM);
+  };
 }
 #endif
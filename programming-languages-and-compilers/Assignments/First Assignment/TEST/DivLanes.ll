@@ -0,0 +1,148 @@
+; Divisioni e resti vettoriali con un divisore diverso in ogni corsia (reduceNonUniform).
+; Le corsie con d=±1 accanto a potenze di due non possono usare solo gli shift, -2^(w-1)
+; non si riscrive. Ogni riga di output dipende solo dalla semantica di sdiv/srem/udiv/urem:
+;   opt -load-pass-plugin <plugin> -passes=localopts DivLanes.ll -S -o DivLanes-res.ll
+;   lli DivLanes.ll e lli DivLanes-res.ll devono stampare le stesse righe
+target datalayout = "e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-i128:128-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-pc-linux-gnu"
+
+@xs = private constant [8 x i32] [i32 -2147483648, i32 2147483647, i32 -7, i32 7, i32 -1, i32 0, i32 1, i32 -8]
+@ys = private constant [8 x i32] [i32 -2147483647, i32 2147483647, i32 -7, i32 7, i32 -1, i32 0, i32 1, i32 -8]
+@.fmt = private unnamed_addr constant [17 x i8] c"%s: %d %d %d %d\0A\00"
+@.sdiv_pow2_unit = private unnamed_addr constant [15 x i8] c"sdiv <1,2,4,8>\00"
+@.srem_pow2_unit = private unnamed_addr constant [15 x i8] c"srem <1,2,4,8>\00"
+@.sdiv_neg_unit = private unnamed_addr constant [17 x i8] c"sdiv <-1,1,2,16>\00"
+@.srem_neg_unit = private unnamed_addr constant [17 x i8] c"srem <-1,1,2,16>\00"
+@.sdiv_neg_pow2 = private unnamed_addr constant [17 x i8] c"sdiv <-2,4,-8,1>\00"
+@.sdiv_mixed = private unnamed_addr constant [17 x i8] c"sdiv <1,-1,3,-7>\00"
+@.srem_mixed = private unnamed_addr constant [17 x i8] c"srem <1,-1,3,-7>\00"
+@.sdiv_pow2 = private unnamed_addr constant [15 x i8] c"sdiv <2,4,8,2>\00"
+@.udiv_pow2 = private unnamed_addr constant [15 x i8] c"udiv <1,2,4,8>\00"
+@.urem_pow2 = private unnamed_addr constant [15 x i8] c"urem <1,2,4,8>\00"
+@.udiv_mixed = private unnamed_addr constant [15 x i8] c"udiv <1,3,5,7>\00"
+
+define <4 x i32> @sdiv_pow2_unit(<4 x i32> %x) {
+  %q = sdiv <4 x i32> %x, <i32 1, i32 2, i32 4, i32 8>
+  ret <4 x i32> %q
+}
+
+define <4 x i32> @srem_pow2_unit(<4 x i32> %x) {
+  %r = srem <4 x i32> %x, <i32 1, i32 2, i32 4, i32 8>
+  ret <4 x i32> %r
+}
+
+define <4 x i32> @sdiv_neg_unit(<4 x i32> %x) {
+  %q = sdiv <4 x i32> %x, <i32 -1, i32 1, i32 2, i32 16>
+  ret <4 x i32> %q
+}
+
+define <4 x i32> @srem_neg_unit(<4 x i32> %x) {
+  %r = srem <4 x i32> %x, <i32 -1, i32 1, i32 2, i32 16>
+  ret <4 x i32> %r
+}
+
+define <4 x i32> @sdiv_neg_pow2(<4 x i32> %x) {
+  %q = sdiv <4 x i32> %x, <i32 -2, i32 4, i32 -8, i32 1>
+  ret <4 x i32> %q
+}
+
+define <4 x i32> @sdiv_mixed(<4 x i32> %x) {
+  %q = sdiv <4 x i32> %x, <i32 1, i32 -1, i32 3, i32 -7>
+  ret <4 x i32> %q
+}
+
+define <4 x i32> @srem_mixed(<4 x i32> %x) {
+  %r = srem <4 x i32> %x, <i32 1, i32 -1, i32 3, i32 -7>
+  ret <4 x i32> %r
+}
+
+define <4 x i32> @sdiv_pow2(<4 x i32> %x) {
+  %q = sdiv <4 x i32> %x, <i32 2, i32 4, i32 8, i32 2>
+  ret <4 x i32> %q
+}
+
+define <4 x i32> @udiv_pow2(<4 x i32> %x) {
+  %q = udiv <4 x i32> %x, <i32 1, i32 2, i32 4, i32 8>
+  ret <4 x i32> %q
+}
+
+define <4 x i32> @urem_pow2(<4 x i32> %x) {
+  %r = urem <4 x i32> %x, <i32 1, i32 2, i32 4, i32 8>
+  ret <4 x i32> %r
+}
+
+define <4 x i32> @udiv_mixed(<4 x i32> %x) {
+  %q = udiv <4 x i32> %x, <i32 1, i32 3, i32 5, i32 7>
+  ret <4 x i32> %q
+}
+
+; Vettore con le corsie xs[i], xs[i+1], xs[i+2], xs[i+3] (indici modulo 8)
+define <4 x i32> @lanes(ptr %table, i32 %i) {
+  %v0 = call i32 @lane(ptr %table, i32 %i, i32 0)
+  %v1 = call i32 @lane(ptr %table, i32 %i, i32 1)
+  %v2 = call i32 @lane(ptr %table, i32 %i, i32 2)
+  %v3 = call i32 @lane(ptr %table, i32 %i, i32 3)
+  %a = insertelement <4 x i32> undef, i32 %v0, i32 0
+  %b = insertelement <4 x i32> %a, i32 %v1, i32 1
+  %c = insertelement <4 x i32> %b, i32 %v2, i32 2
+  %d = insertelement <4 x i32> %c, i32 %v3, i32 3
+  ret <4 x i32> %d
+}
+
+define i32 @lane(ptr %table, i32 %i, i32 %j) {
+  %s = add i32 %i, %j
+  %m = and i32 %s, 7
+  %idx = zext i32 %m to i64
+  %p = getelementptr [8 x i32], ptr %table, i64 0, i64 %idx
+  %v = load i32, ptr %p
+  ret i32 %v
+}
+
+define void @print(ptr %name, <4 x i32> %v) {
+  %v0 = extractelement <4 x i32> %v, i32 0
+  %v1 = extractelement <4 x i32> %v, i32 1
+  %v2 = extractelement <4 x i32> %v, i32 2
+  %v3 = extractelement <4 x i32> %v, i32 3
+  %r = call i32 (ptr, ...) @printf(ptr @.fmt, ptr %name, i32 %v0, i32 %v1, i32 %v2, i32 %v3)
+  ret void
+}
+
+declare i32 @printf(ptr, ...)
+
+define i32 @main() {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %next, %loop ]
+  %x = call <4 x i32> @lanes(ptr @xs, i32 %i)
+  %y = call <4 x i32> @lanes(ptr @ys, i32 %i)
+  %r0 = call <4 x i32> @sdiv_pow2_unit(<4 x i32> %x)
+  call void @print(ptr @.sdiv_pow2_unit, <4 x i32> %r0)
+  %r1 = call <4 x i32> @srem_pow2_unit(<4 x i32> %x)
+  call void @print(ptr @.srem_pow2_unit, <4 x i32> %r1)
+  %r2 = call <4 x i32> @sdiv_neg_unit(<4 x i32> %y)
+  call void @print(ptr @.sdiv_neg_unit, <4 x i32> %r2)
+  %r3 = call <4 x i32> @srem_neg_unit(<4 x i32> %y)
+  call void @print(ptr @.srem_neg_unit, <4 x i32> %r3)
+  %r4 = call <4 x i32> @sdiv_neg_pow2(<4 x i32> %x)
+  call void @print(ptr @.sdiv_neg_pow2, <4 x i32> %r4)
+  %r5 = call <4 x i32> @sdiv_mixed(<4 x i32> %y)
+  call void @print(ptr @.sdiv_mixed, <4 x i32> %r5)
+  %r6 = call <4 x i32> @srem_mixed(<4 x i32> %y)
+  call void @print(ptr @.srem_mixed, <4 x i32> %r6)
+  %r7 = call <4 x i32> @sdiv_pow2(<4 x i32> %x)
+  call void @print(ptr @.sdiv_pow2, <4 x i32> %r7)
+  %r8 = call <4 x i32> @udiv_pow2(<4 x i32> %x)
+  call void @print(ptr @.udiv_pow2, <4 x i32> %r8)
+  %r9 = call <4 x i32> @urem_pow2(<4 x i32> %x)
+  call void @print(ptr @.urem_pow2, <4 x i32> %r9)
+  %r10 = call <4 x i32> @udiv_mixed(<4 x i32> %x)
+  call void @print(ptr @.udiv_mixed, <4 x i32> %r10)
+  %next = add i32 %i, 1
+  %done = icmp eq i32 %next, 8
+  br i1 %done, label %exit, label %loop
+
+exit:
+  ret i32 0
+}
@@ -0,0 +1,551 @@
+; Divisioni e resti scalari per costante (numero magico, shift, casi limite). I divisori
+; coprono -2^(w-1), -1, 1, 2^(w-1) (senza segno), potenze di due con e senza segno e
+; divisori con magic "add"; i dividendi coprono -2^(w-1), -1, 0 e 2^(w-1)-1. Con d=-1 il
+; dividendo -2^(w-1) (overflow, comportamento indefinito) è sostituito da 2^(w-1)-1:
+;   opt -load-pass-plugin <plugin> -passes=localopts DivScalar.ll -S -o DivScalar-res.ll
+;   lli DivScalar.ll e lli DivScalar-res.ll devono stampare le stesse righe
+target datalayout = "e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-i128:128-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-pc-linux-gnu"
+
+@in32 = private constant [10 x i32] [i32 -2147483648, i32 -2147483647, i32 -1000003, i32 -7, i32 -1, i32 0, i32 1, i32 7, i32 1000003, i32 2147483647]
+@in8 = private constant [10 x i8] [i8 -128, i8 -127, i8 -7, i8 -1, i8 0, i8 1, i8 7, i8 100, i8 127, i8 -100]
+@.fmt = private unnamed_addr constant [7 x i8] c"%s %d\0A\00"
+@.fmtu = private unnamed_addr constant [7 x i8] c"%s %u\0A\00"
+@.sdiv32_m2147483648 = private unnamed_addr constant [19 x i8] c"sdiv32 -2147483648\00"
+@.sdiv32_m1 = private unnamed_addr constant [10 x i8] c"sdiv32 -1\00"
+@.sdiv32_1 = private unnamed_addr constant [9 x i8] c"sdiv32 1\00"
+@.sdiv32_2 = private unnamed_addr constant [9 x i8] c"sdiv32 2\00"
+@.sdiv32_m2 = private unnamed_addr constant [10 x i8] c"sdiv32 -2\00"
+@.sdiv32_8 = private unnamed_addr constant [9 x i8] c"sdiv32 8\00"
+@.sdiv32_m8 = private unnamed_addr constant [10 x i8] c"sdiv32 -8\00"
+@.sdiv32_3 = private unnamed_addr constant [9 x i8] c"sdiv32 3\00"
+@.sdiv32_7 = private unnamed_addr constant [9 x i8] c"sdiv32 7\00"
+@.sdiv32_m7 = private unnamed_addr constant [10 x i8] c"sdiv32 -7\00"
+@.sdiv32_641 = private unnamed_addr constant [11 x i8] c"sdiv32 641\00"
+@.sdiv32_1073741824 = private unnamed_addr constant [18 x i8] c"sdiv32 1073741824\00"
+@.srem32_m2147483648 = private unnamed_addr constant [19 x i8] c"srem32 -2147483648\00"
+@.srem32_m1 = private unnamed_addr constant [10 x i8] c"srem32 -1\00"
+@.srem32_1 = private unnamed_addr constant [9 x i8] c"srem32 1\00"
+@.srem32_2 = private unnamed_addr constant [9 x i8] c"srem32 2\00"
+@.srem32_m2 = private unnamed_addr constant [10 x i8] c"srem32 -2\00"
+@.srem32_8 = private unnamed_addr constant [9 x i8] c"srem32 8\00"
+@.srem32_m8 = private unnamed_addr constant [10 x i8] c"srem32 -8\00"
+@.srem32_3 = private unnamed_addr constant [9 x i8] c"srem32 3\00"
+@.srem32_7 = private unnamed_addr constant [9 x i8] c"srem32 7\00"
+@.srem32_m7 = private unnamed_addr constant [10 x i8] c"srem32 -7\00"
+@.srem32_641 = private unnamed_addr constant [11 x i8] c"srem32 641\00"
+@.srem32_1073741824 = private unnamed_addr constant [18 x i8] c"srem32 1073741824\00"
+@.sdiv8_m128 = private unnamed_addr constant [11 x i8] c"sdiv8 -128\00"
+@.sdiv8_m1 = private unnamed_addr constant [9 x i8] c"sdiv8 -1\00"
+@.sdiv8_1 = private unnamed_addr constant [8 x i8] c"sdiv8 1\00"
+@.sdiv8_3 = private unnamed_addr constant [8 x i8] c"sdiv8 3\00"
+@.sdiv8_m7 = private unnamed_addr constant [9 x i8] c"sdiv8 -7\00"
+@.sdiv8_64 = private unnamed_addr constant [9 x i8] c"sdiv8 64\00"
+@.srem8_m128 = private unnamed_addr constant [11 x i8] c"srem8 -128\00"
+@.srem8_m1 = private unnamed_addr constant [9 x i8] c"srem8 -1\00"
+@.srem8_1 = private unnamed_addr constant [8 x i8] c"srem8 1\00"
+@.srem8_3 = private unnamed_addr constant [8 x i8] c"srem8 3\00"
+@.srem8_m7 = private unnamed_addr constant [9 x i8] c"srem8 -7\00"
+@.srem8_64 = private unnamed_addr constant [9 x i8] c"srem8 64\00"
+@.udiv32_1 = private unnamed_addr constant [9 x i8] c"udiv32 1\00"
+@.udiv32_3 = private unnamed_addr constant [9 x i8] c"udiv32 3\00"
+@.udiv32_7 = private unnamed_addr constant [9 x i8] c"udiv32 7\00"
+@.udiv32_16 = private unnamed_addr constant [10 x i8] c"udiv32 16\00"
+@.udiv32_641 = private unnamed_addr constant [11 x i8] c"udiv32 641\00"
+@.udiv32_2147483648 = private unnamed_addr constant [18 x i8] c"udiv32 2147483648\00"
+@.udiv32_4294967295 = private unnamed_addr constant [18 x i8] c"udiv32 4294967295\00"
+@.urem32_1 = private unnamed_addr constant [9 x i8] c"urem32 1\00"
+@.urem32_3 = private unnamed_addr constant [9 x i8] c"urem32 3\00"
+@.urem32_7 = private unnamed_addr constant [9 x i8] c"urem32 7\00"
+@.urem32_16 = private unnamed_addr constant [10 x i8] c"urem32 16\00"
+@.urem32_641 = private unnamed_addr constant [11 x i8] c"urem32 641\00"
+@.urem32_2147483648 = private unnamed_addr constant [18 x i8] c"urem32 2147483648\00"
+@.urem32_4294967295 = private unnamed_addr constant [18 x i8] c"urem32 4294967295\00"
+@.udiv8_1 = private unnamed_addr constant [8 x i8] c"udiv8 1\00"
+@.udiv8_3 = private unnamed_addr constant [8 x i8] c"udiv8 3\00"
+@.udiv8_7 = private unnamed_addr constant [8 x i8] c"udiv8 7\00"
+@.udiv8_128 = private unnamed_addr constant [10 x i8] c"udiv8 128\00"
+@.udiv8_255 = private unnamed_addr constant [10 x i8] c"udiv8 255\00"
+@.urem8_1 = private unnamed_addr constant [8 x i8] c"urem8 1\00"
+@.urem8_3 = private unnamed_addr constant [8 x i8] c"urem8 3\00"
+@.urem8_7 = private unnamed_addr constant [8 x i8] c"urem8 7\00"
+@.urem8_128 = private unnamed_addr constant [10 x i8] c"urem8 128\00"
+@.urem8_255 = private unnamed_addr constant [10 x i8] c"urem8 255\00"
+
+define i32 @sdiv32_m2147483648(i32 %x) {
+  %r = sdiv i32 %x, -2147483648
+  ret i32 %r
+}
+
+define i32 @sdiv32_m1(i32 %x) {
+  %r = sdiv i32 %x, -1
+  ret i32 %r
+}
+
+define i32 @sdiv32_1(i32 %x) {
+  %r = sdiv i32 %x, 1
+  ret i32 %r
+}
+
+define i32 @sdiv32_2(i32 %x) {
+  %r = sdiv i32 %x, 2
+  ret i32 %r
+}
+
+define i32 @sdiv32_m2(i32 %x) {
+  %r = sdiv i32 %x, -2
+  ret i32 %r
+}
+
+define i32 @sdiv32_8(i32 %x) {
+  %r = sdiv i32 %x, 8
+  ret i32 %r
+}
+
+define i32 @sdiv32_m8(i32 %x) {
+  %r = sdiv i32 %x, -8
+  ret i32 %r
+}
+
+define i32 @sdiv32_3(i32 %x) {
+  %r = sdiv i32 %x, 3
+  ret i32 %r
+}
+
+define i32 @sdiv32_7(i32 %x) {
+  %r = sdiv i32 %x, 7
+  ret i32 %r
+}
+
+define i32 @sdiv32_m7(i32 %x) {
+  %r = sdiv i32 %x, -7
+  ret i32 %r
+}
+
+define i32 @sdiv32_641(i32 %x) {
+  %r = sdiv i32 %x, 641
+  ret i32 %r
+}
+
+define i32 @sdiv32_1073741824(i32 %x) {
+  %r = sdiv i32 %x, 1073741824
+  ret i32 %r
+}
+
+define i32 @srem32_m2147483648(i32 %x) {
+  %r = srem i32 %x, -2147483648
+  ret i32 %r
+}
+
+define i32 @srem32_m1(i32 %x) {
+  %r = srem i32 %x, -1
+  ret i32 %r
+}
+
+define i32 @srem32_1(i32 %x) {
+  %r = srem i32 %x, 1
+  ret i32 %r
+}
+
+define i32 @srem32_2(i32 %x) {
+  %r = srem i32 %x, 2
+  ret i32 %r
+}
+
+define i32 @srem32_m2(i32 %x) {
+  %r = srem i32 %x, -2
+  ret i32 %r
+}
+
+define i32 @srem32_8(i32 %x) {
+  %r = srem i32 %x, 8
+  ret i32 %r
+}
+
+define i32 @srem32_m8(i32 %x) {
+  %r = srem i32 %x, -8
+  ret i32 %r
+}
+
+define i32 @srem32_3(i32 %x) {
+  %r = srem i32 %x, 3
+  ret i32 %r
+}
+
+define i32 @srem32_7(i32 %x) {
+  %r = srem i32 %x, 7
+  ret i32 %r
+}
+
+define i32 @srem32_m7(i32 %x) {
+  %r = srem i32 %x, -7
+  ret i32 %r
+}
+
+define i32 @srem32_641(i32 %x) {
+  %r = srem i32 %x, 641
+  ret i32 %r
+}
+
+define i32 @srem32_1073741824(i32 %x) {
+  %r = srem i32 %x, 1073741824
+  ret i32 %r
+}
+
+define i8 @sdiv8_m128(i8 %x) {
+  %r = sdiv i8 %x, -128
+  ret i8 %r
+}
+
+define i8 @sdiv8_m1(i8 %x) {
+  %r = sdiv i8 %x, -1
+  ret i8 %r
+}
+
+define i8 @sdiv8_1(i8 %x) {
+  %r = sdiv i8 %x, 1
+  ret i8 %r
+}
+
+define i8 @sdiv8_3(i8 %x) {
+  %r = sdiv i8 %x, 3
+  ret i8 %r
+}
+
+define i8 @sdiv8_m7(i8 %x) {
+  %r = sdiv i8 %x, -7
+  ret i8 %r
+}
+
+define i8 @sdiv8_64(i8 %x) {
+  %r = sdiv i8 %x, 64
+  ret i8 %r
+}
+
+define i8 @srem8_m128(i8 %x) {
+  %r = srem i8 %x, -128
+  ret i8 %r
+}
+
+define i8 @srem8_m1(i8 %x) {
+  %r = srem i8 %x, -1
+  ret i8 %r
+}
+
+define i8 @srem8_1(i8 %x) {
+  %r = srem i8 %x, 1
+  ret i8 %r
+}
+
+define i8 @srem8_3(i8 %x) {
+  %r = srem i8 %x, 3
+  ret i8 %r
+}
+
+define i8 @srem8_m7(i8 %x) {
+  %r = srem i8 %x, -7
+  ret i8 %r
+}
+
+define i8 @srem8_64(i8 %x) {
+  %r = srem i8 %x, 64
+  ret i8 %r
+}
+
+define i32 @udiv32_1(i32 %x) {
+  %r = udiv i32 %x, 1
+  ret i32 %r
+}
+
+define i32 @udiv32_3(i32 %x) {
+  %r = udiv i32 %x, 3
+  ret i32 %r
+}
+
+define i32 @udiv32_7(i32 %x) {
+  %r = udiv i32 %x, 7
+  ret i32 %r
+}
+
+define i32 @udiv32_16(i32 %x) {
+  %r = udiv i32 %x, 16
+  ret i32 %r
+}
+
+define i32 @udiv32_641(i32 %x) {
+  %r = udiv i32 %x, 641
+  ret i32 %r
+}
+
+define i32 @udiv32_2147483648(i32 %x) {
+  %r = udiv i32 %x, 2147483648
+  ret i32 %r
+}
+
+define i32 @udiv32_4294967295(i32 %x) {
+  %r = udiv i32 %x, 4294967295
+  ret i32 %r
+}
+
+define i32 @urem32_1(i32 %x) {
+  %r = urem i32 %x, 1
+  ret i32 %r
+}
+
+define i32 @urem32_3(i32 %x) {
+  %r = urem i32 %x, 3
+  ret i32 %r
+}
+
+define i32 @urem32_7(i32 %x) {
+  %r = urem i32 %x, 7
+  ret i32 %r
+}
+
+define i32 @urem32_16(i32 %x) {
+  %r = urem i32 %x, 16
+  ret i32 %r
+}
+
+define i32 @urem32_641(i32 %x) {
+  %r = urem i32 %x, 641
+  ret i32 %r
+}
+
+define i32 @urem32_2147483648(i32 %x) {
+  %r = urem i32 %x, 2147483648
+  ret i32 %r
+}
+
+define i32 @urem32_4294967295(i32 %x) {
+  %r = urem i32 %x, 4294967295
+  ret i32 %r
+}
+
+define i8 @udiv8_1(i8 %x) {
+  %r = udiv i8 %x, 1
+  ret i8 %r
+}
+
+define i8 @udiv8_3(i8 %x) {
+  %r = udiv i8 %x, 3
+  ret i8 %r
+}
+
+define i8 @udiv8_7(i8 %x) {
+  %r = udiv i8 %x, 7
+  ret i8 %r
+}
+
+define i8 @udiv8_128(i8 %x) {
+  %r = udiv i8 %x, 128
+  ret i8 %r
+}
+
+define i8 @udiv8_255(i8 %x) {
+  %r = udiv i8 %x, 255
+  ret i8 %r
+}
+
+define i8 @urem8_1(i8 %x) {
+  %r = urem i8 %x, 1
+  ret i8 %r
+}
+
+define i8 @urem8_3(i8 %x) {
+  %r = urem i8 %x, 3
+  ret i8 %r
+}
+
+define i8 @urem8_7(i8 %x) {
+  %r = urem i8 %x, 7
+  ret i8 %r
+}
+
+define i8 @urem8_128(i8 %x) {
+  %r = urem i8 %x, 128
+  ret i8 %r
+}
+
+define i8 @urem8_255(i8 %x) {
+  %r = urem i8 %x, 255
+  ret i8 %r
+}
+
+; Dividendo valido per d=-1: -2^(w-1)/-1 non è rappresentabile
+define i32 @safe32(i32 %x) {
+  %min = icmp eq i32 %x, -2147483648
+  %r = select i1 %min, i32 2147483647, i32 %x
+  ret i32 %r
+}
+
+; Dividendo valido per d=-1: -2^(w-1)/-1 non è rappresentabile
+define i8 @safe8(i8 %x) {
+  %min = icmp eq i8 %x, -128
+  %r = select i1 %min, i8 127, i8 %x
+  ret i8 %r
+}
+
+declare i32 @printf(ptr, ...)
+
+define i32 @main() {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i64 [ 0, %entry ], [ %next, %loop ]
+  %p32 = getelementptr [10 x i32], ptr @in32, i64 0, i64 %i
+  %x32 = load i32, ptr %p32
+  %s32 = call i32 @safe32(i32 %x32)
+  %p8 = getelementptr [10 x i8], ptr @in8, i64 0, i64 %i
+  %x8 = load i8, ptr %p8
+  %s8 = call i8 @safe8(i8 %x8)
+  %r0 = call i32 @sdiv32_m2147483648(i32 %x32)
+  call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.sdiv32_m2147483648, i32 %r0)
+  %r1 = call i32 @sdiv32_m1(i32 %s32)
+  call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.sdiv32_m1, i32 %r1)
+  %r2 = call i32 @sdiv32_1(i32 %x32)
+  call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.sdiv32_1, i32 %r2)
+  %r3 = call i32 @sdiv32_2(i32 %x32)
+  call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.sdiv32_2, i32 %r3)
+  %r4 = call i32 @sdiv32_m2(i32 %x32)
+  call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.sdiv32_m2, i32 %r4)
+  %r5 = call i32 @sdiv32_8(i32 %x32)
+  call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.sdiv32_8, i32 %r5)
+  %r6 = call i32 @sdiv32_m8(i32 %x32)
+  call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.sdiv32_m8, i32 %r6)
+  %r7 = call i32 @sdiv32_3(i32 %x32)
+  call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.sdiv32_3, i32 %r7)
+  %r8 = call i32 @sdiv32_7(i32 %x32)
+  call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.sdiv32_7, i32 %r8)
+  %r9 = call i32 @sdiv32_m7(i32 %x32)
+  call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.sdiv32_m7, i32 %r9)
+  %r10 = call i32 @sdiv32_641(i32 %x32)
+  call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.sdiv32_641, i32 %r10)
+  %r11 = call i32 @sdiv32_1073741824(i32 %x32)
+  call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.sdiv32_1073741824, i32 %r11)
+  %r12 = call i32 @srem32_m2147483648(i32 %x32)
+  call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.srem32_m2147483648, i32 %r12)
+  %r13 = call i32 @srem32_m1(i32 %s32)
+  call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.srem32_m1, i32 %r13)
+  %r14 = call i32 @srem32_1(i32 %x32)
+  call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.srem32_1, i32 %r14)
+  %r15 = call i32 @srem32_2(i32 %x32)
+  call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.srem32_2, i32 %r15)
+  %r16 = call i32 @srem32_m2(i32 %x32)
+  call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.srem32_m2, i32 %r16)
+  %r17 = call i32 @srem32_8(i32 %x32)
+  call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.srem32_8, i32 %r17)
+  %r18 = call i32 @srem32_m8(i32 %x32)
+  call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.srem32_m8, i32 %r18)
+  %r19 = call i32 @srem32_3(i32 %x32)
+  call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.srem32_3, i32 %r19)
+  %r20 = call i32 @srem32_7(i32 %x32)
+  call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.srem32_7, i32 %r20)
+  %r21 = call i32 @srem32_m7(i32 %x32)
+  call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.srem32_m7, i32 %r21)
+  %r22 = call i32 @srem32_641(i32 %x32)
+  call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.srem32_641, i32 %r22)
+  %r23 = call i32 @srem32_1073741824(i32 %x32)
+  call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.srem32_1073741824, i32 %r23)
+  %r24 = call i8 @sdiv8_m128(i8 %x8)
+  %e24 = sext i8 %r24 to i32
+  call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.sdiv8_m128, i32 %e24)
+  %r25 = call i8 @sdiv8_m1(i8 %s8)
+  %e25 = sext i8 %r25 to i32
+  call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.sdiv8_m1, i32 %e25)
+  %r26 = call i8 @sdiv8_1(i8 %x8)
+  %e26 = sext i8 %r26 to i32
+  call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.sdiv8_1, i32 %e26)
+  %r27 = call i8 @sdiv8_3(i8 %x8)
+  %e27 = sext i8 %r27 to i32
+  call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.sdiv8_3, i32 %e27)
+  %r28 = call i8 @sdiv8_m7(i8 %x8)
+  %e28 = sext i8 %r28 to i32
+  call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.sdiv8_m7, i32 %e28)
+  %r29 = call i8 @sdiv8_64(i8 %x8)
+  %e29 = sext i8 %r29 to i32
+  call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.sdiv8_64, i32 %e29)
+  %r30 = call i8 @srem8_m128(i8 %x8)
+  %e30 = sext i8 %r30 to i32
+  call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.srem8_m128, i32 %e30)
+  %r31 = call i8 @srem8_m1(i8 %s8)
+  %e31 = sext i8 %r31 to i32
+  call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.srem8_m1, i32 %e31)
+  %r32 = call i8 @srem8_1(i8 %x8)
+  %e32 = sext i8 %r32 to i32
+  call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.srem8_1, i32 %e32)
+  %r33 = call i8 @srem8_3(i8 %x8)
+  %e33 = sext i8 %r33 to i32
+  call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.srem8_3, i32 %e33)
+  %r34 = call i8 @srem8_m7(i8 %x8)
+  %e34 = sext i8 %r34 to i32
+  call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.srem8_m7, i32 %e34)
+  %r35 = call i8 @srem8_64(i8 %x8)
+  %e35 = sext i8 %r35 to i32
+  call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.srem8_64, i32 %e35)
+  %r36 = call i32 @udiv32_1(i32 %x32)
+  call i32 (ptr, ...) @printf(ptr @.fmtu, ptr @.udiv32_1, i32 %r36)
+  %r37 = call i32 @udiv32_3(i32 %x32)
+  call i32 (ptr, ...) @printf(ptr @.fmtu, ptr @.udiv32_3, i32 %r37)
+  %r38 = call i32 @udiv32_7(i32 %x32)
+  call i32 (ptr, ...) @printf(ptr @.fmtu, ptr @.udiv32_7, i32 %r38)
+  %r39 = call i32 @udiv32_16(i32 %x32)
+  call i32 (ptr, ...) @printf(ptr @.fmtu, ptr @.udiv32_16, i32 %r39)
+  %r40 = call i32 @udiv32_641(i32 %x32)
+  call i32 (ptr, ...) @printf(ptr @.fmtu, ptr @.udiv32_641, i32 %r40)
+  %r41 = call i32 @udiv32_2147483648(i32 %x32)
+  call i32 (ptr, ...) @printf(ptr @.fmtu, ptr @.udiv32_2147483648, i32 %r41)
+  %r42 = call i32 @udiv32_4294967295(i32 %x32)
+  call i32 (ptr, ...) @printf(ptr @.fmtu, ptr @.udiv32_4294967295, i32 %r42)
+  %r43 = call i32 @urem32_1(i32 %x32)
+  call i32 (ptr, ...) @printf(ptr @.fmtu, ptr @.urem32_1, i32 %r43)
+  %r44 = call i32 @urem32_3(i32 %x32)
+  call i32 (ptr, ...) @printf(ptr @.fmtu, ptr @.urem32_3, i32 %r44)
+  %r45 = call i32 @urem32_7(i32 %x32)
+  call i32 (ptr, ...) @printf(ptr @.fmtu, ptr @.urem32_7, i32 %r45)
+  %r46 = call i32 @urem32_16(i32 %x32)
+  call i32 (ptr, ...) @printf(ptr @.fmtu, ptr @.urem32_16, i32 %r46)
+  %r47 = call i32 @urem32_641(i32 %x32)
+  call i32 (ptr, ...) @printf(ptr @.fmtu, ptr @.urem32_641, i32 %r47)
+  %r48 = call i32 @urem32_2147483648(i32 %x32)
+  call i32 (ptr, ...) @printf(ptr @.fmtu, ptr @.urem32_2147483648, i32 %r48)
+  %r49 = call i32 @urem32_4294967295(i32 %x32)
+  call i32 (ptr, ...) @printf(ptr @.fmtu, ptr @.urem32_4294967295, i32 %r49)
+  %r50 = call i8 @udiv8_1(i8 %x8)
+  %e50 = zext i8 %r50 to i32
+  call i32 (ptr, ...) @printf(ptr @.fmtu, ptr @.udiv8_1, i32 %e50)
+  %r51 = call i8 @udiv8_3(i8 %x8)
+  %e51 = zext i8 %r51 to i32
+  call i32 (ptr, ...) @printf(ptr @.fmtu, ptr @.udiv8_3, i32 %e51)
+  %r52 = call i8 @udiv8_7(i8 %x8)
+  %e52 = zext i8 %r52 to i32
+  call i32 (ptr, ...) @printf(ptr @.fmtu, ptr @.udiv8_7, i32 %e52)
+  %r53 = call i8 @udiv8_128(i8 %x8)
+  %e53 = zext i8 %r53 to i32
+  call i32 (ptr, ...) @printf(ptr @.fmtu, ptr @.udiv8_128, i32 %e53)
+  %r54 = call i8 @udiv8_255(i8 %x8)
+  %e54 = zext i8 %r54 to i32
+  call i32 (ptr, ...) @printf(ptr @.fmtu, ptr @.udiv8_255, i32 %e54)
+  %r55 = call i8 @urem8_1(i8 %x8)
+  %e55 = zext i8 %r55 to i32
+  call i32 (ptr, ...) @printf(ptr @.fmtu, ptr @.urem8_1, i32 %e55)
+  %r56 = call i8 @urem8_3(i8 %x8)
+  %e56 = zext i8 %r56 to i32
+  call i32 (ptr, ...) @printf(ptr @.fmtu, ptr @.urem8_3, i32 %e56)
+  %r57 = call i8 @urem8_7(i8 %x8)
+  %e57 = zext i8 %r57 to i32
+  call i32 (ptr, ...) @printf(ptr @.fmtu, ptr @.urem8_7, i32 %e57)
+  %r58 = call i8 @urem8_128(i8 %x8)
+  %e58 = zext i8 %r58 to i32
+  call i32 (ptr, ...) @printf(ptr @.fmtu, ptr @.urem8_128, i32 %e58)
+  %r59 = call i8 @urem8_255(i8 %x8)
+  %e59 = zext i8 %r59 to i32
+  call i32 (ptr, ...) @printf(ptr @.fmtu, ptr @.urem8_255, i32 %e59)
+  %next = add i64 %i, 1
+  %done = icmp eq i64 %next, 10
+  br i1 %done, label %exit, label %loop
+
+exit:
+  ret i32 0
+}
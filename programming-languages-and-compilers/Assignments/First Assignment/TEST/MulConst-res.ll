@@ -0,0 +1,241 @@
+; ModuleID = 'MulConst.ll'
+source_filename = "MulConst.ll"
+target datalayout = "e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-i128:128-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-pc-linux-gnu"
+
+@in32 = private constant [10 x i32] [i32 -2147483648, i32 -1000003, i32 -7, i32 -1, i32 0, i32 1, i32 7, i32 1000003, i32 2147483647, i32 123456789]
+@in8 = private constant [10 x i8] c"\80\F9\FF\00\01\07d\7F\9C7"
+@in64 = private constant [10 x i64] [i64 -9223372036854775808, i64 -1000000000000000, i64 -7, i64 -1, i64 0, i64 1, i64 7, i64 1000000000000000, i64 9223372036854775807, i64 123456789123]
+@.fmt = private unnamed_addr constant [9 x i8] c"%s %lld\0A\00"
+@.fmtv = private unnamed_addr constant [16 x i8] c"%s %d %d %d %d\0A\00"
+@.mul32_15 = private unnamed_addr constant [9 x i8] c"mul32 15\00"
+@.mul32_100 = private unnamed_addr constant [10 x i8] c"mul32 100\00"
+@.mul32_m7 = private unnamed_addr constant [9 x i8] c"mul32 -7\00"
+@.mul32_3 = private unnamed_addr constant [8 x i8] c"mul32 3\00"
+@.mul32_255 = private unnamed_addr constant [10 x i8] c"mul32 255\00"
+@.mul32_1023 = private unnamed_addr constant [11 x i8] c"mul32 1023\00"
+@.mul32_2147483647 = private unnamed_addr constant [17 x i8] c"mul32 2147483647\00"
+@.mul32_m2147483648 = private unnamed_addr constant [18 x i8] c"mul32 -2147483648\00"
+@.mul32_m1 = private unnamed_addr constant [9 x i8] c"mul32 -1\00"
+@.mul32_1431655765 = private unnamed_addr constant [17 x i8] c"mul32 1431655765\00"
+@.mul32_m100 = private unnamed_addr constant [11 x i8] c"mul32 -100\00"
+@.mul8_m128 = private unnamed_addr constant [10 x i8] c"mul8 -128\00"
+@.mul8_127 = private unnamed_addr constant [9 x i8] c"mul8 127\00"
+@.mul8_3 = private unnamed_addr constant [7 x i8] c"mul8 3\00"
+@.mul8_100 = private unnamed_addr constant [9 x i8] c"mul8 100\00"
+@.mul8_m3 = private unnamed_addr constant [8 x i8] c"mul8 -3\00"
+@.mul64_9223372036854775807 = private unnamed_addr constant [26 x i8] c"mul64 9223372036854775807\00"
+@.mul64_1000003 = private unnamed_addr constant [14 x i8] c"mul64 1000003\00"
+@.mul64_m15 = private unnamed_addr constant [10 x i8] c"mul64 -15\00"
+@.splat = private unnamed_addr constant [17 x i8] c"mul <4 x i32> 15\00"
+@.pow2 = private unnamed_addr constant [34 x i8] c"mul <4 x i32> <1,2,4,-2147483648>\00"
+
+define i32 @mul32_15(i32 %x) {
+  %1 = shl i32 %x, 4
+  %2 = sub i32 %1, %x
+  ret i32 %2
+}
+
+define i32 @mul32_100(i32 %x) {
+  %r = mul i32 %x, 100
+  ret i32 %r
+}
+
+define i32 @mul32_m7(i32 %x) {
+  %1 = shl i32 %x, 3
+  %2 = sub i32 %x, %1
+  ret i32 %2
+}
+
+define i32 @mul32_3(i32 %x) {
+  %1 = shl i32 %x, 2
+  %2 = sub i32 %1, %x
+  ret i32 %2
+}
+
+define i32 @mul32_255(i32 %x) {
+  %1 = shl i32 %x, 8
+  %2 = sub i32 %1, %x
+  ret i32 %2
+}
+
+define i32 @mul32_1023(i32 %x) {
+  %1 = shl i32 %x, 10
+  %2 = sub i32 %1, %x
+  ret i32 %2
+}
+
+define i32 @mul32_2147483647(i32 %x) {
+  %1 = shl i32 %x, 31
+  %2 = sub i32 %1, %x
+  ret i32 %2
+}
+
+define i32 @mul32_m2147483648(i32 %x) {
+  %1 = shl i32 %x, 31
+  ret i32 %1
+}
+
+define i32 @mul32_m1(i32 %x) {
+  %1 = sub i32 0, %x
+  ret i32 %1
+}
+
+define i32 @mul32_1431655765(i32 %x) {
+  %r = mul i32 %x, 1431655765
+  ret i32 %r
+}
+
+define i32 @mul32_m100(i32 %x) {
+  %r = mul i32 %x, -100
+  ret i32 %r
+}
+
+define i8 @mul8_m128(i8 %x) {
+  %1 = shl i8 %x, 7
+  ret i8 %1
+}
+
+define i8 @mul8_127(i8 %x) {
+  %1 = shl i8 %x, 7
+  %2 = sub i8 %1, %x
+  ret i8 %2
+}
+
+define i8 @mul8_3(i8 %x) {
+  %1 = shl i8 %x, 2
+  %2 = sub i8 %1, %x
+  ret i8 %2
+}
+
+define i8 @mul8_100(i8 %x) {
+  %r = mul i8 %x, 100
+  ret i8 %r
+}
+
+define i8 @mul8_m3(i8 %x) {
+  %1 = shl i8 %x, 2
+  %2 = sub i8 %x, %1
+  ret i8 %2
+}
+
+define i64 @mul64_9223372036854775807(i64 %x) {
+  %1 = shl i64 %x, 63
+  %2 = sub i64 %1, %x
+  ret i64 %2
+}
+
+define i64 @mul64_1000003(i64 %x) {
+  %r = mul i64 %x, 1000003
+  ret i64 %r
+}
+
+define i64 @mul64_m15(i64 %x) {
+  %1 = shl i64 %x, 4
+  %2 = sub i64 %x, %1
+  ret i64 %2
+}
+
+define <4 x i32> @splat(<4 x i32> %x) {
+  %1 = shl <4 x i32> %x, <i32 4, i32 4, i32 4, i32 4>
+  %2 = sub <4 x i32> %1, %x
+  ret <4 x i32> %2
+}
+
+define <4 x i32> @pow2(<4 x i32> %x) {
+  %1 = shl <4 x i32> %x, <i32 0, i32 1, i32 2, i32 31>
+  ret <4 x i32> %1
+}
+
+define void @print(ptr %name, <4 x i32> %v) {
+  %v0 = extractelement <4 x i32> %v, i32 0
+  %v1 = extractelement <4 x i32> %v, i32 1
+  %v2 = extractelement <4 x i32> %v, i32 2
+  %v3 = extractelement <4 x i32> %v, i32 3
+  %r = call i32 (ptr, ...) @printf(ptr @.fmtv, ptr %name, i32 %v0, i32 %v1, i32 %v2, i32 %v3)
+  ret void
+}
+
+declare i32 @printf(ptr, ...)
+
+define i32 @main() {
+entry:
+  br label %loop
+
+loop:                                             ; preds = %loop, %entry
+  %i = phi i64 [ 0, %entry ], [ %next, %loop ]
+  %p32 = getelementptr [10 x i32], ptr @in32, i64 0, i64 %i
+  %x32 = load i32, ptr %p32, align 4
+  %p8 = getelementptr [10 x i8], ptr @in8, i64 0, i64 %i
+  %x8 = load i8, ptr %p8, align 1
+  %p64 = getelementptr [10 x i64], ptr @in64, i64 0, i64 %i
+  %x64 = load i64, ptr %p64, align 8
+  %r0 = call i32 @mul32_15(i32 %x32)
+  %e0 = sext i32 %r0 to i64
+  %0 = call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.mul32_15, i64 %e0)
+  %r1 = call i32 @mul32_100(i32 %x32)
+  %e1 = sext i32 %r1 to i64
+  %1 = call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.mul32_100, i64 %e1)
+  %r2 = call i32 @mul32_m7(i32 %x32)
+  %e2 = sext i32 %r2 to i64
+  %2 = call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.mul32_m7, i64 %e2)
+  %r3 = call i32 @mul32_3(i32 %x32)
+  %e3 = sext i32 %r3 to i64
+  %3 = call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.mul32_3, i64 %e3)
+  %r4 = call i32 @mul32_255(i32 %x32)
+  %e4 = sext i32 %r4 to i64
+  %4 = call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.mul32_255, i64 %e4)
+  %r5 = call i32 @mul32_1023(i32 %x32)
+  %e5 = sext i32 %r5 to i64
+  %5 = call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.mul32_1023, i64 %e5)
+  %r6 = call i32 @mul32_2147483647(i32 %x32)
+  %e6 = sext i32 %r6 to i64
+  %6 = call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.mul32_2147483647, i64 %e6)
+  %r7 = call i32 @mul32_m2147483648(i32 %x32)
+  %e7 = sext i32 %r7 to i64
+  %7 = call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.mul32_m2147483648, i64 %e7)
+  %r8 = call i32 @mul32_m1(i32 %x32)
+  %e8 = sext i32 %r8 to i64
+  %8 = call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.mul32_m1, i64 %e8)
+  %r9 = call i32 @mul32_1431655765(i32 %x32)
+  %e9 = sext i32 %r9 to i64
+  %9 = call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.mul32_1431655765, i64 %e9)
+  %r10 = call i32 @mul32_m100(i32 %x32)
+  %e10 = sext i32 %r10 to i64
+  %10 = call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.mul32_m100, i64 %e10)
+  %r11 = call i8 @mul8_m128(i8 %x8)
+  %e11 = sext i8 %r11 to i64
+  %11 = call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.mul8_m128, i64 %e11)
+  %r12 = call i8 @mul8_127(i8 %x8)
+  %e12 = sext i8 %r12 to i64
+  %12 = call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.mul8_127, i64 %e12)
+  %r13 = call i8 @mul8_3(i8 %x8)
+  %e13 = sext i8 %r13 to i64
+  %13 = call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.mul8_3, i64 %e13)
+  %r14 = call i8 @mul8_100(i8 %x8)
+  %e14 = sext i8 %r14 to i64
+  %14 = call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.mul8_100, i64 %e14)
+  %r15 = call i8 @mul8_m3(i8 %x8)
+  %e15 = sext i8 %r15 to i64
+  %15 = call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.mul8_m3, i64 %e15)
+  %r16 = call i64 @mul64_9223372036854775807(i64 %x64)
+  %16 = call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.mul64_9223372036854775807, i64 %r16)
+  %r17 = call i64 @mul64_1000003(i64 %x64)
+  %17 = call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.mul64_1000003, i64 %r17)
+  %r18 = call i64 @mul64_m15(i64 %x64)
+  %18 = call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.mul64_m15, i64 %r18)
+  %a = insertelement <4 x i32> undef, i32 %x32, i32 0
+  %b = insertelement <4 x i32> %a, i32 -7, i32 1
+  %c = insertelement <4 x i32> %b, i32 2147483647, i32 2
+  %v = insertelement <4 x i32> %c, i32 %x32, i32 3
+  %s = call <4 x i32> @splat(<4 x i32> %v)
+  call void @print(ptr @.splat, <4 x i32> %s)
+  %q = call <4 x i32> @pow2(<4 x i32> %v)
+  call void @print(ptr @.pow2, <4 x i32> %q)
+  %next = add i64 %i, 1
+  %done = icmp eq i64 %next, 10
+  br i1 %done, label %exit, label %loop
+
+exit:                                             ; preds = %loop
+  ret i32 0
+}
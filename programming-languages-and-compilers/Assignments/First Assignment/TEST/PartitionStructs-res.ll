@@ -0,0 +1,51 @@
+; ModuleID = 'PartitionStructs.ll'
+source_filename = "PartitionStructs.ll"
+target datalayout = "e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-i128:128-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-pc-linux-gnu"
+
+%struct.S = type { i32, i32 }
+%struct.T = type { %struct.S, [2 x i32] }
+
+@g = global %struct.S { i32 3, i32 4 }
+@fmt = private unnamed_addr constant [4 x i8] c"%d\0A\00"
+
+declare i32 @printf(ptr, ...)
+
+define %struct.S @scale(%struct.S %s) {
+  %a = extractvalue %struct.S %s, 0
+  %1 = shl i32 %a, 3
+  %t = alloca %struct.T, align 8
+  %q = getelementptr %struct.T, ptr %t, i32 0, i32 1, i32 1
+  store i32 %1, ptr %q, align 4
+  %c = load i32, ptr %q, align 4
+  %gp = getelementptr %struct.S, ptr @g, i32 0, i32 1
+  %gv = load i32, ptr %gp, align 4
+  %d = add i32 %c, %gv
+  %r = insertvalue %struct.S %s, i32 %d, 1
+  ret %struct.S %r
+}
+
+define i32 @half(%struct.S %s) {
+  %a = extractvalue %struct.S %s, 1
+  %1 = lshr i32 %a, 31
+  %2 = add i32 %a, %1
+  %3 = ashr i32 %2, 1
+  ret i32 %3
+}
+
+define %struct.S @make(i32 %x) {
+  %a = insertvalue %struct.S undef, i32 %x, 0
+  %b = insertvalue %struct.S %a, i32 %x, 1
+  ret %struct.S %b
+}
+
+define i32 @main() {
+  %s0 = load %struct.S, ptr @g, align 4
+  %s1 = call %struct.S @scale(%struct.S %s0)
+  %x = extractvalue %struct.S %s1, 1
+  %p1 = call i32 (ptr, ...) @printf(ptr @fmt, i32 %x)
+  %s2 = call %struct.S @make(i32 %x)
+  %h = call i32 @half(%struct.S %s2)
+  %p2 = call i32 (ptr, ...) @printf(ptr @fmt, i32 %h)
+  ret i32 0
+}
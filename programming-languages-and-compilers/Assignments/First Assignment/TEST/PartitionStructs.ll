@@ -0,0 +1,56 @@
+; Modalità a partizioni di localopts con struct passate e restituite per valore, usate
+; negli alloca e in una variabile globale: rileggendo le partizioni i tipi con nome
+; vengono duplicati (%struct.S.0) e devono tornare quelli del modulo.
+;   opt -load <plugin> -load-pass-plugin <plugin> -passes=localopts -localopts-threads=2 \
+;       -localopts-parallel-threshold=2 PartitionStructs.ll -S -o PartitionStructs-res.ll
+;   lli PartitionStructs.ll e lli PartitionStructs-res.ll stampano 28 e 14
+target datalayout = "e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-i128:128-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-pc-linux-gnu"
+
+%struct.S = type { i32, i32 }
+%struct.T = type { %struct.S, [2 x i32] }
+
+@g = global %struct.S { i32 3, i32 4 }
+@fmt = private unnamed_addr constant [4 x i8] c"%d\0A\00"
+
+declare i32 @printf(ptr, ...)
+
+define %struct.S @scale(%struct.S %s) {
+  %a = extractvalue %struct.S %s, 0
+  %b = mul i32 %a, 8
+  %t = alloca %struct.T
+  %q = getelementptr %struct.T, ptr %t, i32 0, i32 1, i32 1
+  store i32 %b, ptr %q
+  %c = load i32, ptr %q
+  %gp = getelementptr %struct.S, ptr @g, i32 0, i32 1
+  %gv = load i32, ptr %gp
+  %d = add i32 %c, %gv
+  %e = add i32 %d, 0
+  %r = insertvalue %struct.S %s, i32 %e, 1
+  ret %struct.S %r
+}
+
+define i32 @half(%struct.S %s) {
+  %a = extractvalue %struct.S %s, 1
+  %b = mul i32 %a, 1
+  %c = sdiv i32 %b, 2
+  ret i32 %c
+}
+
+define %struct.S @make(i32 %x) {
+  %y = add i32 %x, 0
+  %a = insertvalue %struct.S undef, i32 %y, 0
+  %b = insertvalue %struct.S %a, i32 %y, 1
+  ret %struct.S %b
+}
+
+define i32 @main() {
+  %s0 = load %struct.S, ptr @g
+  %s1 = call %struct.S @scale(%struct.S %s0)
+  %x = extractvalue %struct.S %s1, 1
+  %p1 = call i32 (ptr, ...) @printf(ptr @fmt, i32 %x)
+  %s2 = call %struct.S @make(i32 %x)
+  %h = call i32 @half(%struct.S %s2)
+  %p2 = call i32 (ptr, ...) @printf(ptr @fmt, i32 %h)
+  ret i32 0
+}
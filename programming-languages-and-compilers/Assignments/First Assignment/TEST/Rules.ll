@@ -0,0 +1,239 @@
+; Motore delle regole di LocalOptsRules.def: una funzione per regola (identità
+; algebriche, operazioni inverse e shift con nuw/nsw/exact), una catena di regole che si
+; abilitano a vicenda e il local value numbering (espressioni commutate e confronti con
+; il predicato scambiato). Dopo il pass ogni regola restituisce un operando o una costante:
+;   opt -load-pass-plugin <plugin> -passes=localopts Rules.ll -S -o Rules-res.ll
+;   lli Rules.ll e lli Rules-res.ll devono stampare le stesse righe
+target datalayout = "e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-i128:128-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-pc-linux-gnu"
+
+@xs = private constant [10 x i32] [i32 -2147483648, i32 -1000003, i32 -7, i32 -1, i32 0, i32 1, i32 7, i32 255, i32 1000003, i32 2147483647]
+@bs = private constant [10 x i32] [i32 3, i32 -2147483648, i32 2147483647, i32 -1, i32 0, i32 1, i32 12345, i32 -12345, i32 7, i32 -8]
+@.fmt = private unnamed_addr constant [14 x i8] c"%s %d %d: %d\0A\00"
+@.AddZero = private unnamed_addr constant [8 x i8] c"AddZero\00"
+@.AddSubInverse = private unnamed_addr constant [14 x i8] c"AddSubInverse\00"
+@.SubZero = private unnamed_addr constant [8 x i8] c"SubZero\00"
+@.SubSelf = private unnamed_addr constant [8 x i8] c"SubSelf\00"
+@.DoubleNeg = private unnamed_addr constant [10 x i8] c"DoubleNeg\00"
+@.SubAddInverse = private unnamed_addr constant [14 x i8] c"SubAddInverse\00"
+@.MulOne = private unnamed_addr constant [7 x i8] c"MulOne\00"
+@.MulZero = private unnamed_addr constant [8 x i8] c"MulZero\00"
+@.AndAllOnes = private unnamed_addr constant [11 x i8] c"AndAllOnes\00"
+@.AndZero = private unnamed_addr constant [8 x i8] c"AndZero\00"
+@.AndSelf = private unnamed_addr constant [8 x i8] c"AndSelf\00"
+@.OrZero = private unnamed_addr constant [7 x i8] c"OrZero\00"
+@.OrAllOnes = private unnamed_addr constant [10 x i8] c"OrAllOnes\00"
+@.OrSelf = private unnamed_addr constant [7 x i8] c"OrSelf\00"
+@.XorZero = private unnamed_addr constant [8 x i8] c"XorZero\00"
+@.XorSelf = private unnamed_addr constant [8 x i8] c"XorSelf\00"
+@.XorInverse = private unnamed_addr constant [11 x i8] c"XorInverse\00"
+@.ShiftZero = private unnamed_addr constant [10 x i8] c"ShiftZero\00"
+@.LShrShlInverse = private unnamed_addr constant [15 x i8] c"LShrShlInverse\00"
+@.AShrShlInverse = private unnamed_addr constant [15 x i8] c"AShrShlInverse\00"
+@.ShlShrInverse = private unnamed_addr constant [14 x i8] c"ShlShrInverse\00"
+@.Chain = private unnamed_addr constant [6 x i8] c"Chain\00"
+@.Redundant = private unnamed_addr constant [10 x i8] c"Redundant\00"
+
+define i32 @AddZero(i32 %x, i32 %b) {
+  %r = add i32 0, %x
+  ret i32 %r
+}
+
+define i32 @AddSubInverse(i32 %x, i32 %b) {
+  %t = sub i32 %x, %b
+  %r = add i32 %b, %t
+  ret i32 %r
+}
+
+define i32 @SubZero(i32 %x, i32 %b) {
+  %r = sub i32 %x, 0
+  ret i32 %r
+}
+
+define i32 @SubSelf(i32 %x, i32 %b) {
+  %r = sub i32 %x, %x
+  ret i32 %r
+}
+
+define i32 @DoubleNeg(i32 %x, i32 %b) {
+  %n = sub i32 0, %x
+  %r = sub i32 0, %n
+  ret i32 %r
+}
+
+define i32 @SubAddInverse(i32 %x, i32 %b) {
+  %t = add i32 %b, %x
+  %r = sub i32 %t, %b
+  ret i32 %r
+}
+
+define i32 @MulOne(i32 %x, i32 %b) {
+  %r = mul i32 1, %x
+  ret i32 %r
+}
+
+define i32 @MulZero(i32 %x, i32 %b) {
+  %r = mul i32 %x, 0
+  ret i32 %r
+}
+
+define i32 @AndAllOnes(i32 %x, i32 %b) {
+  %r = and i32 -1, %x
+  ret i32 %r
+}
+
+define i32 @AndZero(i32 %x, i32 %b) {
+  %r = and i32 %x, 0
+  ret i32 %r
+}
+
+define i32 @AndSelf(i32 %x, i32 %b) {
+  %r = and i32 %x, %x
+  ret i32 %r
+}
+
+define i32 @OrZero(i32 %x, i32 %b) {
+  %r = or i32 0, %x
+  ret i32 %r
+}
+
+define i32 @OrAllOnes(i32 %x, i32 %b) {
+  %r = or i32 %x, -1
+  ret i32 %r
+}
+
+define i32 @OrSelf(i32 %x, i32 %b) {
+  %r = or i32 %x, %x
+  ret i32 %r
+}
+
+define i32 @XorZero(i32 %x, i32 %b) {
+  %r = xor i32 %x, 0
+  ret i32 %r
+}
+
+define i32 @XorSelf(i32 %x, i32 %b) {
+  %r = xor i32 %x, %x
+  ret i32 %r
+}
+
+define i32 @XorInverse(i32 %x, i32 %b) {
+  %t = xor i32 %b, %x
+  %r = xor i32 %t, %b
+  ret i32 %r
+}
+
+define i32 @ShiftZero(i32 %x, i32 %b) {
+  %s = shl i32 %x, 0
+  %a = ashr i32 %s, 0
+  %r = lshr i32 %a, 0
+  ret i32 %r
+}
+
+define i32 @LShrShlInverse(i32 %x, i32 %b) {
+  %m = lshr i32 %x, 4
+  %s = shl nuw i32 %m, 4
+  %r = lshr i32 %s, 4
+  ret i32 %r
+}
+
+define i32 @AShrShlInverse(i32 %x, i32 %b) {
+  %m = ashr i32 %x, 4
+  %s = shl nsw i32 %m, 4
+  %r = ashr i32 %s, 4
+  ret i32 %r
+}
+
+define i32 @ShlShrInverse(i32 %x, i32 %b) {
+  %m = and i32 %x, -16
+  %s = lshr exact i32 %m, 4
+  %r = shl i32 %s, 4
+  ret i32 %r
+}
+
+define i32 @Chain(i32 %x, i32 %b) {
+  %t = add i32 %x, %b
+  %u = sub i32 %t, %b
+  %v = mul i32 %u, 1
+  %w = xor i32 %v, 0
+  %r = add i32 %w, 0
+  ret i32 %r
+}
+
+define i32 @Redundant(i32 %x, i32 %b) {
+  %s1 = add i32 %x, %b
+  %s2 = add i32 %b, %x
+  %c1 = icmp slt i32 %x, %b
+  %c2 = icmp sgt i32 %b, %x
+  %d = sub i32 %s1, %s2
+  %e = select i1 %c1, i32 %s1, i32 %d
+  %f = select i1 %c2, i32 %s2, i32 %d
+  %r = mul i32 %e, %f
+  ret i32 %r
+}
+
+declare i32 @printf(ptr, ...)
+
+define i32 @main() {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i64 [ 0, %entry ], [ %next, %loop ]
+  %px = getelementptr [10 x i32], ptr @xs, i64 0, i64 %i
+  %x = load i32, ptr %px
+  %pb = getelementptr [10 x i32], ptr @bs, i64 0, i64 %i
+  %b = load i32, ptr %pb
+  %r0 = call i32 @AddZero(i32 %x, i32 %b)
+  call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.AddZero, i32 %x, i32 %b, i32 %r0)
+  %r1 = call i32 @AddSubInverse(i32 %x, i32 %b)
+  call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.AddSubInverse, i32 %x, i32 %b, i32 %r1)
+  %r2 = call i32 @SubZero(i32 %x, i32 %b)
+  call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.SubZero, i32 %x, i32 %b, i32 %r2)
+  %r3 = call i32 @SubSelf(i32 %x, i32 %b)
+  call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.SubSelf, i32 %x, i32 %b, i32 %r3)
+  %r4 = call i32 @DoubleNeg(i32 %x, i32 %b)
+  call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.DoubleNeg, i32 %x, i32 %b, i32 %r4)
+  %r5 = call i32 @SubAddInverse(i32 %x, i32 %b)
+  call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.SubAddInverse, i32 %x, i32 %b, i32 %r5)
+  %r6 = call i32 @MulOne(i32 %x, i32 %b)
+  call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.MulOne, i32 %x, i32 %b, i32 %r6)
+  %r7 = call i32 @MulZero(i32 %x, i32 %b)
+  call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.MulZero, i32 %x, i32 %b, i32 %r7)
+  %r8 = call i32 @AndAllOnes(i32 %x, i32 %b)
+  call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.AndAllOnes, i32 %x, i32 %b, i32 %r8)
+  %r9 = call i32 @AndZero(i32 %x, i32 %b)
+  call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.AndZero, i32 %x, i32 %b, i32 %r9)
+  %r10 = call i32 @AndSelf(i32 %x, i32 %b)
+  call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.AndSelf, i32 %x, i32 %b, i32 %r10)
+  %r11 = call i32 @OrZero(i32 %x, i32 %b)
+  call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.OrZero, i32 %x, i32 %b, i32 %r11)
+  %r12 = call i32 @OrAllOnes(i32 %x, i32 %b)
+  call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.OrAllOnes, i32 %x, i32 %b, i32 %r12)
+  %r13 = call i32 @OrSelf(i32 %x, i32 %b)
+  call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.OrSelf, i32 %x, i32 %b, i32 %r13)
+  %r14 = call i32 @XorZero(i32 %x, i32 %b)
+  call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.XorZero, i32 %x, i32 %b, i32 %r14)
+  %r15 = call i32 @XorSelf(i32 %x, i32 %b)
+  call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.XorSelf, i32 %x, i32 %b, i32 %r15)
+  %r16 = call i32 @XorInverse(i32 %x, i32 %b)
+  call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.XorInverse, i32 %x, i32 %b, i32 %r16)
+  %r17 = call i32 @ShiftZero(i32 %x, i32 %b)
+  call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.ShiftZero, i32 %x, i32 %b, i32 %r17)
+  %r18 = call i32 @LShrShlInverse(i32 %x, i32 %b)
+  call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.LShrShlInverse, i32 %x, i32 %b, i32 %r18)
+  %r19 = call i32 @AShrShlInverse(i32 %x, i32 %b)
+  call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.AShrShlInverse, i32 %x, i32 %b, i32 %r19)
+  %r20 = call i32 @ShlShrInverse(i32 %x, i32 %b)
+  call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.ShlShrInverse, i32 %x, i32 %b, i32 %r20)
+  %r21 = call i32 @Chain(i32 %x, i32 %b)
+  call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.Chain, i32 %x, i32 %b, i32 %r21)
+  %r22 = call i32 @Redundant(i32 %x, i32 %b)
+  call i32 (ptr, ...) @printf(ptr @.fmt, ptr @.Redundant, i32 %x, i32 %b, i32 %r22)
+  %next = add i64 %i, 1
+  %done = icmp eq i64 %next, 10
+  br i1 %done, label %exit, label %loop
+
+exit:
+  ret i32 0
+}
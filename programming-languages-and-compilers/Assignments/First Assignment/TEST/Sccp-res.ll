@@ -0,0 +1,146 @@
+; ModuleID = 'Sccp.ll'
+source_filename = "Sccp.ll"
+target datalayout = "e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-i128:128-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-pc-linux-gnu"
+
+@.fmt = private unnamed_addr constant [11 x i8] c"%s %d: %d\0A\00"
+@.branch = private unnamed_addr constant [7 x i8] c"branch\00"
+@.loop = private unnamed_addr constant [5 x i8] c"loop\00"
+@.switch = private unnamed_addr constant [7 x i8] c"switch\00"
+@.select = private unnamed_addr constant [7 x i8] c"select\00"
+@.divzero = private unnamed_addr constant [8 x i8] c"divzero\00"
+@.overflow = private unnamed_addr constant [9 x i8] c"overflow\00"
+@.variable = private unnamed_addr constant [9 x i8] c"variable\00"
+
+define i32 @branch(i32 %n) {
+entry:
+  br label %then
+
+then:                                             ; preds = %entry
+  br label %join
+
+join:                                             ; preds = %then
+  %r = add i32 20, %n
+  ret i32 %r
+}
+
+define i32 @loop(i32 %n) {
+entry:
+  br label %header
+
+header:                                           ; preds = %latch, %entry
+  %i = phi i32 [ 0, %entry ], [ %i.next, %latch ]
+  %s = phi i32 [ 0, %entry ], [ %s.next, %latch ]
+  %done = icmp sge i32 %i, %n
+  br i1 %done, label %exit, label %body
+
+body:                                             ; preds = %header
+  br label %latch
+
+latch:                                            ; preds = %body
+  %s.next = add i32 %s, 1
+  %i.next = add i32 %i, 1
+  br label %header
+
+exit:                                             ; preds = %header
+  ret i32 %s
+}
+
+define i32 @switch(i32 %n) {
+entry:
+  br label %two
+
+two:                                              ; preds = %entry
+  br label %join
+
+join:                                             ; preds = %two
+  %r = sub i32 200, %n
+  ret i32 %r
+}
+
+define i32 @select(i32 %n) {
+entry:
+  %v = select i1 true, i32 %n, i32 0
+  %r = xor i32 %v, -2147483648
+  ret i32 %r
+}
+
+define i32 @divzero(i32 %n) {
+entry:
+  %c = icmp eq i32 %n, 0
+  br i1 %c, label %dead, label %live
+
+dead:                                             ; preds = %entry
+  %q = sdiv i32 1, 0
+  br label %join
+
+live:                                             ; preds = %entry
+  br label %join
+
+join:                                             ; preds = %live, %dead
+  %r = phi i32 [ %q, %dead ], [ 1073741824, %live ]
+  ret i32 %r
+}
+
+define i32 @overflow(i32 %n) {
+entry:
+  %r = add i32 -1, %n
+  ret i32 %r
+}
+
+define i32 @variable(i32 %n) {
+entry:
+  %c = icmp slt i32 %n, 0
+  br i1 %c, label %neg, label %pos
+
+neg:                                              ; preds = %entry
+  %a = sub i32 0, %n
+  br label %join
+
+pos:                                              ; preds = %entry
+  %0 = shl i32 %n, 2
+  %1 = sub i32 %0, %n
+  br label %join
+
+join:                                             ; preds = %pos, %neg
+  %r = phi i32 [ %a, %neg ], [ %1, %pos ]
+  ret i32 %r
+}
+
+declare i32 @printf(ptr, ...)
+
+define void @print(ptr %name, i32 %n, i32 %v) {
+  %r = call i32 (ptr, ...) @printf(ptr @.fmt, ptr %name, i32 %n, i32 %v)
+  ret void
+}
+
+define i32 @main() {
+entry:
+  br label %loop
+
+loop:                                             ; preds = %loop, %entry
+  %i = phi i32 [ -3, %entry ], [ %next, %loop ]
+  %0 = shl i32 %i, 3
+  %1 = sub i32 %0, %i
+  %r0 = call i32 @branch(i32 %1)
+  call void @print(ptr @.branch, i32 %1, i32 %r0)
+  %r1 = call i32 @loop(i32 %1)
+  call void @print(ptr @.loop, i32 %1, i32 %r1)
+  %r2 = call i32 @switch(i32 %1)
+  call void @print(ptr @.switch, i32 %1, i32 %r2)
+  %r3 = call i32 @select(i32 %1)
+  call void @print(ptr @.select, i32 %1, i32 %r3)
+  %m = or i32 %1, 1
+  %r4 = call i32 @divzero(i32 %m)
+  call void @print(ptr @.divzero, i32 %m, i32 %r4)
+  %r5 = call i32 @overflow(i32 %1)
+  call void @print(ptr @.overflow, i32 %1, i32 %r5)
+  %r6 = call i32 @variable(i32 %1)
+  call void @print(ptr @.variable, i32 %1, i32 %r6)
+  %next = add i32 %i, 1
+  %done = icmp eq i32 %next, 4
+  br i1 %done, label %exit, label %loop
+
+exit:                                             ; preds = %loop
+  ret i32 0
+}
@@ -0,0 +1,191 @@
+; Propagazione delle costanti con raggiungibilità (localsccp): condizioni che diventano
+; costanti solo ignorando i rami mai eseguiti, PHI con la stessa costante su tutti gli
+; archi eseguibili, switch e select con condizione costante, variabili di loop che non
+; cambiano mai e una divisione per zero in un blocco morto che non va ripiegata. Le
+; funzioni con argomenti variabili non devono perdere nessun ramo:
+;   opt -load-pass-plugin <plugin> -passes='function(localsccp,localopts)' Sccp.ll -S -o Sccp-res.ll
+;   lli Sccp.ll e lli Sccp-res.ll devono stampare le stesse righe
+target datalayout = "e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-i128:128-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-pc-linux-gnu"
+
+@.fmt = private unnamed_addr constant [11 x i8] c"%s %d: %d\0A\00"
+@.branch = private unnamed_addr constant [7 x i8] c"branch\00"
+@.loop = private unnamed_addr constant [5 x i8] c"loop\00"
+@.switch = private unnamed_addr constant [7 x i8] c"switch\00"
+@.select = private unnamed_addr constant [7 x i8] c"select\00"
+@.divzero = private unnamed_addr constant [8 x i8] c"divzero\00"
+@.overflow = private unnamed_addr constant [9 x i8] c"overflow\00"
+@.variable = private unnamed_addr constant [9 x i8] c"variable\00"
+
+; x=10; if(x>5) y=x*2; else y=x/0; return y+n
+define i32 @branch(i32 %n) {
+entry:
+  %x = add i32 4, 6
+  %c = icmp sgt i32 %x, 5
+  br i1 %c, label %then, label %else
+
+then:
+  %y1 = mul i32 %x, 2
+  br label %join
+
+else:
+  %y2 = sdiv i32 %x, 0
+  br label %join
+
+join:
+  %y = phi i32 [ %y1, %then ], [ %y2, %else ]
+  %r = add i32 %y, %n
+  ret i32 %r
+}
+
+; k resta 1 per tutto il loop: il ramo che lo cambierebbe non è mai eseguito
+define i32 @loop(i32 %n) {
+entry:
+  br label %header
+
+header:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %latch ]
+  %k = phi i32 [ 1, %entry ], [ %k.next, %latch ]
+  %s = phi i32 [ 0, %entry ], [ %s.next, %latch ]
+  %done = icmp sge i32 %i, %n
+  br i1 %done, label %exit, label %body
+
+body:
+  %bad = icmp ne i32 %k, 1
+  br i1 %bad, label %change, label %latch
+
+change:
+  %k2 = add i32 %k, 1
+  br label %latch
+
+latch:
+  %k.next = phi i32 [ %k, %body ], [ %k2, %change ]
+  %s.next = add i32 %s, %k.next
+  %i.next = add i32 %i, 1
+  br label %header
+
+exit:
+  %r = mul i32 %s, %k
+  ret i32 %r
+}
+
+define i32 @switch(i32 %n) {
+entry:
+  %c = and i32 7, 2
+  switch i32 %c, label %default [
+    i32 0, label %zero
+    i32 2, label %two
+  ]
+
+zero:
+  br label %join
+
+two:
+  br label %join
+
+default:
+  br label %join
+
+join:
+  %v = phi i32 [ 100, %zero ], [ 200, %two ], [ %n, %default ]
+  %r = sub i32 %v, %n
+  ret i32 %r
+}
+
+define i32 @select(i32 %n) {
+entry:
+  %c = icmp eq i32 3, 3
+  %v = select i1 %c, i32 %n, i32 0
+  %w = select i1 %c, i32 -2147483648, i32 %n
+  %r = xor i32 %v, %w
+  ret i32 %r
+}
+
+; Dopo x-x=0 la divisione per zero sta nel ramo eseguito solo con n=0 (main passa n dispari):
+; non va ripiegata né ridotta
+define i32 @divzero(i32 %n) {
+entry:
+  %z = sub i32 %n, %n
+  %c = icmp eq i32 %n, 0
+  br i1 %c, label %dead, label %live
+
+dead:
+  %q = sdiv i32 1, %z
+  br label %join
+
+live:
+  %p = sdiv i32 -2147483648, -2
+  br label %join
+
+join:
+  %r = phi i32 [ %q, %dead ], [ %p, %live ]
+  ret i32 %r
+}
+
+; Costanti ai limiti: -2^31/1, -2^31 srem 2^31-1, 2^31-1 + 1 senza flag (wrap)
+define i32 @overflow(i32 %n) {
+entry:
+  %a = sdiv i32 -2147483648, 1
+  %b = srem i32 -2147483648, 2147483647
+  %c = add i32 2147483647, 1
+  %d = add i32 %a, %b
+  %e = xor i32 %d, %c
+  %r = add i32 %e, %n
+  ret i32 %r
+}
+
+; Nessuna costante: tutti i rami restano
+define i32 @variable(i32 %n) {
+entry:
+  %c = icmp slt i32 %n, 0
+  br i1 %c, label %neg, label %pos
+
+neg:
+  %a = sub i32 0, %n
+  br label %join
+
+pos:
+  %b = mul i32 %n, 3
+  br label %join
+
+join:
+  %r = phi i32 [ %a, %neg ], [ %b, %pos ]
+  ret i32 %r
+}
+
+declare i32 @printf(ptr, ...)
+
+define void @print(ptr %name, i32 %n, i32 %v) {
+  %r = call i32 (ptr, ...) @printf(ptr @.fmt, ptr %name, i32 %n, i32 %v)
+  ret void
+}
+
+define i32 @main() {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ -3, %entry ], [ %next, %loop ]
+  %n = mul i32 %i, 7
+  %r0 = call i32 @branch(i32 %n)
+  call void @print(ptr @.branch, i32 %n, i32 %r0)
+  %r1 = call i32 @loop(i32 %n)
+  call void @print(ptr @.loop, i32 %n, i32 %r1)
+  %r2 = call i32 @switch(i32 %n)
+  call void @print(ptr @.switch, i32 %n, i32 %r2)
+  %r3 = call i32 @select(i32 %n)
+  call void @print(ptr @.select, i32 %n, i32 %r3)
+  %m = or i32 %n, 1
+  %r4 = call i32 @divzero(i32 %m)
+  call void @print(ptr @.divzero, i32 %m, i32 %r4)
+  %r5 = call i32 @overflow(i32 %n)
+  call void @print(ptr @.overflow, i32 %n, i32 %r5)
+  %r6 = call i32 @variable(i32 %n)
+  call void @print(ptr @.variable, i32 %n, i32 %r6)
+  %next = add i32 %i, 1
+  %done = icmp eq i32 %next, 4
+  br i1 %done, label %exit, label %loop
+
+exit:
+  ret i32 0
+}
@@ -1,19 +1,67 @@
 #include "llvm/Transforms/Utils/LoopFusionPass.h"
+#include "llvm/Transforms/Utils/RuntimeAliasCheck.h"
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/InstrTypes.h"
 #include "llvm/Transforms/Utils/LoopRotationUtils.h"
+#include "llvm/Transforms/Utils/BasicBlockUtils.h"
+#include "llvm/Transforms/Utils/Cloning.h"
+#include "llvm/Transforms/Utils/Local.h"
 #include "llvm/IR/PassManager.h"
 #include "llvm/IR/Dominators.h"
 #include "llvm/Analysis/PostDominators.h"
 #include "llvm/Analysis/ScalarEvolution.h"
+#include "llvm/Analysis/ScalarEvolutionExpressions.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/GenericCycleImpl.h"
 #include "llvm/Analysis/LoopInfo.h"
 #include "llvm/IR/Constants.h"
 #include "llvm/Analysis/DependenceAnalysis.h"
+#include "llvm/Analysis/DomTreeUpdater.h"
+#include "llvm/Analysis/OptimizationRemarkEmitter.h"
+#include "llvm/Analysis/TargetTransformInfo.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/Timer.h"
+#include "llvm/Pass.h"
+#include <optional>
 
 using namespace llvm;
 
+#define DEBUG_TYPE "loopfusionpass"
+
+STATISTIC(NumCandidates, "Numero di coppie di loop considerate");
+STATISTIC(NumNotAdjacent, "Numero di coppie scartate perché non adiacenti");
+STATISTIC(NumUnsupportedShape, "Numero di coppie scartate per la forma dei loop");
+STATISTIC(NumDifferentControlFlow, "Numero di coppie scartate per control flow diverso");
+STATISTIC(NumTripCountMismatch, "Numero di coppie scartate per trip count diversi");
+STATISTIC(NumCrossLoopUses, "Numero di coppie scartate per usi di valori tra i loop");
+STATISTIC(NumInverseDependency, "Numero di coppie scartate per dipendenze negative");
+STATISTIC(NumNotProfitable, "Numero di coppie scartate perché la fusione non conviene");
+STATISTIC(NumDependenceQueries, "Numero di coppie di accessi passate a DependenceAnalysis");
+STATISTIC(NumFused, "Numero di loop fusi");
+STATISTIC(NumPeeled, "Numero di iterazioni staccate per pareggiare i trip count");
+STATISTIC(NumVersioned, "Numero di coppie fuse dietro un controllo di alias a runtime");
+
+static cl::opt<unsigned> MaxPeel("loopfusionpass-max-peel", cl::init(4), cl::Hidden,
+                                 cl::desc("Iterazioni che si possono staccare dal loop più lungo per pareggiare i trip count"));
+static cl::opt<unsigned> MinReuse("loopfusionpass-min-reuse", cl::init(1), cl::Hidden,
+                                  cl::desc("Byte per iterazione che il loop2 deve riusare dal loop1 perché la fusione convenga "
+                                           "(0: si fondono tutti i loop legali)"));
+static cl::opt<unsigned> ReuseDistance("loopfusionpass-reuse-distance", cl::init(16), cl::Hidden,
+                                       cl::desc("Distanza massima in iterazioni tra due accessi agli stessi dati perché dopo la fusione siano ancora in cache"));
+static cl::opt<unsigned> VectorWidth("loopfusionpass-vector-width", cl::init(8), cl::Hidden,
+                                     cl::desc("Iterazioni eseguite insieme da un loop vettorizzato"));
+static cl::opt<bool> Versioning("loopfusionpass-versioning", cl::init(true), cl::Hidden,
+                                cl::desc("Fonde anche le coppie con dipendenze tra puntatori di cui non si conosce l'alias, "
+                                         "dietro un controllo a runtime che ricade sui loop originali"));
+
+static const char *TimerGroupName="loopfusionpass";
+static const char *TimerGroupDesc="LoopFusionPass";
+
+namespace {
+
 /*
     Controllo se il loop1 è adiacente al loop2 nel caso in cui siano guarded
     Esso lo è se il successore non loop del guard branch equivale all'header del loop2
@@ -43,12 +91,15 @@ bool guardedLoopAdjacent(Loop *loop1, Loop *loop2) {
 
 /*
     Controllo se il preheader del loop1 è adiacente al loop2
-    Se gli exit blocks del loop1 sono TUTTI uguali al preheader del loop2 allora sono adiacenti
+    Se gli exit blocks del loop1 sono TUTTI uguali al preheader del loop2 allora sono adiacenti,
+    purché tra i due loop non ci sia altro codice (il preheader contiene solo il salto)
 */
 bool notGuardedLoopAdjacent(Loop *loop1, Loop *loop2){
 
     SmallVector<BasicBlock*> BBuscita;
     loop1->getExitBlocks(BBuscita);
+    if(BBuscita.empty() || !loop2->getLoopPreheader() || loop2->getLoopPreheader()->size() != 1)
+        return false;
 
     for(auto BB : BBuscita){
         if(BB != loop2->getLoopPreheader())
@@ -68,75 +119,312 @@ bool isSameControlFlow(DominatorTree& DT, PostDominatorTree& PDT, Loop* loop1, L
 }
 
 /*
-    Ottengo il trip count dei loop
+    Differenza tra il numero di iterazioni del loop2 e quello del loop1, calcolata sui backedge-taken count di SCEV:
+    funziona anche con trip count simbolici (es. i<n in entrambi i loop, differenza 0). Vuoto se uno dei due
+    trip count non è calcolabile o se la differenza non è una costante
 */
-int getLoopTripCount(Loop *loop, ScalarEvolution &SE){
-    return SE.getSmallConstantTripCount(loop);
+std::optional<int64_t> getTripCountDifference(Loop *loop1, Loop *loop2, ScalarEvolution &SE){
+    const SCEV *count1 = SE.getBackedgeTakenCount(loop1);
+    const SCEV *count2 = SE.getBackedgeTakenCount(loop2);
+    if(isa<SCEVCouldNotCompute>(count1) || isa<SCEVCouldNotCompute>(count2))
+        return std::nullopt;
+    Type *type = SE.getWiderType(count1->getType(), count2->getType());
+    count1 = SE.getNoopOrZeroExtend(count1, type);
+    count2 = SE.getNoopOrZeroExtend(count2, type);
+    const SCEVConstant *difference = dyn_cast<SCEVConstant>(SE.getMinusSCEV(count2, count1));
+    if(!difference || difference->getAPInt().getMinSignedBits() > 64)
+        return std::nullopt;
+    return difference->getAPInt().getSExtValue();
 }
 
 /*
-    Funzione di ricerca per verificare che un BB sia presente in un insieme di BB
+    Controllo se si possono staccare le prime o le ultime count iterazioni del loop come codice in linea retta:
+    il loop deve essere innermost, con il latch che salta solo all'header, e deve iterare almeno count volte
+    (così le copie non hanno bisogno del controllo di uscita)
 */
-bool search(ArrayRef<BasicBlock*> BBs, BasicBlock *BBsearch){
-    bool found=false;
-    for(auto BB : BBs){
-        if(BB == BBsearch){
-            found=true;
-            break;
+bool canPeel(Loop *loop, unsigned count, ScalarEvolution &SE){
+    if(count > MaxPeel || !loop->isInnermost())
+        return false;
+    BranchInst *latchBranch = dyn_cast<BranchInst>(loop->getLoopLatch()->getTerminator());
+    if(!latchBranch || latchBranch->isConditional())
+        return false;
+    for(BasicBlock *BB : loop->blocks()){
+        for(Instruction &I : *BB){
+            CallBase *call = dyn_cast<CallBase>(&I);
+            if(call && (call->cannotDuplicate() || call->isConvergent()))
+                return false;
         }
     }
-    return found;
+    const SCEV *count1 = SE.getBackedgeTakenCount(loop);
+    return SE.isKnownPredicate(ICmpInst::ICMP_UGE, count1, SE.getConstant(count1->getType(), count));
 }
 
 /*
-    Funzione per ottenere i BB interni al body di un loop
+    Accesso alla memoria visto da un loop: in ogni iterazione tocca i byte [Low, High) a partire da
+    Start + Step * iterazione. Low e High contano la dimensione dell'accesso e quanto si sposta nei loop
+    interni (AddRec con passo e trip count costanti). Step è nullo se l'indirizzo non ha questa forma
 */
-SmallVector<BasicBlock*> getLoopBodyBlocks(Loop *loop){
-    SmallVector<BasicBlock*> bodyBlocks;
-    ArrayRef<BasicBlock*> BBs = loop->getBlocks();
-    SmallVector<BasicBlock*> latches;
-    loop->getLoopLatches(latches);
-    SmallVector<BasicBlock*> exitings;
-    loop->getExitingBlocks(exitings);
-    for(BasicBlock* BB : BBs){
-        if (BB == loop->getHeader() || search(latches, BB) || search(exitings, BB))
-            continue;
-        bodyBlocks.push_back(BB);
+struct AffineAccess {
+    const SCEV *Start = nullptr;
+    const SCEVConstant *Step = nullptr;
+    int64_t Low = 0;
+    int64_t High = 0;
+};
+
+/*
+    Risultati riusati lungo una catena di fusioni: la descrizione di ogni accesso per ogni loop (da ricalcolare
+    solo per i loop a cui vengono staccate le iterazioni iniziali) e le coppie di accessi che DependenceAnalysis
+    ha dimostrato indipendenti
+*/
+struct DependenceCache {
+    DenseMap<std::pair<Instruction*,Loop*>,AffineAccess> Accesses;
+    DenseMap<std::pair<Instruction*,Instruction*>,bool> Independent;
+};
+
+const AffineAccess &getAffineAccess(Instruction *I, Loop *loop, ScalarEvolution &SE, DependenceCache &cache){
+    auto found = cache.Accesses.find({I, loop});
+    if(found != cache.Accesses.end())
+        return found->second;
+    AffineAccess &access = cache.Accesses[{I, loop}];
+    Type *type = getLoadStoreType(I);
+    if(isa<ScalableVectorType>(type))
+        return access;
+    int64_t low = 0, high = I->getModule()->getDataLayout().getTypeStoreSize(type);
+
+    //i loop interni spostano l'accesso dentro una iterazione del loop: ne tengo solo l'estensione
+    const SCEV *address = SE.getSCEV(getLoadStorePointerOperand(I));
+    const SCEVAddRecExpr *rec = dyn_cast<SCEVAddRecExpr>(address);
+    for(; rec && rec->getLoop() != loop && loop->contains(rec->getLoop()); rec = dyn_cast<SCEVAddRecExpr>(address)){
+        const SCEVConstant *step = dyn_cast<SCEVConstant>(rec->getStepRecurrence(SE));
+        const SCEVConstant *count = dyn_cast<SCEVConstant>(SE.getBackedgeTakenCount(rec->getLoop()));
+        if(!rec->isAffine() || !step || !count || step->getAPInt().getMinSignedBits() > 32
+           || count->getAPInt().getActiveBits() > 31)
+            return access;
+        int64_t span = count->getAPInt().getSExtValue();
+        //se il loop interno esce solo dall'header l'ultimo valore dell'AddRec non arriva al body
+        const Loop *inner = rec->getLoop();
+        if(span > 0 && inner->getExitingBlock() == inner->getHeader() && I->getParent() != inner->getHeader())
+            span--;
+        span *= step->getAPInt().getSExtValue();
+        if(AddOverflow(span < 0 ? low : high, span, span < 0 ? low : high))
+            return access;
+        address = rec->getStart();
+    }
+    if(rec && rec->getLoop() == loop && rec->isAffine()){
+        access.Start = rec->getStart();
+        access.Step = dyn_cast<SCEVConstant>(rec->getStepRecurrence(SE));
+    }else if(SE.isLoopInvariant(address, loop)){
+        access.Start = address;
+        access.Step = cast<SCEVConstant>(SE.getConstant(SE.getEffectiveSCEVType(address->getType()), 0));
     }
-    return bodyBlocks;
+    access.Low = low;
+    access.High = high;
+    return access;
 }
 
 /*
-    Funzione per ottenere le istruzioni interne ad un BB
+    Divisioni intere arrotondate verso -infinito e verso +infinito, per divisore positivo
 */
-SmallVector<Instruction*> getInstructionsFromBlock(SmallVector<BasicBlock*> BBs){
-    SmallVector<Instruction*> instrVect;
-    for(auto BB : BBs){
-        for(auto i=BB->begin(); i != BB->end(); i++){
-            instrVect.push_back(dyn_cast<Instruction>(i));
+int64_t floorDiv(int64_t a, int64_t b){
+    return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+int64_t ceilDiv(int64_t a, int64_t b){
+    return a >= 0 ? (a + b - 1) / b : -(-a / b);
+}
+
+/*
+    Controllo se access1 all'iterazione j + k tocca gli stessi byte di access2 all'iterazione j per qualche k in
+    [minDistance, maxDistance]. Con c = Start1 - Start2 i due intervalli si sovrappongono se
+    Low2 - High1 < c + Step * k < High2 - Low1. Vuoto se uno dei due indirizzi non ha la forma di AffineAccess
+    o se la loro differenza non è una costante
+*/
+std::optional<bool> overlapsAtDistance(const AffineAccess &a1, const AffineAccess &a2, int64_t minDistance,
+                                       int64_t maxDistance, ScalarEvolution &SE){
+    if(!a1.Step || !a2.Step || a1.Step != a2.Step || a1.Start->getType() != a2.Start->getType())
+        return std::nullopt;
+    const SCEVConstant *offset = dyn_cast<SCEVConstant>(SE.getMinusSCEV(a1.Start, a2.Start));
+    if(!offset || offset->getAPInt().getMinSignedBits() > 48 || a1.Step->getAPInt().getMinSignedBits() > 48)
+        return std::nullopt;
+    int64_t c = offset->getAPInt().getSExtValue(), step = a1.Step->getAPInt().getSExtValue();
+    int64_t lower, upper;                               //Step * k deve stare in (lower, upper)
+    if(SubOverflow(a2.Low, c, lower) || SubOverflow(lower, a1.High, lower)
+       || SubOverflow(a2.High, c, upper) || SubOverflow(upper, a1.Low, upper))
+        return std::nullopt;
+    if(minDistance > maxDistance)
+        return false;
+    if(step == 0)
+        return lower < 0 && 0 < upper;
+    if(step < 0){
+        std::swap(lower, upper);
+        lower = -lower;
+        upper = -upper;
+        step = -step;
+    }
+    int64_t first = std::max(floorDiv(lower, step) + 1, minDistance);
+    int64_t last = std::min(ceilDiv(upper, step) - 1, maxDistance);
+    return first <= last;
+}
+
+/*
+    Quando la sovrapposizione non si può calcolare decide DependenceAnalysis, che può solo dimostrare che
+    gli accessi sono indipendenti
+*/
+bool mayDepend(Instruction *access1, Instruction *access2, DependenceInfo &DI, DependenceCache &cache){
+    auto pair = std::make_pair(access1, access2);
+    auto found = cache.Independent.find(pair);
+    if(found == cache.Independent.end()){
+        ++NumDependenceQueries;
+        found = cache.Independent.insert({pair, !DI.depends(access1, access2, true)}).first;
+    }
+    if(!found->second)
+        LLVM_DEBUG(dbgs()<<"Dependency found: "<<*access1<<" -> "<<*access2<<"\n");
+    return !found->second;
+}
+
+/*
+    Controllo se la coppia di accessi (access1 nel loop1, access2 nel loop2) impedisce la fusione.
+    Dopo la fusione l'iterazione i del loop1 viene eseguita insieme all'iterazione i - peeled del loop2
+    (peeled = iterazioni iniziali staccate dal loop1), prima del suo body: la fusione inverte una dipendenza
+    se access2 all'iterazione j tocca gli stessi byte di access1 all'iterazione i = j + k con k > peeled.
+    Per i loop con sottoloop il controllo riguarda le iterazioni del loop esterno: l'ordine nei loop interni
+    conta solo quando vengono fusi anche loro
+*/
+bool isFusionPreventing(Instruction *access1, Loop *loop1, Instruction *access2, Loop *loop2, unsigned peeled,
+                        DependenceInfo &DI, ScalarEvolution &SE, DependenceCache &cache){
+    const AffineAccess &a1 = getAffineAccess(access1, loop1, SE, cache);
+    const AffineAccess &a2 = getAffineAccess(access2, loop2, SE, cache);
+    std::optional<bool> overlap = overlapsAtDistance(a1, a2, (int64_t)peeled + 1, INT64_MAX, SE);
+    if(!overlap)
+        return mayDepend(access1, access2, DI, cache);
+    LLVM_DEBUG(dbgs()<<(*overlap ? "Dipendenza invertita: " : "Dipendenza rispettata: ")
+                     <<*access1<<" -> "<<*access2<<"\n");
+    return *overlap;
+}
+
+/*
+    Raccolgo gli accessi alla memoria del loop nell'ordine dei suoi blocchi (l'header per primo). Si gestiscono solo load e store: con
+    altre istruzioni che accedono alla memoria (chiamate, atomiche) restituisce false
+*/
+bool collectAccesses(Loop *loop, SmallVectorImpl<Instruction*> &accesses){
+    for(BasicBlock *BB : loop->blocks()){
+        for(Instruction &I : *BB){
+            if(!I.mayReadOrWriteMemory())
+                continue;
+            if(!isa<LoadInst>(I) && !isa<StoreInst>(I))
+                return false;
+            accesses.push_back(&I);
+        }
+    }
+    return true;
+}
+
+/*
+    Controllo se ci siano dipendenze tra il loop1 e il loop2 che la fusione invertirebbe. Si considerano solo
+    le coppie con almeno una scrittura. Se unresolved non è nullo, le coppie di cui non si conosce la distanza e
+    che DependenceAnalysis non dimostra indipendenti (tipicamente puntatori diversi che potrebbero essere in alias)
+    vengono raccolte lì invece di impedire la fusione
+*/
+bool checkDependencies(ArrayRef<Instruction*> accesses1, Loop *loop1, ArrayRef<Instruction*> accesses2, Loop *loop2,
+                       unsigned peeled, DependenceInfo &DI, ScalarEvolution &SE, DependenceCache &cache,
+                       SmallVectorImpl<std::pair<Instruction*,Instruction*>> *unresolved = nullptr){
+    for(Instruction *access2 : accesses2){
+        for(Instruction *access1 : accesses1){
+            if(isa<LoadInst>(access1) && isa<LoadInst>(access2))
+                continue;
+            if(!isFusionPreventing(access1, loop1, access2, loop2, peeled, DI, SE, cache))
+                continue;
+            if(!unresolved || overlapsAtDistance(getAffineAccess(access1, loop1, SE, cache), getAffineAccess(access2, loop2, SE, cache),
+                                                 (int64_t)peeled + 1, INT64_MAX, SE))
+                return false;
+            unresolved->push_back({access1, access2});
         }
     }
-    return instrVect;
+    return true;
+}
+
+/*
+    Controllo se nel loop c'è una dipendenza che ne impedisce la vettorizzazione: il loop vettorizzato esegue
+    ogni istruzione per VectorWidth iterazioni prima di passare alla successiva, quindi un accesso y che segue x
+    nel body non deve toccare gli stessi byte di x in una delle VectorWidth - 1 iterazioni successive
+*/
+bool hasVectorizationPreventingDependence(ArrayRef<Instruction*> accesses, Loop *loop, DependenceInfo &DI,
+                                          ScalarEvolution &SE, DependenceCache &cache){
+    for(unsigned i=0; i<accesses.size(); i++){
+        for(unsigned j=i+1; j<accesses.size(); j++){
+            Instruction *x = accesses[i], *y = accesses[j];
+            if(isa<LoadInst>(x) && isa<LoadInst>(y))
+                continue;
+            std::optional<bool> overlap = overlapsAtDistance(getAffineAccess(x, loop, SE, cache),
+                                                             getAffineAccess(y, loop, SE, cache), 1,
+                                                             (int64_t)VectorWidth - 1, SE);
+            if(overlap ? *overlap : mayDepend(x, y, DI, cache))
+                return true;
+        }
+    }
+    return false;
+}
+
+/*
+    Stima del riuso tra i due loop: byte per iterazione a cui il loop2 accede e che il loop1 tocca al più
+    ReuseDistance iterazioni prima o dopo, quindi dopo la fusione ancora in cache. Contano anche le letture
+    degli stessi dati in entrambi i loop
+*/
+uint64_t estimateReuse(ArrayRef<Instruction*> accesses1, Loop *loop1, ArrayRef<Instruction*> accesses2, Loop *loop2,
+                       ScalarEvolution &SE, DependenceCache &cache){
+    uint64_t reuse = 0;
+    for(Instruction *access2 : accesses2){
+        const AffineAccess &a2 = getAffineAccess(access2, loop2, SE, cache);
+        bool reused = any_of(accesses1, [&](Instruction *access1){
+            std::optional<bool> overlap = overlapsAtDistance(getAffineAccess(access1, loop1, SE, cache), a2,
+                                                             -(int64_t)ReuseDistance, ReuseDistance, SE);
+            return overlap && *overlap;
+        });
+        if(reused)
+            reuse += a2.High - a2.Low;
+    }
+    return reuse;
 }
 
 /*
-    Controllo se ci siano dipendenze negative tra il loop1 e loop2
-    Ci sono dipendenze negative se un'istruzione nel loop2 accede ad un dato che è stato
-    precedentemente acceduto dal loop1 in un'iterazione successiva.
-    NON GIUSTO
+    Controllo che il loop abbia la forma che editCFG sa fondere: un solo latch, diverso dall'header, e un'unica
+    uscita dall'header verso un solo exit block (il for non ruotato prodotto da clang -O0 + mem2reg)
 */
-bool checkInverseDependency(Loop *loop1, Loop *loop2, DependenceInfo &DI){
-    SmallVector<BasicBlock*> bodyBlocksLoop1 = getLoopBodyBlocks(loop1);
-    SmallVector<BasicBlock*> bodyBlocksLoop2 = getLoopBodyBlocks(loop2);
-    SmallVector<Instruction*> bodyInstrLoop1 = getInstructionsFromBlock(bodyBlocksLoop1);
-    SmallVector<Instruction*> bodyInstrLoop2 = getInstructionsFromBlock(bodyBlocksLoop2);
+bool isFusibleShape(Loop *loop){
+    BasicBlock *header = loop->getHeader();
+    if(!loop->getLoopPreheader() || !loop->getLoopLatch() || loop->getLoopLatch() == header)
+        return false;
+    if(!loop->getExitBlock() || loop->getExitingBlock() != header)
+        return false;
+    BranchInst *headerBranch = dyn_cast<BranchInst>(header->getTerminator());
+    return headerBranch && headerBranch->isConditional();
+}
 
-    for(Instruction *innerInstr : bodyInstrLoop2){
-        for(Instruction *outerInstr : bodyInstrLoop1){
-            auto dep = DI.depends(dyn_cast<Instruction>(innerInstr), dyn_cast<Instruction>(outerInstr), true);
-            if(dep){
-                outs()<<"Dependency found: "<<*innerInstr<<" -> "<<*outerInstr<<"\n";
+/*
+    Controllo che la fusione non cambi i valori visti dagli usi:
+     - il loop2 non deve usare valori del loop1, vedrebbe quelli dell'iterazione corrente invece di quelli finali
+     - dopo il loop2 si possono usare solo le PHI del suo header, che diventano PHI dell'header del loop fuso
+     - le altre istruzioni dell'header del loop2 non devono avere effetti collaterali: l'ultima esecuzione
+       dell'header, quella che esce dal loop, sparisce
+*/
+bool checkValueUses(Loop *loop1, Loop *loop2){
+    for(BasicBlock *BB : loop1->blocks()){
+        for(Instruction &I : *BB){
+            for(User *U : I.users()){
+                if(loop2->contains(cast<Instruction>(U)))
+                    return false;
+            }
+        }
+    }
+    for(BasicBlock *BB : loop2->blocks()){
+        for(Instruction &I : *BB){
+            if(BB == loop2->getHeader() && isa<PHINode>(I))
+                continue;
+            if(BB == loop2->getHeader() && !I.isTerminator() && I.mayHaveSideEffects())
                 return false;
+            for(User *U : I.users()){
+                if(!loop2->contains(cast<Instruction>(U)))
+                    return false;
             }
         }
     }
@@ -144,56 +432,493 @@ bool checkInverseDependency(Loop *loop1, Loop *loop2, DependenceInfo &DI){
 }
 
 /*
-    Funzione per invertire gli usi degli incrementatori
+    Cerco nell'header del loop1 una PHI che evolve come phi2 (stesso valore iniziale e stesso passo, secondo SCEV):
+    dopo la fusione phi2 può essere sostituita da quella
 */
-bool modifyUseInductionVarible(Loop *loop1, Loop *loop2,ScalarEvolution &SE){
-    PHINode *ivloop1 = loop1->getCanonicalInductionVariable();
-    PHINode *ivloop2 = loop2->getCanonicalInductionVariable();
-    if(ivloop1 && ivloop2){
-        ivloop2->replaceAllUsesWith(ivloop1);
-        return true;
+PHINode *getEquivalentPHI(Loop *loop1, PHINode *phi2, ScalarEvolution &SE){
+    if(!SE.isSCEVable(phi2->getType()))
+        return nullptr;
+    const SCEVAddRecExpr *rec2 = dyn_cast<SCEVAddRecExpr>(SE.getSCEV(phi2));
+    if(!rec2 || !rec2->isAffine())
+        return nullptr;
+    for(PHINode &phi1 : loop1->getHeader()->phis()){
+        if(phi1.getType() != phi2->getType())
+            continue;
+        const SCEVAddRecExpr *rec1 = dyn_cast<SCEVAddRecExpr>(SE.getSCEV(&phi1));
+        if(rec1 && rec1->isAffine() && rec1->getStart() == rec2->getStart()
+           && rec1->getStepRecurrence(SE) == rec2->getStepRecurrence(SE))
+            return &phi1;
     }
-    else
-        return false;
+    return nullptr;
 }
 
 /*
-    Funzione che edita il CFG unendo i 2 loop
+    Valori che il loop fuso tiene in un registro per tutta la sua durata: le PHI degli header (tranne quelle
+    del loop2 sostituite da una IV del loop1) e gli argomenti e le istruzioni definite prima dei loop e usate dentro
 */
-void editCFG(Loop *loop1, Loop *loop2){
-    BasicBlock *headerL2 = loop2->getHeader();
+unsigned estimateFusedPressure(Loop *loop1, Loop *loop2, ScalarEvolution &SE){
+    SmallPtrSet<Value*,16> live;
+    for(Loop *loop : {loop1, loop2}){
+        for(BasicBlock *BB : loop->blocks()){
+            for(Instruction &I : *BB){
+                if(PHINode *phi = dyn_cast<PHINode>(&I); phi && BB == loop->getHeader()){
+                    if(loop == loop1 || !getEquivalentPHI(loop1, phi, SE))
+                        live.insert(phi);
+                    continue;
+                }
+                for(Value *op : I.operands()){
+                    Instruction *def = dyn_cast<Instruction>(op);
+                    if(isa<Argument>(op) || (def && !loop1->contains(def) && !loop2->contains(def)))
+                        live.insert(op);
+                }
+            }
+        }
+    }
+    return live.size();
+}
+
+/*
+    Funzione che edita il CFG unendo i 2 loop:
+    preheader1 -> header1 -> body1 -> latch1 -> header2 -> body2 -> latch2 -> header1, header1 -> exit2
+    Le PHI dell'header del loop2 vengono sostituite dalla PHI equivalente del loop1 o spostate nell'header del loop1,
+    il preheader del loop2 diventa irraggiungibile e viene eliminato. Il loop1 resta, con i blocchi e i sottoloop
+    del loop2: LoopInfo, DominatorTree e PostDominatorTree vengono aggiornati senza ricalcolarli
+*/
+void editCFG(Loop *loop1, Loop *loop2, LoopInfo &LI, DomTreeUpdater &DTU, ScalarEvolution &SE){
+    BasicBlock *preheaderL1 = loop1->getLoopPreheader();
     BasicBlock *headerL1 = loop1->getHeader();
-    BasicBlock* latchL1 = loop1->getLoopLatch();
-    SmallVector<BasicBlock*> bodyL1 = getLoopBodyBlocks(loop1);
-    SmallVector<BasicBlock*> bodyL2 = getLoopBodyBlocks(loop2);
-    SmallVector<BasicBlock*> exitL2;
-    loop2->getExitBlocks(exitL2);
-    
-    //muovo le istruzioni del loop2 prima del latch del loop1
-    for(auto BB: bodyL2){
-        BB->moveBefore(latchL1);
+    BasicBlock *latchL1 = loop1->getLoopLatch();
+    BasicBlock *preheaderL2 = loop2->getLoopPreheader();
+    BasicBlock *headerL2 = loop2->getHeader();
+    BasicBlock *latchL2 = loop2->getLoopLatch();
+    BasicBlock *exitL2 = loop2->getExitBlock();
+    MDNode *loopID = loop1->getLoopID();
+
+    //sostituisco le IV del loop2 con quelle del loop1, le altre PHI passano nell'header del loop1
+    SmallVector<std::pair<PHINode*,PHINode*>> equivalent;
+    for(PHINode &phi2 : headerL2->phis())
+        equivalent.push_back({&phi2, getEquivalentPHI(loop1, &phi2, SE)});
+    SE.forgetLoop(loop2);
+    SE.forgetLoop(loop1);
+    for(auto [phi2, phi1] : equivalent){
+        if(phi1){
+            SmallVector<Value*> incoming(phi2->incoming_values());
+            phi2->replaceAllUsesWith(phi1);
+            phi2->eraseFromParent();
+            for(Value *V : incoming)                    //l'incremento della IV del loop2
+                RecursivelyDeleteTriviallyDeadInstructions(V);
+        }else{
+            phi2->replaceIncomingBlockWith(preheaderL2, preheaderL1);
+            phi2->moveBefore(headerL1->getFirstNonPHI());
+        }
     }
+    for(PHINode &phi1 : headerL1->phis())
+        phi1.replaceIncomingBlockWith(latchL1, latchL2);
+    for(PHINode &phi : exitL2->phis())
+        phi.replaceIncomingBlockWith(headerL2, headerL1);
 
-    //collego il primo BB del body di L2 con l'ultimo BB del body di L1
-    Instruction *terminatorL1 = bodyL1.back()->getTerminator();
-    terminatorL1->setSuccessor(0,bodyL2.front());
+    //l'uscita del loop fuso è quella del loop2, il controllo dell'header del loop2 non serve più
+    headerL1->getTerminator()->replaceSuccessorWith(preheaderL2, exitL2);
+    BranchInst *headerL2Terminator = cast<BranchInst>(headerL2->getTerminator());
+    BasicBlock *bodyL2 = headerL2Terminator->getSuccessor(headerL2Terminator->getSuccessor(0) == exitL2);
+    Value *condition = headerL2Terminator->getCondition();
+    BranchInst::Create(bodyL2, headerL2Terminator);
+    headerL2Terminator->eraseFromParent();
+    RecursivelyDeleteTriviallyDeadInstructions(condition);
 
-    //collego il latch del loop1 all'ultimo BB del body del loop2
-    Instruction *terminatorL2 = bodyL2.back()->getTerminator();
-    terminatorL2->setSuccessor(0,latchL1);
+    //concateno i body: latch1 -> header2, latch2 -> header1
+    latchL1->getTerminator()->replaceSuccessorWith(headerL1, headerL2);
+    latchL1->getTerminator()->setMetadata(LLVMContext::MD_loop, nullptr);
+    latchL2->getTerminator()->replaceSuccessorWith(headerL2, headerL1);
 
-    //collego il latch del loop2 (sia ramo true che false) all'header del loop2
-    Instruction *headerL2Terminator = headerL2->getTerminator();
-    headerL2Terminator->setSuccessor(0, loop2->getLoopLatch());
-    headerL2Terminator->setSuccessor(1, loop2->getLoopLatch());
+    DTU.applyUpdates({{DominatorTree::Delete, headerL1, preheaderL2}, {DominatorTree::Insert, headerL1, exitL2},
+                      {DominatorTree::Delete, preheaderL2, headerL2}, {DominatorTree::Delete, headerL2, exitL2},
+                      {DominatorTree::Delete, latchL1, headerL1}, {DominatorTree::Insert, latchL1, headerL2},
+                      {DominatorTree::Delete, latchL2, headerL2}, {DominatorTree::Insert, latchL2, headerL1}});
+    LI.removeBlock(preheaderL2);
+    DTU.deleteBB(preheaderL2);
 
-    //collego tutte le uscite del loop1 al BB successore dell'exit di loop2
-    Instruction *headerL1Terminator = headerL1->getTerminator();
-    for(auto BB : exitL2){
-        headerL1Terminator->setSuccessor(1, BB);
+    //sposto blocchi e sottoloop del loop2 nel loop1 ed elimino il loop2
+    SmallVector<BasicBlock*> blocksL2(loop2->blocks());
+    for(BasicBlock *BB : blocksL2){
+        loop1->addBlockEntry(BB);
+        loop2->removeBlockFromLoop(BB);
+        if(LI.getLoopFor(BB) == loop2)
+            LI.changeLoopFor(BB, loop1);
     }
+    while(!loop2->isInnermost()){
+        Loop *child = loop2->removeChildLoop(loop2->begin());
+        loop1->addChildLoop(child);
+    }
+    if(Loop *parent = loop2->getParentLoop())
+        parent->removeChildLoop(loop2);
+    else
+        LI.removeLoop(find(LI, loop2));
+    LI.destroy(loop2);
+    if(loopID)
+        loop1->setLoopID(loopID);
+
+    //il codice rimasto nel latch del loop1 (l'incremento della IV) serve solo alle PHI dell'header: lo sposto nel
+    //latch del loop fuso e unisco i blocchi rimasti vuoti, così i sottoloop dei due nidi diventano adiacenti
+    for(Instruction &I : make_early_inc_range(reverse(*latchL1))){
+        if(I.isTerminator() || isa<PHINode>(I) || I.mayHaveSideEffects() || I.mayReadFromMemory())
+            continue;
+        bool onlyLatchUses = all_of(I.users(), [&](User *U){
+            Instruction *user = cast<Instruction>(U);
+            return (isa<PHINode>(user) && user->getParent() == headerL1) || (!isa<PHINode>(user) && user->getParent() == latchL2);
+        });
+        if(onlyLatchUses)
+            I.moveBefore(&*latchL2->getFirstInsertionPt());
+    }
+    if(MergeBlockIntoPredecessor(headerL2, &DTU, &LI))
+        MergeBlockIntoPredecessor(bodyL2, &DTU, &LI);
+    DTU.flush();
+}
+
+/*
+    Clona count iterazioni del loop in linea retta prima del blocco insertBefore: in ogni copia l'header salta
+    direttamente al body e il latch all'header della copia successiva, l'ultimo latch salta a next.
+    values contiene il valore delle PHI dell'header all'ingresso della prima copia e, al ritorno, quello
+    all'uscita dell'ultima. Restituisce l'header della prima copia, in lastLatch il latch dell'ultima
+*/
+BasicBlock *cloneIterations(Loop *loop, unsigned count, DenseMap<PHINode*,Value*> &values, BasicBlock *insertBefore,
+                            BasicBlock *next, BasicBlock *&lastLatch, LoopInfo &LI,
+                            SmallVectorImpl<DominatorTree::UpdateType> &updates){
+    BasicBlock *header = loop->getHeader(), *latch = loop->getLoopLatch();
+    Function *F = header->getParent();
+    BasicBlock *first = nullptr, *previousHeader = nullptr;
+    lastLatch = nullptr;
+    SmallVector<BasicBlock*> clones;
+    for(unsigned k=0; k<count; k++){
+        ValueToValueMapTy VMap;
+        SmallVector<BasicBlock*> iteration;
+        for(BasicBlock *BB : loop->blocks()){
+            BasicBlock *clone = CloneBasicBlock(BB, VMap, ".peel"+Twine(k), F);
+            clone->moveBefore(insertBefore);
+            VMap[BB] = clone;
+            iteration.push_back(clone);
+            if(Loop *parent = loop->getParentLoop())
+                parent->addBasicBlockToLoop(clone, LI);
+        }
+        BasicBlock *headerClone = cast<BasicBlock>(VMap[header]);
+        SmallVector<PHINode*> phiClones;
+        for(PHINode &phi : header->phis()){
+            phiClones.push_back(cast<PHINode>(VMap[&phi]));
+            VMap[&phi] = values[&phi];
+        }
+        remapInstructionsInBlocks(iteration, VMap);
+        for(PHINode *phi : phiClones)
+            phi->eraseFromParent();
+        for(PHINode &phi : header->phis()){
+            Value *V = phi.getIncomingValueForBlock(latch);
+            values[&phi] = VMap.count(V) ? (Value*)VMap[V] : V;
+        }
+
+        //l'iterazione non esce dal loop: l'header clonato salta direttamente al body
+        BranchInst *headerBranch = cast<BranchInst>(headerClone->getTerminator());
+        Value *condition = headerBranch->getCondition();
+        BranchInst::Create(headerBranch->getSuccessor(loop->contains(header->getTerminator()->getSuccessor(0)) ? 0 : 1),
+                           headerBranch);
+        headerBranch->eraseFromParent();
+        RecursivelyDeleteTriviallyDeadInstructions(condition);
+
+        if(lastLatch)
+            lastLatch->getTerminator()->replaceSuccessorWith(previousHeader, headerClone);
+        lastLatch = cast<BasicBlock>(VMap[latch]);
+        lastLatch->getTerminator()->setMetadata(LLVMContext::MD_loop, nullptr);
+        previousHeader = headerClone;
+        if(!first)
+            first = headerClone;
+        clones.append(iteration.begin(), iteration.end());
+    }
+    lastLatch->getTerminator()->replaceSuccessorWith(previousHeader, next);
+    for(BasicBlock *BB : clones){
+        for(BasicBlock *succ : successors(BB))
+            updates.push_back({DominatorTree::Insert, BB, succ});
+    }
+    return first;
+}
+
+/*
+    Stacca le prime count iterazioni del loop e le esegue prima del loop, che parte dai valori che
+    le copie lasciano nelle PHI. L'ultimo latch clonato diventa il nuovo preheader
+*/
+void peelPrologue(Loop *loop, unsigned count, LoopInfo &LI, DomTreeUpdater &DTU, ScalarEvolution &SE){
+    BasicBlock *preheader = loop->getLoopPreheader(), *header = loop->getHeader();
+    DenseMap<PHINode*,Value*> values;
+    for(PHINode &phi : header->phis())
+        values[&phi] = phi.getIncomingValueForBlock(preheader);
+    SE.forgetLoop(loop);
+
+    SmallVector<DominatorTree::UpdateType> updates;
+    BasicBlock *lastLatch;
+    BasicBlock *first = cloneIterations(loop, count, values, header, header, lastLatch, LI, updates);
+    preheader->getTerminator()->replaceSuccessorWith(header, first);
+    for(PHINode &phi : header->phis()){
+        int i = phi.getBasicBlockIndex(preheader);
+        phi.setIncomingBlock(i, lastLatch);
+        phi.setIncomingValue(i, values[&phi]);
+    }
+    updates.push_back({DominatorTree::Delete, preheader, header});
+    updates.push_back({DominatorTree::Insert, preheader, first});
+    DTU.applyUpdates(updates);
+    DTU.flush();
 }
 
+/*
+    Aggiunge dopo l'uscita del loop count iterazioni in linea retta, che partono dai valori delle PHI
+    all'uscita; gli usi delle PHI dopo il loop vedono i valori lasciati dall'ultima copia.
+    Da solo il loop eseguirebbe count iterazioni di troppo: serve solo prima di editCFG, che toglie
+    il controllo di uscita del loop2 e lascia quello del loop1, più corto di count iterazioni
+*/
+void peelEpilogue(Loop *loop, unsigned count, LoopInfo &LI, DomTreeUpdater &DTU, ScalarEvolution &SE){
+    BasicBlock *header = loop->getHeader(), *exit = loop->getExitBlock();
+    DenseMap<PHINode*,Value*> values;
+    for(PHINode &phi : header->phis())
+        values[&phi] = &phi;
+    SE.forgetLoop(loop);
+
+    SmallVector<DominatorTree::UpdateType> updates;
+    BasicBlock *lastLatch;
+    BasicBlock *first = cloneIterations(loop, count, values, exit, exit, lastLatch, LI, updates);
+    header->getTerminator()->replaceSuccessorWith(exit, first);
+    for(PHINode &phi : exit->phis())
+        phi.replaceIncomingBlockWith(header, lastLatch);
+    DominatorTree &DT = DTU.getDomTree();                  //non ancora aggiornato: le copie non ci sono
+    for(PHINode &phi : header->phis()){
+        phi.replaceUsesWithIf(values[&phi], [&](Use &U){
+            BasicBlock *userBB = cast<Instruction>(U.getUser())->getParent();
+            return DT.getNode(userBB) && !loop->contains(userBB) && DT.dominates(exit, userBB);
+        });
+    }
+    updates.push_back({DominatorTree::Delete, header, exit});
+    updates.push_back({DominatorTree::Insert, header, first});
+    DTU.applyUpdates(updates);
+    DTU.flush();
+}
+
+/*
+    Remark per una coppia di loop scartata, sull'header del secondo loop
+*/
+void remarkMissed(OptimizationRemarkEmitter &ORE, StringRef name, Loop *loop2, StringRef msg){
+    ORE.emit([&](){
+        return OptimizationRemarkMissed(DEBUG_TYPE, name, loop2->getStartLoc(), loop2->getHeader())<<msg;
+    });
+}
+
+/*
+    Analisi usate (e aggiornate) dalla fusione
+*/
+struct FusionAnalyses {
+    LoopInfo &LI;
+    DominatorTree &DT;
+    PostDominatorTree &PDT;
+    ScalarEvolution &SE;
+    DependenceInfo &DI;
+    OptimizationRemarkEmitter &ORE;
+    TargetTransformInfo &TTI;
+    DomTreeUpdater &DTU;
+    DependenceCache &Dependences;
+};
+
+/*
+    Fonde i loop fratelli (stesso parent) in ordine di programma: ogni loop viene fuso nel precedente (che a sua
+    volta può essere il risultato di fusioni) finché la coppia è legale, altrimenti inizia una nuova catena.
+    Le analisi sono aggiornate dopo ogni fusione, quindi i controlli sulla coppia successiva vedono il loop già
+    fuso. In survivors restano i loop non eliminati, nello stesso ordine
+*/
+bool fuseSiblings(ArrayRef<Loop*> siblings, SmallVectorImpl<Loop*> &survivors, FusionAnalyses &A){
+    LoopInfo &loops = A.LI;
+    DominatorTree &DT = A.DT;
+    PostDominatorTree &PDT = A.PDT;
+    ScalarEvolution &SE = A.SE;
+    DependenceInfo &DI = A.DI;
+    OptimizationRemarkEmitter &ORE = A.ORE;
+    TargetTransformInfo &TTI = A.TTI;
+    DomTreeUpdater &DTU = A.DTU;
+    DependenceCache &dependences = A.Dependences;
+    SmallPtrSet<Loop*,8> fused;
+
+    Loop *chain = nullptr;                              //loop in cui fondere il successivo
+    unsigned chainLength = 0;
+    bool changed = false;
+    for(Loop *next : siblings){
+        Loop *loop1 = chain, *loop2 = next;
+        unsigned length = chainLength;
+        std::optional<int64_t> difference;
+        SmallVector<Instruction*> accesses1, accesses2;
+        SmallVector<std::pair<Instruction*,Instruction*>> unresolved;
+        std::optional<RuntimeAliasCheck> aliasCheck;    //se la fusione vale solo quando i puntatori non si sovrappongono
+        chain = next;                                   //se la coppia viene scartata la catena riparte da loop2
+        chainLength = 1;
+        if(!loop1)
+            continue;
+        ++NumCandidates;
+
+        {
+            NamedRegionTimer T("legality", "Adiacenza, control flow e trip count", TimerGroupName, TimerGroupDesc, TimePassesIsEnabled);
+            if(loop1->isGuarded()){
+                LLVM_DEBUG(dbgs()<<"Loop 1 guarded\n");
+                if(!guardedLoopAdjacent(loop1, loop2)){
+                    remarkMissed(ORE, "NotAdjacent", loop2, "Loop 1 e Loop 2 non adiacenti");
+                    ++NumNotAdjacent;
+                    continue;
+                }
+            }else{
+                LLVM_DEBUG(dbgs()<<"Loop 1 not guarded\n");
+                if(!notGuardedLoopAdjacent(loop1, loop2)){
+                    remarkMissed(ORE, "NotAdjacent", loop2, "Loop 1 e Loop 2 non adiacenti");
+                    ++NumNotAdjacent;
+                    continue;
+                }
+            }
+
+            if(!isFusibleShape(loop1) || !isFusibleShape(loop2)){
+                remarkMissed(ORE, "UnsupportedShape", loop2, "Loop 1 o Loop 2 non hanno un solo latch e l'uscita nell'header");
+                ++NumUnsupportedShape;
+                continue;
+            }
+
+            if(!isSameControlFlow(DT,PDT,loop1,loop2)){
+                remarkMissed(ORE, "DifferentControlFlow", loop2, "Loop 1 e Loop 2 non sono equivalenti a livello di control flow");
+                ++NumDifferentControlFlow;
+                continue;
+            }
+
+            //se un loop itera poche volte più dell'altro, le iterazioni in più vengono staccate
+            difference = getTripCountDifference(loop1, loop2, SE);
+            if(!difference || (*difference > 0 && !canPeel(loop2, *difference, SE))
+               || (*difference < 0 && !canPeel(loop1, -*difference, SE))){
+                remarkMissed(ORE, "TripCountMismatch", loop2, "Loop 1 e Loop 2 non iterano lo stesso numero di volte");
+                ++NumTripCountMismatch;
+                continue;
+            }
+
+            if(!checkValueUses(loop1, loop2)){
+                remarkMissed(ORE, "CrossLoopUses", loop2, "Loop 2 usa valori di Loop 1 o valori di Loop 2 sono usati dopo il loop");
+                ++NumCrossLoopUses;
+                continue;
+            }
+        }
+
+        {
+            NamedRegionTimer T("dependence", "Controllo delle dipendenze", TimerGroupName, TimerGroupDesc, TimePassesIsEnabled);
+            unsigned peeled = *difference < 0 ? -*difference : 0;
+            bool legal = collectAccesses(loop1, accesses1) && collectAccesses(loop2, accesses2)
+                         && checkDependencies(accesses1, loop1, accesses2, loop2, peeled, DI, SE, dependences,
+                                              Versioning ? &unresolved : nullptr);
+            //le dipendenze rimaste sono tra puntatori con basi diverse: la coppia si fonde dietro un controllo a
+            //runtime che gli intervalli toccati dai due loop siano disgiunti
+            if(legal && !unresolved.empty()){
+                aliasCheck.emplace(ArrayRef<Loop*>({loop1, loop2}), SE, DT);
+                legal = !loop1->isGuarded() && !RuntimeAliasCheck::isDisabled(loop1) && !RuntimeAliasCheck::isDisabled(loop2)
+                        && all_of(unresolved, [&](auto &pair){ return aliasCheck->addChecks(pair.first, pair.second); });
+            }
+            if(!legal){
+                remarkMissed(ORE, "InverseDependency", loop2, "Loop 1 e Loop 2 soffrono di dipendenza inversa");
+                ++NumInverseDependency;
+                continue;
+            }
+        }
+
+        //la fusione conviene se il loop2 riusa dati del loop1 ancora in cache e, tra loop innermost, se il loop
+        //fuso non ha bisogno di più registri di quelli disponibili e non perde la vettorizzazione di uno dei due
+        if(MinReuse > 0){
+            NamedRegionTimer T("profitability", "Modello di convenienza", TimerGroupName, TimerGroupDesc, TimePassesIsEnabled);
+            uint64_t reuse = estimateReuse(accesses1, loop1, accesses2, loop2, SE, dependences);
+            if(reuse < MinReuse){
+                ORE.emit([&](){
+                    return OptimizationRemarkMissed(DEBUG_TYPE, "NotProfitable", loop2->getStartLoc(), loop2->getHeader())
+                           <<"Loop 2 riusa "<<ore::NV("Reuse", reuse)<<" byte per iterazione dal Loop 1: la fusione non conviene";
+                });
+                ++NumNotProfitable;
+                continue;
+            }
+            if(loop1->isInnermost() && loop2->isInnermost()){
+                unsigned pressure = estimateFusedPressure(loop1, loop2, SE);
+                unsigned registers = TTI.getNumberOfRegisters(TTI.getRegisterClassForType(false));
+                if(pressure > registers){
+                    ORE.emit([&](){
+                        return OptimizationRemarkMissed(DEBUG_TYPE, "RegisterPressure", loop2->getStartLoc(), loop2->getHeader())
+                               <<"Il loop fuso terrebbe vivi "<<ore::NV("Values", pressure)<<" valori con "
+                               <<ore::NV("Registers", registers)<<" registri";
+                    });
+                    ++NumNotProfitable;
+                    continue;
+                }
+                bool vectorizable1 = !hasVectorizationPreventingDependence(accesses1, loop1, DI, SE, dependences);
+                bool vectorizable2 = !hasVectorizationPreventingDependence(accesses2, loop2, DI, SE, dependences);
+                if(vectorizable1 != vectorizable2){
+                    remarkMissed(ORE, "BlocksVectorization", loop2, vectorizable1 ? "La fusione impedirebbe la vettorizzazione di Loop 1"
+                                                                                 : "La fusione impedirebbe la vettorizzazione di Loop 2");
+                    ++NumNotProfitable;
+                    continue;
+                }
+            }
+        }
+
+        NamedRegionTimer T("fusion", "Fusione dei loop", TimerGroupName, TimerGroupDesc, TimePassesIsEnabled);
+        //si fondono i loop originali, eseguiti se il controllo passa: le copie restano separate
+        if(aliasCheck){
+            if(aliasCheck->versionLoops(loops, DTU).empty()){
+                remarkMissed(ORE, "InverseDependency", loop2, "Loop 1 e Loop 2 soffrono di dipendenza inversa");
+                ++NumInverseDependency;
+                continue;
+            }
+            ORE.emit([&](){
+                return OptimizationRemark(DEBUG_TYPE, "Versioned", loop1->getStartLoc(), loop1->getHeader())
+                       <<"Loop 1 e Loop 2 duplicati dietro un controllo a runtime su "
+                       <<ore::NV("NumChecks", aliasCheck->getNumChecks())<<" coppie di puntatori";
+            });
+            ++NumVersioned;
+        }
+        chain = loop1;
+        chainLength = length+1;
+        ORE.emit([&](){
+            return OptimizationRemark(DEBUG_TYPE, "Fused", loop1->getStartLoc(), loop1->getHeader())
+                   <<"Loop 1 e Loop 2 fusi ("<<ore::NV("ChainLength", chainLength)<<" loop nella catena)";
+        });
+        ++NumFused;
+        if(*difference != 0){
+            Loop *longer = *difference > 0 ? loop2 : loop1;
+            unsigned count = std::abs(*difference);
+            ORE.emit([&](){
+                return OptimizationRemark(DEBUG_TYPE, "Peeled", longer->getStartLoc(), longer->getHeader())
+                       <<"Staccate "<<ore::NV("Count", count)<<(longer == loop1 ? " iterazioni iniziali" : " iterazioni finali")
+                       <<" per pareggiare i trip count";
+            });
+            NumPeeled += count;
+            if(longer == loop1){
+                SmallVector<std::pair<Instruction*,Loop*>> stale;   //gli indirizzi ora partono dall'iterazione count
+                for(auto &access : dependences.Accesses){
+                    if(loop1->contains(access.first.first))
+                        stale.push_back(access.first);
+                }
+                for(auto &key : stale)
+                    dependences.Accesses.erase(key);
+                peelPrologue(loop1, count, loops, DTU, SE);
+            }
+            else
+                peelEpilogue(loop2, count, loops, DTU, SE);
+        }
+        editCFG(loop1, loop2, loops, DTU, SE);
+        fused.insert(loop2);
+        changed = true;
+    }
+    for(Loop *loop : siblings){
+        if(!fused.count(loop))
+            survivors.push_back(loop);
+    }
+    return changed;
+}
+
+}
+
+/*
+    Visito l'albero dei loop dall'esterno: prima si fondono i loop di primo livello, poi i sottoloop di ogni loop
+    rimasto. Fondere due nidi unisce i loro sottoloop sotto lo stesso loop esterno, uno dopo l'altro, così al
+    livello successivo si fondono anche loro (nidi con gli stessi trip count livello per livello)
+*/
 PreservedAnalyses LoopFusionPass::run(Function &F,FunctionAnalysisManager &AM){
 
     LoopInfo &loops = AM.getResult<LoopAnalysis>(F);
@@ -201,53 +926,335 @@ PreservedAnalyses LoopFusionPass::run(Function &F,FunctionAnalysisManager &AM){
     PostDominatorTree &PDT = AM.getResult<PostDominatorTreeAnalysis>(F);
     ScalarEvolution &SE =AM.getResult<ScalarEvolutionAnalysis>(F);
     DependenceInfo &DI = AM.getResult<DependenceAnalysis>(F);
+    OptimizationRemarkEmitter &ORE = AM.getResult<OptimizationRemarkEmitterAnalysis>(F);
+    TargetTransformInfo &TTI = AM.getResult<TargetIRAnalysis>(F);
+    DomTreeUpdater DTU(DT, PDT, DomTreeUpdater::UpdateStrategy::Lazy);
+    DependenceCache dependences;
+    FusionAnalyses A{loops, DT, PDT, SE, DI, ORE, TTI, DTU, dependences};
 
-    for(auto L = loops.rbegin(); L != loops.rend(); L++){
-        
-        //ottengo loop2
-        auto Lnext = L;
-        Lnext++;
-        if(Lnext == loops.rend()){
-            continue;
+    //LoopInfo tiene i loop di primo livello in ordine inverso, i sottoloop in ordine di programma
+    SmallVector<SmallVector<Loop*>> worklist;
+    worklist.push_back(SmallVector<Loop*>(loops.rbegin(), loops.rend()));
+    bool changed = false;
+    while(!worklist.empty()){
+        SmallVector<Loop*> siblings = worklist.pop_back_val();
+        SmallVector<Loop*> survivors;
+        changed |= fuseSiblings(siblings, survivors, A);
+        for(Loop *loop : survivors){
+            if(!loop->isInnermost())
+                worklist.push_back(SmallVector<Loop*>(loop->begin(), loop->end()));
         }
+    }
+    if(!changed)
+        return PreservedAnalyses::all();
 
-        if((*L)->isGuarded()){
-            outs()<<"Loop 1 guarded\n";
-            if(!guardedLoopAdjacent(*L, *(Lnext))){
-                outs()<<"Loop 1 e Loop 2 non adiacenti\n";
-                continue;
-            }else{
-                outs()<<"Loop 1 e Loop 2 adiacenti\n";
-            }
-        }else{
-            outs()<<"Loop 1 not guarded\n";
-            if(!notGuardedLoopAdjacent(*L, *(Lnext))){
-                outs()<<"Loop 1 e Loop 2 non adiacenti\n";
-                continue;
-            }else{
-                outs()<<"Loop 1 e Loop 2 adiacenti\n";
+    PreservedAnalyses PA;
+    PA.preserve<LoopAnalysis>();
+    PA.preserve<DominatorTreeAnalysis>();
+    PA.preserve<PostDominatorTreeAnalysis>();
+    PA.preserve<ScalarEvolutionAnalysis>();
+    return PA;
+}
+
+#undef DEBUG_TYPE
+#define DEBUG_TYPE "loopdistributionpass"
+
+STATISTIC(NumDistributionCandidates, "Numero di loop considerati per la distribuzione");
+STATISTIC(NumDistributed, "Numero di loop distribuiti");
+STATISTIC(NumDistributedLoops, "Numero di loop prodotti dalla distribuzione");
+
+namespace {
+
+/*
+    Parte di un loop da distribuire: le radici che calcola (store e valori usati dopo il loop), gli accessi alla
+    memoria da cui dipendono, in ordine di programma, e se tra questi c'è una dipendenza che impedisce la
+    vettorizzazione
+*/
+struct LoopPartition {
+    SmallVector<Instruction*> Roots;
+    SmallVector<Instruction*> Accesses;
+    bool Cyclic = false;
+};
+
+/*
+    Istruzioni del loop in ordine di programma, se ha la forma che la distribuzione gestisce: quella di
+    isFusibleShape, senza sottoloop, con il body in linea retta dall'header al latch e solo load e store semplici
+*/
+bool getStraightLineBody(Loop *loop, SmallVectorImpl<Instruction*> &order){
+    if(!loop->isInnermost() || !isFusibleShape(loop))
+        return false;
+    BasicBlock *header = loop->getHeader();
+    BranchInst *headerBranch = cast<BranchInst>(header->getTerminator());
+    SmallVector<BasicBlock*> blocks{header};
+    BasicBlock *BB = headerBranch->getSuccessor(loop->contains(headerBranch->getSuccessor(0)) ? 0 : 1);
+    while(BB != header){
+        if(!BB || blocks.size() == loop->getNumBlocks())
+            return false;
+        blocks.push_back(BB);
+        BB = BB->getSingleSuccessor();
+    }
+    if(blocks.size() != loop->getNumBlocks())
+        return false;
+    for(BasicBlock *block : blocks){
+        for(Instruction &I : *block){
+            if(I.mayReadOrWriteMemory()){
+                LoadInst *load = dyn_cast<LoadInst>(&I);
+                StoreInst *store = dyn_cast<StoreInst>(&I);
+                if(!(load && load->isSimple()) && !(store && store->isSimple()))
+                    return false;
             }
+            order.push_back(&I);
         }
+    }
+    return true;
+}
+
+/*
+    Accessi alla memoria da cui dipende root dentro il loop (root compresa), risalendo gli operandi e le PHI
+*/
+void collectSlice(Instruction *root, Loop *loop, SmallPtrSetImpl<Instruction*> &accesses){
+    SmallVector<Instruction*> worklist{root};
+    SmallPtrSet<Instruction*,32> visited{root};
+    while(!worklist.empty()){
+        Instruction *I = worklist.pop_back_val();
+        if(I->mayReadOrWriteMemory())
+            accesses.insert(I);
+        for(Value *op : I->operands()){
+            Instruction *def = dyn_cast<Instruction>(op);
+            if(def && loop->contains(def) && visited.insert(def).second)
+                worklist.push_back(def);
+        }
+    }
+}
+
+/*
+    Remark per un loop che non viene distribuito
+*/
+void remarkNotDistributed(OptimizationRemarkEmitter &ORE, StringRef name, Loop *loop, StringRef msg){
+    ORE.emit([&](){
+        return OptimizationRemarkMissed(DEBUG_TYPE, name, loop->getStartLoc(), loop->getHeader())<<msg;
+    });
+}
+
+/*
+    Divide le radici del loop in parti, ognuna con le istruzioni che le servono, da eseguire in loop separati
+    uno dopo l'altro:
+     - si parte da una parte per ogni store e per ogni valore usato dopo il loop che legge la memoria, ordinate
+       secondo il loro ultimo accesso; i valori che non leggono la memoria vanno nell'ultima parte
+     - la distribuzione esegue tutte le iterazioni della parte a prima di quelle della parte b > a: se un accesso
+       y di b viene prima di un accesso x di a che tocca gli stessi byte (in un'iterazione precedente, o nella
+       stessa se y lo precede nel body) le parti da a a b vengono unite
+     - le parti adiacenti entrambe vettorizzabili o entrambe no vengono unite, così la distribuzione separa solo
+       le dipendenze che impediscono la vettorizzazione e non perde il riuso tra le altre
+    Restituisce le parti in ordine di esecuzione (vuoto se non conviene distribuire)
+*/
+SmallVector<LoopPartition> partitionLoop(Loop *loop, ArrayRef<Instruction*> order, DependenceInfo &DI, ScalarEvolution &SE,
+                                     OptimizationRemarkEmitter &ORE){
+    DenseMap<Instruction*,unsigned> position;
+    for(unsigned i=0; i<order.size(); i++)
+        position[order[i]] = i;
+    auto byPosition = [&](Instruction *a, Instruction *b){ return position[a] < position[b]; };
 
-        if(isSameControlFlow(DT,PDT,*L,*Lnext))
-            outs()<<"Loop 1 e Loop 2 sono equivalenti a livello di control flow\n";
-        else 
+    //gli accessi che decidono l'uscita dal loop servono a tutte le parti
+    SmallPtrSet<Instruction*,8> control;
+    collectSlice(loop->getHeader()->getTerminator(), loop, control);
+    SmallVector<LoopPartition> partitions;
+    SmallVector<Instruction*> scalarRoots;
+    for(Instruction *I : order){
+        bool liveOut = !I->isTerminator() && any_of(I->users(), [&](User *U){
+            return !loop->contains(cast<Instruction>(U));
+        });
+        if(!isa<StoreInst>(I) && !liveOut)
             continue;
-        
-        if(getLoopTripCount(*L,SE) == getLoopTripCount(*Lnext,SE))
-            outs()<<"Loop 1 e Loop 2 iterano lo stesso numero di volte\n";
-        else 
+        SmallPtrSet<Instruction*,16> slice(control.begin(), control.end());
+        unsigned controlAccesses = slice.size();
+        collectSlice(I, loop, slice);
+        if(!isa<StoreInst>(I) && slice.size() == controlAccesses){
+            scalarRoots.push_back(I);
             continue;
+        }
+        LoopPartition &partition = partitions.emplace_back();
+        partition.Roots.push_back(I);
+        partition.Accesses.append(slice.begin(), slice.end());
+        sort(partition.Accesses, byPosition);
+    }
+    if(partitions.size() < 2)
+        return {};
+    //ogni parte parte dal suo ultimo accesso: le PHI usate dopo il loop si mettono vicino a ciò che leggono
+    std::stable_sort(partitions.begin(), partitions.end(), [&](const LoopPartition &a, const LoopPartition &b){
+        return position[a.Accesses.back()] < position[b.Accesses.back()];
+    });
+
+    auto merge = [&](unsigned a, unsigned b){
+        LoopPartition &into = partitions[a];
+        for(unsigned k=a+1; k<=b; k++){
+            into.Roots.append(partitions[k].Roots);
+            into.Accesses.append(partitions[k].Accesses);
+            into.Cyclic |= partitions[k].Cyclic;
+        }
+        sort(into.Accesses, byPosition);
+        into.Accesses.erase(std::unique(into.Accesses.begin(), into.Accesses.end()), into.Accesses.end());
+        partitions.erase(partitions.begin()+a+1, partitions.begin()+b+1);
+    };
+    DependenceCache cache;
+    auto mustFollow = [&](LoopPartition &pa, LoopPartition &pb){
+        for(Instruction *x : pa.Accesses){
+            for(Instruction *y : pb.Accesses){
+                if(x == y || (isa<LoadInst>(x) && isa<LoadInst>(y)))
+                    continue;
+                std::optional<bool> overlap = overlapsAtDistance(getAffineAccess(x, loop, SE, cache),
+                                                                 getAffineAccess(y, loop, SE, cache),
+                                                                 position[y] < position[x] ? 0 : 1, INT64_MAX, SE);
+                if(overlap ? *overlap : mayDepend(x, y, DI, cache))
+                    return true;
+            }
+        }
+        return false;
+    };
+    for(bool merged = true; merged;){
+        merged = false;
+        for(unsigned a=0; a<partitions.size() && !merged; a++){
+            for(unsigned b=a+1; b<partitions.size() && !merged; b++){
+                if(mustFollow(partitions[a], partitions[b])){
+                    merge(a, b);
+                    merged = true;
+                }
+            }
+        }
+    }
+    if(partitions.size() < 2){
+        remarkNotDistributed(ORE, "Dependences", loop, "Le dipendenze tra le store non permettono di distribuire il loop");
+        return {};
+    }
 
-        getLoopBodyBlocks(*L);
+    for(LoopPartition &partition : partitions)
+        partition.Cyclic = hasVectorizationPreventingDependence(partition.Accesses, loop, DI, SE, cache);
+    for(unsigned a=0; a+1<partitions.size();){
+        if(partitions[a].Cyclic == partitions[a+1].Cyclic)
+            merge(a, a+1);
+        else
+            a++;
+    }
+    if(partitions.size() < 2){
+        remarkNotDistributed(ORE, "NotProfitable", loop, partitions[0].Cyclic ? "Nessuna parte del loop è vettorizzabile"
+                                                                              : "Il loop è già vettorizzabile");
+        return {};
+    }
+    partitions.back().Roots.append(scalarRoots);
+    return partitions;
+}
 
-        if(!checkInverseDependency(*L, *Lnext, DI)){
-            outs()<<"Loop 1 e Loop 2 soffrono di dipendenza inversa\n";
-            continue;
+/*
+    Esegue la distribuzione: le prime parti sono copie del loop (cloneLoopWithPreheader) messe prima del loop
+    originale, che calcola l'ultima. Ogni copia esce nel preheader della successiva; in ogni loop restano solo
+    le store della sua parte e le istruzioni che servono a calcolarle, il resto viene eliminato come codice
+    morto. Gli usi dopo il loop dei valori calcolati da una copia passano alla copia
+*/
+void distributeLoop(Loop *loop, MutableArrayRef<LoopPartition> partitions, LoopInfo &LI, DominatorTree &DT,
+                    ScalarEvolution &SE){
+    BasicBlock *preheader = loop->getLoopPreheader();
+    if(!preheader->getSinglePredecessor() || &preheader->front() != preheader->getTerminator())
+        preheader = SplitBlock(preheader, preheader->getTerminator(), &DT, &LI);
+    BasicBlock *pred = preheader->getSinglePredecessor();
+    BasicBlock *exit = loop->getExitBlock();
+    MDNode *loopID = loop->getLoopID();
+    SE.forgetLoop(loop);
+
+    unsigned n = partitions.size();
+    std::vector<std::unique_ptr<ValueToValueMapTy>> maps(n);
+    SmallVector<Loop*> copies(n, loop);
+    BasicBlock *top = preheader;
+    for(int p = n-2; p >= 0; p--){
+        maps[p] = std::make_unique<ValueToValueMapTy>();
+        SmallVector<BasicBlock*> blocks;
+        copies[p] = cloneLoopWithPreheader(top, pred, loop, *maps[p], ".dist"+Twine(p), &LI, &DT, blocks);
+        (*maps[p])[exit] = top;
+        remapInstructionsInBlocks(blocks, *maps[p]);
+        if(loopID){                                     //ogni copia ha il suo loop ID, con le stesse proprietà
+            SmallVector<Metadata*> ops{nullptr};
+            for(const MDOperand &op : drop_begin(loopID->operands()))
+                ops.push_back(op.get());
+            MDNode *copyID = MDNode::getDistinct(loop->getHeader()->getContext(), ops);
+            copyID->replaceOperandWith(0, copyID);
+            copies[p]->setLoopID(copyID);
+        }
+        top = copies[p]->getLoopPreheader();
+    }
+    pred->getTerminator()->replaceUsesOfWith(preheader, top);
+    for(unsigned p=0; p+1<n; p++)
+        DT.changeImmediateDominator(copies[p+1]->getLoopPreheader(), copies[p]->getHeader());
+
+    for(unsigned p=0; p<n; p++){
+        auto copyOf = [&](Instruction *I){ return p+1 == n ? I : cast<Instruction>((*maps[p])[I]); };
+        SmallPtrSet<Instruction*,8> owned(partitions[p].Roots.begin(), partitions[p].Roots.end());
+        SmallVector<WeakTrackingVH> dead;
+        for(unsigned q=0; q<n; q++){
+            for(Instruction *root : partitions[q].Roots){
+                Instruction *I = copyOf(root);
+                if(owned.count(root)){
+                    if(I != root)
+                        root->replaceUsesWithIf(I, [&](Use &U){ return !loop->contains(cast<Instruction>(U.getUser())); });
+                }else if(isa<StoreInst>(I)){
+                    dead.append(I->op_begin(), I->op_end());
+                    I->eraseFromParent();
+                }
+            }
         }
+        RecursivelyDeleteTriviallyDeadInstructionsPermissive(dead);
+        SmallVector<WeakTrackingVH> phis;
+        for(PHINode &phi : copies[p]->getHeader()->phis())
+            phis.push_back(&phi);
+        for(WeakTrackingVH &V : phis){
+            if(PHINode *phi = dyn_cast_or_null<PHINode>((Value*)V))
+                RecursivelyDeleteDeadPHINode(phi);
+        }
+    }
+}
+
+}
 
-        modifyUseInductionVarible(*L, *Lnext, SE);    
-        editCFG(*L, *Lnext);
+/*
+    Distribuzione (fissione) dei loop innermost, l'inversa della fusione: un loop in cui alcune store hanno una
+    dipendenza tra iterazioni che ne impedisce la vettorizzazione viene diviso in loop consecutivi, così le
+    altre parti diventano vettorizzabili
+*/
+PreservedAnalyses LoopDistributionPass::run(Function &F, FunctionAnalysisManager &AM){
+    LoopInfo &loops = AM.getResult<LoopAnalysis>(F);
+    DominatorTree &DT = AM.getResult<DominatorTreeAnalysis>(F);
+    ScalarEvolution &SE = AM.getResult<ScalarEvolutionAnalysis>(F);
+    DependenceInfo &DI = AM.getResult<DependenceAnalysis>(F);
+    OptimizationRemarkEmitter &ORE = AM.getResult<OptimizationRemarkEmitterAnalysis>(F);
+
+    SmallVector<Loop*> candidates;
+    for(Loop *loop : loops.getLoopsInPreorder()){
+        if(loop->isInnermost())
+            candidates.push_back(loop);
     }
-    return PreservedAnalyses::all();
+    bool changed = false;
+    for(Loop *loop : candidates){
+        SmallVector<Instruction*> order;
+        if(!getStraightLineBody(loop, order))
+            continue;
+        ++NumDistributionCandidates;
+        SmallVector<LoopPartition> partitions = partitionLoop(loop, order, DI, SE, ORE);
+        if(partitions.empty())
+            continue;
+        unsigned vectorizable = count_if(partitions, [](const LoopPartition &partition){ return !partition.Cyclic; });
+        ORE.emit([&](){
+            return OptimizationRemark(DEBUG_TYPE, "Distributed", loop->getStartLoc(), loop->getHeader())
+                   <<"Loop distribuito in "<<ore::NV("Loops", (unsigned)partitions.size())<<" loop, "
+                   <<ore::NV("Vectorizable", vectorizable)<<" vettorizzabili";
+        });
+        ++NumDistributed;
+        NumDistributedLoops += partitions.size();
+        distributeLoop(loop, partitions, loops, DT, SE);
+        changed = true;
+    }
+    if(!changed)
+        return PreservedAnalyses::all();
+
+    PreservedAnalyses PA;
+    PA.preserve<LoopAnalysis>();
+    PA.preserve<DominatorTreeAnalysis>();
+    return PA;
 }
@@ -6,5 +6,10 @@ namespace llvm {
         public:
             PreservedAnalyses run(Function &F, FunctionAnalysisManager &AM);
     };
+
+    class LoopDistributionPass : public PassInfoMixin<LoopDistributionPass> {
+        public:
+            PreservedAnalyses run(Function &F, FunctionAnalysisManager &AM);
+    };
 }
 #endif
\ No newline at end of file
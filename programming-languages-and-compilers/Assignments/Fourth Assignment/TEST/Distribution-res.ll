@@ -0,0 +1,326 @@
+; ModuleID = 'Distribution.ll'
+source_filename = "Distribution.ll"
+target datalayout = "e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-i128:128-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-pc-linux-gnu"
+
+@A = global [64 x i32] zeroinitializer
+@B = global [64 x i32] zeroinitializer
+@C = global [64 x i32] zeroinitializer
+@D = global [64 x i32] zeroinitializer
+@.fmt = private unnamed_addr constant [20 x i8] c"%s %d: %d %d %d %d\0A\00"
+@.split = private unnamed_addr constant [6 x i8] c"split\00"
+@.recurrences = private unnamed_addr constant [12 x i8] c"recurrences\00"
+@.vectorizable = private unnamed_addr constant [13 x i8] c"vectorizable\00"
+@.antidependence = private unnamed_addr constant [15 x i8] c"antidependence\00"
+@.backward = private unnamed_addr constant [9 x i8] c"backward\00"
+
+define i32 @split(i64 %n, i32 %k) {
+entry:
+  br label %entry.split.dist0
+
+entry.split.dist0:                                ; preds = %entry
+  br label %h.dist0
+
+h.dist0:                                          ; preds = %latch.dist0, %entry.split.dist0
+  %i.dist0 = phi i64 [ 0, %entry.split.dist0 ], [ %i.next.dist0, %latch.dist0 ]
+  %c.dist0 = icmp slt i64 %i.dist0, %n
+  br i1 %c.dist0, label %body.dist0, label %entry.split.dist1
+
+body.dist0:                                       ; preds = %h.dist0
+  %pb.dist0 = getelementptr inbounds [64 x i32], ptr @B, i64 0, i64 %i.dist0
+  %vb.dist0 = load i32, ptr %pb.dist0, align 4
+  %va.dist0 = mul i32 %vb.dist0, 2
+  %pa.dist0 = getelementptr inbounds [64 x i32], ptr @A, i64 0, i64 %i.dist0
+  store i32 %va.dist0, ptr %pa.dist0, align 4
+  br label %latch.dist0
+
+latch.dist0:                                      ; preds = %body.dist0
+  %i.next.dist0 = add nsw i64 %i.dist0, 1
+  br label %h.dist0
+
+entry.split.dist1:                                ; preds = %h.dist0
+  br label %h.dist1
+
+h.dist1:                                          ; preds = %latch.dist1, %entry.split.dist1
+  %i.dist1 = phi i64 [ 0, %entry.split.dist1 ], [ %i.next.dist1, %latch.dist1 ]
+  %s.dist1 = phi i32 [ 0, %entry.split.dist1 ], [ %s.next.dist1, %latch.dist1 ]
+  %c.dist1 = icmp slt i64 %i.dist1, %n
+  br i1 %c.dist1, label %body.dist1, label %entry.split
+
+body.dist1:                                       ; preds = %h.dist1
+  %pa.dist1 = getelementptr inbounds [64 x i32], ptr @A, i64 0, i64 %i.dist1
+  %pc.dist1 = getelementptr inbounds [64 x i32], ptr @C, i64 0, i64 %i.dist1
+  %vc.dist1 = load i32, ptr %pc.dist1, align 4
+  %la.dist1 = load i32, ptr %pa.dist1, align 4
+  %vc2.dist1 = add i32 %vc.dist1, %la.dist1
+  %i1.dist1 = add nsw i64 %i.dist1, 1
+  %pc1.dist1 = getelementptr inbounds [64 x i32], ptr @C, i64 0, i64 %i1.dist1
+  store i32 %vc2.dist1, ptr %pc1.dist1, align 4
+  %s.next.dist1 = add i32 %s.dist1, %vc.dist1
+  br label %latch.dist1
+
+latch.dist1:                                      ; preds = %body.dist1
+  %i.next.dist1 = add nsw i64 %i.dist1, 1
+  br label %h.dist1
+
+entry.split:                                      ; preds = %h.dist1
+  br label %h
+
+h:                                                ; preds = %latch, %entry.split
+  %i = phi i64 [ 0, %entry.split ], [ %i.next, %latch ]
+  %c = icmp slt i64 %i, %n
+  br i1 %c, label %body, label %exit
+
+body:                                             ; preds = %h
+  %pa = getelementptr inbounds [64 x i32], ptr @A, i64 0, i64 %i
+  %la = load i32, ptr %pa, align 4
+  %vd = add i32 %la, %k
+  %pd = getelementptr inbounds [64 x i32], ptr @D, i64 0, i64 %i
+  store i32 %vd, ptr %pd, align 4
+  br label %latch
+
+latch:                                            ; preds = %body
+  %i.next = add nsw i64 %i, 1
+  br label %h
+
+exit:                                             ; preds = %h
+  ret i32 %s.dist1
+}
+
+define i32 @recurrences(i64 %n, i32 %k) {
+entry:
+  br label %h
+
+h:                                                ; preds = %latch, %entry
+  %i = phi i64 [ 0, %entry ], [ %i.next, %latch ]
+  %c = icmp slt i64 %i, %n
+  br i1 %c, label %body, label %exit
+
+body:                                             ; preds = %h
+  %i1 = add nsw i64 %i, 1
+  %pc = getelementptr inbounds [64 x i32], ptr @C, i64 0, i64 %i
+  %vc = load i32, ptr %pc, align 4
+  %m = mul i32 %vc, 3
+  %vc2 = add i32 %m, %k
+  %pc1 = getelementptr inbounds [64 x i32], ptr @C, i64 0, i64 %i1
+  store i32 %vc2, ptr %pc1, align 4
+  %pd = getelementptr inbounds [64 x i32], ptr @D, i64 0, i64 %i
+  %vd = load i32, ptr %pd, align 4
+  %vd2 = xor i32 %vd, %vc
+  %pd1 = getelementptr inbounds [64 x i32], ptr @D, i64 0, i64 %i1
+  store i32 %vd2, ptr %pd1, align 4
+  br label %latch
+
+latch:                                            ; preds = %body
+  %i.next = add nsw i64 %i, 1
+  br label %h
+
+exit:                                             ; preds = %h
+  ret i32 0
+}
+
+define i32 @vectorizable(i64 %n, i32 %k) {
+entry:
+  br label %h
+
+h:                                                ; preds = %latch, %entry
+  %i = phi i64 [ 0, %entry ], [ %i.next, %latch ]
+  %c = icmp slt i64 %i, %n
+  br i1 %c, label %body, label %exit
+
+body:                                             ; preds = %h
+  %pb = getelementptr inbounds [64 x i32], ptr @B, i64 0, i64 %i
+  %vb = load i32, ptr %pb, align 4
+  %va = sub i32 %vb, %k
+  %pa = getelementptr inbounds [64 x i32], ptr @A, i64 0, i64 %i
+  store i32 %va, ptr %pa, align 4
+  %pc = getelementptr inbounds [64 x i32], ptr @C, i64 0, i64 %i
+  %vc = load i32, ptr %pc, align 4
+  %vd = mul i32 %va, %vc
+  %pd = getelementptr inbounds [64 x i32], ptr @D, i64 0, i64 %i
+  store i32 %vd, ptr %pd, align 4
+  br label %latch
+
+latch:                                            ; preds = %body
+  %i.next = add nsw i64 %i, 1
+  br label %h
+
+exit:                                             ; preds = %h
+  ret i32 0
+}
+
+define i32 @antidependence(i64 %n, i32 %k) {
+entry:
+  br label %entry.split.dist0
+
+entry.split.dist0:                                ; preds = %entry
+  br label %h.dist0
+
+h.dist0:                                          ; preds = %latch.dist0, %entry.split.dist0
+  %i.dist0 = phi i64 [ 0, %entry.split.dist0 ], [ %i.next.dist0, %latch.dist0 ]
+  %c.dist0 = icmp slt i64 %i.dist0, %n
+  br i1 %c.dist0, label %body.dist0, label %entry.split
+
+body.dist0:                                       ; preds = %h.dist0
+  %i1.dist0 = add nsw i64 %i.dist0, 1
+  %pa1.dist0 = getelementptr inbounds [64 x i32], ptr @A, i64 0, i64 %i1.dist0
+  %va.dist0 = load i32, ptr %pa1.dist0, align 4
+  %pc.dist0 = getelementptr inbounds [64 x i32], ptr @C, i64 0, i64 %i.dist0
+  %vc.dist0 = load i32, ptr %pc.dist0, align 4
+  %vd.dist0 = add i32 %va.dist0, %vc.dist0
+  %pd.dist0 = getelementptr inbounds [64 x i32], ptr @D, i64 0, i64 %i.dist0
+  store i32 %vd.dist0, ptr %pd.dist0, align 4
+  %vc2.dist0 = add i32 %vc.dist0, 1
+  %pc1.dist0 = getelementptr inbounds [64 x i32], ptr @C, i64 0, i64 %i1.dist0
+  store i32 %vc2.dist0, ptr %pc1.dist0, align 4
+  br label %latch.dist0
+
+latch.dist0:                                      ; preds = %body.dist0
+  %i.next.dist0 = add nsw i64 %i.dist0, 1
+  br label %h.dist0
+
+entry.split:                                      ; preds = %h.dist0
+  br label %h
+
+h:                                                ; preds = %latch, %entry.split
+  %i = phi i64 [ 0, %entry.split ], [ %i.next, %latch ]
+  %c = icmp slt i64 %i, %n
+  br i1 %c, label %body, label %exit
+
+body:                                             ; preds = %h
+  %i1 = add nsw i64 %i, 1
+  %pa1 = getelementptr inbounds [64 x i32], ptr @A, i64 0, i64 %i1
+  %pb = getelementptr inbounds [64 x i32], ptr @B, i64 0, i64 %i
+  %vb = load i32, ptr %pb, align 4
+  %vb2 = mul i32 %vb, %k
+  store i32 %vb2, ptr %pa1, align 4
+  br label %latch
+
+latch:                                            ; preds = %body
+  %i.next = add nsw i64 %i, 1
+  br label %h
+
+exit:                                             ; preds = %h
+  ret i32 0
+}
+
+define i32 @backward(i64 %n, i32 %k) {
+entry:
+  br label %h
+
+h:                                                ; preds = %latch, %entry
+  %i = phi i64 [ 0, %entry ], [ %i.next, %latch ]
+  %c = icmp slt i64 %i, %n
+  br i1 %c, label %body, label %exit
+
+body:                                             ; preds = %h
+  %i1 = add nsw i64 %i, 1
+  %pa = getelementptr inbounds [64 x i32], ptr @A, i64 0, i64 %i
+  %va = load i32, ptr %pa, align 4
+  %pc = getelementptr inbounds [64 x i32], ptr @C, i64 0, i64 %i
+  %vc = load i32, ptr %pc, align 4
+  %vd = add i32 %va, %vc
+  %pd = getelementptr inbounds [64 x i32], ptr @D, i64 0, i64 %i
+  store i32 %vd, ptr %pd, align 4
+  %vc2 = add i32 %vc, 1
+  %pc1 = getelementptr inbounds [64 x i32], ptr @C, i64 0, i64 %i1
+  store i32 %vc2, ptr %pc1, align 4
+  %pb = getelementptr inbounds [64 x i32], ptr @B, i64 0, i64 %i
+  %vb = load i32, ptr %pb, align 4
+  %vb2 = mul i32 %vb, %k
+  %pa1 = getelementptr inbounds [64 x i32], ptr @A, i64 0, i64 %i1
+  store i32 %vb2, ptr %pa1, align 4
+  br label %latch
+
+latch:                                            ; preds = %body
+  %i.next = add nsw i64 %i, 1
+  br label %h
+
+exit:                                             ; preds = %h
+  ret i32 0
+}
+
+define void @init() {
+entry:
+  br label %body
+
+body:                                             ; preds = %body, %entry
+  %i = phi i64 [ 0, %entry ], [ %i.next, %body ]
+  %v = trunc i64 %i to i32
+  %b = mul i32 %v, 7
+  %b2 = sub i32 %b, 100
+  %pb = getelementptr inbounds [64 x i32], ptr @B, i64 0, i64 %i
+  store i32 %b2, ptr %pb, align 4
+  %pc = getelementptr inbounds [64 x i32], ptr @C, i64 0, i64 %i
+  store i32 %v, ptr %pc, align 4
+  %pa = getelementptr inbounds [64 x i32], ptr @A, i64 0, i64 %i
+  store i32 0, ptr %pa, align 4
+  %pd = getelementptr inbounds [64 x i32], ptr @D, i64 0, i64 %i
+  store i32 0, ptr %pd, align 4
+  %i.next = add i64 %i, 1
+  %c = icmp slt i64 %i.next, 64
+  br i1 %c, label %body, label %exit
+
+exit:                                             ; preds = %body
+  ret void
+}
+
+define i32 @checksum(ptr %p) {
+entry:
+  br label %body
+
+body:                                             ; preds = %body, %entry
+  %i = phi i64 [ 0, %entry ], [ %i.next, %body ]
+  %s = phi i32 [ 0, %entry ], [ %s.next, %body ]
+  %q = getelementptr i32, ptr %p, i64 %i
+  %v = load i32, ptr %q, align 4
+  %s31 = mul i32 %s, 31
+  %s.next = add i32 %s31, %v
+  %i.next = add i64 %i, 1
+  %c = icmp slt i64 %i.next, 64
+  br i1 %c, label %body, label %exit
+
+exit:                                             ; preds = %body
+  ret i32 %s.next
+}
+
+declare i32 @printf(ptr, ...)
+
+define void @print(ptr %name, i64 %n, i32 %r) {
+  %a = call i32 @checksum(ptr @A)
+  %c = call i32 @checksum(ptr @C)
+  %d = call i32 @checksum(ptr @D)
+  %p = call i32 (ptr, ...) @printf(ptr @.fmt, ptr %name, i64 %n, i32 %r, i32 %a, i32 %c, i32 %d)
+  ret void
+}
+
+define i32 @main() {
+entry:
+  br label %loop
+
+loop:                                             ; preds = %loop, %entry
+  %n = phi i64 [ 0, %entry ], [ %n.next, %loop ]
+  %n32 = trunc i64 %n to i32
+  %k = sub i32 %n32, 20
+  call void @init()
+  %r0 = call i32 @split(i64 %n, i32 %k)
+  call void @print(ptr @.split, i64 %n, i32 %r0)
+  call void @init()
+  %r1 = call i32 @recurrences(i64 %n, i32 %k)
+  call void @print(ptr @.recurrences, i64 %n, i32 %r1)
+  call void @init()
+  %r2 = call i32 @vectorizable(i64 %n, i32 %k)
+  call void @print(ptr @.vectorizable, i64 %n, i32 %r2)
+  call void @init()
+  %r3 = call i32 @antidependence(i64 %n, i32 %k)
+  call void @print(ptr @.antidependence, i64 %n, i32 %r3)
+  call void @init()
+  %r4 = call i32 @backward(i64 %n, i32 %k)
+  call void @print(ptr @.backward, i64 %n, i32 %r4)
+  %n.next = add i64 %n, 1
+  %done = icmp eq i64 %n.next, 63
+  br i1 %done, label %exit, label %loop
+
+exit:                                             ; preds = %loop
+  ret i32 0
+}
@@ -0,0 +1,285 @@
+; Distribuzione dei loop (loopdistributionpass): la ricorrenza C[i+1]=C[i]+A[i] impedisce
+; la vettorizzazione dell'intero loop e viene separata dagli store indipendenti in A e D,
+; con la somma usata dopo il loop. Non vengono distribuiti un loop fatto solo di
+; ricorrenze e uno già vettorizzabile. Se una parte legge A[i+1] prima che una parte
+; successiva lo scriva, la distribuzione è legale; se legge A[i], scritto nell'iterazione
+; precedente da una store che viene dopo nel body, il loop non si distribuisce:
+;   opt -load-pass-plugin <plugin> -passes=loopdistributionpass Distribution.ll -S -o Distribution-res.ll
+;   lli Distribution.ll e lli Distribution-res.ll devono stampare le stesse righe
+target datalayout = "e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-i128:128-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-pc-linux-gnu"
+
+@A = global [64 x i32] zeroinitializer
+@B = global [64 x i32] zeroinitializer
+@C = global [64 x i32] zeroinitializer
+@D = global [64 x i32] zeroinitializer
+@.fmt = private unnamed_addr constant [20 x i8] c"%s %d: %d %d %d %d\0A\00"
+@.split = private unnamed_addr constant [6 x i8] c"split\00"
+@.recurrences = private unnamed_addr constant [12 x i8] c"recurrences\00"
+@.vectorizable = private unnamed_addr constant [13 x i8] c"vectorizable\00"
+@.antidependence = private unnamed_addr constant [15 x i8] c"antidependence\00"
+@.backward = private unnamed_addr constant [9 x i8] c"backward\00"
+
+; for(i=0; i<n; i++){ A[i]=B[i]*2; C[i+1]=C[i]+A[i]; D[i]=A[i]+k; s+=C[i]; } return s;
+define i32 @split(i64 %n, i32 %k) {
+entry:
+  br label %h
+
+h:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %latch ]
+  %s = phi i32 [ 0, %entry ], [ %s.next, %latch ]
+  %c = icmp slt i64 %i, %n
+  br i1 %c, label %body, label %exit
+
+body:
+  %pb = getelementptr inbounds [64 x i32], ptr @B, i64 0, i64 %i
+  %vb = load i32, ptr %pb
+  %va = mul i32 %vb, 2
+  %pa = getelementptr inbounds [64 x i32], ptr @A, i64 0, i64 %i
+  store i32 %va, ptr %pa
+  %pc = getelementptr inbounds [64 x i32], ptr @C, i64 0, i64 %i
+  %vc = load i32, ptr %pc
+  %la = load i32, ptr %pa
+  %vc2 = add i32 %vc, %la
+  %i1 = add nsw i64 %i, 1
+  %pc1 = getelementptr inbounds [64 x i32], ptr @C, i64 0, i64 %i1
+  store i32 %vc2, ptr %pc1
+  %vd = add i32 %la, %k
+  %pd = getelementptr inbounds [64 x i32], ptr @D, i64 0, i64 %i
+  store i32 %vd, ptr %pd
+  %s.next = add i32 %s, %vc
+  br label %latch
+
+latch:
+  %i.next = add nsw i64 %i, 1
+  br label %h
+
+exit:
+  ret i32 %s
+}
+
+; for(i=0; i<n; i++){ C[i+1]=C[i]*3+k; D[i+1]=D[i]^C[i]; }
+define i32 @recurrences(i64 %n, i32 %k) {
+entry:
+  br label %h
+
+h:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %latch ]
+  %c = icmp slt i64 %i, %n
+  br i1 %c, label %body, label %exit
+
+body:
+  %i1 = add nsw i64 %i, 1
+  %pc = getelementptr inbounds [64 x i32], ptr @C, i64 0, i64 %i
+  %vc = load i32, ptr %pc
+  %m = mul i32 %vc, 3
+  %vc2 = add i32 %m, %k
+  %pc1 = getelementptr inbounds [64 x i32], ptr @C, i64 0, i64 %i1
+  store i32 %vc2, ptr %pc1
+  %pd = getelementptr inbounds [64 x i32], ptr @D, i64 0, i64 %i
+  %vd = load i32, ptr %pd
+  %vd2 = xor i32 %vd, %vc
+  %pd1 = getelementptr inbounds [64 x i32], ptr @D, i64 0, i64 %i1
+  store i32 %vd2, ptr %pd1
+  br label %latch
+
+latch:
+  %i.next = add nsw i64 %i, 1
+  br label %h
+
+exit:
+  ret i32 0
+}
+
+; for(i=0; i<n; i++){ A[i]=B[i]-k; D[i]=A[i]*C[i]; }
+define i32 @vectorizable(i64 %n, i32 %k) {
+entry:
+  br label %h
+
+h:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %latch ]
+  %c = icmp slt i64 %i, %n
+  br i1 %c, label %body, label %exit
+
+body:
+  %pb = getelementptr inbounds [64 x i32], ptr @B, i64 0, i64 %i
+  %vb = load i32, ptr %pb
+  %va = sub i32 %vb, %k
+  %pa = getelementptr inbounds [64 x i32], ptr @A, i64 0, i64 %i
+  store i32 %va, ptr %pa
+  %pc = getelementptr inbounds [64 x i32], ptr @C, i64 0, i64 %i
+  %vc = load i32, ptr %pc
+  %vd = mul i32 %va, %vc
+  %pd = getelementptr inbounds [64 x i32], ptr @D, i64 0, i64 %i
+  store i32 %vd, ptr %pd
+  br label %latch
+
+latch:
+  %i.next = add nsw i64 %i, 1
+  br label %h
+
+exit:
+  ret i32 0
+}
+
+; for(i=0; i<n; i++){ D[i]=A[i+1]+C[i]; C[i+1]=C[i]+1; A[i+1]=B[i]*k; }
+; La parte di D legge A[i+1] prima che la parte di A lo scriva: si possono separare
+define i32 @antidependence(i64 %n, i32 %k) {
+entry:
+  br label %h
+
+h:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %latch ]
+  %c = icmp slt i64 %i, %n
+  br i1 %c, label %body, label %exit
+
+body:
+  %i1 = add nsw i64 %i, 1
+  %pa1 = getelementptr inbounds [64 x i32], ptr @A, i64 0, i64 %i1
+  %va = load i32, ptr %pa1
+  %pc = getelementptr inbounds [64 x i32], ptr @C, i64 0, i64 %i
+  %vc = load i32, ptr %pc
+  %vd = add i32 %va, %vc
+  %pd = getelementptr inbounds [64 x i32], ptr @D, i64 0, i64 %i
+  store i32 %vd, ptr %pd
+  %vc2 = add i32 %vc, 1
+  %pc1 = getelementptr inbounds [64 x i32], ptr @C, i64 0, i64 %i1
+  store i32 %vc2, ptr %pc1
+  %pb = getelementptr inbounds [64 x i32], ptr @B, i64 0, i64 %i
+  %vb = load i32, ptr %pb
+  %vb2 = mul i32 %vb, %k
+  store i32 %vb2, ptr %pa1
+  br label %latch
+
+latch:
+  %i.next = add nsw i64 %i, 1
+  br label %h
+
+exit:
+  ret i32 0
+}
+
+; for(i=0; i<n; i++){ D[i]=A[i]+C[i]; C[i+1]=C[i]+1; A[i+1]=B[i]*k; }
+; A[i] è scritto nell'iterazione precedente dalla store in fondo al body: le parti restano unite
+define i32 @backward(i64 %n, i32 %k) {
+entry:
+  br label %h
+
+h:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %latch ]
+  %c = icmp slt i64 %i, %n
+  br i1 %c, label %body, label %exit
+
+body:
+  %i1 = add nsw i64 %i, 1
+  %pa = getelementptr inbounds [64 x i32], ptr @A, i64 0, i64 %i
+  %va = load i32, ptr %pa
+  %pc = getelementptr inbounds [64 x i32], ptr @C, i64 0, i64 %i
+  %vc = load i32, ptr %pc
+  %vd = add i32 %va, %vc
+  %pd = getelementptr inbounds [64 x i32], ptr @D, i64 0, i64 %i
+  store i32 %vd, ptr %pd
+  %vc2 = add i32 %vc, 1
+  %pc1 = getelementptr inbounds [64 x i32], ptr @C, i64 0, i64 %i1
+  store i32 %vc2, ptr %pc1
+  %pb = getelementptr inbounds [64 x i32], ptr @B, i64 0, i64 %i
+  %vb = load i32, ptr %pb
+  %vb2 = mul i32 %vb, %k
+  %pa1 = getelementptr inbounds [64 x i32], ptr @A, i64 0, i64 %i1
+  store i32 %vb2, ptr %pa1
+  br label %latch
+
+latch:
+  %i.next = add nsw i64 %i, 1
+  br label %h
+
+exit:
+  ret i32 0
+}
+
+; B[i]=i*7-100, C[i]=i, A[i]=D[i]=0
+define void @init() {
+entry:
+  br label %body
+
+body:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %body ]
+  %v = trunc i64 %i to i32
+  %b = mul i32 %v, 7
+  %b2 = sub i32 %b, 100
+  %pb = getelementptr inbounds [64 x i32], ptr @B, i64 0, i64 %i
+  store i32 %b2, ptr %pb
+  %pc = getelementptr inbounds [64 x i32], ptr @C, i64 0, i64 %i
+  store i32 %v, ptr %pc
+  %pa = getelementptr inbounds [64 x i32], ptr @A, i64 0, i64 %i
+  store i32 0, ptr %pa
+  %pd = getelementptr inbounds [64 x i32], ptr @D, i64 0, i64 %i
+  store i32 0, ptr %pd
+  %i.next = add i64 %i, 1
+  %c = icmp slt i64 %i.next, 64
+  br i1 %c, label %body, label %exit
+
+exit:
+  ret void
+}
+
+; Somma pesata di un array di 64 elementi
+define i32 @checksum(ptr %p) {
+entry:
+  br label %body
+
+body:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %body ]
+  %s = phi i32 [ 0, %entry ], [ %s.next, %body ]
+  %q = getelementptr i32, ptr %p, i64 %i
+  %v = load i32, ptr %q
+  %s31 = mul i32 %s, 31
+  %s.next = add i32 %s31, %v
+  %i.next = add i64 %i, 1
+  %c = icmp slt i64 %i.next, 64
+  br i1 %c, label %body, label %exit
+
+exit:
+  ret i32 %s.next
+}
+
+declare i32 @printf(ptr, ...)
+
+define void @print(ptr %name, i64 %n, i32 %r) {
+  %a = call i32 @checksum(ptr @A)
+  %c = call i32 @checksum(ptr @C)
+  %d = call i32 @checksum(ptr @D)
+  %p = call i32 (ptr, ...) @printf(ptr @.fmt, ptr %name, i64 %n, i32 %r, i32 %a, i32 %c, i32 %d)
+  ret void
+}
+
+define i32 @main() {
+entry:
+  br label %loop
+
+loop:
+  %n = phi i64 [ 0, %entry ], [ %n.next, %loop ]
+  %n32 = trunc i64 %n to i32
+  %k = sub i32 %n32, 20
+  call void @init()
+  %r0 = call i32 @split(i64 %n, i32 %k)
+  call void @print(ptr @.split, i64 %n, i32 %r0)
+  call void @init()
+  %r1 = call i32 @recurrences(i64 %n, i32 %k)
+  call void @print(ptr @.recurrences, i64 %n, i32 %r1)
+  call void @init()
+  %r2 = call i32 @vectorizable(i64 %n, i32 %k)
+  call void @print(ptr @.vectorizable, i64 %n, i32 %r2)
+  call void @init()
+  %r3 = call i32 @antidependence(i64 %n, i32 %k)
+  call void @print(ptr @.antidependence, i64 %n, i32 %r3)
+  call void @init()
+  %r4 = call i32 @backward(i64 %n, i32 %k)
+  call void @print(ptr @.backward, i64 %n, i32 %r4)
+  %n.next = add i64 %n, 1
+  %done = icmp eq i64 %n.next, 63
+  br i1 %done, label %exit, label %loop
+
+exit:
+  ret i32 0
+}
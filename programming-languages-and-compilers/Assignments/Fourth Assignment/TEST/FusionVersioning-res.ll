@@ -0,0 +1,219 @@
+; ModuleID = 'FusionVersioning.ll'
+source_filename = "FusionVersioning.ll"
+target datalayout = "e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-i128:128-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-pc-linux-gnu"
+
+@x = global [40 x i32] zeroinitializer
+@y = global [40 x i32] zeroinitializer
+@z = global [40 x i32] zeroinitializer
+@.fmt = private unnamed_addr constant [17 x i8] c"%s %d: %d %d %d\0A\00"
+@.disjoint = private unnamed_addr constant [9 x i8] c"disjoint\00"
+@.shifted = private unnamed_addr constant [8 x i8] c"shifted\00"
+@.inplace = private unnamed_addr constant [8 x i8] c"inplace\00"
+@.touching = private unnamed_addr constant [9 x i8] c"touching\00"
+
+define void @sweep(ptr %dst, ptr %mid, ptr %src, i64 %n, i32 %k) {
+entry:
+  %dst3 = ptrtoint ptr %dst to i64
+  %src2 = ptrtoint ptr %src to i64
+  %mid1 = ptrtoint ptr %mid to i64
+  %smax = call i64 @llvm.smax.i64(i64 %n, i64 0)
+  %0 = shl i64 %smax, 2
+  %1 = add i64 %mid1, %0
+  %2 = add i64 %1, 4
+  %3 = add i64 %src2, %0
+  %4 = add i64 %3, 4
+  %5 = icmp ule i64 %4, %mid1
+  %6 = icmp ule i64 %2, %src2
+  %alias.disjoint = or i1 %6, %5
+  %7 = add i64 %dst3, %0
+  %8 = add i64 %7, 4
+  %9 = icmp ule i64 %8, %src2
+  %10 = icmp ule i64 %4, %dst3
+  %alias.disjoint4 = or i1 %10, %9
+  %alias.disjoint5 = and i1 %alias.disjoint, %alias.disjoint4
+  %11 = icmp ule i64 %8, %mid1
+  %12 = icmp ule i64 %2, %dst3
+  %alias.disjoint6 = or i1 %12, %11
+  %alias.disjoint7 = and i1 %alias.disjoint5, %alias.disjoint6
+  br i1 %alias.disjoint7, label %h1.ph, label %h1.ph.slow
+
+h1.ph.slow:                                       ; preds = %entry
+  br label %h1.slow
+
+h1.slow:                                          ; preds = %latch1.slow, %h1.ph.slow
+  %i.slow = phi i64 [ 0, %h1.ph.slow ], [ %i.next.slow, %latch1.slow ]
+  %c1.slow = icmp slt i64 %i.slow, %n
+  br i1 %c1.slow, label %body1.slow, label %ph2.slow
+
+body1.slow:                                       ; preds = %h1.slow
+  %ps.slow = getelementptr inbounds i32, ptr %src, i64 %i.slow
+  %s.slow = load i32, ptr %ps.slow, align 4
+  %m.slow = mul i32 %s.slow, %k
+  %m1.slow = add i32 %m.slow, 1
+  %pm.slow = getelementptr inbounds i32, ptr %mid, i64 %i.slow
+  store i32 %m1.slow, ptr %pm.slow, align 4
+  br label %latch1.slow
+
+latch1.slow:                                      ; preds = %body1.slow
+  %i.next.slow = add nsw i64 %i.slow, 1
+  br label %h1.slow, !llvm.loop !0
+
+ph2.slow:                                         ; preds = %h1.slow
+  br label %h2.slow
+
+h2.slow:                                          ; preds = %latch2.slow, %ph2.slow
+  %j.slow = phi i64 [ 0, %ph2.slow ], [ %j.next.slow, %latch2.slow ]
+  %c2.slow = icmp slt i64 %j.slow, %n
+  br i1 %c2.slow, label %body2.slow, label %exit
+
+body2.slow:                                       ; preds = %h2.slow
+  %pm2.slow = getelementptr inbounds i32, ptr %mid, i64 %j.slow
+  %v.slow = load i32, ptr %pm2.slow, align 4
+  %ps2.slow = getelementptr inbounds i32, ptr %src, i64 %j.slow
+  %s2.slow = load i32, ptr %ps2.slow, align 4
+  %d.slow = sub i32 %v.slow, %s2.slow
+  %pd.slow = getelementptr inbounds i32, ptr %dst, i64 %j.slow
+  store i32 %d.slow, ptr %pd.slow, align 4
+  br label %latch2.slow
+
+latch2.slow:                                      ; preds = %body2.slow
+  %j.next.slow = add nsw i64 %j.slow, 1
+  br label %h2.slow, !llvm.loop !2
+
+h1.ph:                                            ; preds = %entry
+  br label %h1
+
+h1:                                               ; preds = %latch2, %h1.ph
+  %i = phi i64 [ 0, %h1.ph ], [ %i.next, %latch2 ]
+  %c1 = icmp slt i64 %i, %n
+  br i1 %c1, label %body1, label %exit
+
+body1:                                            ; preds = %h1
+  %ps = getelementptr inbounds i32, ptr %src, i64 %i
+  %s = load i32, ptr %ps, align 4, !alias.scope !3, !noalias !6
+  %m = mul i32 %s, %k
+  %m1 = add i32 %m, 1
+  %pm = getelementptr inbounds i32, ptr %mid, i64 %i
+  store i32 %m1, ptr %pm, align 4, !alias.scope !9, !noalias !10
+  br label %latch1
+
+latch1:                                           ; preds = %body1
+  %pm2 = getelementptr inbounds i32, ptr %mid, i64 %i
+  %v = load i32, ptr %pm2, align 4
+  %ps2 = getelementptr inbounds i32, ptr %src, i64 %i
+  %s2 = load i32, ptr %ps2, align 4, !alias.scope !3, !noalias !6
+  %d = sub i32 %v, %s2
+  %pd = getelementptr inbounds i32, ptr %dst, i64 %i
+  store i32 %d, ptr %pd, align 4, !alias.scope !11, !noalias !12
+  br label %latch2
+
+latch2:                                           ; preds = %latch1
+  %i.next = add nsw i64 %i, 1
+  br label %h1
+
+exit:                                             ; preds = %h1, %h2.slow
+  ret void
+}
+
+define void @init() {
+entry:
+  br label %body
+
+body:                                             ; preds = %body, %entry
+  %i = phi i64 [ 0, %entry ], [ %i.next, %body ]
+  %v = trunc i64 %i to i32
+  %r = urem i32 %v, 7
+  %r3 = sub i32 %r, 3
+  %px = getelementptr inbounds [40 x i32], ptr @x, i64 0, i64 %i
+  store i32 %r3, ptr %px, align 4
+  %py = getelementptr inbounds [40 x i32], ptr @y, i64 0, i64 %i
+  store i32 0, ptr %py, align 4
+  %pz = getelementptr inbounds [40 x i32], ptr @z, i64 0, i64 %i
+  store i32 0, ptr %pz, align 4
+  %i.next = add i64 %i, 1
+  %c = icmp slt i64 %i.next, 40
+  br i1 %c, label %body, label %exit
+
+exit:                                             ; preds = %body
+  ret void
+}
+
+define i32 @checksum(ptr %p) {
+entry:
+  br label %body
+
+body:                                             ; preds = %body, %entry
+  %i = phi i64 [ 0, %entry ], [ %i.next, %body ]
+  %s = phi i32 [ 0, %entry ], [ %s.next, %body ]
+  %q = getelementptr i32, ptr %p, i64 %i
+  %v = load i32, ptr %q, align 4
+  %s31 = mul i32 %s, 31
+  %s.next = add i32 %s31, %v
+  %i.next = add i64 %i, 1
+  %c = icmp slt i64 %i.next, 40
+  br i1 %c, label %body, label %exit
+
+exit:                                             ; preds = %body
+  ret i32 %s.next
+}
+
+declare i32 @printf(ptr, ...)
+
+define void @print(ptr %name, i64 %n) {
+  %x = call i32 @checksum(ptr @x)
+  %y = call i32 @checksum(ptr @y)
+  %z = call i32 @checksum(ptr @z)
+  %r = call i32 (ptr, ...) @printf(ptr @.fmt, ptr %name, i64 %n, i32 %x, i32 %y, i32 %z)
+  ret void
+}
+
+define i32 @main() {
+entry:
+  br label %loop
+
+loop:                                             ; preds = %loop, %entry
+  %n = phi i64 [ 1, %entry ], [ %n.next, %loop ]
+  %n32 = trunc i64 %n to i32
+  %k = add i32 %n32, 2
+  call void @init()
+  call void @sweep(ptr @z, ptr @y, ptr @x, i64 %n, i32 %k)
+  call void @print(ptr @.disjoint, i64 %n)
+  call void @init()
+  %x1 = getelementptr inbounds [40 x i32], ptr @x, i64 0, i64 1
+  call void @sweep(ptr @z, ptr %x1, ptr @x, i64 %n, i32 %k)
+  call void @print(ptr @.shifted, i64 %n)
+  call void @init()
+  call void @sweep(ptr @x, ptr @y, ptr @x, i64 %n, i32 %k)
+  call void @print(ptr @.inplace, i64 %n)
+  call void @init()
+  %last = getelementptr inbounds [40 x i32], ptr @y, i64 0, i64 %n
+  %mid = getelementptr inbounds i32, ptr %last, i64 -1
+  call void @sweep(ptr @y, ptr %mid, ptr @x, i64 %n, i32 %k)
+  call void @print(ptr @.touching, i64 %n)
+  %n.next = add i64 %n, 1
+  %done = icmp eq i64 %n.next, 20
+  br i1 %done, label %exit, label %loop
+
+exit:                                             ; preds = %loop
+  ret i32 0
+}
+
+; Function Attrs: nofree nosync nounwind readnone speculatable willreturn
+declare i64 @llvm.smax.i64(i64, i64) #0
+
+attributes #0 = { nofree nosync nounwind readnone speculatable willreturn }
+
+!0 = distinct !{!0, !1}
+!1 = !{!"llvm.loop.runtime_alias_check.disable", i32 1}
+!2 = distinct !{!2, !1}
+!3 = !{!4}
+!4 = distinct !{!4, !5}
+!5 = distinct !{!5, !"RuntimeAliasCheck"}
+!6 = !{!7, !8}
+!7 = distinct !{!7, !5}
+!8 = distinct !{!8, !5}
+!9 = !{!7}
+!10 = !{!4, !8}
+!11 = !{!8}
+!12 = !{!4, !7}
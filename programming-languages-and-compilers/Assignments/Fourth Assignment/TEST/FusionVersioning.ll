@@ -0,0 +1,153 @@
+; Fusione dietro un controllo di alias a runtime (loopfusionpass): i due loop di sweep
+; lavorano su puntatori argomento che possono sovrapporsi, quindi vengono fusi solo nella
+; versione eseguita quando gli intervalli di src, mid e dst sono disgiunti; la copia
+; originale resta separata. main chiama sweep con array disgiunti, con mid=src+1,
+; dst=src e con intervalli che si toccano solo all'ultimo elemento:
+;   opt -load-pass-plugin <plugin> -passes=loopfusionpass FusionVersioning.ll -S -o FusionVersioning-res.ll
+;   lli FusionVersioning.ll e lli FusionVersioning-res.ll devono stampare le stesse righe
+target datalayout = "e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-i128:128-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-pc-linux-gnu"
+
+@x = global [40 x i32] zeroinitializer
+@y = global [40 x i32] zeroinitializer
+@z = global [40 x i32] zeroinitializer
+@.fmt = private unnamed_addr constant [17 x i8] c"%s %d: %d %d %d\0A\00"
+@.disjoint = private unnamed_addr constant [9 x i8] c"disjoint\00"
+@.shifted = private unnamed_addr constant [8 x i8] c"shifted\00"
+@.inplace = private unnamed_addr constant [8 x i8] c"inplace\00"
+@.touching = private unnamed_addr constant [9 x i8] c"touching\00"
+
+; for(i=0; i<n; i++) mid[i]=src[i]*k+1;  for(i=0; i<n; i++) dst[i]=mid[i]-src[i];
+define void @sweep(ptr %dst, ptr %mid, ptr %src, i64 %n, i32 %k) {
+entry:
+  br label %h1
+
+h1:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %latch1 ]
+  %c1 = icmp slt i64 %i, %n
+  br i1 %c1, label %body1, label %ph2
+
+body1:
+  %ps = getelementptr inbounds i32, ptr %src, i64 %i
+  %s = load i32, ptr %ps
+  %m = mul i32 %s, %k
+  %m1 = add i32 %m, 1
+  %pm = getelementptr inbounds i32, ptr %mid, i64 %i
+  store i32 %m1, ptr %pm
+  br label %latch1
+
+latch1:
+  %i.next = add nsw i64 %i, 1
+  br label %h1
+
+ph2:
+  br label %h2
+
+h2:
+  %j = phi i64 [ 0, %ph2 ], [ %j.next, %latch2 ]
+  %c2 = icmp slt i64 %j, %n
+  br i1 %c2, label %body2, label %exit
+
+body2:
+  %pm2 = getelementptr inbounds i32, ptr %mid, i64 %j
+  %v = load i32, ptr %pm2
+  %ps2 = getelementptr inbounds i32, ptr %src, i64 %j
+  %s2 = load i32, ptr %ps2
+  %d = sub i32 %v, %s2
+  %pd = getelementptr inbounds i32, ptr %dst, i64 %j
+  store i32 %d, ptr %pd
+  br label %latch2
+
+latch2:
+  %j.next = add nsw i64 %j, 1
+  br label %h2
+
+exit:
+  ret void
+}
+
+; x[i]=i%7-3, y[i]=z[i]=0
+define void @init() {
+entry:
+  br label %body
+
+body:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %body ]
+  %v = trunc i64 %i to i32
+  %r = urem i32 %v, 7
+  %r3 = sub i32 %r, 3
+  %px = getelementptr inbounds [40 x i32], ptr @x, i64 0, i64 %i
+  store i32 %r3, ptr %px
+  %py = getelementptr inbounds [40 x i32], ptr @y, i64 0, i64 %i
+  store i32 0, ptr %py
+  %pz = getelementptr inbounds [40 x i32], ptr @z, i64 0, i64 %i
+  store i32 0, ptr %pz
+  %i.next = add i64 %i, 1
+  %c = icmp slt i64 %i.next, 40
+  br i1 %c, label %body, label %exit
+
+exit:
+  ret void
+}
+
+; Somma pesata di un array di 40 elementi
+define i32 @checksum(ptr %p) {
+entry:
+  br label %body
+
+body:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %body ]
+  %s = phi i32 [ 0, %entry ], [ %s.next, %body ]
+  %q = getelementptr i32, ptr %p, i64 %i
+  %v = load i32, ptr %q
+  %s31 = mul i32 %s, 31
+  %s.next = add i32 %s31, %v
+  %i.next = add i64 %i, 1
+  %c = icmp slt i64 %i.next, 40
+  br i1 %c, label %body, label %exit
+
+exit:
+  ret i32 %s.next
+}
+
+declare i32 @printf(ptr, ...)
+
+define void @print(ptr %name, i64 %n) {
+  %x = call i32 @checksum(ptr @x)
+  %y = call i32 @checksum(ptr @y)
+  %z = call i32 @checksum(ptr @z)
+  %r = call i32 (ptr, ...) @printf(ptr @.fmt, ptr %name, i64 %n, i32 %x, i32 %y, i32 %z)
+  ret void
+}
+
+define i32 @main() {
+entry:
+  br label %loop
+
+loop:
+  %n = phi i64 [ 1, %entry ], [ %n.next, %loop ]
+  %n32 = trunc i64 %n to i32
+  %k = add i32 %n32, 2
+  call void @init()
+  call void @sweep(ptr @z, ptr @y, ptr @x, i64 %n, i32 %k)
+  call void @print(ptr @.disjoint, i64 %n)
+  call void @init()
+  %x1 = getelementptr inbounds [40 x i32], ptr @x, i64 0, i64 1
+  call void @sweep(ptr @z, ptr %x1, ptr @x, i64 %n, i32 %k)
+  call void @print(ptr @.shifted, i64 %n)
+  call void @init()
+  call void @sweep(ptr @x, ptr @y, ptr @x, i64 %n, i32 %k)
+  call void @print(ptr @.inplace, i64 %n)
+  ; mid=&y[n-1], dst=y: l'ultimo elemento di dst è il primo di mid
+  call void @init()
+  %last = getelementptr inbounds [40 x i32], ptr @y, i64 0, i64 %n
+  %mid = getelementptr inbounds i32, ptr %last, i64 -1
+  call void @sweep(ptr @y, ptr %mid, ptr @x, i64 %n, i32 %k)
+  call void @print(ptr @.touching, i64 %n)
+  %n.next = add i64 %n, 1
+  %done = icmp eq i64 %n.next, 20
+  br i1 %done, label %exit, label %loop
+
+exit:
+  ret i32 0
+}
@@ -0,0 +1,251 @@
+; ModuleID = 'Peeling.ll'
+source_filename = "Peeling.ll"
+target datalayout = "e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-i128:128-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-pc-linux-gnu"
+
+@A = global [16 x i32] zeroinitializer
+@B = global [16 x i32] [i32 5, i32 -3, i32 8, i32 -2147483648, i32 2147483647, i32 0, i32 1, i32 -1, i32 7, i32 9, i32 -11, i32 13, i32 100, i32 -100, i32 42, i32 3]
+@C = global [16 x i32] zeroinitializer
+@.fmt = private unnamed_addr constant [14 x i8] c"%s %d: %d %d\0A\00"
+@.prologue = private unnamed_addr constant [9 x i8] c"prologue\00"
+@.epilogue = private unnamed_addr constant [9 x i8] c"epilogue\00"
+@.toomany = private unnamed_addr constant [8 x i8] c"toomany\00"
+
+define void @prologue(i32 %k) {
+entry:
+  br label %h1.peel0
+
+h1.peel0:                                         ; preds = %entry
+  br label %body1.peel0
+
+body1.peel0:                                      ; preds = %h1.peel0
+  %pb.peel0 = getelementptr [16 x i32], ptr @B, i64 0, i64 0
+  %b.peel0 = load i32, ptr %pb.peel0, align 4
+  %a.peel0 = mul i32 %b.peel0, %k
+  %pa.peel0 = getelementptr [16 x i32], ptr @A, i64 0, i64 0
+  store i32 %a.peel0, ptr %pa.peel0, align 4
+  br label %latch1.peel0
+
+latch1.peel0:                                     ; preds = %body1.peel0
+  %i.next.peel0 = add nsw i64 0, 1
+  br label %h1.peel1
+
+h1.peel1:                                         ; preds = %latch1.peel0
+  br label %body1.peel1
+
+body1.peel1:                                      ; preds = %h1.peel1
+  %pb.peel1 = getelementptr [16 x i32], ptr @B, i64 0, i64 %i.next.peel0
+  %b.peel1 = load i32, ptr %pb.peel1, align 4
+  %a.peel1 = mul i32 %b.peel1, %k
+  %pa.peel1 = getelementptr [16 x i32], ptr @A, i64 0, i64 %i.next.peel0
+  store i32 %a.peel1, ptr %pa.peel1, align 4
+  br label %latch1.peel1
+
+latch1.peel1:                                     ; preds = %body1.peel1
+  %i.next.peel1 = add nsw i64 %i.next.peel0, 1
+  br label %h1
+
+h1:                                               ; preds = %latch2, %latch1.peel1
+  %i = phi i64 [ %i.next.peel1, %latch1.peel1 ], [ %i.next, %latch2 ]
+  %j = phi i64 [ 0, %latch1.peel1 ], [ %j.next, %latch2 ]
+  %c1 = icmp slt i64 %i, 10
+  br i1 %c1, label %body1, label %exit
+
+body1:                                            ; preds = %h1
+  %pb = getelementptr [16 x i32], ptr @B, i64 0, i64 %i
+  %b = load i32, ptr %pb, align 4
+  %a = mul i32 %b, %k
+  %pa = getelementptr [16 x i32], ptr @A, i64 0, i64 %i
+  store i32 %a, ptr %pa, align 4
+  br label %latch1
+
+latch1:                                           ; preds = %body1
+  %pa0 = getelementptr [16 x i32], ptr @A, i64 0, i64 %j
+  %a0 = load i32, ptr %pa0, align 4
+  %j1 = add nsw i64 %j, 1
+  %pa1 = getelementptr [16 x i32], ptr @A, i64 0, i64 %j1
+  %a1 = load i32, ptr %pa1, align 4
+  %s = add i32 %a0, %a1
+  %pc = getelementptr [16 x i32], ptr @C, i64 0, i64 %j
+  store i32 %s, ptr %pc, align 4
+  br label %latch2
+
+latch2:                                           ; preds = %latch1
+  %i.next = add nsw i64 %i, 1
+  %j.next = add nsw i64 %j, 1
+  br label %h1
+
+exit:                                             ; preds = %h1
+  ret void
+}
+
+define void @epilogue(i32 %k) {
+entry:
+  br label %h1
+
+h1:                                               ; preds = %latch2, %entry
+  %i = phi i64 [ 0, %entry ], [ %i.next, %latch2 ]
+  %c1 = icmp slt i64 %i, 8
+  br i1 %c1, label %body1, label %h2.peel0
+
+body1:                                            ; preds = %h1
+  %pb = getelementptr [16 x i32], ptr @B, i64 0, i64 %i
+  %b = load i32, ptr %pb, align 4
+  %a = add i32 %b, %k
+  %pa = getelementptr [16 x i32], ptr @A, i64 0, i64 %i
+  store i32 %a, ptr %pa, align 4
+  br label %latch1
+
+latch1:                                           ; preds = %body1
+  %pa0 = getelementptr [16 x i32], ptr @A, i64 0, i64 %i
+  %a0 = load i32, ptr %pa0, align 4
+  %m = mul i32 %a0, 3
+  %pc = getelementptr [16 x i32], ptr @C, i64 0, i64 %i
+  store i32 %m, ptr %pc, align 4
+  br label %latch2
+
+latch2:                                           ; preds = %latch1
+  %i.next = add nsw i64 %i, 1
+  br label %h1
+
+h2.peel0:                                         ; preds = %h1
+  br label %body2.peel0
+
+body2.peel0:                                      ; preds = %h2.peel0
+  %pa0.peel0 = getelementptr [16 x i32], ptr @A, i64 0, i64 %i
+  %a0.peel0 = load i32, ptr %pa0.peel0, align 4
+  %m.peel0 = mul i32 %a0.peel0, 3
+  %pc.peel0 = getelementptr [16 x i32], ptr @C, i64 0, i64 %i
+  store i32 %m.peel0, ptr %pc.peel0, align 4
+  br label %latch2.peel0
+
+latch2.peel0:                                     ; preds = %body2.peel0
+  %j.next.peel0 = add nsw i64 %i, 1
+  br label %h2.peel1
+
+h2.peel1:                                         ; preds = %latch2.peel0
+  br label %body2.peel1
+
+body2.peel1:                                      ; preds = %h2.peel1
+  %pa0.peel1 = getelementptr [16 x i32], ptr @A, i64 0, i64 %j.next.peel0
+  %a0.peel1 = load i32, ptr %pa0.peel1, align 4
+  %m.peel1 = mul i32 %a0.peel1, 3
+  %pc.peel1 = getelementptr [16 x i32], ptr @C, i64 0, i64 %j.next.peel0
+  store i32 %m.peel1, ptr %pc.peel1, align 4
+  br label %latch2.peel1
+
+latch2.peel1:                                     ; preds = %body2.peel1
+  %j.next.peel1 = add nsw i64 %j.next.peel0, 1
+  br label %h2.peel2
+
+h2.peel2:                                         ; preds = %latch2.peel1
+  br label %body2.peel2
+
+body2.peel2:                                      ; preds = %h2.peel2
+  %pa0.peel2 = getelementptr [16 x i32], ptr @A, i64 0, i64 %j.next.peel1
+  %a0.peel2 = load i32, ptr %pa0.peel2, align 4
+  %m.peel2 = mul i32 %a0.peel2, 3
+  %pc.peel2 = getelementptr [16 x i32], ptr @C, i64 0, i64 %j.next.peel1
+  store i32 %m.peel2, ptr %pc.peel2, align 4
+  br label %latch2.peel2
+
+latch2.peel2:                                     ; preds = %body2.peel2
+  %j.next.peel2 = add nsw i64 %j.next.peel1, 1
+  br label %exit
+
+exit:                                             ; preds = %latch2.peel2
+  ret void
+}
+
+define void @toomany(i32 %k) {
+entry:
+  br label %h1
+
+h1:                                               ; preds = %latch1, %entry
+  %i = phi i64 [ 0, %entry ], [ %i.next, %latch1 ]
+  %c1 = icmp slt i64 %i, 4
+  br i1 %c1, label %body1, label %ph2
+
+body1:                                            ; preds = %h1
+  %pb = getelementptr [16 x i32], ptr @B, i64 0, i64 %i
+  %b = load i32, ptr %pb, align 4
+  %a = sub i32 %b, %k
+  %pa = getelementptr [16 x i32], ptr @A, i64 0, i64 %i
+  store i32 %a, ptr %pa, align 4
+  br label %latch1
+
+latch1:                                           ; preds = %body1
+  %i.next = add nsw i64 %i, 1
+  br label %h1
+
+ph2:                                              ; preds = %h1
+  br label %h2
+
+h2:                                               ; preds = %latch2, %ph2
+  %j = phi i64 [ 0, %ph2 ], [ %j.next, %latch2 ]
+  %c2 = icmp slt i64 %j, 10
+  br i1 %c2, label %body2, label %exit
+
+body2:                                            ; preds = %h2
+  %pa0 = getelementptr [16 x i32], ptr @A, i64 0, i64 %j
+  %a0 = load i32, ptr %pa0, align 4
+  %x = xor i32 %a0, %k
+  %pc = getelementptr [16 x i32], ptr @C, i64 0, i64 %j
+  store i32 %x, ptr %pc, align 4
+  br label %latch2
+
+latch2:                                           ; preds = %body2
+  %j.next = add nsw i64 %j, 1
+  br label %h2
+
+exit:                                             ; preds = %h2
+  ret void
+}
+
+define i32 @checksum(ptr %p) {
+entry:
+  br label %body
+
+body:                                             ; preds = %body, %entry
+  %i = phi i64 [ 0, %entry ], [ %i.next, %body ]
+  %s = phi i32 [ 0, %entry ], [ %s.next, %body ]
+  %q = getelementptr i32, ptr %p, i64 %i
+  %v = load i32, ptr %q, align 4
+  %s31 = mul i32 %s, 31
+  %s.next = add i32 %s31, %v
+  %i.next = add i64 %i, 1
+  %c = icmp slt i64 %i.next, 16
+  br i1 %c, label %body, label %exit
+
+exit:                                             ; preds = %body
+  ret i32 %s.next
+}
+
+declare i32 @printf(ptr, ...)
+
+define void @print(ptr %name, i32 %k) {
+  %a = call i32 @checksum(ptr @A)
+  %c = call i32 @checksum(ptr @C)
+  %r = call i32 (ptr, ...) @printf(ptr @.fmt, ptr %name, i32 %k, i32 %a, i32 %c)
+  ret void
+}
+
+define i32 @main() {
+entry:
+  br label %loop
+
+loop:                                             ; preds = %loop, %entry
+  %k = phi i32 [ -3, %entry ], [ %k.next, %loop ]
+  call void @prologue(i32 %k)
+  call void @print(ptr @.prologue, i32 %k)
+  call void @epilogue(i32 %k)
+  call void @print(ptr @.epilogue, i32 %k)
+  call void @toomany(i32 %k)
+  call void @print(ptr @.toomany, i32 %k)
+  %k.next = add i32 %k, 1
+  %done = icmp eq i32 %k.next, 4
+  br i1 %done, label %exit, label %loop
+
+exit:                                             ; preds = %loop
+  ret i32 0
+}
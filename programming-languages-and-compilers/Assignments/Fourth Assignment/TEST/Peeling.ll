@@ -0,0 +1,207 @@
+; Fusione con trip count diversi (loopfusionpass): se Loop 1 itera due volte in più, le sue
+; prime iterazioni vengono staccate prima del loop fuso, che così può leggere A[i+1] già
+; scritto; se Loop 2 itera tre volte in più, le sue ultime iterazioni vengono staccate dopo.
+; Con una differenza maggiore di -loopfusionpass-max-peel i loop restano separati. I loop
+; hanno la forma di clang -O0 + mem2reg (header con l'uscita e latch separato):
+;   opt -load-pass-plugin <plugin> -passes=loopfusionpass Peeling.ll -S -o Peeling-res.ll
+;   lli Peeling.ll e lli Peeling-res.ll devono stampare le stesse righe
+target datalayout = "e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-i128:128-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-pc-linux-gnu"
+
+@A = global [16 x i32] zeroinitializer
+@B = global [16 x i32] [i32 5, i32 -3, i32 8, i32 -2147483648, i32 2147483647, i32 0, i32 1, i32 -1, i32 7, i32 9, i32 -11, i32 13, i32 100, i32 -100, i32 42, i32 3]
+@C = global [16 x i32] zeroinitializer
+@.fmt = private unnamed_addr constant [14 x i8] c"%s %d: %d %d\0A\00"
+@.prologue = private unnamed_addr constant [9 x i8] c"prologue\00"
+@.epilogue = private unnamed_addr constant [9 x i8] c"epilogue\00"
+@.toomany = private unnamed_addr constant [8 x i8] c"toomany\00"
+
+; for(i=0; i<10; i++) A[i]=B[i]*k;  for(i=0; i<8; i++) C[i]=A[i]+A[i+1];
+define void @prologue(i32 %k) {
+entry:
+  br label %h1
+
+h1:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %latch1 ]
+  %c1 = icmp slt i64 %i, 10
+  br i1 %c1, label %body1, label %ph2
+
+body1:
+  %pb = getelementptr [16 x i32], ptr @B, i64 0, i64 %i
+  %b = load i32, ptr %pb
+  %a = mul i32 %b, %k
+  %pa = getelementptr [16 x i32], ptr @A, i64 0, i64 %i
+  store i32 %a, ptr %pa
+  br label %latch1
+
+latch1:
+  %i.next = add nsw i64 %i, 1
+  br label %h1
+
+ph2:
+  br label %h2
+
+h2:
+  %j = phi i64 [ 0, %ph2 ], [ %j.next, %latch2 ]
+  %c2 = icmp slt i64 %j, 8
+  br i1 %c2, label %body2, label %exit
+
+body2:
+  %pa0 = getelementptr [16 x i32], ptr @A, i64 0, i64 %j
+  %a0 = load i32, ptr %pa0
+  %j1 = add nsw i64 %j, 1
+  %pa1 = getelementptr [16 x i32], ptr @A, i64 0, i64 %j1
+  %a1 = load i32, ptr %pa1
+  %s = add i32 %a0, %a1
+  %pc = getelementptr [16 x i32], ptr @C, i64 0, i64 %j
+  store i32 %s, ptr %pc
+  br label %latch2
+
+latch2:
+  %j.next = add nsw i64 %j, 1
+  br label %h2
+
+exit:
+  ret void
+}
+
+; for(i=0; i<8; i++) A[i]=B[i]+k;  for(i=0; i<11; i++) C[i]=A[i]*3;
+define void @epilogue(i32 %k) {
+entry:
+  br label %h1
+
+h1:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %latch1 ]
+  %c1 = icmp slt i64 %i, 8
+  br i1 %c1, label %body1, label %ph2
+
+body1:
+  %pb = getelementptr [16 x i32], ptr @B, i64 0, i64 %i
+  %b = load i32, ptr %pb
+  %a = add i32 %b, %k
+  %pa = getelementptr [16 x i32], ptr @A, i64 0, i64 %i
+  store i32 %a, ptr %pa
+  br label %latch1
+
+latch1:
+  %i.next = add nsw i64 %i, 1
+  br label %h1
+
+ph2:
+  br label %h2
+
+h2:
+  %j = phi i64 [ 0, %ph2 ], [ %j.next, %latch2 ]
+  %c2 = icmp slt i64 %j, 11
+  br i1 %c2, label %body2, label %exit
+
+body2:
+  %pa0 = getelementptr [16 x i32], ptr @A, i64 0, i64 %j
+  %a0 = load i32, ptr %pa0
+  %m = mul i32 %a0, 3
+  %pc = getelementptr [16 x i32], ptr @C, i64 0, i64 %j
+  store i32 %m, ptr %pc
+  br label %latch2
+
+latch2:
+  %j.next = add nsw i64 %j, 1
+  br label %h2
+
+exit:
+  ret void
+}
+
+; for(i=0; i<4; i++) A[i]=B[i]-k;  for(i=0; i<10; i++) C[i]=A[i]^k;
+define void @toomany(i32 %k) {
+entry:
+  br label %h1
+
+h1:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %latch1 ]
+  %c1 = icmp slt i64 %i, 4
+  br i1 %c1, label %body1, label %ph2
+
+body1:
+  %pb = getelementptr [16 x i32], ptr @B, i64 0, i64 %i
+  %b = load i32, ptr %pb
+  %a = sub i32 %b, %k
+  %pa = getelementptr [16 x i32], ptr @A, i64 0, i64 %i
+  store i32 %a, ptr %pa
+  br label %latch1
+
+latch1:
+  %i.next = add nsw i64 %i, 1
+  br label %h1
+
+ph2:
+  br label %h2
+
+h2:
+  %j = phi i64 [ 0, %ph2 ], [ %j.next, %latch2 ]
+  %c2 = icmp slt i64 %j, 10
+  br i1 %c2, label %body2, label %exit
+
+body2:
+  %pa0 = getelementptr [16 x i32], ptr @A, i64 0, i64 %j
+  %a0 = load i32, ptr %pa0
+  %x = xor i32 %a0, %k
+  %pc = getelementptr [16 x i32], ptr @C, i64 0, i64 %j
+  store i32 %x, ptr %pc
+  br label %latch2
+
+latch2:
+  %j.next = add nsw i64 %j, 1
+  br label %h2
+
+exit:
+  ret void
+}
+
+; Somma pesata di un array di 16 elementi
+define i32 @checksum(ptr %p) {
+entry:
+  br label %body
+
+body:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %body ]
+  %s = phi i32 [ 0, %entry ], [ %s.next, %body ]
+  %q = getelementptr i32, ptr %p, i64 %i
+  %v = load i32, ptr %q
+  %s31 = mul i32 %s, 31
+  %s.next = add i32 %s31, %v
+  %i.next = add i64 %i, 1
+  %c = icmp slt i64 %i.next, 16
+  br i1 %c, label %body, label %exit
+
+exit:
+  ret i32 %s.next
+}
+
+declare i32 @printf(ptr, ...)
+
+define void @print(ptr %name, i32 %k) {
+  %a = call i32 @checksum(ptr @A)
+  %c = call i32 @checksum(ptr @C)
+  %r = call i32 (ptr, ...) @printf(ptr @.fmt, ptr %name, i32 %k, i32 %a, i32 %c)
+  ret void
+}
+
+define i32 @main() {
+entry:
+  br label %loop
+
+loop:
+  %k = phi i32 [ -3, %entry ], [ %k.next, %loop ]
+  call void @prologue(i32 %k)
+  call void @print(ptr @.prologue, i32 %k)
+  call void @epilogue(i32 %k)
+  call void @print(ptr @.epilogue, i32 %k)
+  call void @toomany(i32 %k)
+  call void @print(ptr @.toomany, i32 %k)
+  %k.next = add i32 %k, 1
+  %done = icmp eq i32 %k.next, 4
+  br i1 %done, label %exit, label %loop
+
+exit:
+  ret i32 0
+}
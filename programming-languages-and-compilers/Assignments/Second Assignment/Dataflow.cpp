@@ -0,0 +1,706 @@
+/*
+######################################
+          SECONDO ASSIGNMENT
+######################################
+*/
+
+#include "llvm/Transforms/Utils/Dataflow.h"
+#include "llvm/Transforms/Utils/ExpressionKey.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/InstrTypes.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/ModuleSlotTracker.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/ADT/DepthFirstIterator.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/ValueTracking.h"
+#include "llvm/Analysis/OptimizationRemarkEmitter.h"
+#include "llvm/Transforms/Utils/BasicBlockUtils.h"
+#include "llvm/Transforms/Utils/SSAUpdater.h"
+
+using namespace llvm;
+
+AnalysisKey LivenessAnalysis::Key;
+AnalysisKey ReachingDefinitionsAnalysis::Key;
+AnalysisKey AvailableExpressionsAnalysis::Key;
+AnalysisKey VeryBusyExpressionsAnalysis::Key;
+
+/*
+------------------- Liveness -------------------
+  in[B]  = use[B] U (out[B] - def[B])
+  out[B] = U in[S] per ogni successore S, più gli
+           operandi dei PHI di S che arrivano da B
+------------------------------------------------
+*/
+struct LivenessProblem {
+  static constexpr DataflowDirection Direction=DataflowDirection::Backward;
+  static constexpr DataflowMeet Meet=DataflowMeet::Union;
+  static constexpr bool HasEdgeTransfer=true;
+  const LivenessInfo &Info;
+
+  unsigned getDomainSize() const { return Info.Values.size(); }
+  void getBoundary(BitVector &V) const {}
+
+  void getGenKill(const BasicBlock &BB, BitVector &Gen, BitVector &Kill) const {
+    for(const Instruction &I : BB){
+      if(not isa<PHINode>(I)){                                    // Gli usi nei PHI appartengono agli archi entranti
+        for(const Value *op : I.operands()){
+          auto found=Info.Index.find(op);
+          if(found!=Info.Index.end() and not Kill.test(found->second))
+            Gen.set(found->second);                               // Uso non preceduto dalla definizione nel blocco
+        }
+      }
+      auto found=Info.Index.find(&I);
+      if(found!=Info.Index.end())
+        Kill.set(found->second);
+    }
+  }
+
+  void transferEdge(const BasicBlock &From, const BasicBlock &To, BitVector &V) const {
+    for(const PHINode &phi : To.phis()){
+      auto found=Info.Index.find(phi.getIncomingValueForBlock(&From));
+      if(found!=Info.Index.end())
+        V.set(found->second);
+    }
+  }
+};
+
+bool LivenessInfo::isLiveIn(const Value *V, const BasicBlock *BB) const {
+  auto found=Index.find(V);
+  return found!=Index.end() and Result.getIn(BB).test(found->second);
+}
+
+bool LivenessInfo::isLiveOut(const Value *V, const BasicBlock *BB) const {
+  auto found=Index.find(V);
+  return found!=Index.end() and Result.getOut(BB).test(found->second);
+}
+
+bool LivenessInfo::isLiveOnEdge(const Value *V, const BasicBlock *From, const BasicBlock *To) const {
+  if(isLiveIn(V, To))
+    return true;
+  for(const PHINode &phi : To->phis())
+    if(phi.getIncomingValueForBlock(From)==V)
+      return true;
+  return false;
+}
+
+LivenessInfo llvm::computeLiveness(const Function &F){
+  LivenessInfo info;
+  for(const Argument &arg : F.args()){
+    info.Index[&arg]=info.Values.size();
+    info.Values.push_back(&arg);
+  }
+  for(const Instruction &I : instructions(F)){
+    if(I.getType()->isVoidTy())
+      continue;
+    info.Index[&I]=info.Values.size();
+    info.Values.push_back(&I);
+  }
+  info.Result=solveDataflow(F, LivenessProblem{info});
+  return info;
+}
+
+LivenessInfo LivenessAnalysis::run(Function &F, FunctionAnalysisManager &AM){
+  return computeLiveness(F);
+}
+
+/*
+------------------- Reaching Definitions -------------------
+  out[B] = gen[B] U (in[B] - kill[B])
+  in[B]  = U out[P] per ogni predecessore P
+------------------------------------------------------------
+*/
+struct ReachingDefinitionsProblem {
+  static constexpr DataflowDirection Direction=DataflowDirection::Forward;
+  static constexpr DataflowMeet Meet=DataflowMeet::Union;
+  static constexpr bool HasEdgeTransfer=false;
+  const ReachingDefinitionsInfo &Info;
+  DenseMap<const Value*,SmallVector<unsigned,4>> StoresTo;       // Store per puntatore
+
+  ReachingDefinitionsProblem(const ReachingDefinitionsInfo &Info) : Info(Info) {
+    for(unsigned d=0; d<Info.Defs.size(); d++)
+      if(const StoreInst *store=dyn_cast<StoreInst>(Info.Defs[d]))
+        StoresTo[store->getPointerOperand()].push_back(d);
+  }
+
+  unsigned getDomainSize() const { return Info.Defs.size(); }
+  void getBoundary(BitVector &V) const {}
+  void transferEdge(const BasicBlock &From, const BasicBlock &To, BitVector &V) const {}
+
+  void getGenKill(const BasicBlock &BB, BitVector &Gen, BitVector &Kill) const {
+    for(const Instruction &I : BB){
+      auto found=Info.Index.find(&I);
+      if(found==Info.Index.end())
+        continue;
+      if(const StoreInst *store=dyn_cast<StoreInst>(&I)){         // La store uccide le altre store allo stesso puntatore,
+        for(unsigned other : StoresTo.lookup(store->getPointerOperand())){
+          Kill.set(other);                                        // comprese quelle precedenti nel blocco
+          Gen.reset(other);
+        }
+        Kill.reset(found->second);
+      }
+      Gen.set(found->second);
+    }
+  }
+};
+
+bool ReachingDefinitionsInfo::reachesIn(const Instruction *Def, const BasicBlock *BB) const {
+  auto found=Index.find(Def);
+  return found!=Index.end() and Result.getIn(BB).test(found->second);
+}
+
+bool ReachingDefinitionsInfo::reachesOut(const Instruction *Def, const BasicBlock *BB) const {
+  auto found=Index.find(Def);
+  return found!=Index.end() and Result.getOut(BB).test(found->second);
+}
+
+ReachingDefinitionsInfo llvm::computeReachingDefinitions(const Function &F){
+  ReachingDefinitionsInfo info;
+  for(const Instruction &I : instructions(F)){
+    if(I.getType()->isVoidTy() and not isa<StoreInst>(I))
+      continue;
+    info.Index[&I]=info.Defs.size();
+    info.Defs.push_back(&I);
+  }
+  info.Result=solveDataflow(F, ReachingDefinitionsProblem(info));
+  return info;
+}
+
+ReachingDefinitionsInfo ReachingDefinitionsAnalysis::run(Function &F, FunctionAnalysisManager &AM){
+  return computeReachingDefinitions(F);
+}
+
+/*
+------------------- Dominio delle espressioni -------------------
+  Le espressioni sono identificate da ExpressionKey, la stessa chiave
+  usata dal local value numbering di LocalOpts
+-----------------------------------------------------------------
+*/
+bool ExpressionDomain::isCandidate(const Instruction *I){
+  return ExpressionKey::isCandidate(I);
+}
+
+void ExpressionDomain::build(const Function &F){
+  DenseMap<ExpressionKey,unsigned> keys;
+  for(const Instruction &I : instructions(F)){
+    if(not isCandidate(&I))
+      continue;
+    auto inserted=keys.insert({ExpressionKey::get(&I), (unsigned)Exprs.size()});
+    if(inserted.second)
+      Exprs.push_back(&I);
+    Index[&I]=inserted.first->second;
+  }
+}
+
+int ExpressionDomain::lookup(const Instruction *I) const {
+  auto found=Index.find(I);
+  return found==Index.end()?-1:(int)found->second;
+}
+
+/*
+  Espressioni uccise da ogni valore: quelle che lo usano come operando
+*/
+static DenseMap<const Value*,SmallVector<unsigned,4>> getExpressionUsers(const ExpressionDomain &D){
+  DenseMap<const Value*,SmallVector<unsigned,4>> users;
+  for(unsigned e=0; e<D.Exprs.size(); e++)
+    for(const Value *op : D.Exprs[e]->operands())
+      if(isa<Instruction>(op))                                    // Costanti e argomenti non vengono mai ridefiniti
+        users[op].push_back(e);
+  return users;
+}
+
+/*
+------------------- Available Expressions -------------------
+  out[B] = gen[B] U (in[B] - kill[B])
+  in[B]  = ∩ out[P] per ogni predecessore P, vuoto all'entry
+-------------------------------------------------------------
+*/
+struct AvailableExpressionsProblem {
+  static constexpr DataflowDirection Direction=DataflowDirection::Forward;
+  static constexpr DataflowMeet Meet=DataflowMeet::Intersection;
+  static constexpr bool HasEdgeTransfer=false;
+  const ExpressionDomain &Domain;
+  DenseMap<const Value*,SmallVector<unsigned,4>> Users;
+
+  AvailableExpressionsProblem(const ExpressionDomain &Domain) : Domain(Domain), Users(getExpressionUsers(Domain)) {}
+
+  unsigned getDomainSize() const { return Domain.Exprs.size(); }
+  void getBoundary(BitVector &V) const {}
+  void transferEdge(const BasicBlock &From, const BasicBlock &To, BitVector &V) const {}
+
+  void getGenKill(const BasicBlock &BB, BitVector &Gen, BitVector &Kill) const {
+    for(const Instruction &I : BB){
+      auto users=Users.find(&I);                                  // Ridefinire un operando uccide l'espressione,
+      if(users!=Users.end())
+        for(unsigned e : users->second){
+          Kill.set(e);
+          Gen.reset(e);
+        }
+      int e=Domain.lookup(&I);                                    // che torna disponibile se ricalcolata dopo
+      if(e>=0)
+        Gen.set(e);
+    }
+  }
+};
+
+bool AvailableExpressionsInfo::isAvailableIn(const Instruction *Expr, const BasicBlock *BB) const {
+  int e=Domain.lookup(Expr);
+  return e>=0 and Result.getIn(BB).test(e);
+}
+
+bool AvailableExpressionsInfo::isAvailableOut(const Instruction *Expr, const BasicBlock *BB) const {
+  int e=Domain.lookup(Expr);
+  return e>=0 and Result.getOut(BB).test(e);
+}
+
+AvailableExpressionsInfo llvm::computeAvailableExpressions(const Function &F){
+  AvailableExpressionsInfo info;
+  info.Domain.build(F);
+  info.Result=solveDataflow(F, AvailableExpressionsProblem(info.Domain));
+  return info;
+}
+
+AvailableExpressionsInfo AvailableExpressionsAnalysis::run(Function &F, FunctionAnalysisManager &AM){
+  return computeAvailableExpressions(F);
+}
+
+/*
+------------------- Very Busy Expressions -------------------
+  in[B]  = gen[B] U (out[B] - kill[B])
+  out[B] = ∩ in[S] per ogni successore S, vuoto all'uscita
+-------------------------------------------------------------
+*/
+struct VeryBusyExpressionsProblem {
+  static constexpr DataflowDirection Direction=DataflowDirection::Backward;
+  static constexpr DataflowMeet Meet=DataflowMeet::Intersection;
+  static constexpr bool HasEdgeTransfer=false;
+  const ExpressionDomain &Domain;
+  DenseMap<const Value*,SmallVector<unsigned,4>> Users;
+
+  VeryBusyExpressionsProblem(const ExpressionDomain &Domain) : Domain(Domain), Users(getExpressionUsers(Domain)) {}
+
+  unsigned getDomainSize() const { return Domain.Exprs.size(); }
+  void getBoundary(BitVector &V) const {}
+  void transferEdge(const BasicBlock &From, const BasicBlock &To, BitVector &V) const {}
+
+  void getGenKill(const BasicBlock &BB, BitVector &Gen, BitVector &Kill) const {
+    for(const Instruction &I : BB){
+      int e=Domain.lookup(&I);                                    // Calcolata prima che un suo operando venga ridefinito nel blocco
+      if(e>=0 and not Kill.test(e))
+        Gen.set(e);
+      auto users=Users.find(&I);
+      if(users!=Users.end())
+        for(unsigned e : users->second)
+          Kill.set(e);
+    }
+  }
+};
+
+bool VeryBusyExpressionsInfo::isVeryBusyIn(const Instruction *Expr, const BasicBlock *BB) const {
+  int e=Domain.lookup(Expr);
+  return e>=0 and Result.getIn(BB).test(e);
+}
+
+bool VeryBusyExpressionsInfo::isVeryBusyOut(const Instruction *Expr, const BasicBlock *BB) const {
+  int e=Domain.lookup(Expr);
+  return e>=0 and Result.getOut(BB).test(e);
+}
+
+VeryBusyExpressionsInfo llvm::computeVeryBusyExpressions(const Function &F){
+  VeryBusyExpressionsInfo info;
+  info.Domain.build(F);
+  info.Result=solveDataflow(F, VeryBusyExpressionsProblem(info.Domain));
+  return info;
+}
+
+VeryBusyExpressionsInfo VeryBusyExpressionsAnalysis::run(Function &F, FunctionAnalysisManager &AM){
+  return computeVeryBusyExpressions(F);
+}
+
+/*
+  I risultati dipendono dalle istruzioni, non solo dal CFG: restano validi
+  solo se il pass li preserva esplicitamente
+*/
+template <typename AnalysisT>
+static bool isInvalidated(const PreservedAnalyses &PA){
+  auto PAC=PA.getChecker<AnalysisT>();
+  return not (PAC.preserved() or PAC.template preservedSet<AllAnalysesOn<Function>>());
+}
+
+bool LivenessInfo::invalidate(Function &F, const PreservedAnalyses &PA, FunctionAnalysisManager::Invalidator &Inv){
+  return isInvalidated<LivenessAnalysis>(PA);
+}
+
+bool ReachingDefinitionsInfo::invalidate(Function &F, const PreservedAnalyses &PA, FunctionAnalysisManager::Invalidator &Inv){
+  return isInvalidated<ReachingDefinitionsAnalysis>(PA);
+}
+
+bool AvailableExpressionsInfo::invalidate(Function &F, const PreservedAnalyses &PA, FunctionAnalysisManager::Invalidator &Inv){
+  return isInvalidated<AvailableExpressionsAnalysis>(PA);
+}
+
+bool VeryBusyExpressionsInfo::invalidate(Function &F, const PreservedAnalyses &PA, FunctionAnalysisManager::Invalidator &Inv){
+  return isInvalidated<VeryBusyExpressionsAnalysis>(PA);
+}
+
+/*
+------------------- Stampa -------------------
+  Lo slot tracker numera una volta sola i valori senza nome della
+  funzione: printAsOperand senza tracker la rinumera a ogni chiamata
+*/
+template <typename T>
+static void printSet(raw_ostream &OS, ModuleSlotTracker &MST, const BitVector &set, const std::vector<T> &domain){
+  OS<<"{";
+  bool first=true;
+  for(unsigned b : set.set_bits()){
+    OS<<(first?" ":", ");
+    domain[b]->printAsOperand(OS, false, MST);
+    first=false;
+  }
+  OS<<" }";
+}
+
+static void printExpressions(raw_ostream &OS, ModuleSlotTracker &MST, const BitVector &set, const ExpressionDomain &D){
+  OS<<"{";
+  bool first=true;
+  for(unsigned b : set.set_bits()){
+    const Instruction *I=D.Exprs[b];
+    OS<<(first?" ":", ")<<I->getOpcodeName();
+    for(const Value *op : I->operands()){
+      OS<<" ";
+      op->printAsOperand(OS, false, MST);
+    }
+    first=false;
+  }
+  OS<<" }";
+}
+
+template <typename Info, typename PrintFn>
+static void printBlocks(raw_ostream &OS, const Function &F, const char *name, const Info &info, PrintFn printFn){
+  ModuleSlotTracker MST(F.getParent());
+  MST.incorporateFunction(F);
+  OS<<name<<" di '"<<F.getName()<<"' ("<<info.Result.Visits<<" visite):\n";
+  for(const BasicBlock &BB : F){
+    OS<<"  ";
+    BB.printAsOperand(OS, false, MST);
+    OS<<"\n    IN:  ";
+    printFn(MST, info.Result.getIn(&BB));
+    OS<<"\n    OUT: ";
+    printFn(MST, info.Result.getOut(&BB));
+    OS<<"\n";
+  }
+}
+
+void LivenessInfo::print(raw_ostream &OS, const Function &F) const {
+  printBlocks(OS, F, "Liveness", *this, [&](ModuleSlotTracker &MST, const BitVector &set){ printSet(OS, MST, set, Values); });
+}
+
+void ReachingDefinitionsInfo::print(raw_ostream &OS, const Function &F) const {
+  printBlocks(OS, F, "Reaching definitions", *this, [&](ModuleSlotTracker &MST, const BitVector &set){
+    OS<<"{";
+    bool first=true;
+    for(unsigned b : set.set_bits()){                             // Le store non hanno nome: le stampo per intero
+      OS<<(first?" ":", ");
+      if(Defs[b]->getType()->isVoidTy()){
+        OS<<"[";
+        Defs[b]->print(OS, MST);
+        OS<<" ]";
+      }else{
+        Defs[b]->printAsOperand(OS, false, MST);
+      }
+      first=false;
+    }
+    OS<<" }";
+  });
+}
+
+void AvailableExpressionsInfo::print(raw_ostream &OS, const Function &F) const {
+  printBlocks(OS, F, "Available expressions", *this, [&](ModuleSlotTracker &MST, const BitVector &set){
+    printExpressions(OS, MST, set, Domain);
+  });
+}
+
+void VeryBusyExpressionsInfo::print(raw_ostream &OS, const Function &F) const {
+  printBlocks(OS, F, "Very busy expressions", *this, [&](ModuleSlotTracker &MST, const BitVector &set){
+    printExpressions(OS, MST, set, Domain);
+  });
+}
+
+PreservedAnalyses DataflowPrinterPass::run(Function &F, FunctionAnalysisManager &AM){
+  if(F.isDeclaration())
+    return PreservedAnalyses::all();
+  AM.getResult<LivenessAnalysis>(F).print(OS, F);
+  AM.getResult<ReachingDefinitionsAnalysis>(F).print(OS, F);
+  AM.getResult<AvailableExpressionsAnalysis>(F).print(OS, F);
+  AM.getResult<VeryBusyExpressionsAnalysis>(F).print(OS, F);
+  return PreservedAnalyses::all();
+}
+
+/*
+------------------- Lazy Code Motion -------------------
+  Partial redundancy elimination nella formulazione sugli archi, a
+  partire da available (avout) e very busy expressions (antin, antout).
+  antloc[B] = espressioni calcolate in B prima che un loro operando venga
+  definito (il gen delle very busy), kill[B] = espressioni con un
+  operando definito in B:
+
+  earliest(P,S) = antin[S] ∩ ¬avout[P] ∩ (kill[P] ∪ ¬antout[P])
+  later(P,S)    = earliest(P,S) ∪ (laterin[P] - antloc[P])
+  laterin[S]    = ∩ later(P,S) per ogni predecessore P, antin all'entry
+  insert(P,S)   = later(P,S) - laterin[S]
+  delete[B]     = antloc[B] - laterin[B]
+
+  Il calcolo viene inserito il più tardi possibile tra i punti in cui è
+  anticipabile su ogni cammino: nessun cammino calcola l'espressione più
+  volte di prima e il valore non vive più a lungo del necessario
+--------------------------------------------------------
+*/
+#define DEBUG_TYPE "lazycodemotion"
+
+STATISTIC(NumLCMInserted, "Numero di calcoli inseriti dalla lazy code motion");
+STATISTIC(NumLCMDeleted, "Numero di calcoli ridondanti eliminati dalla lazy code motion");
+STATISTIC(NumLCMSplitEdges, "Numero di archi critici spezzati per inserire un calcolo");
+STATISTIC(NumLCMNotPlaced, "Numero di espressioni lasciate al loro posto perché un arco non si può spezzare");
+
+/*
+  Con l'opzione disattivata il pass non modifica il CFG: le espressioni
+  che andrebbero inserite su un arco critico restano dove sono
+*/
+static cl::opt<bool> SplitEdges("lazycodemotion-split-edges", cl::init(true), cl::Hidden,
+                                cl::desc("Spezza gli archi critici su cui la lazy code motion inserisce un calcolo"));
+
+struct LocalExpressions {
+  BitVector AntLoc;
+  BitVector Kill;
+};
+
+struct LaterProblem {
+  static constexpr DataflowDirection Direction=DataflowDirection::Forward;
+  static constexpr DataflowMeet Meet=DataflowMeet::Intersection;
+  static constexpr bool HasEdgeTransfer=true;
+  const DataflowResult &Available;
+  const DataflowResult &Anticipated;
+  const DenseMap<const BasicBlock*,LocalExpressions> &Local;
+  const SmallPtrSetImpl<const BasicBlock*> &Reachable;
+  const BitVector &Candidates;
+  const BasicBlock &Entry;
+
+  unsigned getDomainSize() const { return Candidates.size(); }
+
+  void getBoundary(BitVector &V) const {                          // Sull'arco d'ingresso della funzione earliest = antin[entry]
+    V=Anticipated.getIn(&Entry);
+    V&=Candidates;
+  }
+
+  void getGenKill(const BasicBlock &BB, BitVector &Gen, BitVector &Kill) const {
+    Kill=Local.find(&BB)->second.AntLoc;
+  }
+
+  mutable BitVector Earliest, Stop;                               // Vettori di appoggio, per non allocare a ogni arco
+
+  void earliest(const BasicBlock &From, const BasicBlock &To, BitVector &E) const {
+    E=Anticipated.getIn(&To);
+    E.reset(Available.getOut(&From));
+    Stop=Anticipated.getOut(&From);                               // Più in alto di From non è anticipabile, o un operando nasce in From
+    Stop.flip();
+    Stop|=Local.find(&From)->second.Kill;
+    E&=Stop;
+    E&=Candidates;
+  }
+
+  void transferEdge(const BasicBlock &From, const BasicBlock &To, BitVector &V) const {
+    if(not Reachable.count(&From)){                               // Gli archi da blocchi irraggiungibili non vincolano il meet
+      V.set();
+      return;
+    }
+    earliest(From, To, Earliest);
+    V|=Earliest;
+  }
+};
+
+/*
+  Un arco su cui inserire: il calcolo va in fondo a From se ha S come
+  unico successore, altrimenti in un blocco nuovo che spezza l'arco
+*/
+struct InsertionEdge {
+  BasicBlock *From;
+  BasicBlock *To;
+  BitVector Insert;
+  BasicBlock *Block=nullptr;
+};
+
+static bool canSplitEdge(const BasicBlock *From, const BasicBlock *To){
+  const Instruction *term=From->getTerminator();
+  return not isa<IndirectBrInst>(term) and not isa<CallBrInst>(term) and not To->isEHPad();
+}
+
+PreservedAnalyses LazyCodeMotionPass::run(Function &F, FunctionAnalysisManager &AM){
+  if(F.isDeclaration())
+    return PreservedAnalyses::all();
+  const AvailableExpressionsInfo &AV=AM.getResult<AvailableExpressionsAnalysis>(F);
+  const VeryBusyExpressionsInfo &ANT=AM.getResult<VeryBusyExpressionsAnalysis>(F);
+  OptimizationRemarkEmitter &ORE=AM.getResult<OptimizationRemarkEmitterAnalysis>(F);
+  const ExpressionDomain &D=AV.Domain;                            // Costruiti allo stesso modo: gli indici coincidono
+  unsigned size=D.Exprs.size();
+  assert(ANT.Domain.Exprs.size()==size and "Domini delle espressioni diversi");
+  if(size==0)
+    return PreservedAnalyses::all();
+
+  SmallPtrSet<const BasicBlock*,32> reachable;
+  for(const BasicBlock *BB : depth_first(&F.getEntryBlock()))
+    reachable.insert(BB);
+
+  BitVector candidates(size);                                     // Anticipabile non basta: un blocco intermedio potrebbe non terminare
+  for(unsigned e=0; e<size; e++)
+    if(isSafeToSpeculativelyExecute(D.Exprs[e]))
+      candidates.set(e);
+
+  DenseMap<const BasicBlock*,LocalExpressions> local;
+  VeryBusyExpressionsProblem transfer(D);
+  for(const BasicBlock &BB : F){
+    LocalExpressions sets{BitVector(size), BitVector(size)};
+    transfer.getGenKill(BB, sets.AntLoc, sets.Kill);
+    local[&BB]=std::move(sets);
+  }
+
+  LaterProblem later{AV.Result, ANT.Result, local, reachable, candidates, F.getEntryBlock()};
+  DataflowResult laterIn=solveDataflow(F, later);
+
+  std::vector<InsertionEdge> edges;                               // insert(P,S) != ∅, archi raggiungibili
+  BitVector moved(size), notPlaced(size);
+  for(BasicBlock &BB : F){
+    if(not reachable.count(&BB))
+      continue;
+    SmallPtrSet<BasicBlock*,4> seen;                              // Archi multipli verso lo stesso successore (switch) contano una volta
+    for(BasicBlock *succ : successors(&BB)){
+      if(not seen.insert(succ).second)
+        continue;
+      BitVector insert=laterIn.getOut(&BB);
+      later.transferEdge(BB, *succ, insert);
+      insert.reset(laterIn.getIn(succ));
+      if(insert.none())
+        continue;
+      if(not BB.getUniqueSuccessor() and (not SplitEdges or not canSplitEdge(&BB, succ)))
+        notPlaced|=insert;
+      moved|=insert;
+      edges.push_back({&BB, succ, std::move(insert)});
+    }
+  }
+  DenseMap<const BasicBlock*,BitVector> deleted;                 // delete[B], solo dove non è vuoto
+  for(const BasicBlock &BB : F){
+    if(not reachable.count(&BB))
+      continue;
+    BitVector del=local.find(&BB)->second.AntLoc;
+    del.reset(laterIn.getIn(&BB));
+    del&=candidates;
+    if(del.none())
+      continue;
+    moved|=del;
+    deleted[&BB]=std::move(del);
+  }
+  moved.reset(notPlaced);
+
+  std::vector<SmallVector<Instruction*,4>> occurrences(size);     // Calcoli di ogni espressione spostata, in ordine di programma
+  for(Instruction &I : instructions(F)){
+    int e=D.lookup(&I);
+    if(e>=0 and moved.test(e))
+      occurrences[e].push_back(&I);
+  }
+  for(unsigned e : notPlaced.set_bits()){
+    ++NumLCMNotPlaced;
+    ORE.emit([&](){
+      return OptimizationRemarkMissed(DEBUG_TYPE, "CriticalEdge", D.Exprs[e])
+             <<"Espressione parzialmente ridondante non spostata: un arco critico non si può spezzare";
+    });
+  }
+  if(moved.none())
+    return PreservedAnalyses::all();
+
+  bool split=false;
+  for(InsertionEdge &edge : edges){
+    edge.Insert&=moved;
+    if(edge.Insert.none())
+      continue;
+    if(edge.From->getUniqueSuccessor()){
+      edge.Block=edge.From;
+    }else{
+      edge.Block=SplitCriticalEdge(edge.From, edge.To, CriticalEdgeSplittingOptions().setMergeIdenticalEdges());
+      assert(edge.Block and "Arco critico non spezzato");
+      ++NumLCMSplitEdges;
+      split=true;
+    }
+  }
+
+  for(unsigned e : moved.set_bits()){
+    SmallVector<Instruction*,4> &occ=occurrences[e];
+    Instruction *proto=occ.front();
+    for(Instruction *I : drop_begin(occ))                         // I flag (nsw, exact, inbounds...) validi per tutti i calcoli
+      proto->andIRFlags(I);
+
+    SSAUpdater SSA;
+    SSA.Initialize(proto->getType(), proto->getName());
+    unsigned inserted=0, removed=0;
+    for(InsertionEdge &edge : edges){
+      if(not edge.Insert.test(e))
+        continue;
+      Instruction *clone=proto->clone();
+      clone->setName(proto->getName()+".pre");
+      clone->insertBefore(edge.Block->getTerminator());
+      SSA.AddAvailableValue(edge.Block, clone);
+      inserted++;
+    }
+
+    SmallVector<std::pair<Instruction*,unsigned>,4> blocks;       // Primo calcolo di ogni blocco e numero di calcoli nel blocco
+    for(unsigned i=0; i<occ.size(); i++){
+      if(i>0 and occ[i]->getParent()==occ[i-1]->getParent()){
+        blocks.back().second++;
+        continue;
+      }
+      blocks.push_back({occ[i], 1});
+    }
+    auto isDeleted=[&](BasicBlock *BB){
+      auto del=deleted.find(BB);
+      return del!=deleted.end() and del->second.test(e);
+    };
+    for(auto &block : blocks){                                    // Nei blocchi che restano il primo calcolo rende disponibile il valore
+      if(isDeleted(block.first->getParent()))
+        continue;
+      block.first->copyIRFlags(proto);
+      SSA.AddAvailableValue(block.first->getParent(), block.first);
+    }
+
+    ORE.emit([&](){
+      unsigned deletions=0;
+      for(auto &block : blocks)
+        deletions+=isDeleted(block.first->getParent())?block.second:block.second-1;
+      return OptimizationRemark(DEBUG_TYPE, inserted?"PartiallyRedundant":"FullyRedundant", proto)
+             <<"Espressione spostata: "<<ore::NV("Inserted", inserted)<<" calcoli inseriti, "
+             <<ore::NV("Deleted", deletions)<<" eliminati";
+    });
+
+    unsigned i=0;
+    for(auto &block : blocks){
+      Instruction *first=block.first;
+      Value *value=first;
+      if(isDeleted(first->getParent()))
+        value=SSA.GetValueInMiddleOfBlock(first->getParent());
+      for(unsigned j=i; j<i+block.second; j++){
+        if(occ[j]==value)
+          continue;
+        occ[j]->replaceAllUsesWith(value);
+        occ[j]->eraseFromParent();
+        removed++;
+      }
+      i+=block.second;
+    }
+    NumLCMInserted+=inserted;
+    NumLCMDeleted+=removed;
+  }
+
+  if(split)
+    return PreservedAnalyses::none();
+  PreservedAnalyses PA;
+  PA.preserveSet<CFGAnalyses>();
+  return PA;
+}
@@ -0,0 +1,280 @@
+#ifndef LLVM_TRANSFORMS_DATAFLOW_H
+#define LLVM_TRANSFORMS_DATAFLOW_H
+#include "llvm/IR/PassManager.h"
+#include "llvm/IR/CFG.h"
+#include "llvm/IR/Function.h"
+#include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/PostOrderIterator.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include <algorithm>
+#include <vector>
+
+namespace llvm {
+  class raw_ostream;
+
+  enum class DataflowDirection { Forward, Backward };
+  enum class DataflowMeet { Union, Intersection };
+
+  /*
+    Soluzione di un problema di dataflow: un vettore di bit (uno per elemento
+    del dominio) all'ingresso e all'uscita di ogni blocco
+  */
+  struct DataflowResult {
+    DenseMap<const BasicBlock*,unsigned> BlockIndex;
+    std::vector<BitVector> In;
+    std::vector<BitVector> Out;
+    unsigned Visits=0;                                            // Blocchi visitati prima del punto fisso
+
+    const BitVector &getIn(const BasicBlock *BB) const { return In[BlockIndex.lookup(BB)]; }
+    const BitVector &getOut(const BasicBlock *BB) const { return Out[BlockIndex.lookup(BB)]; }
+  };
+
+  /*
+    Motore generico per i problemi di dataflow su vettori di bit. Il
+    problema (parametro Problem) fornisce direzione, operatore di meet e
+    funzione di trasferimento di ogni blocco nella forma gen/kill:
+
+      static constexpr DataflowDirection Direction;
+      static constexpr DataflowMeet Meet;
+      static constexpr bool HasEdgeTransfer;
+      unsigned getDomainSize() const;
+      void getBoundary(BitVector &V) const;
+      void getGenKill(const BasicBlock &BB, BitVector &Gen, BitVector &Kill) const;
+      void transferEdge(const BasicBlock &From, const BasicBlock &To, BitVector &V) const;
+
+    getBoundary dà il valore all'entry (in avanti) o all'uscita dei blocchi
+    senza successori (all'indietro). transferEdge, usata solo se
+    HasEdgeTransfer, modifica il valore che attraversa un arco prima del
+    meet (per esempio gli usi dei PHI nella liveness).
+
+    I blocchi vengono visitati in reverse post-order (in avanti) o in
+    post-order (all'indietro), ripartendo ogni volta dal primo blocco il cui
+    ingresso è cambiato: in un CFG riducibile servono pochi giri anche per
+    funzioni con decine di migliaia di istruzioni
+  */
+  template <typename Problem>
+  DataflowResult solveDataflow(const Function &F, const Problem &P){
+    constexpr bool forward=Problem::Direction==DataflowDirection::Forward;
+    constexpr bool intersection=Problem::Meet==DataflowMeet::Intersection;
+    DataflowResult R;
+    if(F.isDeclaration())
+      return R;
+    unsigned size=P.getDomainSize();
+
+    std::vector<const BasicBlock*> order;                         // Ordine di visita
+    for(const BasicBlock *BB : ReversePostOrderTraversal<const Function*>(&F))
+      order.push_back(BB);
+    if(not forward)
+      std::reverse(order.begin(), order.end());
+    if(order.size()!=F.size()){                                   // I blocchi irraggiungibili vanno in fondo
+      SmallPtrSet<const BasicBlock*,32> reached(order.begin(), order.end());
+      for(const BasicBlock &BB : F)
+        if(not reached.count(&BB))
+          order.push_back(&BB);
+    }
+    unsigned n=order.size();
+    for(unsigned i=0; i<n; i++)
+      R.BlockIndex[order[i]]=i;
+
+    std::vector<BitVector> gen(n, BitVector(size)), kill(n, BitVector(size));
+    for(unsigned i=0; i<n; i++)
+      P.getGenKill(*order[i], gen[i], kill[i]);
+    R.In.assign(n, BitVector(size, intersection));                // Valore iniziale: il top del reticolo
+    R.Out.assign(n, BitVector(size, intersection));
+    BitVector boundary(size);
+    P.getBoundary(boundary);
+
+    BitVector dirty(n, true);                                     // Blocchi da (ri)visitare
+    BitVector meet(size), edge(size), result(size);
+    for(int i=dirty.find_first(); i!=-1; i=dirty.find_first()){
+      for(; i!=-1; i=dirty.find_next(i)){                         // Un giro in ordine sui blocchi da visitare
+        dirty.reset(i);
+        R.Visits++;
+        const BasicBlock *BB=order[i];
+        bool first=true;
+        auto join=[&](const BasicBlock *From, const BasicBlock *To, const BitVector &V){
+          const BitVector *val=&V;
+          if(Problem::HasEdgeTransfer){
+            edge=V;
+            P.transferEdge(*From, *To, edge);
+            val=&edge;
+          }
+          if(first)
+            meet=*val;
+          else if(intersection)
+            meet&=*val;
+          else
+            meet|=*val;
+          first=false;
+        };
+        if(forward){
+          for(const BasicBlock *pred : predecessors(BB))
+            join(pred, BB, R.Out[R.BlockIndex[pred]]);
+        }else{
+          for(const BasicBlock *succ : successors(BB))
+            join(BB, succ, R.In[R.BlockIndex[succ]]);
+        }
+        if(first)                                                 // Entry, o blocco senza successori all'indietro
+          meet=boundary;
+
+        result=meet;                                              // Trasferimento: gen U (meet - kill)
+        result.reset(kill[i]);
+        result|=gen[i];
+        (forward?R.In[i]:R.Out[i])=meet;
+        BitVector &output=forward?R.Out[i]:R.In[i];
+        if(result==output)
+          continue;
+        output=result;
+        if(forward){
+          for(const BasicBlock *succ : successors(BB))
+            dirty.set(R.BlockIndex[succ]);
+        }else{
+          for(const BasicBlock *pred : predecessors(BB))
+            dirty.set(R.BlockIndex[pred]);
+        }
+      }
+    }
+    return R;
+  }
+
+  /*
+    Liveness (all'indietro, unione): dominio = argomenti e istruzioni con un
+    valore. Gli usi nei PHI sono vivi solo sull'arco dal blocco entrante
+  */
+  class LivenessInfo {
+    public:
+      std::vector<const Value*> Values;
+      DenseMap<const Value*,unsigned> Index;
+      DataflowResult Result;
+
+      bool isLiveIn(const Value *V, const BasicBlock *BB) const;
+      bool isLiveOut(const Value *V, const BasicBlock *BB) const;
+      bool isLiveOnEdge(const Value *V, const BasicBlock *From, const BasicBlock *To) const;
+      void print(raw_ostream &OS, const Function &F) const;
+      bool invalidate(Function &F, const PreservedAnalyses &PA, FunctionAnalysisManager::Invalidator &Inv);
+  };
+
+  /*
+    Reaching definitions (in avanti, unione): dominio = istruzioni con un
+    valore e store. In SSA i valori non vengono mai ridefiniti, mentre una
+    store uccide le altre store allo stesso puntatore
+  */
+  class ReachingDefinitionsInfo {
+    public:
+      std::vector<const Instruction*> Defs;
+      DenseMap<const Instruction*,unsigned> Index;
+      DataflowResult Result;
+
+      bool reachesIn(const Instruction *Def, const BasicBlock *BB) const;
+      bool reachesOut(const Instruction *Def, const BasicBlock *BB) const;
+      void print(raw_ostream &OS, const Function &F) const;
+      bool invalidate(Function &F, const PreservedAnalyses &PA, FunctionAnalysisManager::Invalidator &Inv);
+  };
+
+  /*
+    Espressioni (operazioni senza effetti collaterali che non leggono
+    memoria) numerate a meno della commutatività: istruzioni uguali hanno lo
+    stesso indice, e Exprs contiene la prima occorrenza di ogni espressione
+  */
+  class ExpressionDomain {
+    public:
+      std::vector<const Instruction*> Exprs;
+      DenseMap<const Instruction*,unsigned> Index;
+
+      static bool isCandidate(const Instruction *I);
+      void build(const Function &F);
+      int lookup(const Instruction *I) const;
+  };
+
+  /*
+    Available expressions (in avanti, intersezione) e very busy expressions
+    (all'indietro, intersezione) sullo stesso dominio di espressioni.
+    Un'espressione è uccisa nei blocchi che definiscono uno dei suoi operandi
+  */
+  class AvailableExpressionsInfo {
+    public:
+      ExpressionDomain Domain;
+      DataflowResult Result;
+
+      bool isAvailableIn(const Instruction *Expr, const BasicBlock *BB) const;
+      bool isAvailableOut(const Instruction *Expr, const BasicBlock *BB) const;
+      void print(raw_ostream &OS, const Function &F) const;
+      bool invalidate(Function &F, const PreservedAnalyses &PA, FunctionAnalysisManager::Invalidator &Inv);
+  };
+
+  class VeryBusyExpressionsInfo {
+    public:
+      ExpressionDomain Domain;
+      DataflowResult Result;
+
+      bool isVeryBusyIn(const Instruction *Expr, const BasicBlock *BB) const;
+      bool isVeryBusyOut(const Instruction *Expr, const BasicBlock *BB) const;
+      void print(raw_ostream &OS, const Function &F) const;
+      bool invalidate(Function &F, const PreservedAnalyses &PA, FunctionAnalysisManager::Invalidator &Inv);
+  };
+
+  /*
+    Calcolo diretto, per i pass che non possono chiedere le analisi al
+    FunctionAnalysisManager (es. i pass di loop, che vedono solo i
+    risultati di funzione già in cache e mai invalidabili)
+  */
+  LivenessInfo computeLiveness(const Function &F);
+  ReachingDefinitionsInfo computeReachingDefinitions(const Function &F);
+  AvailableExpressionsInfo computeAvailableExpressions(const Function &F);
+  VeryBusyExpressionsInfo computeVeryBusyExpressions(const Function &F);
+
+  class LivenessAnalysis : public AnalysisInfoMixin<LivenessAnalysis> {
+    friend AnalysisInfoMixin<LivenessAnalysis>;
+    static AnalysisKey Key;
+    public:
+      using Result=LivenessInfo;
+      Result run(Function &F, FunctionAnalysisManager &AM);
+  };
+
+  class ReachingDefinitionsAnalysis : public AnalysisInfoMixin<ReachingDefinitionsAnalysis> {
+    friend AnalysisInfoMixin<ReachingDefinitionsAnalysis>;
+    static AnalysisKey Key;
+    public:
+      using Result=ReachingDefinitionsInfo;
+      Result run(Function &F, FunctionAnalysisManager &AM);
+  };
+
+  class AvailableExpressionsAnalysis : public AnalysisInfoMixin<AvailableExpressionsAnalysis> {
+    friend AnalysisInfoMixin<AvailableExpressionsAnalysis>;
+    static AnalysisKey Key;
+    public:
+      using Result=AvailableExpressionsInfo;
+      Result run(Function &F, FunctionAnalysisManager &AM);
+  };
+
+  class VeryBusyExpressionsAnalysis : public AnalysisInfoMixin<VeryBusyExpressionsAnalysis> {
+    friend AnalysisInfoMixin<VeryBusyExpressionsAnalysis>;
+    static AnalysisKey Key;
+    public:
+      using Result=VeryBusyExpressionsInfo;
+      Result run(Function &F, FunctionAnalysisManager &AM);
+  };
+
+  /*
+    Stampa IN e OUT di ogni blocco per le quattro analisi
+  */
+  class DataflowPrinterPass : public PassInfoMixin<DataflowPrinterPass> {
+    raw_ostream &OS;
+    public:
+      explicit DataflowPrinterPass(raw_ostream &OS) : OS(OS) {}
+      PreservedAnalyses run(Function &F, FunctionAnalysisManager &AM);
+  };
+
+  /*
+    Partial redundancy elimination con la lazy code motion: sposta i
+    calcoli delle espressioni nei punti più tardivi in cui sono disponibili
+    su ogni cammino ed elimina quelli ridondanti, spezzando gli archi
+    critici dove serve inserire un calcolo
+  */
+  class LazyCodeMotionPass : public PassInfoMixin<LazyCodeMotionPass> {
+    public:
+      PreservedAnalyses run(Function &F, FunctionAnalysisManager &AM);
+  };
+}
+#endif
@@ -0,0 +1,144 @@
+; ModuleID = 'LCM.ll'
+source_filename = "LCM.ll"
+target datalayout = "e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-i128:128-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-pc-linux-gnu"
+
+@.fmt = private unnamed_addr constant [14 x i8] c"%s %d %d: %d\0A\00"
+@.diamond = private unnamed_addr constant [8 x i8] c"diamond\00"
+@.dowhile = private unnamed_addr constant [8 x i8] c"dowhile\00"
+@.critical = private unnamed_addr constant [9 x i8] c"critical\00"
+@.killed = private unnamed_addr constant [7 x i8] c"killed\00"
+@.guarded = private unnamed_addr constant [8 x i8] c"guarded\00"
+
+define i32 @diamond(i32 %a, i32 %b) {
+entry:
+  %c = icmp sgt i32 %a, %b
+  br i1 %c, label %then, label %else
+
+then:                                             ; preds = %entry
+  %m1 = mul i32 %a, %b
+  br label %join
+
+else:                                             ; preds = %entry
+  %m1.pre = mul i32 %a, %b
+  br label %join
+
+join:                                             ; preds = %else, %then
+  %m11 = phi i32 [ %m1, %then ], [ %m1.pre, %else ]
+  %x = phi i32 [ %m1, %then ], [ 0, %else ]
+  %r = add i32 %x, %m11
+  ret i32 %r
+}
+
+define i32 @dowhile(i32 %a, i32 %b) {
+entry:
+  %d.pre = sub i32 %a, %b
+  br label %body
+
+body:                                             ; preds = %body, %entry
+  %i = phi i32 [ 0, %entry ], [ %i.next, %body ]
+  %s = phi i32 [ 0, %entry ], [ %s.next, %body ]
+  %s.next = add i32 %s, %d.pre
+  %i.next = add i32 %i, 1
+  %c = icmp slt i32 %i.next, 8
+  br i1 %c, label %body, label %exit
+
+exit:                                             ; preds = %body
+  ret i32 %s.next
+}
+
+define i32 @critical(i32 %a, i32 %b) {
+entry:
+  %c = icmp slt i32 %a, 0
+  br i1 %c, label %then, label %entry.join_crit_edge
+
+entry.join_crit_edge:                             ; preds = %entry
+  %t.pre = add i32 %a, %b
+  br label %join
+
+then:                                             ; preds = %entry
+  %t = add i32 %a, %b
+  %u = shl i32 %t, 1
+  br label %join
+
+join:                                             ; preds = %entry.join_crit_edge, %then
+  %t1 = phi i32 [ %t, %then ], [ %t.pre, %entry.join_crit_edge ]
+  %x = phi i32 [ %u, %then ], [ %b, %entry.join_crit_edge ]
+  %r = xor i32 %x, %t1
+  ret i32 %r
+}
+
+define i32 @killed(i32 %a, i32 %b) {
+entry:
+  br label %body
+
+body:                                             ; preds = %body, %entry
+  %j = phi i32 [ %b, %entry ], [ %j.next, %body ]
+  %s = phi i32 [ 0, %entry ], [ %s.next, %body ]
+  %p = mul i32 %a, %j
+  %s.next = add i32 %s, %p
+  %j.next = add i32 %j, 1
+  %c = icmp slt i32 %j.next, 10
+  br i1 %c, label %body, label %exit
+
+exit:                                             ; preds = %body
+  %q = mul i32 %a, %j.next
+  %r = sub i32 %s.next, %q
+  ret i32 %r
+}
+
+define i32 @guarded(i32 %a, i32 %b) {
+entry:
+  %z = icmp eq i32 %b, 0
+  br i1 %z, label %zero, label %div
+
+div:                                              ; preds = %entry
+  %q1 = sdiv i32 %a, %b
+  %c = icmp sgt i32 %q1, 1
+  br i1 %c, label %big, label %join
+
+big:                                              ; preds = %div
+  %q2 = sdiv i32 %a, %b
+  %q3 = add i32 %q2, 100
+  br label %join
+
+zero:                                             ; preds = %entry
+  br label %join
+
+join:                                             ; preds = %zero, %big, %div
+  %r = phi i32 [ %q3, %big ], [ %q1, %div ], [ -1, %zero ]
+  ret i32 %r
+}
+
+declare i32 @printf(ptr, ...)
+
+define void @print(ptr %name, i32 %a, i32 %b, i32 %v) {
+  %r = call i32 (ptr, ...) @printf(ptr @.fmt, ptr %name, i32 %a, i32 %b, i32 %v)
+  ret void
+}
+
+define i32 @main() {
+entry:
+  br label %loop
+
+loop:                                             ; preds = %loop, %entry
+  %i = phi i32 [ -4, %entry ], [ %next, %loop ]
+  %a = mul i32 %i, 13
+  %b = sub i32 3, %i
+  %r0 = call i32 @diamond(i32 %a, i32 %b)
+  call void @print(ptr @.diamond, i32 %a, i32 %b, i32 %r0)
+  %r1 = call i32 @dowhile(i32 %a, i32 %b)
+  call void @print(ptr @.dowhile, i32 %a, i32 %b, i32 %r1)
+  %r2 = call i32 @critical(i32 %a, i32 %b)
+  call void @print(ptr @.critical, i32 %a, i32 %b, i32 %r2)
+  %r3 = call i32 @killed(i32 %a, i32 %b)
+  call void @print(ptr @.killed, i32 %a, i32 %b, i32 %r3)
+  %r4 = call i32 @guarded(i32 %a, i32 %b)
+  call void @print(ptr @.guarded, i32 %a, i32 %b, i32 %r4)
+  %next = add i32 %i, 1
+  %done = icmp eq i32 %next, 5
+  br i1 %done, label %exit, label %loop
+
+exit:                                             ; preds = %loop
+  ret i32 0
+}
@@ -0,0 +1,165 @@
+#include "llvm/Transforms/Utils/IVStrengthReduction.h"
+#include "llvm/Transforms/Utils/RuntimeAliasCheck.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/LoopIterator.h"
+#include "llvm/Analysis/MemorySSAUpdater.h"
+#include "llvm/Analysis/OptimizationRemarkEmitter.h"
+#include "llvm/Analysis/ScalarEvolution.h"
+#include "llvm/Analysis/ScalarEvolutionExpressions.h"
+#include "llvm/Transforms/Utils/Local.h"
+#include "llvm/Transforms/Utils/ScalarEvolutionExpander.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/Timer.h"
+
+#include <memory>
+#include <vector>
+
+using namespace llvm;
+
+#define DEBUG_TYPE "ivstrengthreduction"
+
+STATISTIC(NumReduced, "Numero di espressioni lineari nell'IV sostituite da una ricorrenza additiva");
+STATISTIC(NumNewPHIs, "Numero di PHI create per le nuove ricorrenze");
+STATISTIC(NumReusedPHIs, "Numero di espressioni sostituite da una PHI già esistente");
+STATISTIC(NumDeletedIVs, "Numero di induction variable rimaste senza usi ed eliminate");
+
+static cl::opt<unsigned> MaxNewPHIs("ivstrengthreduction-max-phis", cl::init(8), cl::Hidden,
+                                    cl::desc("Nuove ricorrenze create al più per loop (ognuna occupa un registro per tutto il loop)"));
+
+static const char *TimerGroupName="ivstrengthreduction";
+static const char *TimerGroupDesc="PassIVStrengthReduction";
+
+//restituisce la ricorrenza affine {start,+,step} del loop che descrive l'istruzione, se start e step si possono
+//calcolare nel preheader
+static const SCEVAddRecExpr *ricorrenzaLineare(Loop &L, Instruction *I, ScalarEvolution &SE){
+    if(!I->getType()->isIntegerTy() || isa<PHINode>(I) || !SE.isSCEVable(I->getType()))
+        return nullptr;
+    const SCEVAddRecExpr *AR=dyn_cast<SCEVAddRecExpr>(SE.getSCEV(I));
+    if(!AR || AR->getLoop()!=&L || !AR->isAffine())
+        return nullptr;
+    if(!RuntimeAliasCheck::isSafeToExpandInPreheader(L, AR->getStart(), SE)
+       || !RuntimeAliasCheck::isSafeToExpandInPreheader(L, AR->getStepRecurrence(SE), SE))
+        return nullptr;
+    return AR;
+}
+
+//Strength reduction delle induction variable: un'espressione lineare nelle IV del loop che contiene una moltiplicazione
+//(i*stride, base+i*c, la sext dell'indice di un accesso) vale start+k*step all'iterazione k, qualunque sia il
+//percorso nel corpo. La si sostituisce con una PHI nell'header che parte da start e a cui il latch somma step:
+//una add per iterazione al posto della catena di mul/shl. La somma nella PHI è senza flag nsw/nuw: l'incremento
+//dell'ultima iterazione può uscire dall'intervallo anche se l'espressione originale non lo faceva mai
+PreservedAnalyses PassIVStrengthReduction::run(Loop &L, LoopAnalysisManager &LAM, LoopStandardAnalysisResults &LAR, LPMUpdater &LU){
+    BasicBlock *preHeader=L.getLoopPreheader();
+    BasicBlock *latch=L.getLoopLatch();
+    if(!preHeader || !latch)
+        return PreservedAnalyses::all();
+    ScalarEvolution &SE=LAR.SE;
+    OptimizationRemarkEmitter ORE(L.getHeader()->getParent());
+    NamedRegionTimer T("ivsr", "Strength reduction delle induction variable", TimerGroupName, TimerGroupDesc, TimePassesIsEnabled);
+
+    //le espressioni lineari del loop e, per ognuna, se nella sua catena di operandi lineari c'è una moltiplicazione.
+    //In reverse post-order gli operandi sono visti prima dei loro usi
+    std::vector<Instruction*> lineari;
+    DenseMap<Instruction*,bool> conMoltiplicazione;
+    LoopBlocksRPO RPO(&L);
+    RPO.perform(&LAR.LI);
+    for(BasicBlock *BB : RPO){
+        for(Instruction &I : *BB){
+            if(!ricorrenzaLineare(L, &I, SE))
+                continue;
+            bool molt=I.getOpcode()==Instruction::Mul || I.getOpcode()==Instruction::Shl;
+            for(Value *op : I.operands()){
+                if(Instruction *O=dyn_cast<Instruction>(op))
+                    molt|=conMoltiplicazione.lookup(O);
+            }
+            conMoltiplicazione[&I]=molt;
+            lineari.push_back(&I);
+        }
+    }
+
+    //si riduce solo la radice di ogni catena, cioè l'espressione con almeno un uso che non è a sua volta lineare
+    //(un load, un confronto, un uso fuori dal loop): le espressioni interne restano senza usi e vengono eliminate
+    SmallVector<Instruction*> radici;
+    for(Instruction *I : lineari){
+        if(!conMoltiplicazione[I])
+            continue;
+        for(User *U : I->users()){
+            Instruction *UI=cast<Instruction>(U);
+            if(!L.contains(UI) || isa<PHINode>(UI) || !conMoltiplicazione.count(UI)){
+                radici.push_back(I);
+                break;
+            }
+        }
+    }
+    if(radici.empty())
+        return PreservedAnalyses::all();
+
+    //PHI dell'header già presenti: un'espressione con la stessa ricorrenza usa quella invece di crearne una nuova
+    DenseMap<const SCEV*,PHINode*> ricorrenze;
+    for(PHINode &PN : L.getHeader()->phis()){
+        if(SE.isSCEVable(PN.getType()) && PN.getType()->isIntegerTy())
+            ricorrenze.try_emplace(SE.getSCEV(&PN), &PN);
+    }
+
+    SCEVExpander Expander(SE, L.getHeader()->getModule()->getDataLayout(), "ivsr");
+    SmallVector<WeakTrackingVH,16> morte;
+    unsigned nuove=0;
+    for(Instruction *I : radici){
+        const SCEVAddRecExpr *AR=ricorrenzaLineare(L, I, SE);
+        PHINode *PN=ricorrenze.lookup(AR);
+        if(PN){
+            ++NumReusedPHIs;
+        }else if(nuove>=MaxNewPHIs){
+            ORE.emit([&](){
+                return OptimizationRemarkMissed(DEBUG_TYPE, "TooManyRecurrences", I)
+                       <<ore::NV("Inst", I)<<" non ridotta: il loop ha già "<<ore::NV("NumPHIs", nuove)<<" nuove ricorrenze";
+            });
+            continue;
+        }else{
+            Value *start=Expander.expandCodeFor(AR->getStart(), I->getType(), preHeader->getTerminator());
+            Value *step=Expander.expandCodeFor(AR->getStepRecurrence(SE), I->getType(), preHeader->getTerminator());
+            PN=PHINode::Create(I->getType(), 2, I->getName()+".sr", &L.getHeader()->front());
+            Instruction *next=BinaryOperator::CreateAdd(PN, step, I->getName()+".sr.next", latch->getTerminator());
+            PN->addIncoming(start, preHeader);
+            PN->addIncoming(next, latch);
+            ricorrenze[AR]=PN;
+            ++NumNewPHIs;
+            nuove++;
+        }
+        ORE.emit([&](){
+            return OptimizationRemark(DEBUG_TYPE, "Reduced", I)<<ore::NV("Inst", I)<<" sostituita dalla ricorrenza "
+                   <<ore::NV("PHI", PN)<<" aggiornata con una somma per iterazione";
+        });
+        SE.forgetValue(I);
+        I->replaceAllUsesWith(PN);
+        morte.push_back(I);
+        ++NumReduced;
+    }
+    if(morte.empty())
+        return PreservedAnalyses::all();
+
+    //le catene di mul/shl rimaste senza usi e le induction variable originali che servivano solo a loro
+    std::unique_ptr<MemorySSAUpdater> MSSAU;
+    if(LAR.MSSA)
+        MSSAU=std::make_unique<MemorySSAUpdater>(LAR.MSSA);
+    RecursivelyDeleteTriviallyDeadInstructionsPermissive(morte, &LAR.TLI, MSSAU.get(), [&](Value *V){ SE.forgetValue(V); });
+    SmallVector<WeakTrackingVH,4> phi;
+    for(PHINode &PN : L.getHeader()->phis())
+        phi.push_back(&PN);
+    for(WeakTrackingVH &V : phi){
+        PHINode *PN=dyn_cast_or_null<PHINode>(V);
+        if(!PN || !PN->hasOneUse())
+            continue;
+        SE.forgetValue(PN);
+        SE.forgetValue(PN->user_back());
+        if(RecursivelyDeleteDeadPHINode(PN, &LAR.TLI, MSSAU.get()))
+            ++NumDeletedIVs;
+    }
+
+    PreservedAnalyses PA=getLoopPassPreservedAnalyses();
+    if(LAR.MSSA)
+        PA.preserve<MemorySSAAnalysis>();
+    return PA;
+}
@@ -0,0 +1,12 @@
+#ifndef LLVM_TRANSFORMS_IVSTRENGTHREDUCTION_H
+#define LLVM_TRANSFORMS_IVSTRENGTHREDUCTION_H
+#include "llvm/IR/PassManager.h"
+#include "llvm/Transforms/Scalar/LoopPassManager.h"
+
+namespace llvm {
+  class PassIVStrengthReduction : public PassInfoMixin<PassIVStrengthReduction> {
+    public:
+      PreservedAnalyses run(Loop &L,LoopAnalysisManager &LAM,LoopStandardAnalysisResults &LAR,LPMUpdater &LU);
+  };
+}
+#endif
@@ -0,0 +1,250 @@
+; ModuleID = 'IVSR.ll'
+source_filename = "IVSR.ll"
+target datalayout = "e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-i128:128-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-pc-linux-gnu"
+
+@buf = global [256 x i32] zeroinitializer
+@.fmt = private unnamed_addr constant [11 x i8] c"%s %d: %d\0A\00"
+@.stride = private unnamed_addr constant [7 x i8] c"stride\00"
+@.shift = private unnamed_addr constant [6 x i8] c"shift\00"
+@.nested = private unnamed_addr constant [7 x i8] c"nested\00"
+@.backward = private unnamed_addr constant [9 x i8] c"backward\00"
+@.wrap = private unnamed_addr constant [5 x i8] c"wrap\00"
+@.many = private unnamed_addr constant [5 x i8] c"many\00"
+
+define void @stride(i32 %n, i32 %a, i32 %b) {
+entry:
+  %guard = icmp sgt i32 %n, 0
+  br i1 %guard, label %body.preheader, label %exit
+
+body.preheader:                                   ; preds = %entry
+  %0 = mul i32 %b, %a
+  br label %body
+
+body:                                             ; preds = %body.preheader, %body
+  %w.sr = phi i32 [ %0, %body.preheader ], [ %w.sr.next, %body ]
+  %idx64.sr = phi i64 [ 2, %body.preheader ], [ %idx64.sr.next, %body ]
+  %i = phi i32 [ %i.next, %body ], [ 0, %body.preheader ]
+  %p = getelementptr [256 x i32], ptr @buf, i64 0, i64 %idx64.sr
+  store i32 %w.sr, ptr %p, align 4
+  %i.next = add nsw i32 %i, 1
+  %c = icmp slt i32 %i.next, %n
+  %idx64.sr.next = add i64 %idx64.sr, 3
+  %w.sr.next = add i32 %w.sr, 12
+  br i1 %c, label %body, label %exit.loopexit
+
+exit.loopexit:                                    ; preds = %body
+  br label %exit
+
+exit:                                             ; preds = %exit.loopexit, %entry
+  ret void
+}
+
+define i32 @shift(i32 %n, i32 %x) {
+entry:
+  %lim = mul i32 %n, 3
+  br label %body
+
+body:                                             ; preds = %body, %entry
+  %t.sr = phi i32 [ %x, %entry ], [ %t.sr.next, %body ]
+  %i = phi i32 [ 0, %entry ], [ %i.next, %body ]
+  %k = phi i32 [ 0, %entry ], [ %k.next, %body ]
+  %lt = icmp slt i32 %t.sr, %lim
+  %inc = zext i1 %lt to i32
+  %k.next = add i32 %k, %inc
+  %i.next = add i32 %i, 1
+  %c = icmp slt i32 %i.next, %n
+  %t.sr.next = add i32 %t.sr, 4
+  br i1 %c, label %body, label %exit
+
+exit:                                             ; preds = %body
+  %k.next.lcssa = phi i32 [ %k.next, %body ]
+  ret i32 %k.next.lcssa
+}
+
+define void @nested(i64 %m) {
+entry:
+  br label %outer
+
+outer:                                            ; preds = %outer.latch, %entry
+  %row.sr = phi i64 [ 0, %entry ], [ %row.sr.next, %outer.latch ]
+  %j = phi i64 [ 0, %entry ], [ %j.next, %outer.latch ]
+  br label %inner
+
+inner:                                            ; preds = %inner, %outer
+  %i = phi i64 [ 0, %outer ], [ %i.next, %inner ]
+  %idx = add i64 %row.sr, %i
+  %p = getelementptr [256 x i32], ptr @buf, i64 0, i64 %idx
+  %v = load i32, ptr %p, align 4
+  %d = sub i64 %j, %i
+  %d32 = trunc i64 %d to i32
+  %w = add i32 %v, %d32
+  store i32 %w, ptr %p, align 4
+  %i.next = add i64 %i, 1
+  %ci = icmp slt i64 %i.next, 8
+  br i1 %ci, label %inner, label %outer.latch
+
+outer.latch:                                      ; preds = %inner
+  %j.next = add i64 %j, 1
+  %cj = icmp slt i64 %j.next, %m
+  %row.sr.next = add i64 %row.sr, 8
+  br i1 %cj, label %outer, label %exit
+
+exit:                                             ; preds = %outer.latch
+  ret void
+}
+
+define i32 @backward(i32 %n) {
+entry:
+  %guard = icmp sgt i32 %n, 0
+  br i1 %guard, label %body.preheader, label %exit
+
+body.preheader:                                   ; preds = %entry
+  %0 = mul i32 %n, 7
+  %1 = sub i32 100, %0
+  br label %body
+
+body:                                             ; preds = %body.preheader, %body
+  %v.sr = phi i32 [ %1, %body.preheader ], [ %v.sr.next, %body ]
+  %i = phi i32 [ %i.next, %body ], [ %n, %body.preheader ]
+  %s = phi i32 [ %s.next, %body ], [ 0, %body.preheader ]
+  %s.next = add i32 %s, %v.sr
+  %i.next = add i32 %i, -1
+  %c = icmp sgt i32 %i.next, 0
+  %v.sr.next = add i32 %v.sr, 7
+  br i1 %c, label %body, label %exit.loopexit
+
+exit.loopexit:                                    ; preds = %body
+  %s.next.lcssa = phi i32 [ %s.next, %body ]
+  br label %exit
+
+exit:                                             ; preds = %exit.loopexit, %entry
+  %r = phi i32 [ 0, %entry ], [ %s.next.lcssa, %exit.loopexit ]
+  ret i32 %r
+}
+
+define i32 @wrap(i32 %n) {
+entry:
+  br label %body
+
+body:                                             ; preds = %body, %entry
+  %m.sr = phi i8 [ 0, %entry ], [ %m.sr.next, %body ]
+  %i = phi i8 [ 0, %entry ], [ %i.next, %body ]
+  %s = phi i32 [ 0, %entry ], [ %s.next, %body ]
+  %e = sext i8 %m.sr to i32
+  %s2 = mul i32 %s, 3
+  %s.next = add i32 %s2, %e
+  %i.next = add i8 %i, 1
+  %i32 = zext i8 %i.next to i32
+  %c = icmp slt i32 %i32, %n
+  %m.sr.next = add i8 %m.sr, 37
+  br i1 %c, label %body, label %exit
+
+exit:                                             ; preds = %body
+  %s.next.lcssa = phi i32 [ %s.next, %body ]
+  ret i32 %s.next.lcssa
+}
+
+define i32 @many(i32 %n) {
+entry:
+  br label %body
+
+body:                                             ; preds = %body, %entry
+  %m8.sr = phi i32 [ 0, %entry ], [ %m8.sr.next, %body ]
+  %m7.sr = phi i32 [ 0, %entry ], [ %m7.sr.next, %body ]
+  %m6.sr = phi i32 [ 0, %entry ], [ %m6.sr.next, %body ]
+  %m5.sr = phi i32 [ 0, %entry ], [ %m5.sr.next, %body ]
+  %m4.sr = phi i32 [ 0, %entry ], [ %m4.sr.next, %body ]
+  %m3.sr = phi i32 [ 0, %entry ], [ %m3.sr.next, %body ]
+  %m2.sr = phi i32 [ 0, %entry ], [ %m2.sr.next, %body ]
+  %m1.sr = phi i32 [ 0, %entry ], [ %m1.sr.next, %body ]
+  %i = phi i32 [ 0, %entry ], [ %i.next, %body ]
+  %s = phi i32 [ 0, %entry ], [ %s.next, %body ]
+  %m9 = mul i32 %i, 29
+  %m10 = mul i32 %i, 31
+  %x1 = xor i32 %s, %m1.sr
+  %x2 = xor i32 %x1, %m2.sr
+  %x3 = xor i32 %x2, %m3.sr
+  %x4 = xor i32 %x3, %m4.sr
+  %x5 = xor i32 %x4, %m5.sr
+  %x6 = xor i32 %x5, %m6.sr
+  %x7 = xor i32 %x6, %m7.sr
+  %x8 = xor i32 %x7, %m8.sr
+  %x9 = xor i32 %x8, %m9
+  %s.next = xor i32 %x9, %m10
+  %i.next = add i32 %i, 1
+  %c = icmp slt i32 %i.next, %n
+  %m1.sr.next = add i32 %m1.sr, 3
+  %m2.sr.next = add i32 %m2.sr, 5
+  %m3.sr.next = add i32 %m3.sr, 7
+  %m4.sr.next = add i32 %m4.sr, 11
+  %m5.sr.next = add i32 %m5.sr, 13
+  %m6.sr.next = add i32 %m6.sr, 17
+  %m7.sr.next = add i32 %m7.sr, 19
+  %m8.sr.next = add i32 %m8.sr, 23
+  br i1 %c, label %body, label %exit
+
+exit:                                             ; preds = %body
+  %s.next.lcssa = phi i32 [ %s.next, %body ]
+  ret i32 %s.next.lcssa
+}
+
+define i32 @checksum() {
+entry:
+  br label %body
+
+body:                                             ; preds = %body, %entry
+  %i = phi i64 [ 0, %entry ], [ %i.next, %body ]
+  %s = phi i32 [ 0, %entry ], [ %s.next, %body ]
+  %p = getelementptr [256 x i32], ptr @buf, i64 0, i64 %i
+  %v = load i32, ptr %p, align 4
+  %s31 = mul i32 %s, 31
+  %s.next = add i32 %s31, %v
+  %i.next = add i64 %i, 1
+  %c = icmp slt i64 %i.next, 256
+  br i1 %c, label %body, label %exit
+
+exit:                                             ; preds = %body
+  %s.next.lcssa = phi i32 [ %s.next, %body ]
+  ret i32 %s.next.lcssa
+}
+
+declare i32 @printf(ptr, ...)
+
+define void @print(ptr %name, i32 %n, i32 %v) {
+  %r = call i32 (ptr, ...) @printf(ptr @.fmt, ptr %name, i32 %n, i32 %v)
+  ret void
+}
+
+define i32 @main() {
+entry:
+  br label %loop
+
+loop:                                             ; preds = %loop, %entry
+  %n = phi i32 [ 0, %entry ], [ %n.next, %loop ]
+  %a = sub i32 %n, 40
+  call void @stride(i32 %n, i32 %a, i32 -3)
+  %c0 = call i32 @checksum()
+  call void @print(ptr @.stride, i32 %n, i32 %c0)
+  %x = sub i32 50, %n
+  %r1 = call i32 @shift(i32 %n, i32 %x)
+  call void @print(ptr @.shift, i32 %n, i32 %r1)
+  %m = lshr i32 %n, 1
+  %m1 = add i32 %m, 1
+  %m64 = zext i32 %m1 to i64
+  call void @nested(i64 %m64)
+  %c2 = call i32 @checksum()
+  call void @print(ptr @.nested, i32 %n, i32 %c2)
+  %r3 = call i32 @backward(i32 %n)
+  call void @print(ptr @.backward, i32 %n, i32 %r3)
+  %r4 = call i32 @wrap(i32 %n)
+  call void @print(ptr @.wrap, i32 %n, i32 %r4)
+  %r5 = call i32 @many(i32 %n)
+  call void @print(ptr @.many, i32 %n, i32 %r5)
+  %n.next = add i32 %n, 1
+  %done = icmp eq i32 %n.next, 60
+  br i1 %done, label %exit, label %loop
+
+exit:                                             ; preds = %loop
+  ret i32 0
+}
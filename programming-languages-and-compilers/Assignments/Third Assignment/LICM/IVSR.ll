@@ -0,0 +1,234 @@
+; Strength reduction delle induction variable (ivstrengthreduction): indici i*3+2 con la
+; sext dell'accesso, i<<2 usata in un confronto, un nido di loop con l'indice j*8+i, un
+; loop che conta all'indietro, un prodotto i8 che va in overflow (la ricorrenza è modulo
+; 2^w come il prodotto) e un loop con più espressioni di -ivstrengthreduction-max-phis,
+; di cui le ultime restano moltiplicazioni. a*b senza IV non si tocca:
+;   opt -load-pass-plugin <plugin> -passes='loop(ivstrengthreduction)' IVSR.ll -S -o IVSR-res.ll
+;   lli IVSR.ll e lli IVSR-res.ll devono stampare le stesse righe
+target datalayout = "e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-i128:128-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-pc-linux-gnu"
+
+@buf = global [256 x i32] zeroinitializer
+@.fmt = private unnamed_addr constant [11 x i8] c"%s %d: %d\0A\00"
+@.stride = private unnamed_addr constant [7 x i8] c"stride\00"
+@.shift = private unnamed_addr constant [6 x i8] c"shift\00"
+@.nested = private unnamed_addr constant [7 x i8] c"nested\00"
+@.backward = private unnamed_addr constant [9 x i8] c"backward\00"
+@.wrap = private unnamed_addr constant [5 x i8] c"wrap\00"
+@.many = private unnamed_addr constant [5 x i8] c"many\00"
+
+; for(i=0; i<n; i++) buf[i*3+2]=i*12+b*a;
+define void @stride(i32 %n, i32 %a, i32 %b) {
+entry:
+  %guard = icmp sgt i32 %n, 0
+  br i1 %guard, label %body, label %exit
+
+body:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %body ]
+  %m = mul nsw i32 %i, 3
+  %idx = add nsw i32 %m, 2
+  %idx64 = sext i32 %idx to i64
+  %p = getelementptr [256 x i32], ptr @buf, i64 0, i64 %idx64
+  %v = mul i32 %i, 12
+  %ab = mul i32 %b, %a
+  %w = add i32 %v, %ab
+  store i32 %w, ptr %p
+  %i.next = add nsw i32 %i, 1
+  %c = icmp slt i32 %i.next, %n
+  br i1 %c, label %body, label %exit
+
+exit:
+  ret void
+}
+
+; Conta le i con (i<<2)+x < 3*n
+define i32 @shift(i32 %n, i32 %x) {
+entry:
+  %lim = mul i32 %n, 3
+  br label %body
+
+body:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %body ]
+  %k = phi i32 [ 0, %entry ], [ %k.next, %body ]
+  %s = shl i32 %i, 2
+  %t = add i32 %s, %x
+  %lt = icmp slt i32 %t, %lim
+  %inc = zext i1 %lt to i32
+  %k.next = add i32 %k, %inc
+  %i.next = add i32 %i, 1
+  %c = icmp slt i32 %i.next, %n
+  br i1 %c, label %body, label %exit
+
+exit:
+  ret i32 %k.next
+}
+
+; for(j=0; j<m; j++) for(i=0; i<8; i++) buf[j*8+i]+=j-i;
+define void @nested(i64 %m) {
+entry:
+  br label %outer
+
+outer:
+  %j = phi i64 [ 0, %entry ], [ %j.next, %outer.latch ]
+  %row = mul i64 %j, 8
+  br label %inner
+
+inner:
+  %i = phi i64 [ 0, %outer ], [ %i.next, %inner ]
+  %idx = add i64 %row, %i
+  %p = getelementptr [256 x i32], ptr @buf, i64 0, i64 %idx
+  %v = load i32, ptr %p
+  %d = sub i64 %j, %i
+  %d32 = trunc i64 %d to i32
+  %w = add i32 %v, %d32
+  store i32 %w, ptr %p
+  %i.next = add i64 %i, 1
+  %ci = icmp slt i64 %i.next, 8
+  br i1 %ci, label %inner, label %outer.latch
+
+outer.latch:
+  %j.next = add i64 %j, 1
+  %cj = icmp slt i64 %j.next, %m
+  br i1 %cj, label %outer, label %exit
+
+exit:
+  ret void
+}
+
+; for(i=n; i>0; i--) s+=i*-7+100;
+define i32 @backward(i32 %n) {
+entry:
+  %guard = icmp sgt i32 %n, 0
+  br i1 %guard, label %body, label %exit
+
+body:
+  %i = phi i32 [ %n, %entry ], [ %i.next, %body ]
+  %s = phi i32 [ 0, %entry ], [ %s.next, %body ]
+  %m = mul i32 %i, -7
+  %v = add i32 %m, 100
+  %s.next = add i32 %s, %v
+  %i.next = add i32 %i, -1
+  %c = icmp sgt i32 %i.next, 0
+  br i1 %c, label %body, label %exit
+
+exit:
+  %r = phi i32 [ 0, %entry ], [ %s.next, %body ]
+  ret i32 %r
+}
+
+; Prodotto i8 senza flag: i*37 va in overflow già dalla quarta iterazione
+define i32 @wrap(i32 %n) {
+entry:
+  br label %body
+
+body:
+  %i = phi i8 [ 0, %entry ], [ %i.next, %body ]
+  %s = phi i32 [ 0, %entry ], [ %s.next, %body ]
+  %m = mul i8 %i, 37
+  %e = sext i8 %m to i32
+  %s2 = mul i32 %s, 3
+  %s.next = add i32 %s2, %e
+  %i.next = add i8 %i, 1
+  %i32 = zext i8 %i.next to i32
+  %c = icmp slt i32 %i32, %n
+  br i1 %c, label %body, label %exit
+
+exit:
+  ret i32 %s.next
+}
+
+; Dieci prodotti con passi diversi: solo i primi -ivstrengthreduction-max-phis diventano PHI
+define i32 @many(i32 %n) {
+entry:
+  br label %body
+
+body:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %body ]
+  %s = phi i32 [ 0, %entry ], [ %s.next, %body ]
+  %m1 = mul i32 %i, 3
+  %m2 = mul i32 %i, 5
+  %m3 = mul i32 %i, 7
+  %m4 = mul i32 %i, 11
+  %m5 = mul i32 %i, 13
+  %m6 = mul i32 %i, 17
+  %m7 = mul i32 %i, 19
+  %m8 = mul i32 %i, 23
+  %m9 = mul i32 %i, 29
+  %m10 = mul i32 %i, 31
+  %x1 = xor i32 %s, %m1
+  %x2 = xor i32 %x1, %m2
+  %x3 = xor i32 %x2, %m3
+  %x4 = xor i32 %x3, %m4
+  %x5 = xor i32 %x4, %m5
+  %x6 = xor i32 %x5, %m6
+  %x7 = xor i32 %x6, %m7
+  %x8 = xor i32 %x7, %m8
+  %x9 = xor i32 %x8, %m9
+  %s.next = xor i32 %x9, %m10
+  %i.next = add i32 %i, 1
+  %c = icmp slt i32 %i.next, %n
+  br i1 %c, label %body, label %exit
+
+exit:
+  ret i32 %s.next
+}
+
+; Somma pesata di buf, per confrontare le scritture
+define i32 @checksum() {
+entry:
+  br label %body
+
+body:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %body ]
+  %s = phi i32 [ 0, %entry ], [ %s.next, %body ]
+  %p = getelementptr [256 x i32], ptr @buf, i64 0, i64 %i
+  %v = load i32, ptr %p
+  %s31 = mul i32 %s, 31
+  %s.next = add i32 %s31, %v
+  %i.next = add i64 %i, 1
+  %c = icmp slt i64 %i.next, 256
+  br i1 %c, label %body, label %exit
+
+exit:
+  ret i32 %s.next
+}
+
+declare i32 @printf(ptr, ...)
+
+define void @print(ptr %name, i32 %n, i32 %v) {
+  %r = call i32 (ptr, ...) @printf(ptr @.fmt, ptr %name, i32 %n, i32 %v)
+  ret void
+}
+
+define i32 @main() {
+entry:
+  br label %loop
+
+loop:
+  %n = phi i32 [ 0, %entry ], [ %n.next, %loop ]
+  %a = sub i32 %n, 40
+  call void @stride(i32 %n, i32 %a, i32 -3)
+  %c0 = call i32 @checksum()
+  call void @print(ptr @.stride, i32 %n, i32 %c0)
+  %x = sub i32 50, %n
+  %r1 = call i32 @shift(i32 %n, i32 %x)
+  call void @print(ptr @.shift, i32 %n, i32 %r1)
+  %m = lshr i32 %n, 1
+  %m1 = add i32 %m, 1
+  %m64 = zext i32 %m1 to i64
+  call void @nested(i64 %m64)
+  %c2 = call i32 @checksum()
+  call void @print(ptr @.nested, i32 %n, i32 %c2)
+  %r3 = call i32 @backward(i32 %n)
+  call void @print(ptr @.backward, i32 %n, i32 %r3)
+  %r4 = call i32 @wrap(i32 %n)
+  call void @print(ptr @.wrap, i32 %n, i32 %r4)
+  %r5 = call i32 @many(i32 %n)
+  call void @print(ptr @.many, i32 %n, i32 %r5)
+  %n.next = add i32 %n, 1
+  %done = icmp eq i32 %n.next, 60
+  br i1 %done, label %exit, label %loop
+
+exit:
+  ret i32 0
+}
@@ -0,0 +1,186 @@
+; ModuleID = 'Nest.ll'
+source_filename = "Nest.ll"
+target datalayout = "e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-i128:128-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-pc-linux-gnu"
+
+@buf = global [128 x i32] zeroinitializer
+@k = global i32 7
+@.fmt = private unnamed_addr constant [11 x i8] c"%s %d: %d\0A\00"
+@.rows = private unnamed_addr constant [5 x i8] c"rows\00"
+@.divide = private unnamed_addr constant [7 x i8] c"divide\00"
+@.guarded = private unnamed_addr constant [8 x i8] c"guarded\00"
+@.stop = private unnamed_addr constant [5 x i8] c"stop\00"
+
+define void @rows(i64 %m, i32 %a, i32 %b) {
+entry:
+  %guard = icmp sgt i64 %m, 0
+  br i1 %guard, label %outer.preheader, label %exit
+
+outer.preheader:                                  ; preds = %entry
+  %ab = mul i32 %a, %b
+  %kv = load i32, ptr @k, align 4
+  %t = add i32 %ab, %kv
+  br label %outer
+
+outer:                                            ; preds = %outer.preheader, %outer.latch
+  %j = phi i64 [ %j.next, %outer.latch ], [ 0, %outer.preheader ]
+  %row = mul i64 %j, 8
+  br label %inner
+
+inner:                                            ; preds = %inner, %outer
+  %i = phi i64 [ 0, %outer ], [ %i.next, %inner ]
+  %i32 = trunc i64 %i to i32
+  %v = add i32 %t, %i32
+  %idx = add i64 %row, %i
+  %p = getelementptr [128 x i32], ptr @buf, i64 0, i64 %idx
+  store i32 %v, ptr %p, align 4
+  %i.next = add i64 %i, 1
+  %ci = icmp slt i64 %i.next, 8
+  br i1 %ci, label %inner, label %outer.latch
+
+outer.latch:                                      ; preds = %inner
+  %j.next = add i64 %j, 1
+  %cj = icmp slt i64 %j.next, %m
+  br i1 %cj, label %outer, label %exit.loopexit
+
+exit.loopexit:                                    ; preds = %outer.latch
+  br label %exit
+
+exit:                                             ; preds = %exit.loopexit, %entry
+  ret void
+}
+
+define i32 @divide(i64 %m, i32 %x, i32 %d) {
+entry:
+  %q = sdiv i32 %x, %d
+  br label %outer
+
+outer:                                            ; preds = %outer.latch, %entry
+  %j = phi i64 [ 0, %entry ], [ %j.next, %outer.latch ]
+  %s = phi i32 [ 0, %entry ], [ %s.in, %outer.latch ]
+  br label %inner
+
+inner:                                            ; preds = %inner, %outer
+  %i = phi i64 [ 0, %outer ], [ %i.next, %inner ]
+  %t = phi i32 [ %s, %outer ], [ %t.next, %inner ]
+  %t.next = add i32 %t, %q
+  %i.next = add i64 %i, 1
+  %ci = icmp slt i64 %i.next, 4
+  br i1 %ci, label %inner, label %outer.latch
+
+outer.latch:                                      ; preds = %inner
+  %s.in = phi i32 [ %t.next, %inner ]
+  %j.next = add i64 %j, 1
+  %cj = icmp slt i64 %j.next, %m
+  br i1 %cj, label %outer, label %exit
+
+exit:                                             ; preds = %outer.latch
+  %s.in.lcssa = phi i32 [ %s.in, %outer.latch ]
+  ret i32 %s.in.lcssa
+}
+
+define i32 @guarded(ptr %p, i64 %m) {
+entry:
+  br label %outer
+
+outer:                                            ; preds = %outer.latch, %entry
+  %j = phi i64 [ 0, %entry ], [ %j.next, %outer.latch ]
+  %s = phi i32 [ 0, %entry ], [ %s.in, %outer.latch ]
+  call void @check(ptr %p)
+  %x = load i32, ptr %p, align 4
+  br label %inner
+
+inner:                                            ; preds = %inner, %outer
+  %i = phi i64 [ 0, %outer ], [ %i.next, %inner ]
+  %t = phi i32 [ %s, %outer ], [ %t.next, %inner ]
+  %t.next = add i32 %t, %x
+  %i.next = add i64 %i, 1
+  %ci = icmp slt i64 %i.next, 4
+  br i1 %ci, label %inner, label %outer.latch
+
+outer.latch:                                      ; preds = %inner
+  %s.in = phi i32 [ %t.next, %inner ]
+  %j.next = add i64 %j, 1
+  %cj = icmp slt i64 %j.next, %m
+  br i1 %cj, label %outer, label %exit
+
+exit:                                             ; preds = %outer.latch
+  %s.in.lcssa = phi i32 [ %s.in, %outer.latch ]
+  ret i32 %s.in.lcssa
+}
+
+; Function Attrs: inaccessiblememonly
+define void @check(ptr %p) #0 {
+entry:
+  %null = icmp eq ptr %p, null
+  br i1 %null, label %fail, label %ok
+
+fail:                                             ; preds = %entry
+  %r = call i32 @puts(ptr @.stop)
+  call void @exit(i32 0)
+  unreachable
+
+ok:                                               ; preds = %entry
+  ret void
+}
+
+define i32 @checksum() {
+entry:
+  br label %body
+
+body:                                             ; preds = %body, %entry
+  %i = phi i64 [ 0, %entry ], [ %i.next, %body ]
+  %s = phi i32 [ 0, %entry ], [ %s.next, %body ]
+  %p = getelementptr [128 x i32], ptr @buf, i64 0, i64 %i
+  %v = load i32, ptr %p, align 4
+  %s31 = mul i32 %s, 31
+  %s.next = add i32 %s31, %v
+  %i.next = add i64 %i, 1
+  %c = icmp slt i64 %i.next, 128
+  br i1 %c, label %body, label %exit
+
+exit:                                             ; preds = %body
+  %s.next.lcssa = phi i32 [ %s.next, %body ]
+  ret i32 %s.next.lcssa
+}
+
+declare i32 @puts(ptr)
+
+; Function Attrs: noreturn
+declare void @exit(i32) #1
+
+declare i32 @printf(ptr, ...)
+
+define void @print(ptr %name, i64 %m, i32 %v) {
+  %r = call i32 (ptr, ...) @printf(ptr @.fmt, ptr %name, i64 %m, i32 %v)
+  ret void
+}
+
+define i32 @main() {
+entry:
+  br label %loop
+
+loop:                                             ; preds = %loop, %entry
+  %m = phi i64 [ 1, %entry ], [ %m.next, %loop ]
+  %m32 = trunc i64 %m to i32
+  %a = sub i32 %m32, 9
+  call void @rows(i64 %m, i32 %a, i32 -3)
+  %c0 = call i32 @checksum()
+  call void @print(ptr @.rows, i64 %m, i32 %c0)
+  %d = sub i32 %m32, 20
+  %r1 = call i32 @divide(i64 %m, i32 -1000003, i32 %d)
+  call void @print(ptr @.divide, i64 %m, i32 %r1)
+  store i32 %a, ptr @k, align 4
+  %r2 = call i32 @guarded(ptr @k, i64 %m)
+  call void @print(ptr @.guarded, i64 %m, i32 %r2)
+  %m.next = add i64 %m, 1
+  %done = icmp eq i64 %m.next, 17
+  br i1 %done, label %exit, label %loop
+
+exit:                                             ; preds = %loop
+  %g = call i32 @guarded(ptr null, i64 3)
+  ret i32 %g
+}
+
+attributes #0 = { inaccessiblememonly }
+attributes #1 = { noreturn }
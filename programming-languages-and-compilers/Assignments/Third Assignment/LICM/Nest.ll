@@ -0,0 +1,180 @@
+; Code motion in un nido di loop (licmpass sul loop interno): a*b e il load di k escono
+; da tutto il nido, una divisione per un argomento esce dal nido solo perché ogni
+; iterazione del loop esterno la esegue, mentre il load di *p resta nel loop esterno
+; dopo la chiamata a check, che può terminare il programma (main la fa scattare per
+; ultima, con un puntatore nullo):
+;   opt -load-pass-plugin <plugin> -passes='loop(licmpass)' Nest.ll -S -o Nest-res.ll
+;   lli Nest.ll e lli Nest-res.ll devono stampare le stesse righe
+target datalayout = "e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-i128:128-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-pc-linux-gnu"
+
+@buf = global [128 x i32] zeroinitializer
+@k = global i32 7
+@.fmt = private unnamed_addr constant [11 x i8] c"%s %d: %d\0A\00"
+@.rows = private unnamed_addr constant [5 x i8] c"rows\00"
+@.divide = private unnamed_addr constant [7 x i8] c"divide\00"
+@.guarded = private unnamed_addr constant [8 x i8] c"guarded\00"
+@.stop = private unnamed_addr constant [5 x i8] c"stop\00"
+
+; for(j=0; j<m; j++) for(i=0; i<8; i++) buf[j*8+i]=a*b+k+i;
+define void @rows(i64 %m, i32 %a, i32 %b) {
+entry:
+  %guard = icmp sgt i64 %m, 0
+  br i1 %guard, label %outer, label %exit
+
+outer:
+  %j = phi i64 [ 0, %entry ], [ %j.next, %outer.latch ]
+  %row = mul i64 %j, 8
+  br label %inner
+
+inner:
+  %i = phi i64 [ 0, %outer ], [ %i.next, %inner ]
+  %ab = mul i32 %a, %b
+  %kv = load i32, ptr @k
+  %t = add i32 %ab, %kv
+  %i32 = trunc i64 %i to i32
+  %v = add i32 %t, %i32
+  %idx = add i64 %row, %i
+  %p = getelementptr [128 x i32], ptr @buf, i64 0, i64 %idx
+  store i32 %v, ptr %p
+  %i.next = add i64 %i, 1
+  %ci = icmp slt i64 %i.next, 8
+  br i1 %ci, label %inner, label %outer.latch
+
+outer.latch:
+  %j.next = add i64 %j, 1
+  %cj = icmp slt i64 %j.next, %m
+  br i1 %cj, label %outer, label %exit
+
+exit:
+  ret void
+}
+
+; do { for(i=0; i<4; i++) s+=x/d; } while(++j<m);
+define i32 @divide(i64 %m, i32 %x, i32 %d) {
+entry:
+  br label %outer
+
+outer:
+  %j = phi i64 [ 0, %entry ], [ %j.next, %outer.latch ]
+  %s = phi i32 [ 0, %entry ], [ %s.in, %outer.latch ]
+  br label %inner
+
+inner:
+  %i = phi i64 [ 0, %outer ], [ %i.next, %inner ]
+  %t = phi i32 [ %s, %outer ], [ %t.next, %inner ]
+  %q = sdiv i32 %x, %d
+  %t.next = add i32 %t, %q
+  %i.next = add i64 %i, 1
+  %ci = icmp slt i64 %i.next, 4
+  br i1 %ci, label %inner, label %outer.latch
+
+outer.latch:
+  %s.in = phi i32 [ %t.next, %inner ]
+  %j.next = add i64 %j, 1
+  %cj = icmp slt i64 %j.next, %m
+  br i1 %cj, label %outer, label %exit
+
+exit:
+  ret i32 %s.in
+}
+
+; do { check(p); for(i=0; i<4; i++) s+=*p; } while(++j<m);
+define i32 @guarded(ptr %p, i64 %m) {
+entry:
+  br label %outer
+
+outer:
+  %j = phi i64 [ 0, %entry ], [ %j.next, %outer.latch ]
+  %s = phi i32 [ 0, %entry ], [ %s.in, %outer.latch ]
+  call void @check(ptr %p)
+  br label %inner
+
+inner:
+  %i = phi i64 [ 0, %outer ], [ %i.next, %inner ]
+  %t = phi i32 [ %s, %outer ], [ %t.next, %inner ]
+  %x = load i32, ptr %p
+  %t.next = add i32 %t, %x
+  %i.next = add i64 %i, 1
+  %ci = icmp slt i64 %i.next, 4
+  br i1 %ci, label %inner, label %outer.latch
+
+outer.latch:
+  %s.in = phi i32 [ %t.next, %inner ]
+  %j.next = add i64 %j, 1
+  %cj = icmp slt i64 %j.next, %m
+  br i1 %cj, label %outer, label %exit
+
+exit:
+  ret i32 %s.in
+}
+
+; Con p nullo stampa e termina il programma: tocca solo la memoria della libreria C
+define void @check(ptr %p) inaccessiblememonly {
+entry:
+  %null = icmp eq ptr %p, null
+  br i1 %null, label %fail, label %ok
+
+fail:
+  %r = call i32 @puts(ptr @.stop)
+  call void @exit(i32 0)
+  unreachable
+
+ok:
+  ret void
+}
+
+; Somma pesata di buf
+define i32 @checksum() {
+entry:
+  br label %body
+
+body:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %body ]
+  %s = phi i32 [ 0, %entry ], [ %s.next, %body ]
+  %p = getelementptr [128 x i32], ptr @buf, i64 0, i64 %i
+  %v = load i32, ptr %p
+  %s31 = mul i32 %s, 31
+  %s.next = add i32 %s31, %v
+  %i.next = add i64 %i, 1
+  %c = icmp slt i64 %i.next, 128
+  br i1 %c, label %body, label %exit
+
+exit:
+  ret i32 %s.next
+}
+
+declare i32 @puts(ptr)
+declare void @exit(i32) noreturn
+declare i32 @printf(ptr, ...)
+
+define void @print(ptr %name, i64 %m, i32 %v) {
+  %r = call i32 (ptr, ...) @printf(ptr @.fmt, ptr %name, i64 %m, i32 %v)
+  ret void
+}
+
+define i32 @main() {
+entry:
+  br label %loop
+
+loop:
+  %m = phi i64 [ 1, %entry ], [ %m.next, %loop ]
+  %m32 = trunc i64 %m to i32
+  %a = sub i32 %m32, 9
+  call void @rows(i64 %m, i32 %a, i32 -3)
+  %c0 = call i32 @checksum()
+  call void @print(ptr @.rows, i64 %m, i32 %c0)
+  %d = sub i32 %m32, 20
+  %r1 = call i32 @divide(i64 %m, i32 -1000003, i32 %d)
+  call void @print(ptr @.divide, i64 %m, i32 %r1)
+  store i32 %a, ptr @k
+  %r2 = call i32 @guarded(ptr @k, i64 %m)
+  call void @print(ptr @.guarded, i64 %m, i32 %r2)
+  %m.next = add i64 %m, 1
+  %done = icmp eq i64 %m.next, 17
+  br i1 %done, label %exit, label %loop
+
+exit:
+  %g = call i32 @guarded(ptr null, i64 3)
+  ret i32 %g
+}
@@ -0,0 +1,234 @@
+; ModuleID = 'Promotion.ll'
+source_filename = "Promotion.ll"
+target datalayout = "e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-i128:128-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-pc-linux-gnu"
+
+@total = global i32 0
+@data = global [16 x i32] [i32 5, i32 -3, i32 8, i32 -2147483648, i32 2147483647, i32 0, i32 1, i32 -1, i32 7, i32 9, i32 -11, i32 13, i32 100, i32 -100, i32 42, i32 3]
+@buf = global [16 x i32] zeroinitializer
+@.fmt = private unnamed_addr constant [11 x i8] c"%s %d: %d\0A\00"
+@.global = private unnamed_addr constant [7 x i8] c"global\00"
+@.noalias = private unnamed_addr constant [8 x i8] c"noalias\00"
+@.conditional = private unnamed_addr constant [12 x i8] c"conditional\00"
+@.types = private unnamed_addr constant [6 x i8] c"types\00"
+@.aliased = private unnamed_addr constant [8 x i8] c"aliased\00"
+@.guarded = private unnamed_addr constant [8 x i8] c"guarded\00"
+@.stop = private unnamed_addr constant [5 x i8] c"stop\00"
+
+define void @global(i64 %n) {
+entry:
+  %guard = icmp sgt i64 %n, 0
+  br i1 %guard, label %body.preheader, label %exit
+
+body.preheader:                                   ; preds = %entry
+  %total.promoted = load i32, ptr @total, align 4
+  br label %body
+
+body:                                             ; preds = %body.preheader, %body
+  %t1 = phi i32 [ %s, %body ], [ %total.promoted, %body.preheader ]
+  %i = phi i64 [ %i.next, %body ], [ 0, %body.preheader ]
+  %p = getelementptr [16 x i32], ptr @data, i64 0, i64 %i
+  %v = load i32, ptr %p, align 4
+  %s = add i32 %t1, %v
+  %i.next = add i64 %i, 1
+  %c = icmp slt i64 %i.next, %n
+  br i1 %c, label %body, label %exit.loopexit
+
+exit.loopexit:                                    ; preds = %body
+  %s.lcssa = phi i32 [ %s, %body ]
+  store i32 %s.lcssa, ptr @total, align 4
+  br label %exit
+
+exit:                                             ; preds = %exit.loopexit, %entry
+  ret void
+}
+
+define void @noalias(ptr noalias %sum, ptr noalias %max, ptr noalias %in, i64 %n) {
+entry:
+  %sum.promoted = load i32, ptr %sum, align 4
+  %max.promoted = load i32, ptr %max, align 4
+  br label %body
+
+body:                                             ; preds = %body, %entry
+  %m2 = phi i32 [ %max.promoted, %entry ], [ %m.next, %body ]
+  %s1 = phi i32 [ %sum.promoted, %entry ], [ %s.next, %body ]
+  %i = phi i64 [ 0, %entry ], [ %i.next, %body ]
+  %p = getelementptr i32, ptr %in, i64 %i
+  %v = load i32, ptr %p, align 4
+  %s.next = add i32 %s1, %v
+  %gt = icmp sgt i32 %v, %m2
+  %m.next = select i1 %gt, i32 %v, i32 %m2
+  %i.next = add i64 %i, 1
+  %c = icmp slt i64 %i.next, %n
+  br i1 %c, label %body, label %exit
+
+exit:                                             ; preds = %body
+  %m.next.lcssa = phi i32 [ %m.next, %body ]
+  %s.next.lcssa = phi i32 [ %s.next, %body ]
+  store i32 %m.next.lcssa, ptr %max, align 4
+  store i32 %s.next.lcssa, ptr %sum, align 4
+  ret void
+}
+
+define void @conditional(ptr noalias %acc, ptr noalias %in, i64 %n) {
+entry:
+  br label %body
+
+body:                                             ; preds = %latch, %entry
+  %i = phi i64 [ 0, %entry ], [ %i.next, %latch ]
+  %p = getelementptr i32, ptr %in, i64 %i
+  %v = load i32, ptr %p, align 4
+  %neg = icmp slt i32 %v, 0
+  br i1 %neg, label %then, label %latch
+
+then:                                             ; preds = %body
+  %a = load i32, ptr %acc, align 4
+  %a.next = sub i32 %a, %v
+  store i32 %a.next, ptr %acc, align 4
+  br label %latch
+
+latch:                                            ; preds = %then, %body
+  %i.next = add i64 %i, 1
+  %c = icmp slt i64 %i.next, %n
+  br i1 %c, label %body, label %exit
+
+exit:                                             ; preds = %latch
+  ret void
+}
+
+define void @types(ptr noalias %acc, ptr noalias %in, i64 %n) {
+entry:
+  br label %body
+
+body:                                             ; preds = %body, %entry
+  %i = phi i64 [ 0, %entry ], [ %i.next, %body ]
+  %p = getelementptr i32, ptr %in, i64 %i
+  %v = load i32, ptr %p, align 4
+  %a = load i32, ptr %acc, align 4
+  %x = xor i32 %a, %v
+  %b = trunc i32 %x to i8
+  store i8 %b, ptr %acc, align 1
+  %i.next = add i64 %i, 1
+  %c = icmp slt i64 %i.next, %n
+  br i1 %c, label %body, label %exit
+
+exit:                                             ; preds = %body
+  ret void
+}
+
+define void @aliased(ptr %acc, ptr %out, ptr %in, i64 %n) {
+entry:
+  br label %body
+
+body:                                             ; preds = %body, %entry
+  %i = phi i64 [ 0, %entry ], [ %i.next, %body ]
+  %p = getelementptr i32, ptr %in, i64 %i
+  %v = load i32, ptr %p, align 4
+  %a = load i32, ptr %acc, align 4
+  %a.next = add i32 %a, %v
+  store i32 %a.next, ptr %acc, align 4
+  %q = getelementptr i32, ptr %out, i64 %i
+  store i32 %a.next, ptr %q, align 4
+  %i.next = add i64 %i, 1
+  %c = icmp slt i64 %i.next, %n
+  br i1 %c, label %body, label %exit
+
+exit:                                             ; preds = %body
+  ret void
+}
+
+define i32 @guarded(ptr %p, i64 %n) {
+entry:
+  br label %body
+
+body:                                             ; preds = %body, %entry
+  %i = phi i64 [ 0, %entry ], [ %i.next, %body ]
+  %s = phi i32 [ 0, %entry ], [ %s.next, %body ]
+  call void @check(ptr %p)
+  %v = load i32, ptr %p, align 4
+  %s.next = add i32 %s, %v
+  %i.next = add i64 %i, 1
+  %c = icmp slt i64 %i.next, %n
+  br i1 %c, label %body, label %exit
+
+exit:                                             ; preds = %body
+  %s.next.lcssa = phi i32 [ %s.next, %body ]
+  ret i32 %s.next.lcssa
+}
+
+; Function Attrs: inaccessiblememonly
+define void @check(ptr %p) #0 {
+entry:
+  %null = icmp eq ptr %p, null
+  br i1 %null, label %fail, label %ok
+
+fail:                                             ; preds = %entry
+  %r = call i32 @puts(ptr @.stop)
+  call void @exit(i32 0)
+  unreachable
+
+ok:                                               ; preds = %entry
+  ret void
+}
+
+declare i32 @puts(ptr)
+
+; Function Attrs: noreturn
+declare void @exit(i32) #1
+
+declare i32 @printf(ptr, ...)
+
+define void @print(ptr %name, i64 %n, i32 %v) {
+  %r = call i32 (ptr, ...) @printf(ptr @.fmt, ptr %name, i64 %n, i32 %v)
+  ret void
+}
+
+define i32 @main() {
+entry:
+  %sum = alloca i32, align 4
+  %max = alloca i32, align 4
+  %acc = alloca i32, align 4
+  %b1 = getelementptr [16 x i32], ptr @buf, i64 0, i64 1
+  br label %loop
+
+loop:                                             ; preds = %loop, %entry
+  %n = phi i64 [ 1, %entry ], [ %n.next, %loop ]
+  call void @global(i64 %n)
+  %t = load i32, ptr @total, align 4
+  call void @print(ptr @.global, i64 %n, i32 %t)
+  store i32 0, ptr %sum, align 4
+  store i32 -2147483648, ptr %max, align 4
+  call void @noalias(ptr %sum, ptr %max, ptr @data, i64 %n)
+  %s = load i32, ptr %sum, align 4
+  call void @print(ptr @.noalias, i64 %n, i32 %s)
+  %m = load i32, ptr %max, align 4
+  call void @print(ptr @.noalias, i64 %n, i32 %m)
+  store i32 0, ptr %acc, align 4
+  call void @conditional(ptr %acc, ptr @data, i64 %n)
+  %a0 = load i32, ptr %acc, align 4
+  call void @print(ptr @.conditional, i64 %n, i32 %a0)
+  store i32 -1, ptr %acc, align 4
+  call void @types(ptr %acc, ptr @data, i64 %n)
+  %a1 = load i32, ptr %acc, align 4
+  call void @print(ptr @.types, i64 %n, i32 %a1)
+  store i32 10, ptr %b1, align 4
+  call void @aliased(ptr %b1, ptr @buf, ptr @data, i64 %n)
+  %a2 = load i32, ptr %b1, align 4
+  call void @print(ptr @.aliased, i64 %n, i32 %a2)
+  %bl = getelementptr [16 x i32], ptr @buf, i64 0, i64 %n
+  %bl.prev = getelementptr i32, ptr %bl, i64 -1
+  %a3 = load i32, ptr %bl.prev, align 4
+  call void @print(ptr @.aliased, i64 %n, i32 %a3)
+  %g = call i32 @guarded(ptr @total, i64 %n)
+  call void @print(ptr @.guarded, i64 %n, i32 %g)
+  %n.next = add i64 %n, 1
+  %done = icmp eq i64 %n.next, 17
+  br i1 %done, label %exit, label %loop
+
+exit:                                             ; preds = %loop
+  %g0 = call i32 @guarded(ptr null, i64 3)
+  ret i32 %g0
+}
+
+attributes #0 = { inaccessiblememonly }
+attributes #1 = { noreturn }
@@ -0,0 +1,236 @@
+; Promozione a registro (licmpass): un accumulo in una globale e due puntatori noalias
+; vengono promossi, mentre restano in memoria uno store in un ramo che non domina le
+; uscite, un puntatore letto e scritto con tipi diversi e un puntatore che può
+; sovrapporsi agli altri accessi del loop (versioning disattivato, vedi Versioning.ll).
+; Resta nel loop anche un load invariante preceduto da una chiamata che può terminare
+; il programma (main la fa scattare per ultima, con un puntatore nullo):
+;   opt -load <plugin> -load-pass-plugin <plugin> -passes='loop(licmpass)' -licmpass-versioning=false \
+;       Promotion.ll -S -o Promotion-res.ll
+;   lli Promotion.ll e lli Promotion-res.ll devono stampare le stesse righe
+target datalayout = "e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-i128:128-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-pc-linux-gnu"
+
+@total = global i32 0
+@data = global [16 x i32] [i32 5, i32 -3, i32 8, i32 -2147483648, i32 2147483647, i32 0, i32 1, i32 -1, i32 7, i32 9, i32 -11, i32 13, i32 100, i32 -100, i32 42, i32 3]
+@buf = global [16 x i32] zeroinitializer
+@.fmt = private unnamed_addr constant [11 x i8] c"%s %d: %d\0A\00"
+@.global = private unnamed_addr constant [7 x i8] c"global\00"
+@.noalias = private unnamed_addr constant [8 x i8] c"noalias\00"
+@.conditional = private unnamed_addr constant [12 x i8] c"conditional\00"
+@.types = private unnamed_addr constant [6 x i8] c"types\00"
+@.aliased = private unnamed_addr constant [8 x i8] c"aliased\00"
+@.guarded = private unnamed_addr constant [8 x i8] c"guarded\00"
+@.stop = private unnamed_addr constant [5 x i8] c"stop\00"
+
+; for(i=0; i<n; i++) total+=data[i];
+define void @global(i64 %n) {
+entry:
+  %guard = icmp sgt i64 %n, 0
+  br i1 %guard, label %body, label %exit
+
+body:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %body ]
+  %p = getelementptr [16 x i32], ptr @data, i64 0, i64 %i
+  %v = load i32, ptr %p
+  %t = load i32, ptr @total
+  %s = add i32 %t, %v
+  store i32 %s, ptr @total
+  %i.next = add i64 %i, 1
+  %c = icmp slt i64 %i.next, %n
+  br i1 %c, label %body, label %exit
+
+exit:
+  ret void
+}
+
+; do { *sum+=in[i]; *max=max(*max,in[i]); } while(++i<n);
+define void @noalias(ptr noalias %sum, ptr noalias %max, ptr noalias %in, i64 %n) {
+entry:
+  br label %body
+
+body:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %body ]
+  %p = getelementptr i32, ptr %in, i64 %i
+  %v = load i32, ptr %p
+  %s = load i32, ptr %sum
+  %s.next = add i32 %s, %v
+  store i32 %s.next, ptr %sum
+  %m = load i32, ptr %max
+  %gt = icmp sgt i32 %v, %m
+  %m.next = select i1 %gt, i32 %v, i32 %m
+  store i32 %m.next, ptr %max
+  %i.next = add i64 %i, 1
+  %c = icmp slt i64 %i.next, %n
+  br i1 %c, label %body, label %exit
+
+exit:
+  ret void
+}
+
+; Lo store avviene solo per i valori negativi: scriverlo nell'uscita sarebbe nuovo
+define void @conditional(ptr noalias %acc, ptr noalias %in, i64 %n) {
+entry:
+  br label %body
+
+body:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %latch ]
+  %p = getelementptr i32, ptr %in, i64 %i
+  %v = load i32, ptr %p
+  %neg = icmp slt i32 %v, 0
+  br i1 %neg, label %then, label %latch
+
+then:
+  %a = load i32, ptr %acc
+  %a.next = sub i32 %a, %v
+  store i32 %a.next, ptr %acc
+  br label %latch
+
+latch:
+  %i.next = add i64 %i, 1
+  %c = icmp slt i64 %i.next, %n
+  br i1 %c, label %body, label %exit
+
+exit:
+  ret void
+}
+
+; Stesso puntatore letto come i32 e scritto come i8
+define void @types(ptr noalias %acc, ptr noalias %in, i64 %n) {
+entry:
+  br label %body
+
+body:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %body ]
+  %p = getelementptr i32, ptr %in, i64 %i
+  %v = load i32, ptr %p
+  %a = load i32, ptr %acc
+  %x = xor i32 %a, %v
+  %b = trunc i32 %x to i8
+  store i8 %b, ptr %acc
+  %i.next = add i64 %i, 1
+  %c = icmp slt i64 %i.next, %n
+  br i1 %c, label %body, label %exit
+
+exit:
+  ret void
+}
+
+; acc può puntare dentro out: ogni store in out[i] può cambiare *acc
+define void @aliased(ptr %acc, ptr %out, ptr %in, i64 %n) {
+entry:
+  br label %body
+
+body:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %body ]
+  %p = getelementptr i32, ptr %in, i64 %i
+  %v = load i32, ptr %p
+  %a = load i32, ptr %acc
+  %a.next = add i32 %a, %v
+  store i32 %a.next, ptr %acc
+  %q = getelementptr i32, ptr %out, i64 %i
+  store i32 %a.next, ptr %q
+  %i.next = add i64 %i, 1
+  %c = icmp slt i64 %i.next, %n
+  br i1 %c, label %body, label %exit
+
+exit:
+  ret void
+}
+
+; do { check(p); s+=*p; } while(++i<n); check può terminare il programma, quindi il load
+; non va anticipato anche se domina l'uscita
+define i32 @guarded(ptr %p, i64 %n) {
+entry:
+  br label %body
+
+body:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %body ]
+  %s = phi i32 [ 0, %entry ], [ %s.next, %body ]
+  call void @check(ptr %p)
+  %v = load i32, ptr %p
+  %s.next = add i32 %s, %v
+  %i.next = add i64 %i, 1
+  %c = icmp slt i64 %i.next, %n
+  br i1 %c, label %body, label %exit
+
+exit:
+  ret i32 %s.next
+}
+
+; Con p nullo stampa e termina il programma: tocca solo la memoria della libreria C
+define void @check(ptr %p) inaccessiblememonly {
+entry:
+  %null = icmp eq ptr %p, null
+  br i1 %null, label %fail, label %ok
+
+fail:
+  %r = call i32 @puts(ptr @.stop)
+  call void @exit(i32 0)
+  unreachable
+
+ok:
+  ret void
+}
+
+declare i32 @puts(ptr)
+declare void @exit(i32) noreturn
+declare i32 @printf(ptr, ...)
+
+define void @print(ptr %name, i64 %n, i32 %v) {
+  %r = call i32 (ptr, ...) @printf(ptr @.fmt, ptr %name, i64 %n, i32 %v)
+  ret void
+}
+
+define i32 @main() {
+entry:
+  %sum = alloca i32
+  %max = alloca i32
+  %acc = alloca i32
+  br label %loop
+
+loop:
+  %n = phi i64 [ 1, %entry ], [ %n.next, %loop ]
+  call void @global(i64 %n)
+  %t = load i32, ptr @total
+  call void @print(ptr @.global, i64 %n, i32 %t)
+
+  store i32 0, ptr %sum
+  store i32 -2147483648, ptr %max
+  call void @noalias(ptr %sum, ptr %max, ptr @data, i64 %n)
+  %s = load i32, ptr %sum
+  call void @print(ptr @.noalias, i64 %n, i32 %s)
+  %m = load i32, ptr %max
+  call void @print(ptr @.noalias, i64 %n, i32 %m)
+
+  store i32 0, ptr %acc
+  call void @conditional(ptr %acc, ptr @data, i64 %n)
+  %a0 = load i32, ptr %acc
+  call void @print(ptr @.conditional, i64 %n, i32 %a0)
+
+  store i32 -1, ptr %acc
+  call void @types(ptr %acc, ptr @data, i64 %n)
+  %a1 = load i32, ptr %acc
+  call void @print(ptr @.types, i64 %n, i32 %a1)
+
+  ; acc = &buf[1]: dalla seconda iterazione *acc è anche out[1]
+  %b1 = getelementptr [16 x i32], ptr @buf, i64 0, i64 1
+  store i32 10, ptr %b1
+  call void @aliased(ptr %b1, ptr @buf, ptr @data, i64 %n)
+  %a2 = load i32, ptr %b1
+  call void @print(ptr @.aliased, i64 %n, i32 %a2)
+  %bl = getelementptr [16 x i32], ptr @buf, i64 0, i64 %n
+  %bl.prev = getelementptr i32, ptr %bl, i64 -1
+  %a3 = load i32, ptr %bl.prev
+  call void @print(ptr @.aliased, i64 %n, i32 %a3)
+
+  %g = call i32 @guarded(ptr @total, i64 %n)
+  call void @print(ptr @.guarded, i64 %n, i32 %g)
+
+  %n.next = add i64 %n, 1
+  %done = icmp eq i64 %n.next, 17
+  br i1 %done, label %exit, label %loop
+
+exit:
+  %g0 = call i32 @guarded(ptr null, i64 3)
+  ret i32 %g0
+}
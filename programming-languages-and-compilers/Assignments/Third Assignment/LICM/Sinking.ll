@@ -0,0 +1,123 @@
+; Sinking nei blocchi di uscita (licmpass): espressioni calcolate a ogni iterazione ma
+; usate solo dopo il loop, anche attraverso una catena di istruzioni, vengono ricalcolate
+; nelle uscite; con due uscite ognuna riceve la propria copia. Un'espressione usata
+; anche nel corpo resta nel loop, mentre una divisione usata solo dopo si sposta: la
+; copia nell'uscita non è speculativa, l'ultima iterazione la eseguiva già:
+;   opt -load-pass-plugin <plugin> -passes='loop(licmpass)' Sinking.ll -S -o Sinking-res.ll
+;   lli Sinking.ll e lli Sinking-res.ll devono stampare le stesse righe
+target datalayout = "e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-i128:128-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-pc-linux-gnu"
+
+@data = global [16 x i32] [i32 5, i32 -3, i32 8, i32 -2147483648, i32 2147483647, i32 0, i32 1, i32 -1, i32 7, i32 9, i32 -11, i32 13, i32 100, i32 -100, i32 42, i32 3]
+@.fmt = private unnamed_addr constant [14 x i8] c"%s %d %d: %d\0A\00"
+@.chain = private unnamed_addr constant [6 x i8] c"chain\00"
+@.twoexits = private unnamed_addr constant [9 x i8] c"twoexits\00"
+@.usedinside = private unnamed_addr constant [11 x i8] c"usedinside\00"
+
+; do { v=data[i]; t=(v*3+x)^i; } while(++i<n); return t;
+define i32 @chain(i32 %x, i64 %n) {
+entry:
+  br label %body
+
+body:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %body ]
+  %p = getelementptr [16 x i32], ptr @data, i64 0, i64 %i
+  %v = load i32, ptr %p
+  %m = mul i32 %v, 3
+  %a = add i32 %m, %x
+  %i32 = trunc i64 %i to i32
+  %t = xor i32 %a, %i32
+  %i.next = add i64 %i, 1
+  %c = icmp slt i64 %i.next, %n
+  br i1 %c, label %body, label %exit
+
+exit:
+  %t.lcssa = phi i32 [ %t, %body ]
+  ret i32 %t.lcssa
+}
+
+; Esce quando data[i]==x o dopo n iterazioni: d=v-x serve a entrambe le uscite
+define i32 @twoexits(i32 %x, i64 %n) {
+entry:
+  br label %body
+
+body:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %latch ]
+  %p = getelementptr [16 x i32], ptr @data, i64 0, i64 %i
+  %v = load i32, ptr %p
+  %d = sub i32 %v, %x
+  %e = shl i32 %d, 2
+  %found = icmp eq i32 %v, %x
+  br i1 %found, label %hit, label %latch
+
+latch:
+  %i.next = add i64 %i, 1
+  %c = icmp slt i64 %i.next, %n
+  br i1 %c, label %body, label %miss
+
+hit:
+  %d.hit = phi i32 [ %d, %body ]
+  %r.hit = add i32 %d.hit, 1000
+  ret i32 %r.hit
+
+miss:
+  %e.miss = phi i32 [ %e, %latch ]
+  ret i32 %e.miss
+}
+
+; s dipende da a dell'iterazione precedente: a resta nel loop, q (divisione) no
+define i32 @usedinside(i32 %x, i64 %n) {
+entry:
+  br label %body
+
+body:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %body ]
+  %s = phi i32 [ 0, %entry ], [ %a, %body ]
+  %p = getelementptr [16 x i32], ptr @data, i64 0, i64 %i
+  %v = load i32, ptr %p
+  %a = add i32 %s, %v
+  %q = sdiv i32 %v, 7
+  %i.next = add i64 %i, 1
+  %c = icmp slt i64 %i.next, %n
+  br i1 %c, label %body, label %exit
+
+exit:
+  %a.lcssa = phi i32 [ %a, %body ]
+  %q.lcssa = phi i32 [ %q, %body ]
+  %r = add i32 %a.lcssa, %q.lcssa
+  ret i32 %r
+}
+
+declare i32 @printf(ptr, ...)
+
+define void @print(ptr %name, i32 %x, i64 %n, i32 %v) {
+  %r = call i32 (ptr, ...) @printf(ptr @.fmt, ptr %name, i32 %x, i64 %n, i32 %v)
+  ret void
+}
+
+define i32 @main() {
+entry:
+  br label %loop
+
+loop:
+  %n = phi i64 [ 1, %entry ], [ %n.next, %loop ]
+  %n32 = trunc i64 %n to i32
+  %x = mul i32 %n32, 1000003
+  %r0 = call i32 @chain(i32 %x, i64 %n)
+  call void @print(ptr @.chain, i32 %x, i64 %n, i32 %r0)
+  %k = and i64 %n, 7
+  %pk = getelementptr [16 x i32], ptr @data, i64 0, i64 %k
+  %y = load i32, ptr %pk
+  %r1 = call i32 @twoexits(i32 %y, i64 %n)
+  call void @print(ptr @.twoexits, i32 %y, i64 %n, i32 %r1)
+  %r2 = call i32 @twoexits(i32 %x, i64 %n)
+  call void @print(ptr @.twoexits, i32 %x, i64 %n, i32 %r2)
+  %r3 = call i32 @usedinside(i32 %x, i64 %n)
+  call void @print(ptr @.usedinside, i32 %x, i64 %n, i32 %r3)
+  %n.next = add i64 %n, 1
+  %done = icmp eq i64 %n.next, 17
+  br i1 %done, label %exit, label %loop
+
+exit:
+  ret i32 0
+}
@@ -0,0 +1,221 @@
+; ModuleID = 'Versioning.ll'
+source_filename = "Versioning.ll"
+target datalayout = "e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-i128:128-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-pc-linux-gnu"
+
+@in = global [16 x i32] [i32 5, i32 -3, i32 8, i32 -2147483648, i32 2147483647, i32 0, i32 1, i32 -1, i32 7, i32 9, i32 -11, i32 13, i32 100, i32 -100, i32 42, i32 3]
+@out = global [20 x i32] zeroinitializer
+@other = global i32 0
+@.fmt = private unnamed_addr constant [13 x i8] c"%s %d %d %d\0A\00"
+@.accumulate = private unnamed_addr constant [11 x i8] c"accumulate\00"
+@.scale = private unnamed_addr constant [6 x i8] c"scale\00"
+
+define void @accumulate(ptr %out, ptr %in, ptr %acc, i64 %n) {
+entry:
+  %in3 = ptrtoint ptr %in to i64
+  %out2 = ptrtoint ptr %out to i64
+  %acc1 = ptrtoint ptr %acc to i64
+  %0 = add i64 %acc1, 4
+  %smax = call i64 @llvm.smax.i64(i64 %n, i64 1)
+  %1 = shl i64 %smax, 2
+  %2 = add i64 %out2, %1
+  %3 = icmp ule i64 %2, %acc1
+  %4 = icmp ule i64 %0, %out2
+  %alias.disjoint = or i1 %4, %3
+  %5 = add i64 %in3, %1
+  %6 = icmp ule i64 %5, %acc1
+  %7 = icmp ule i64 %0, %in3
+  %alias.disjoint4 = or i1 %7, %6
+  %alias.disjoint5 = and i1 %alias.disjoint, %alias.disjoint4
+  br i1 %alias.disjoint5, label %body.ph, label %body.ph.slow
+
+body.ph.slow:                                     ; preds = %entry
+  br label %body.slow
+
+body.slow:                                        ; preds = %body.slow, %body.ph.slow
+  %i.slow = phi i64 [ 0, %body.ph.slow ], [ %i.next.slow, %body.slow ]
+  %p.slow = getelementptr i32, ptr %in, i64 %i.slow
+  %v.slow = load i32, ptr %p.slow, align 4
+  %a.slow = load i32, ptr %acc, align 4
+  %a.next.slow = add i32 %a.slow, %v.slow
+  store i32 %a.next.slow, ptr %acc, align 4
+  %h.slow = ashr i32 %v.slow, 1
+  %q.slow = getelementptr i32, ptr %out, i64 %i.slow
+  store i32 %h.slow, ptr %q.slow, align 4
+  %i.next.slow = add i64 %i.slow, 1
+  %c.slow = icmp slt i64 %i.next.slow, %n
+  br i1 %c.slow, label %body.slow, label %exit.loopexit6, !llvm.loop !0
+
+body.ph:                                          ; preds = %entry
+  %acc.promoted = load i32, ptr %acc, align 4
+  br label %body
+
+body:                                             ; preds = %body, %body.ph
+  %a7 = phi i32 [ %acc.promoted, %body.ph ], [ %a.next, %body ]
+  %i = phi i64 [ 0, %body.ph ], [ %i.next, %body ]
+  %p = getelementptr i32, ptr %in, i64 %i
+  %v = load i32, ptr %p, align 4, !alias.scope !2, !noalias !5
+  %a.next = add i32 %a7, %v
+  %h = ashr i32 %v, 1
+  %q = getelementptr i32, ptr %out, i64 %i
+  store i32 %h, ptr %q, align 4, !alias.scope !7, !noalias !5
+  %i.next = add i64 %i, 1
+  %c = icmp slt i64 %i.next, %n
+  br i1 %c, label %body, label %exit.loopexit, !llvm.loop !9
+
+exit.loopexit:                                    ; preds = %body
+  %a.next.lcssa = phi i32 [ %a.next, %body ]
+  store i32 %a.next.lcssa, ptr %acc, align 4
+  br label %exit
+
+exit.loopexit6:                                   ; preds = %body.slow
+  br label %exit
+
+exit:                                             ; preds = %exit.loopexit6, %exit.loopexit
+  ret void
+}
+
+define void @scale(ptr %out, ptr %in, ptr %k, i64 %n) {
+entry:
+  %out2 = ptrtoint ptr %out to i64
+  %k1 = ptrtoint ptr %k to i64
+  %0 = add i64 %k1, 4
+  %smax = call i64 @llvm.smax.i64(i64 %n, i64 1)
+  %1 = shl i64 %smax, 2
+  %2 = add i64 %out2, %1
+  %3 = icmp ule i64 %2, %k1
+  %4 = icmp ule i64 %0, %out2
+  %alias.disjoint = or i1 %4, %3
+  br i1 %alias.disjoint, label %body.ph, label %body.ph.slow
+
+body.ph.slow:                                     ; preds = %entry
+  br label %body.slow
+
+body.slow:                                        ; preds = %body.slow, %body.ph.slow
+  %i.slow = phi i64 [ 0, %body.ph.slow ], [ %i.next.slow, %body.slow ]
+  %f.slow = load i32, ptr %k, align 4
+  %p.slow = getelementptr i32, ptr %in, i64 %i.slow
+  %v.slow = load i32, ptr %p.slow, align 4
+  %m.slow = mul i32 %v.slow, %f.slow
+  %q.slow = getelementptr i32, ptr %out, i64 %i.slow
+  store i32 %m.slow, ptr %q.slow, align 4
+  %i.next.slow = add i64 %i.slow, 1
+  %c.slow = icmp slt i64 %i.next.slow, %n
+  br i1 %c.slow, label %body.slow, label %exit.loopexit3, !llvm.loop !10
+
+body.ph:                                          ; preds = %entry
+  %f = load i32, ptr %k, align 4, !alias.scope !11, !noalias !14
+  br label %body
+
+body:                                             ; preds = %body, %body.ph
+  %i = phi i64 [ 0, %body.ph ], [ %i.next, %body ]
+  %p = getelementptr i32, ptr %in, i64 %i
+  %v = load i32, ptr %p, align 4
+  %m = mul i32 %v, %f
+  %q = getelementptr i32, ptr %out, i64 %i
+  store i32 %m, ptr %q, align 4, !alias.scope !14, !noalias !11
+  %i.next = add i64 %i, 1
+  %c = icmp slt i64 %i.next, %n
+  br i1 %c, label %body, label %exit.loopexit, !llvm.loop !16
+
+exit.loopexit:                                    ; preds = %body
+  br label %exit
+
+exit.loopexit3:                                   ; preds = %body.slow
+  br label %exit
+
+exit:                                             ; preds = %exit.loopexit3, %exit.loopexit
+  ret void
+}
+
+declare i32 @printf(ptr, ...)
+
+define void @print(ptr %name, i64 %n, ptr %p) {
+entry:
+  br label %body
+
+body:                                             ; preds = %body, %entry
+  %i = phi i64 [ 0, %entry ], [ %i.next, %body ]
+  %s = phi i32 [ 0, %entry ], [ %s.next, %body ]
+  %q = getelementptr [20 x i32], ptr @out, i64 0, i64 %i
+  %v = load i32, ptr %q, align 4
+  %i32 = trunc i64 %i to i32
+  %w = add i32 %i32, 1
+  %vw = mul i32 %v, %w
+  %s.next = add i32 %s, %vw
+  %i.next = add i64 %i, 1
+  %c = icmp slt i64 %i.next, 20
+  br i1 %c, label %body, label %exit
+
+exit:                                             ; preds = %body
+  %s.next.lcssa = phi i32 [ %s.next, %body ]
+  %x = load i32, ptr %p, align 4
+  %r = call i32 (ptr, ...) @printf(ptr @.fmt, ptr %name, i64 %n, i32 %s.next.lcssa, i32 %x)
+  ret void
+}
+
+define void @clear() {
+  call void @llvm.memset.p0.i64(ptr @out, i8 0, i64 80, i1 false)
+  ret void
+}
+
+; Function Attrs: argmemonly nofree nounwind willreturn writeonly
+declare void @llvm.memset.p0.i64(ptr nocapture writeonly, i8, i64, i1 immarg) #0
+
+define void @run(i64 %n, ptr %p) {
+  call void @clear()
+  store i32 7, ptr %p, align 4
+  call void @accumulate(ptr @out, ptr @in, ptr %p, i64 %n)
+  call void @print(ptr @.accumulate, i64 %n, ptr %p)
+  call void @clear()
+  store i32 3, ptr %p, align 4
+  call void @scale(ptr @out, ptr @in, ptr %p, i64 %n)
+  call void @print(ptr @.scale, i64 %n, ptr %p)
+  ret void
+}
+
+define i32 @main() {
+entry:
+  %mid = getelementptr [20 x i32], ptr @out, i64 0, i64 4
+  br label %loop
+
+loop:                                             ; preds = %loop, %entry
+  %n = phi i64 [ 1, %entry ], [ %n.next, %loop ]
+  call void @run(i64 %n, ptr @other)
+  call void @run(i64 %n, ptr @out)
+  call void @run(i64 %n, ptr %mid)
+  %last = getelementptr [20 x i32], ptr @out, i64 0, i64 %n
+  %inside = getelementptr i32, ptr %last, i64 -1
+  call void @run(i64 %n, ptr %inside)
+  call void @run(i64 %n, ptr %last)
+  %n.next = add i64 %n, 1
+  %done = icmp eq i64 %n.next, 17
+  br i1 %done, label %exit, label %loop
+
+exit:                                             ; preds = %loop
+  ret i32 0
+}
+
+; Function Attrs: nofree nosync nounwind readnone speculatable willreturn
+declare i64 @llvm.smax.i64(i64, i64) #1
+
+attributes #0 = { argmemonly nofree nounwind willreturn writeonly }
+attributes #1 = { nofree nosync nounwind readnone speculatable willreturn }
+
+!0 = distinct !{!0, !1}
+!1 = !{!"llvm.loop.runtime_alias_check.disable", i32 1}
+!2 = !{!3}
+!3 = distinct !{!3, !4}
+!4 = distinct !{!4, !"RuntimeAliasCheck"}
+!5 = !{!6}
+!6 = distinct !{!6, !4}
+!7 = !{!8}
+!8 = distinct !{!8, !4}
+!9 = distinct !{!9, !1}
+!10 = distinct !{!10, !1}
+!11 = !{!12}
+!12 = distinct !{!12, !13}
+!13 = distinct !{!13, !"RuntimeAliasCheck"}
+!14 = !{!15}
+!15 = distinct !{!15, !13}
+!16 = distinct !{!16, !1}
@@ -0,0 +1,128 @@
+; Versioning con controllo di alias a runtime (licmpass): *acc e *k hanno un indirizzo
+; invariante ma possono sovrapporsi a out[0..n); il loop viene duplicato dietro un
+; controllo sugli intervalli e solo la versione con gli intervalli disgiunti promuove
+; *acc e sposta il load di *k. main chiama entrambe le funzioni con puntatori disgiunti
+; e con puntatori sovrapposti all'inizio, in mezzo e alla fine di out:
+;   opt -load-pass-plugin <plugin> -passes='loop(licmpass)' Versioning.ll -S -o Versioning-res.ll
+;   lli Versioning.ll e lli Versioning-res.ll devono stampare le stesse righe
+target datalayout = "e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-i128:128-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-pc-linux-gnu"
+
+@in = global [16 x i32] [i32 5, i32 -3, i32 8, i32 -2147483648, i32 2147483647, i32 0, i32 1, i32 -1, i32 7, i32 9, i32 -11, i32 13, i32 100, i32 -100, i32 42, i32 3]
+@out = global [20 x i32] zeroinitializer
+@other = global i32 0
+@.fmt = private unnamed_addr constant [13 x i8] c"%s %d %d %d\0A\00"
+@.accumulate = private unnamed_addr constant [11 x i8] c"accumulate\00"
+@.scale = private unnamed_addr constant [6 x i8] c"scale\00"
+
+; do { *acc+=in[i]; out[i]=in[i]>>1; } while(++i<n);
+define void @accumulate(ptr %out, ptr %in, ptr %acc, i64 %n) {
+entry:
+  br label %body
+
+body:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %body ]
+  %p = getelementptr i32, ptr %in, i64 %i
+  %v = load i32, ptr %p
+  %a = load i32, ptr %acc
+  %a.next = add i32 %a, %v
+  store i32 %a.next, ptr %acc
+  %h = ashr i32 %v, 1
+  %q = getelementptr i32, ptr %out, i64 %i
+  store i32 %h, ptr %q
+  %i.next = add i64 %i, 1
+  %c = icmp slt i64 %i.next, %n
+  br i1 %c, label %body, label %exit
+
+exit:
+  ret void
+}
+
+; do { out[i]=in[i]*(*k); } while(++i<n);
+define void @scale(ptr %out, ptr %in, ptr %k, i64 %n) {
+entry:
+  br label %body
+
+body:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %body ]
+  %f = load i32, ptr %k
+  %p = getelementptr i32, ptr %in, i64 %i
+  %v = load i32, ptr %p
+  %m = mul i32 %v, %f
+  %q = getelementptr i32, ptr %out, i64 %i
+  store i32 %m, ptr %q
+  %i.next = add i64 %i, 1
+  %c = icmp slt i64 %i.next, %n
+  br i1 %c, label %body, label %exit
+
+exit:
+  ret void
+}
+
+declare i32 @printf(ptr, ...)
+
+; Stampa la somma pesata di out[0..20) e il valore puntato da p
+define void @print(ptr %name, i64 %n, ptr %p) {
+entry:
+  br label %body
+
+body:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %body ]
+  %s = phi i32 [ 0, %entry ], [ %s.next, %body ]
+  %q = getelementptr [20 x i32], ptr @out, i64 0, i64 %i
+  %v = load i32, ptr %q
+  %i32 = trunc i64 %i to i32
+  %w = add i32 %i32, 1
+  %vw = mul i32 %v, %w
+  %s.next = add i32 %s, %vw
+  %i.next = add i64 %i, 1
+  %c = icmp slt i64 %i.next, 20
+  br i1 %c, label %body, label %exit
+
+exit:
+  %x = load i32, ptr %p
+  %r = call i32 (ptr, ...) @printf(ptr @.fmt, ptr %name, i64 %n, i32 %s.next, i32 %x)
+  ret void
+}
+
+define void @clear() {
+  call void @llvm.memset.p0.i64(ptr @out, i8 0, i64 80, i1 false)
+  ret void
+}
+
+declare void @llvm.memset.p0.i64(ptr, i8, i64, i1)
+
+; Esegue le due funzioni con n elementi e con il puntatore scalare in 'p'
+define void @run(i64 %n, ptr %p) {
+  call void @clear()
+  store i32 7, ptr %p
+  call void @accumulate(ptr @out, ptr @in, ptr %p, i64 %n)
+  call void @print(ptr @.accumulate, i64 %n, ptr %p)
+  call void @clear()
+  store i32 3, ptr %p
+  call void @scale(ptr @out, ptr @in, ptr %p, i64 %n)
+  call void @print(ptr @.scale, i64 %n, ptr %p)
+  ret void
+}
+
+define i32 @main() {
+entry:
+  br label %loop
+
+loop:
+  %n = phi i64 [ 1, %entry ], [ %n.next, %loop ]
+  call void @run(i64 %n, ptr @other)
+  call void @run(i64 %n, ptr @out)
+  %mid = getelementptr [20 x i32], ptr @out, i64 0, i64 4
+  call void @run(i64 %n, ptr %mid)
+  %last = getelementptr [20 x i32], ptr @out, i64 0, i64 %n
+  %inside = getelementptr i32, ptr %last, i64 -1
+  call void @run(i64 %n, ptr %inside)
+  call void @run(i64 %n, ptr %last)
+  %n.next = add i64 %n, 1
+  %done = icmp eq i64 %n.next, 17
+  br i1 %done, label %exit, label %loop
+
+exit:
+  ret i32 0
+}
@@ -0,0 +1,294 @@
+#include "llvm/Transforms/Utils/RuntimeAliasCheck.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/MDBuilder.h"
+#include "llvm/Analysis/DomTreeUpdater.h"
+#include "llvm/Analysis/ScalarEvolutionExpressions.h"
+#include "llvm/Transforms/Utils/BasicBlockUtils.h"
+#include "llvm/Transforms/Utils/Cloning.h"
+#include "llvm/Transforms/Utils/LoopUtils.h"
+#include "llvm/Transforms/Utils/ScalarEvolutionExpander.h"
+#include "llvm/Transforms/Utils/SSAUpdater.h"
+#include "llvm/Support/CommandLine.h"
+
+using namespace llvm;
+
+//Controllo di alias a runtime e versioning dei loop, condivisi da PassLICM e LoopFusionPass
+
+static const char *VersioningDisabled="llvm.loop.runtime_alias_check.disable";
+
+static cl::opt<unsigned> MaxAliasChecks("runtime-alias-max-checks", cl::init(8), cl::Hidden,
+                                        cl::desc("Coppie di intervalli di memoria confrontate al più da un controllo di alias a runtime"));
+
+RuntimeAliasCheck::RuntimeAliasCheck(ArrayRef<Loop*> Loops, ScalarEvolution &SE, DominatorTree &DT)
+    : Loops(Loops.begin(), Loops.end()), SE(SE), DT(DT) {}
+
+bool RuntimeAliasCheck::isDisabled(const Loop *L){
+    return getBooleanLoopAttribute(L, VersioningDisabled);
+}
+
+void RuntimeAliasCheck::disable(Loop *L){
+    addStringMetadataToLoop(L, VersioningDisabled, 1);
+}
+
+//nel loop la divisione poteva essere sotto una condizione che la protegge: nel preheader no
+bool RuntimeAliasCheck::isSafeToExpandInPreheader(const Loop &L, const SCEV *S, ScalarEvolution &SE){
+    if(!SE.isLoopInvariant(S, &L))
+        return false;
+    return !SCEVExprContains(S, [](const SCEV *E){
+        const SCEVUDivExpr *D=dyn_cast<SCEVUDivExpr>(E);
+        return D && (!isa<SCEVConstant>(D->getRHS()) || cast<SCEVConstant>(D->getRHS())->getValue()->isZero());
+    });
+}
+
+//estremo inferiore (Max falso) o superiore dell'indirizzo S durante i loop: per le AddRec affini dei loop della
+//sequenza, e dei loro sottoloop, è il valore all'iterazione 0 o all'ultima, secondo il segno del passo. L'ultima è
+//il backedge-taken count, per eccesso quando il loop esce dall'header. Nullo se non si calcola nel preheader
+const SCEV *RuntimeAliasCheck::getBound(const SCEV *S, bool Max) const {
+    while(const SCEVAddRecExpr *AR=dyn_cast<SCEVAddRecExpr>(S)){
+        if(none_of(Loops, [&](Loop *L){ return L->contains(AR->getLoop()); }))
+            break;
+        if(!AR->isAffine())
+            return nullptr;
+        const SCEV *step=AR->getStepRecurrence(SE);
+        bool crescente=SE.isKnownNonNegative(step);
+        if(!crescente && !SE.isKnownNonPositive(step))
+            return nullptr;
+        if(crescente!=Max){
+            S=AR->getStart();
+            continue;
+        }
+        const SCEV *ultima=SE.getBackedgeTakenCount(AR->getLoop());
+        if(isa<SCEVCouldNotCompute>(ultima))
+            return nullptr;
+        S=AR->evaluateAtIteration(ultima, SE);
+    }
+    Instruction *punto=Loops.front()->getLoopPreheader()->getTerminator();
+    for(Loop *L : Loops){
+        if(!isSafeToExpandInPreheader(*L, S, SE))
+            return nullptr;
+    }
+    bool dominato=!SCEVExprContains(S, [&](const SCEV *E){
+        Instruction *I=isa<SCEVUnknown>(E) ? dyn_cast<Instruction>(cast<SCEVUnknown>(E)->getValue()) : nullptr;
+        return I && !DT.dominates(I, punto);
+    });
+    return dominato ? S : nullptr;
+}
+
+//base e intervallo di byte [Low, High) toccato dall'accesso in tutte le iterazioni, come interi grandi quanto un puntatore
+bool RuntimeAliasCheck::getRange(Instruction *I, const SCEV *&Base, const SCEV *&Low, const SCEV *&High) const {
+    Value *ptr=getLoadStorePointerOperand(I);
+    if(!ptr || isa<ScalableVectorType>(getLoadStoreType(I)))
+        return false;
+    const DataLayout &DL=I->getModule()->getDataLayout();
+    const SCEV *S=SE.getSCEV(ptr);
+    Base=SE.getPointerBase(S);
+    Low=getBound(S, false);
+    High=getBound(S, true);
+    if(!isa<SCEVUnknown>(Base) || !Low || !High)
+        return false;
+    Type *intPtr=DL.getIntPtrType(ptr->getType());
+    Low=SE.getPtrToIntExpr(Low, intPtr);
+    High=SE.getPtrToIntExpr(High, intPtr);
+    if(isa<SCEVCouldNotCompute>(Low) || isa<SCEVCouldNotCompute>(High))
+        return false;
+    uint64_t dimensione=DL.getTypeStoreSize(getLoadStoreType(I));
+    High=SE.getAddExpr(High, SE.getConstant(intPtr, dimensione));
+    return true;
+}
+
+bool RuntimeAliasCheck::addChecks(Instruction *A, ArrayRef<Instruction*> Others){
+    SmallVector<Instruction*,8> accessi{A};
+    accessi.append(Others.begin(), Others.end());
+    SmallVector<std::tuple<const SCEV*,const SCEV*,const SCEV*>,8> intervalli;
+    for(Instruction *I : accessi){
+        const SCEV *base, *low, *high;
+        if(!getRange(I, base, low, high))
+            return false;
+        intervalli.push_back({base, low, high});
+    }
+
+    //i gruppi nuovi prendono gli indici successivi a quelli esistenti, nell'ordine in cui compaiono
+    DenseMap<const SCEV*,unsigned> nuovi;
+    auto indice=[&](const SCEV *base){
+        auto it=Groups.find(base);
+        if(it!=Groups.end())
+            return (unsigned)(it-Groups.begin());
+        return nuovi.try_emplace(base, Groups.size()+nuovi.size()).first->second;
+    };
+    SmallSetVector<std::pair<unsigned,unsigned>,8> coppie(Pairs.begin(), Pairs.end());
+    unsigned a=indice(std::get<0>(intervalli.front()));
+    for(unsigned i=1; i<intervalli.size(); i++){
+        unsigned b=indice(std::get<0>(intervalli[i]));
+        if(a==b)
+            return false;
+        coppie.insert({std::min(a, b), std::max(a, b)});
+    }
+    if(coppie.size()>MaxAliasChecks)
+        return false;
+
+    Pairs=std::move(coppie);
+    for(unsigned i=0; i<accessi.size(); i++){
+        auto [base, low, high]=intervalli[i];
+        auto it=Groups.find(base);
+        if(it==Groups.end()){
+            it=Groups.insert({base, Group{low, high, {}}}).first;
+        }else{
+            it->second.Low=SE.getUMinExpr(it->second.Low, low);
+            it->second.High=SE.getUMaxExpr(it->second.High, high);
+        }
+        if(!is_contained(it->second.Accesses, accessi[i]))
+            it->second.Accesses.push_back(accessi[i]);
+    }
+    return true;
+}
+
+//aggiunge a LoopInfo la copia del loop L (con i sottoloop) fatta con VMap, come figlio di padre
+static Loop *clonaLoop(Loop *L, Loop *padre, ValueToValueMapTy &VMap, LoopInfo &LI){
+    Loop *copia=LI.AllocateLoop();
+    if(padre)
+        padre->addChildLoop(copia);
+    else
+        LI.addTopLevelLoop(copia);
+    for(BasicBlock *BB : L->blocks()){                      //l'header per primo
+        if(LI.getLoopFor(BB)==L)
+            copia->addBasicBlockToLoop(cast<BasicBlock>(VMap[BB]), LI);
+    }
+    for(Loop *figlio : *L)
+        clonaLoop(figlio, copia, VMap, LI);
+    return copia;
+}
+
+//Il vecchio preheader del primo loop calcola gli intervalli e il controllo e salta al nuovo preheader dei loop
+//originali (percorso veloce) o a quello delle copie. Le copie comprendono i blocchi tra un loop e l'altro e
+//confluiscono negli stessi blocchi di uscita: le PHI delle uscite ricevono i valori delle copie, gli altri usi dopo
+//i loop passano per le PHI create da SSAUpdater
+SmallVector<Loop*,2> RuntimeAliasCheck::versionLoops(LoopInfo &LI, DomTreeUpdater &DTU){
+    Loop *primo=Loops.front();
+    BasicBlock *controllo=primo->getLoopPreheader();
+    if(Pairs.empty() || !controllo)
+        return {};
+    for(unsigned i=0; i+1<Loops.size(); i++){               //tra due loop solo l'uscita del primo, preheader del secondo
+        BasicBlock *tra=Loops[i+1]->getLoopPreheader();
+        if(!tra || Loops[i]->getExitBlock()!=tra
+           || any_of(predecessors(tra), [&](BasicBlock *P){ return !Loops[i]->contains(P); }))
+            return {};
+    }
+    Function *F=controllo->getParent();
+    LLVMContext &Ctx=F->getContext();
+    for(Loop *L : Loops)
+        SE.forgetLoop(L);
+
+    IRBuilder<> B(controllo->getTerminator());
+    SCEVExpander Expander(SE, F->getParent()->getDataLayout(), "alias.check");
+    Value *disgiunti=nullptr;
+    for(auto [g, h] : Pairs){
+        const Group &G=(Groups.begin()+g)->second, &H=(Groups.begin()+h)->second;
+        Type *tipo=G.Low->getType();
+        Value *lowG=Expander.expandCodeFor(G.Low, tipo, controllo->getTerminator());
+        Value *highG=Expander.expandCodeFor(G.High, tipo, controllo->getTerminator());
+        Value *lowH=Expander.expandCodeFor(H.Low, tipo, controllo->getTerminator());
+        Value *highH=Expander.expandCodeFor(H.High, tipo, controllo->getTerminator());
+        Value *separati=B.CreateOr(B.CreateICmpULE(highG, lowH), B.CreateICmpULE(highH, lowG), "alias.disjoint");
+        disgiunti=disgiunti ? B.CreateAnd(disgiunti, separati, "alias.disjoint") : separati;
+    }
+    BasicBlock *veloce=SplitBlock(controllo, controllo->getTerminator(), &DTU, &LI, nullptr, primo->getHeader()->getName()+".ph");
+
+    SmallVector<BasicBlock*> regione{veloce};
+    for(unsigned i=0; i<Loops.size(); i++){
+        regione.append(Loops[i]->block_begin(), Loops[i]->block_end());
+        if(i+1<Loops.size())
+            regione.push_back(Loops[i+1]->getLoopPreheader());
+    }
+    SmallPtrSet<BasicBlock*,32> nellaRegione(regione.begin(), regione.end());
+    SmallSetVector<BasicBlock*,4> uscite;
+    SmallVector<Use*> usiFuori;                             //usi dopo i loop, tranne le PHI che ricevono da un loro blocco
+    for(BasicBlock *BB : regione){
+        for(BasicBlock *succ : successors(BB)){
+            if(!nellaRegione.count(succ))
+                uscite.insert(succ);
+        }
+        for(Instruction &I : *BB){
+            for(Use &U : I.uses()){
+                PHINode *PN=dyn_cast<PHINode>(U.getUser());
+                BasicBlock *punto=PN ? PN->getIncomingBlock(U) : cast<Instruction>(U.getUser())->getParent();
+                if(!nellaRegione.count(punto))
+                    usiFuori.push_back(&U);
+            }
+        }
+    }
+
+    ValueToValueMapTy VMap;
+    SmallVector<BasicBlock*> copie;
+    for(BasicBlock *BB : regione){
+        BasicBlock *copia=CloneBasicBlock(BB, VMap, ".slow", F);
+        copia->moveBefore(veloce);
+        VMap[BB]=copia;
+        copie.push_back(copia);
+    }
+    remapInstructionsInBlocks(copie, VMap);
+    Instruction *T=controllo->getTerminator();
+    BranchInst::Create(veloce, cast<BasicBlock>(VMap[veloce]), disgiunti, T);
+    T->eraseFromParent();
+    SmallVector<DominatorTree::UpdateType> aggiornamenti{{DominatorTree::Insert, controllo, cast<BasicBlock>(VMap[veloce])}};
+    for(BasicBlock *copia : copie){
+        for(BasicBlock *succ : successors(copia))
+            aggiornamenti.push_back({DominatorTree::Insert, copia, succ});
+    }
+    DTU.applyUpdates(aggiornamenti);
+    DTU.flush();
+
+    for(BasicBlock *E : uscite){
+        for(PHINode &PN : E->phis()){
+            SE.forgetValue(&PN);
+            for(unsigned i=0, n=PN.getNumIncomingValues(); i<n; i++){
+                if(!nellaRegione.count(PN.getIncomingBlock(i)))
+                    continue;
+                Value *V=PN.getIncomingValue(i);
+                Value *copia=VMap.lookup(V);
+                PN.addIncoming(copia ? copia : V, cast<BasicBlock>(VMap[PN.getIncomingBlock(i)]));
+            }
+        }
+    }
+    SSAUpdater SSA;
+    for(Use *U : usiFuori){
+        Instruction *I=cast<Instruction>(U->get());
+        SE.forgetValue(U->getUser());
+        SSA.Initialize(I->getType(), I->getName());
+        SSA.AddAvailableValue(I->getParent(), I);
+        SSA.AddAvailableValue(cast<BasicBlock>(VMap[I->getParent()]), VMap[I]);
+        SSA.RewriteUse(*U);
+    }
+
+    Loop *padre=primo->getParentLoop();
+    SmallVector<Loop*,2> lenti;
+    for(Loop *L : Loops)
+        lenti.push_back(clonaLoop(L, padre, VMap, LI));
+    for(BasicBlock *copia : copie){
+        if(padre && !LI.getLoopFor(copia))
+            padre->addBasicBlockToLoop(copia, LI);
+    }
+    for(Loop *L : lenti)
+        disable(L);
+
+    //sul percorso veloce ogni gruppo è disgiunto da quelli con cui è stato confrontato
+    MDBuilder MDB(Ctx);
+    MDNode *dominio=MDB.createAnonymousAliasScopeDomain("RuntimeAliasCheck");
+    SmallVector<MDNode*,8> scope;
+    for(unsigned g=0; g<Groups.size(); g++)
+        scope.push_back(MDB.createAnonymousAliasScope(dominio));
+    for(unsigned g=0; g<Groups.size(); g++){
+        SmallVector<Metadata*,8> separati;
+        for(auto [a, b] : Pairs){
+            if(a==g || b==g)
+                separati.push_back(scope[a==g ? b : a]);
+        }
+        for(Instruction *I : (Groups.begin()+g)->second.Accesses){
+            I->setMetadata(LLVMContext::MD_alias_scope,
+                           MDNode::concatenate(I->getMetadata(LLVMContext::MD_alias_scope), MDNode::get(Ctx, {scope[g]})));
+            I->setMetadata(LLVMContext::MD_noalias,
+                           MDNode::concatenate(I->getMetadata(LLVMContext::MD_noalias), MDNode::get(Ctx, separati)));
+        }
+    }
+    return lenti;
+}
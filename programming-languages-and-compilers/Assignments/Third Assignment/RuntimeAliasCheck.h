@@ -0,0 +1,54 @@
+#ifndef LLVM_TRANSFORMS_RUNTIMEALIASCHECK_H
+#define LLVM_TRANSFORMS_RUNTIMEALIASCHECK_H
+#include "llvm/IR/Dominators.h"
+#include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/ScalarEvolution.h"
+
+namespace llvm {
+  class DomTreeUpdater;
+
+  /*
+    Controllo a runtime che gli accessi alla memoria di una sequenza di loop adiacenti non si sovrappongano, per le
+    coppie su cui l'alias analysis non decide (es. due puntatori passati come argomenti). Usato da PassLICM e da
+    LoopFusionPass, implementato in RuntimeAliasCheck.cpp. Gli accessi sono raggruppati per puntatore base e ogni
+    gruppo tocca i byte [Low, High), calcolati prima del primo loop dagli estremi delle AddRec. versionLoops mette il
+    controllo nel preheader e duplica i loop: se gli intervalli sono disgiunti si eseguono gli originali, che il pass
+    può trasformare (con i metadati noalias l'alias analysis vede che gli accessi sono indipendenti), altrimenti le
+    copie non modificate
+  */
+  class RuntimeAliasCheck {
+    public:
+      RuntimeAliasCheck(ArrayRef<Loop*> Loops, ScalarEvolution &SE, DominatorTree &DT);
+      //chiede che A non si sovrapponga a nessuno degli Others. Falso, senza modifiche, se due accessi hanno la stessa
+      //base, se un intervallo non si calcola prima dei loop o se servirebbero troppi confronti
+      bool addChecks(Instruction *A, ArrayRef<Instruction*> Others);
+      unsigned getNumChecks() const { return Pairs.size(); }
+      //emette il controllo e duplica i loop, aggiornando LoopInfo, gli alberi di DTU (al ritorno già aggiornati) e
+      //ScalarEvolution. Restituisce le copie eseguite quando il controllo fallisce, vuoto se la sequenza non ha un
+      //solo ingresso
+      SmallVector<Loop*,2> versionLoops(LoopInfo &LI, DomTreeUpdater &DTU);
+      //le copie sono marcate nei metadati llvm.loop per non essere duplicate di nuovo
+      static bool isDisabled(const Loop *L);
+      static void disable(Loop *L);
+      //S si può calcolare nel preheader di L: invariante e senza divisioni per un valore che potrebbe essere 0
+      static bool isSafeToExpandInPreheader(const Loop &L, const SCEV *S, ScalarEvolution &SE);
+
+    private:
+      struct Group {
+          const SCEV *Low;
+          const SCEV *High;
+          SmallVector<Instruction*,4> Accesses;
+      };
+      SmallVector<Loop*,2> Loops;
+      ScalarEvolution &SE;
+      DominatorTree &DT;
+      MapVector<const SCEV*,Group> Groups;                    //puntatore base -> intervallo e accessi
+      SmallSetVector<std::pair<unsigned,unsigned>,8> Pairs;   //coppie di gruppi da separare
+
+      const SCEV *getBound(const SCEV *S, bool Max) const;
+      bool getRange(Instruction *I, const SCEV *&Base, const SCEV *&Low, const SCEV *&High) const;
+  };
+}
+#endif
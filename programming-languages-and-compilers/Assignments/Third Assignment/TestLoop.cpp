@@ -1,14 +1,67 @@
 #include "llvm/Transforms/Utils/PassLICM.h"
+#include "llvm/Transforms/Utils/RuntimeAliasCheck.h"
 #include "llvm/IR/PassManager.h"
 #include <llvm/IR/Constants.h>
 #include "llvm/IR/Instructions.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/MapVector.h"
 #include "llvm/IR/Dominators.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/AliasAnalysis.h"
+#include "llvm/Analysis/BlockFrequencyInfo.h"
+#include "llvm/Analysis/DomTreeUpdater.h"
+#include "llvm/Analysis/LoopIterator.h"
+#include "llvm/Analysis/MemorySSA.h"
+#include "llvm/Analysis/MemorySSAUpdater.h"
+#include "llvm/Analysis/MustExecute.h"
+#include "llvm/Analysis/OptimizationRemarkEmitter.h"
+#include "llvm/Analysis/ScalarEvolution.h"
+#include "llvm/Analysis/TargetTransformInfo.h"
+#include "llvm/Analysis/ValueTracking.h"
+#include "llvm/Transforms/Utils/LoopSimplify.h"
+#include "llvm/Transforms/Utils/SSAUpdater.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/Timer.h"
+#include "llvm/Pass.h"
 
+#include <memory>
 #include <vector>
 
 using namespace llvm;
 
+#define DEBUG_TYPE "licmpass"
+
+STATISTIC(NumInvariant, "Numero di istruzioni loop invariant trovate");
+STATISTIC(NumHoisted, "Numero di istruzioni spostate nel preheader");
+STATISTIC(NumNotDominatingExits, "Numero di candidati scartati perché non dominano le uscite");
+STATISTIC(NumNotDominatingUses, "Numero di candidati scartati perché non dominano i propri usi");
+STATISTIC(NumNotSpeculatable, "Numero di candidati scartati perché non eseguibili speculativamente");
+STATISTIC(NumOperandNotHoisted, "Numero di candidati scartati perché un loro operando resta nel loop");
+STATISTIC(NumNotGuaranteed, "Numero di candidati scartati perché il loop può non arrivare a eseguirli");
+STATISTIC(NumLoadsHoisted, "Numero di load invarianti spostati nel preheader");
+STATISTIC(NumHoistedOuter, "Numero di istruzioni spostate nel preheader di un loop più esterno");
+STATISTIC(NumPreheaders, "Numero di preheader creati");
+STATISTIC(NumPromoted, "Numero di locazioni di memoria promosse a registro");
+STATISTIC(NumSunk, "Numero di istruzioni spostate nei blocchi di uscita");
+STATISTIC(NumColdBlock, "Numero di candidati scartati perché in un blocco eseguito raramente");
+STATISTIC(NumRegisterPressure, "Numero di candidati scartati per la pressione sui registri");
+STATISTIC(NumVersioned, "Numero di loop duplicati dietro un controllo di alias a runtime");
+
+static cl::opt<double> SpeculationThreshold("licmpass-speculation-threshold", cl::init(1.0), cl::Hidden,
+                                            cl::desc("Esecuzioni attese per ingresso nel loop sotto le quali un'istruzione "
+                                                     "che non domina le uscite non viene spostata"));
+static cl::opt<unsigned> MaxPressure("licmpass-max-pressure", cl::init(0), cl::Hidden,
+                                     cl::desc("Registri disponibili per classe nel loop (0 = quelli del target)"));
+static cl::opt<bool> Versioning("licmpass-versioning", cl::init(true), cl::Hidden,
+                                cl::desc("Duplica il loop dietro un controllo di alias a runtime quando solo puntatori con "
+                                         "basi diverse impediscono di spostare o promuovere un accesso"));
+
+static const char *TimerGroupName="licmpass";
+static const char *TimerGroupDesc="PassLICM";
+
 
 //controlla se l'operando è un argomento della funzione
 bool isArgument(Use *op){
@@ -26,53 +79,66 @@ bool isConstant(Use *op){
     return false;
 }
 
-//ricerca di un instruzione in un vettore di istruzioni
-bool search(std::vector<Instruction*> founds, Instruction *Instr){
-    bool found=false;
-    for(unsigned int i=0; i<founds.size(); i++){
-        if(founds[i] == Instr){
-            found=true;
-            break;
+//controlla se l'istruzione può essere loop invariant: operazioni senza effetti collaterali che non leggono memoria
+bool isCandidate(Instruction &Instr){
+    return isa<BinaryOperator>(Instr) || isa<UnaryOperator>(Instr) || isa<CastInst>(Instr) ||
+           isa<GetElementPtrInst>(Instr) || isa<CmpInst>(Instr) || isa<SelectInst>(Instr) ||
+           isa<ExtractElementInst>(Instr) || isa<InsertElementInst>(Instr) || isa<ShuffleVectorInst>(Instr) ||
+           isa<ExtractValueInst>(Instr) || isa<InsertValueInst>(Instr) || isa<FreezeInst>(Instr);
+}
+
+//controllo se l'istruzione è loop invariant: ogni operando è un argomento, una costante, un'istruzione
+//fuori dal loop o un'istruzione del loop già presente nell'insieme founds
+bool isLoopInvariant(Loop &L, Instruction &Instr, const SmallPtrSetImpl<Instruction*> &founds){
+    for(Use &op : Instr.operands()){
+        LLVM_DEBUG(dbgs()<<"Operatore "<<*op);
+
+        if(isArgument(&op)){            // se l'operando è un argomento è loop invariant
+            LLVM_DEBUG(dbgs()<<" -> ARGOMENTO\n");
+        }else if(isConstant(&op)){      // se l'operando è costante è loop invariant
+            LLVM_DEBUG(dbgs()<<" -> COSTANTE\n");
+        }else if(Instruction *i = dyn_cast<Instruction>(op)){      // se l'operando è una variabile che è contenuta nel loop e non è tra le
+                                                                    // istruzioni loop invariant già trovate, l'istruzione originaria non
+                                                                    // è loop invariant
+            if(L.contains(i) && !founds.count(i)){
+                LLVM_DEBUG(dbgs()<<" -> NON LOOP INVARIANT\n");
+                return false;
+            }
+            LLVM_DEBUG(dbgs()<<" -> DIPENDE DA UN LOOP INVARIANT\n");
+        }else{
+            return false;
         }
     }
-    return found;
-}
-
-//controllo se l'istruzione è loop invariant
-bool isLoopInvariant(Loop &L, Instruction &Instr, std::vector<Instruction*> founds){
-    bool check;
-    auto op=Instr.op_begin();
-    while(op!=Instr.op_end()){
-        check=false;
-        outs()<<"Operatore "<<**op;
-
-        if(isArgument(op)){             // se l'operando è un argomento è loop invariant, allora l'istruzione è loop invariant
-            outs()<<" -> ARGOMENTO\n";
-            check=true;
-        }else if(isConstant(op)){       // se l'operando è costante è loop invariant, allora l'istruzione è loop invariant
-            outs()<<" -> COSTANTE\n";
-            check=true;
-        }else if(dyn_cast<BinaryOperator>(op)){             // se l'operando è una variabile che è contenuta nel loop e non è presente nelle istruzioni
-                                                            // candidate alla code motion (quindi non è loop invariant), allora l'istruzione originaria
-                                                            // non è loop invariant. Se invece l'operando non soddisfa i criteri detti prima, è loop invariant
-            Instruction* i = dyn_cast<Instruction>(op);
-            if(L.contains(i) && !search(founds, i)){
-                return false;                                      
-            }else{
-                outs()<<" -> DIPENDE DA UN LOOP INVARIANT\n";
-                check=true;
-            }                                                       
-        }
-        if(!check)          //se è già stato trovato un operando non loop invariant, allora l'istruzione intera non lo sarà. Interrompo la ricerca
-            return false;
-        else
-            op++;
+    return true;
+}
+
+//raccolgo le istruzioni del loop che possono scrivere in memoria
+void scrittureDelLoop(Loop &L, SmallVectorImpl<Instruction*> &scritture){
+    for(BasicBlock* BB : L.blocks()){
+        for(Instruction &Inst : *BB){
+            if(Inst.mayWriteToMemory())
+                scritture.push_back(&Inst);
+        }
+    }
+}
+
+//controllo se una scrittura del loop può modificare la locazione letta dal load. Con MemorySSA basta risalire al primo
+//accesso che la modifica (clobber); senza, si interroga l'alias analysis su ogni scrittura del loop
+bool isClobberedInLoop(Loop &L, LoadInst *Load, ArrayRef<Instruction*> scritture, AAResults &AA, MemorySSA *MSSA){
+    if(MSSA){
+        MemoryAccess *clobber=MSSA->getWalker()->getClobberingMemoryAccess(Load);
+        return !MSSA->isLiveOnEntryDef(clobber) && L.contains(clobber->getBlock());
+    }
+    MemoryLocation loc=MemoryLocation::get(Load);
+    for(Instruction *W : scritture){
+        if(isModSet(AA.getModRefInfo(W, loc)))
+            return true;
     }
-    return check;
+    return false;
 }
 
 //Controllo se il basic block dell'istruzione, nella fase code motion, domina tutte le uscite
-bool dominaUscite(DominatorTree &DomTree, Instruction *Instr, SmallVector<BasicBlock*> BBuscita){
+bool dominaUscite(DominatorTree &DomTree, Instruction *Instr, ArrayRef<BasicBlock*> BBuscita){
     bool dominato=true;
     BasicBlock* BBInstr=Instr->getParent();
     for(auto BB: BBuscita){
@@ -85,7 +151,7 @@ bool dominaUscite(DominatorTree &DomTree, Instruction *Instr, SmallVector<BasicB
 }
 
 //Controllo se l'istruzione, dopo l'esecuzione del loop, è utilizzata
-bool mortoDopoLoop(Instruction *Instr, SmallVector<BasicBlock*> BBsuccessori){
+bool mortoDopoLoop(Instruction *Instr, ArrayRef<BasicBlock*> BBsuccessori){
     bool dead=true;
     for(auto u=Instr->user_begin(); u!=Instr->user_end(); u++){
         BasicBlock* BBu=dyn_cast<Instruction>(*u)->getParent();
@@ -110,25 +176,559 @@ bool dominaUsi(DominatorTree &DomTree, Instruction *Instr){
     return dominato;
 }
 
+//legge i pesi !prof "branch_weights" del terminatore, uno per successore
+bool pesiDelRamo(Instruction *T, SmallVectorImpl<uint64_t> &pesi){
+    MDNode *MD=T->getMetadata(LLVMContext::MD_prof);
+    if(!MD || MD->getNumOperands()!=T->getNumSuccessors()+1)
+        return false;
+    MDString *tipo=dyn_cast<MDString>(MD->getOperand(0));
+    if(!tipo || tipo->getString()!="branch_weights")
+        return false;
+    for(unsigned i=1; i<MD->getNumOperands(); i++){
+        ConstantInt *peso=mdconst::dyn_extract<ConstantInt>(MD->getOperand(i));
+        if(!peso)
+            return false;
+        pesi.push_back(peso->getZExtValue());
+    }
+    return true;
+}
+
+//Esecuzioni attese di ogni blocco del loop per ogni ingresso nel loop. Con BlockFrequencyInfo (profilo o stima statica
+//di LLVM) è il rapporto con la frequenza del preheader; altrimenti propago in reverse post-order la frequenza
+//dell'header sui rami del loop, con i pesi !prof o, come l'euristica statica di LLVM, 31 a 1 contro gli archi di
+//uscita, e divido per la probabilità di uscire a ogni iterazione. I backedge dei loop interni sono ignorati: i loro blocchi risultano più freddi del vero
+DenseMap<BasicBlock*,double> stimaFrequenze(Loop &L, LoopStandardAnalysisResults &LAR){
+    DenseMap<BasicBlock*,double> freq;
+    BasicBlock *preHeader=L.getLoopPreheader();
+    if(LAR.BFI && preHeader && LAR.BFI->getBlockFreq(preHeader).getFrequency()){
+        double base=LAR.BFI->getBlockFreq(preHeader).getFrequency();
+        for(BasicBlock *BB : L.blocks())
+            freq[BB]=LAR.BFI->getBlockFreq(BB).getFrequency()/base;
+        return freq;
+    }
+
+    LoopBlocksRPO RPO(&L);
+    RPO.perform(&LAR.LI);
+    DenseMap<BasicBlock*,unsigned> posizione;
+    for(BasicBlock *BB : RPO)
+        posizione[BB]=posizione.size();
+    double ritorno=0;                                       //frequenza che torna all'header a ogni iterazione
+    freq[L.getHeader()]=1.0;
+    for(BasicBlock *BB : RPO){
+        Instruction *T=BB->getTerminator();
+        SmallVector<uint64_t,4> pesi;
+        if(!pesiDelRamo(T, pesi)){
+            pesi.clear();
+            for(BasicBlock *succ : successors(BB))
+                pesi.push_back(L.contains(succ) ? 31 : 1);
+        }
+        uint64_t totale=0;
+        for(uint64_t peso : pesi)
+            totale+=peso;
+        for(unsigned i=0; i<T->getNumSuccessors(); i++){
+            BasicBlock *succ=T->getSuccessor(i);
+            double f=totale ? freq[BB]*pesi[i]/totale : 0;
+            if(succ==L.getHeader())
+                ritorno+=f;
+            else if(L.contains(succ) && posizione[succ]>posizione[BB])
+                freq[succ]+=f;
+        }
+    }
+    double ingressi=ritorno<1.0 ? 1.0/(1.0-ritorno) : 1e9;  //esecuzioni dell'header per ingresso nel loop
+    for(auto &F : freq)
+        F.second*=ingressi;
+    return freq;
+}
+
+//Stima della pressione sui registri nel loop, per classe di registri del target: valori definiti fuori e usati dentro
+//(vivi per tutto il loop), PHI dell'header (portate da un'iterazione all'altra) e il massimo dei valori definiti nel
+//loop vivi contemporaneamente in un blocco. Spostare un'istruzione aggiunge un valore vivo per tutto il loop (se è
+//usata dentro) e libera gli operandi esterni che usava solo lei
+class PressioneRegistri {
+    Loop &L;
+    TargetTransformInfo &TTI;
+    DenseMap<Value*,unsigned> UsiNelLoop;                   //valori definiti fuori dal loop -> usi nel loop
+    DenseMap<unsigned,int> Pressione;                       //classe di registri -> valori vivi
+
+    unsigned classe(Value *V) const {
+        return TTI.getRegisterClassForType(V->getType()->isVectorTy(), V->getType());
+    }
+    static bool inRegistro(Value *V) {
+        return (isa<Instruction>(V) || isa<Argument>(V)) && !V->getType()->isVoidTy();
+    }
+    unsigned usiNelLoop(Instruction *I) const {
+        unsigned usi=0;
+        for(User *U : I->users())
+            usi+=L.contains(cast<Instruction>(U));
+        return usi;
+    }
+
+  public:
+    PressioneRegistri(Loop &L, TargetTransformInfo &TTI) : L(L), TTI(TTI) {
+        DenseMap<unsigned,int> locale;
+        for(BasicBlock *BB : L.blocks()){
+            DenseMap<unsigned,int> vivi, massimo;
+            SmallPtrSet<Value*,16> definiti;                //valori del blocco già visti (all'indietro: usati più avanti)
+            for(auto it=BB->rbegin(); it!=BB->rend(); it++){
+                Instruction &I=*it;
+                if(definiti.erase(&I))
+                    vivi[classe(&I)]--;
+                else if(inRegistro(&I) && !I.use_empty())   //usata solo fuori dal blocco: viva fino alla fine
+                    massimo[classe(&I)]=std::max(massimo[classe(&I)], vivi[classe(&I)]+1);
+                if(isa<PHINode>(I))
+                    continue;
+                for(Value *op : I.operands()){
+                    Instruction *O=dyn_cast<Instruction>(op);
+                    if(O && O->getParent()==BB && !isa<PHINode>(O) && definiti.insert(O).second){
+                        vivi[classe(O)]++;
+                        massimo[classe(O)]=std::max(massimo[classe(O)], vivi[classe(O)]);
+                    }else if(inRegistro(op) && (!O || !L.contains(O)))
+                        UsiNelLoop[op]++;
+                }
+            }
+            for(auto &M : massimo)
+                locale[M.first]=std::max(locale[M.first], M.second);
+        }
+        for(auto &U : UsiNelLoop)
+            Pressione[classe(U.first)]++;
+        for(PHINode &PN : L.getHeader()->phis())
+            Pressione[classe(&PN)]++;
+        for(auto &M : locale)
+            Pressione[M.first]+=M.second;
+    }
+
+    //controllo se, spostata l'istruzione, la sua classe resta entro i registri disponibili
+    bool puoSpostare(Instruction *I) const {
+        unsigned cls=classe(I);
+        int delta=usiNelLoop(I)>0;
+        for(Value *op : I->operands()){
+            if(classe(op)==cls && UsiNelLoop.lookup(op)==1)
+                delta--;
+        }
+        unsigned registri=MaxPressure ? (unsigned)MaxPressure : TTI.getNumberOfRegisters(cls);
+        return delta<=0 || Pressione.lookup(cls)+delta<=(int)registri;
+    }
+
+    void sposta(Instruction *I){
+        if(unsigned usi=usiNelLoop(I)){
+            UsiNelLoop[I]=usi;
+            Pressione[classe(I)]++;
+        }
+        for(Value *op : I->operands()){
+            auto it=UsiNelLoop.find(op);
+            if(it!=UsiNelLoop.end() && --it->second==0){
+                Pressione[classe(op)]--;
+                UsiNelLoop.erase(it);
+            }
+        }
+    }
+};
+
+//restituisce il preheader del loop, creandolo (e aggiornando DominatorTree, LoopInfo e MemorySSA) se manca; in quel
+//caso mette a true *creato
+BasicBlock *preheaderDedicato(Loop &L, LoopStandardAnalysisResults &LAR, MemorySSAUpdater *MSSAU, bool *creato=nullptr){
+    if(BasicBlock *preHeader=L.getLoopPreheader())
+        return preHeader;
+    BasicBlock *preHeader=InsertPreheaderForLoop(&L, &LAR.DT, &LAR.LI, MSSAU, true);
+    if(preHeader){
+        ++NumPreheaders;
+        if(creato)
+            *creato=true;
+    }
+    return preHeader;
+}
+
+//Uscite e scritture dei loop esterni, calcolate una volta sola per invocazione
+struct InfoLoopEsterni {
+    DenseMap<Loop*,SmallVector<BasicBlock*,8>> Uscite;
+    DenseMap<Loop*,SmallVector<Instruction*,8>> Scritture;
+    DenseMap<Loop*,DenseMap<BasicBlock*,double>> Frequenze;
+    DenseMap<Loop*,std::unique_ptr<ICFLoopSafetyInfo>> Sicurezza;
+    bool PreheaderCreati=false;
+};
+
+//Risalgo il nido a partire da L: l'istruzione esce anche dal loop padre P se i suoi operandi in P escono anche loro
+//da P, se è speculabile o viene eseguita sicuramente a ogni iterazione di P e, per i load, se nessuna scrittura di P
+//può modificarne la locazione. Restituisce il loop più esterno da cui l'istruzione esce, il cui preheader esiste
+Loop *loopDestinazione(Loop &L, Instruction *Instr, const DenseMap<Instruction*,Loop*> &destinazione,
+                       LoopStandardAnalysisResults &LAR, MemorySSAUpdater *MSSAU, InfoLoopEsterni &info){
+    Loop *dest=&L;
+    while(Loop *P=dest->getParentLoop()){
+        for(Value *op : Instr->operands()){
+            Instruction *O=dyn_cast<Instruction>(op);
+            Loop *D=O ? destinazione.lookup(O) : nullptr;
+            if(O && P->contains(O) && (!D || !D->contains(P)))
+                return dest;
+        }
+        if(!info.Uscite.count(P))
+            P->getExitingBlocks(info.Uscite[P]);
+        if(!dominaUscite(LAR.DT, Instr, info.Uscite[P])){      //spostamento speculativo: solo se conviene
+            if(!isSafeToSpeculativelyExecute(Instr))
+                return dest;
+            if(!info.Frequenze.count(P))
+                info.Frequenze[P]=stimaFrequenze(*P, LAR);
+            if(info.Frequenze[P].lookup(Instr->getParent())<SpeculationThreshold)
+                return dest;
+        }else if(!isSafeToSpeculativelyExecute(Instr)){
+            std::unique_ptr<ICFLoopSafetyInfo> &sicurezza=info.Sicurezza[P];
+            if(!sicurezza){
+                sicurezza=std::make_unique<ICFLoopSafetyInfo>();
+                sicurezza->computeLoopSafetyInfo(P);
+            }
+            if(!sicurezza->isGuaranteedToExecute(*Instr, &LAR.DT, P))
+                return dest;
+        }
+        if(LoadInst *Load=dyn_cast<LoadInst>(Instr)){
+            if(!LAR.MSSA && !info.Scritture.count(P))
+                scrittureDelLoop(*P, info.Scritture[P]);
+            if(isClobberedInLoop(*P, Load, info.Scritture.lookup(P), LAR.AA, LAR.MSSA))
+                return dest;
+        }
+        if(!preheaderDedicato(*P, LAR, MSSAU, &info.PreheaderCreati))
+            return dest;
+        dest=P;
+    }
+    return dest;
+}
+
+//Promotore per gli accessi a un solo puntatore: i load diventano valori SSA (con le PHI create da SSAUpdater) e gli
+//store vengono eliminati, sostituiti da un unico store in ogni blocco di uscita
+class PromotoreLoop : public LoadAndStorePromoter {
+    Loop &L;
+    Value *Ptr;
+    ArrayRef<BasicBlock*> BBsuccessori;
+    SSAUpdater &SSA;
+    MemorySSAUpdater *MSSAU;
+    Align Allineamento;
+  public:
+    PromotoreLoop(ArrayRef<const Instruction*> Insts, SSAUpdater &S, Loop &L, Value *Ptr, ArrayRef<BasicBlock*> BBsuccessori,
+                  MemorySSAUpdater *MSSAU, Align Allineamento)
+        : LoadAndStorePromoter(Insts, S), L(L), Ptr(Ptr), BBsuccessori(BBsuccessori), SSA(S), MSSAU(MSSAU), Allineamento(Allineamento) {}
+
+    void doExtraRewritesBeforeFinalDeletion() override {
+        for(BasicBlock *BB : BBsuccessori){
+            Value *V=SSA.GetValueInMiddleOfBlock(BB);
+            Instruction *I=dyn_cast<Instruction>(V);
+            if(I && L.contains(I)){                             //la forma LCSSA vuole una PHI nel blocco di uscita
+                PHINode *PN=PHINode::Create(I->getType(), pred_size(BB), I->getName()+".lcssa", &BB->front());
+                for(BasicBlock *Pred : predecessors(BB))
+                    PN->addIncoming(I, Pred);
+                V=PN;
+            }
+            StoreInst *S=new StoreInst(V, Ptr, false, Allineamento, &*BB->getFirstInsertionPt());
+            if(MSSAU){
+                MemoryAccess *A=MSSAU->createMemoryAccessInBB(S, nullptr, BB, MemorySSA::Beginning);
+                MSSAU->insertDef(cast<MemoryDef>(A), true);
+            }
+        }
+    }
+
+    void instructionDeleted(Instruction *I) const override {
+        if(MSSAU)
+            MSSAU->removeMemoryAccess(I);
+    }
+};
+
+//Promozione a registro: un puntatore invariante letto e scritto nel loop solo con load/store semplici dello stesso tipo,
+//che nessun altro accesso del loop può leggere o modificare, viene caricato una volta nel preheader, vive in registro
+//durante il loop e viene scritto una volta in ogni uscita. Serve uno store che domina le uscite (altrimenti lo store
+//nelle uscite sarebbe nuovo) e che nessuna istruzione del loop possa interrompere l'esecuzione prima di raggiungerlo
+bool promuoviInRegistri(Loop &L, LoopStandardAnalysisResults &LAR, MemorySSAUpdater *MSSAU, ArrayRef<BasicBlock*> BBuscita,
+                        ArrayRef<BasicBlock*> BBsuccessori, OptimizationRemarkEmitter &ORE){
+    BasicBlock* preHeader=L.getLoopPreheader();
+    if(!preHeader || !L.hasDedicatedExits())
+        return false;
+
+    MapVector<Value*, SmallVector<Instruction*,4>> gruppi;     //load/store semplici, per puntatore invariante
+    SmallVector<Instruction*> altri;                            //tutti gli altri accessi alla memoria del loop
+    for(BasicBlock* BB : L.blocks()){
+        for(Instruction &I : *BB){
+            if(!isGuaranteedToTransferExecutionToSuccessor(&I))
+                return false;
+            if(!I.mayReadOrWriteMemory())
+                continue;
+            Value *ptr=getLoadStorePointerOperand(&I);
+            bool semplice=isa<LoadInst>(I) ? cast<LoadInst>(I).isSimple() : isa<StoreInst>(I) && cast<StoreInst>(I).isSimple();
+            if(ptr && semplice && L.isLoopInvariant(ptr))
+                gruppi[ptr].push_back(&I);
+            else
+                altri.push_back(&I);
+        }
+    }
+
+    //decido prima quali gruppi promuovere: la promozione cancella gli accessi degli altri gruppi
+    SmallVector<Value*> daPromuovere;
+    for(auto &G : gruppi){
+        Type *tipo=getLoadStoreType(G.second.front());
+        MemoryLocation loc=MemoryLocation::get(G.second.front());
+        bool storeSicuro=false, promuovibile=true;
+        for(Instruction *I : G.second){
+            promuovibile&=getLoadStoreType(I)==tipo;
+            storeSicuro|=isa<StoreInst>(I) && dominaUscite(LAR.DT, I, BBuscita);
+        }
+        for(Instruction *I : altri)
+            promuovibile&=!isModOrRefSet(LAR.AA.getModRefInfo(I, loc));
+        for(auto &H : gruppi){
+            if(H.first!=G.first)
+                promuovibile&=LAR.AA.alias(loc, MemoryLocation::get(H.second.front()))==AliasResult::NoAlias;
+        }
+        if(promuovibile && storeSicuro)
+            daPromuovere.push_back(G.first);
+        else
+            ORE.emit([&](){
+                return OptimizationRemarkMissed(DEBUG_TYPE, "NotPromoted", G.second.front())
+                       <<"accessi a "<<ore::NV("Ptr", G.first)<<" non promossi a registro: "
+                       <<(promuovibile?"nessuno store domina le uscite":"altri accessi del loop possono toccare la stessa memoria");
+            });
+    }
+
+    for(Value *ptr : daPromuovere){
+        SmallVector<Instruction*,4> &accessi=gruppi[ptr];
+        Type *tipo=getLoadStoreType(accessi.front());
+        Align allineamento=getLoadStoreAlignment(accessi.front());
+        for(Instruction *I : accessi)
+            allineamento=std::min(allineamento, getLoadStoreAlignment(I));
+        ORE.emit([&](){
+            return OptimizationRemark(DEBUG_TYPE, "Promoted", accessi.front())
+                   <<ore::NV("NumAccesses", (unsigned)accessi.size())<<" accessi a "<<ore::NV("Ptr", ptr)<<" promossi a registro";
+        });
+
+        SmallVector<PHINode*,8> nuovePHI;
+        SSAUpdater SSA(&nuovePHI);
+        SmallVector<const Instruction*,4> costanti(accessi.begin(), accessi.end());
+        PromotoreLoop Promotore(costanti, SSA, L, ptr, BBsuccessori, MSSAU, allineamento);
+        LoadInst *iniziale=new LoadInst(tipo, ptr, ptr->getName()+".promoted", false, allineamento, preHeader->getTerminator());
+        if(MSSAU){
+            MemoryAccess *A=MSSAU->createMemoryAccessInBB(iniziale, nullptr, preHeader, MemorySSA::End);
+            MSSAU->insertUse(cast<MemoryUse>(A), true);
+        }
+        SSA.AddAvailableValue(preHeader, iniziale);
+        Promotore.run(accessi);
+        ++NumPromoted;
+    }
+    return !daPromuovere.empty();
+}
+
+//controllo se l'istruzione, fuori dal loop, è usata solo da PHI LCSSA che ricevono lei da tutti i predecessori
+bool usataSoloInUscita(Loop &L, Instruction *Instr, const SmallPtrSetImpl<Instruction*> &affondate){
+    for(User *U : Instr->users()){
+        Instruction *UI=cast<Instruction>(U);
+        if(affondate.count(UI))
+            continue;
+        PHINode *PN=dyn_cast<PHINode>(UI);
+        if(!PN || L.contains(PN) || PN->getParent()->isEHPad())
+            return false;
+        for(Value *V : PN->incoming_values()){
+            if(V!=Instr)
+                return false;
+        }
+    }
+    return true;
+}
+
+//Sinking: le istruzioni rimaste nel loop il cui risultato serve solo dopo il loop, direttamente o attraverso altre
+//istruzioni da spostare, vengono ricalcolate in ogni blocco di uscita che le usa (una copia per uscita) e tolte dal
+//corpo del loop. Chi usa il valore fuori dal loop domina l'uscita, quindi l'istruzione veniva già eseguita
+//nell'ultima iterazione con gli stessi operandi: la copia non è speculativa
+unsigned affondaNelleUscite(Loop &L, LoopStandardAnalysisResults &LAR, ArrayRef<BasicBlock*> BBsuccessori,
+                            OptimizationRemarkEmitter &ORE){
+    if(!L.hasDedicatedExits())
+        return 0;
+    std::vector<Instruction*> ordine;                       //istruzioni del loop, ogni definizione prima dei suoi usi
+    LoopBlocksRPO RPO(&L);
+    RPO.perform(&LAR.LI);
+    for(BasicBlock* BB : RPO){
+        for(Instruction &Inst : *BB)
+            ordine.push_back(&Inst);
+    }
+
+    SmallPtrSet<Instruction*,16> affondate;                 //all'indietro: gli usi vengono visti prima delle definizioni
+    for(auto it=ordine.rbegin(); it!=ordine.rend(); it++){
+        if(isCandidate(**it) && !(*it)->use_empty() && usataSoloInUscita(L, *it, affondate))
+            affondate.insert(*it);
+    }
+    if(affondate.empty())
+        return 0;
+
+    DenseMap<Instruction*,unsigned> copie;
+    for(BasicBlock *E : BBsuccessori){
+        SmallPtrSet<Instruction*,16> servono;               //le affondate usate in E, con i loro operandi affondati
+        SmallVector<Instruction*> worklist;
+        for(PHINode &PN : E->phis()){
+            Instruction *I=dyn_cast<Instruction>(PN.getIncomingValue(0));
+            if(I && affondate.count(I) && servono.insert(I).second)
+                worklist.push_back(I);
+        }
+        while(!worklist.empty()){
+            Instruction *I=worklist.pop_back_val();
+            for(Value *op : I->operands()){
+                Instruction *O=dyn_cast<Instruction>(op);
+                if(O && affondate.count(O) && servono.insert(O).second)
+                    worklist.push_back(O);
+            }
+        }
+        if(servono.empty())
+            continue;
+
+        DenseMap<Value*,Value*> nuovi;                      //copie in E e PHI LCSSA per gli operandi rimasti nel loop
+        Instruction *punto=&*E->getFirstInsertionPt();
+        for(Instruction *I : ordine){
+            if(!servono.count(I))
+                continue;
+            Instruction *C=I->clone();
+            C->setName(I->getName());
+            C->insertBefore(punto);
+            for(Use &op : C->operands()){
+                Instruction *O=dyn_cast<Instruction>(op);
+                if(!O || !L.contains(O))
+                    continue;
+                Value *&V=nuovi[O];
+                if(!V){
+                    PHINode *PN=PHINode::Create(O->getType(), pred_size(E), O->getName()+".lcssa", &E->front());
+                    for(BasicBlock *Pred : predecessors(E))
+                        PN->addIncoming(O, Pred);
+                    V=PN;
+                }
+                op.set(V);
+            }
+            nuovi[I]=C;
+            copie[I]++;
+        }
+
+        SmallVector<PHINode*> sostituite;
+        for(PHINode &PN : E->phis()){
+            Instruction *I=dyn_cast<Instruction>(PN.getIncomingValue(0));
+            if(I && servono.count(I))
+                sostituite.push_back(&PN);
+        }
+        for(PHINode *PN : sostituite){
+            PN->replaceAllUsesWith(nuovi[cast<Instruction>(PN->getIncomingValue(0))]);
+            PN->eraseFromParent();
+        }
+    }
+
+    unsigned spostate=0;
+    for(auto it=ordine.rbegin(); it!=ordine.rend(); it++){
+        Instruction *I=*it;
+        if(!affondate.count(I) || !I->use_empty())
+            continue;
+        ORE.emit([&](){
+            return OptimizationRemark(DEBUG_TYPE, "Sunk", I)<<ore::NV("Inst", I)<<" usata solo dopo il loop: spostata in "
+                   <<ore::NV("NumExits", copie.lookup(I))<<" blocchi di uscita";
+        });
+        LAR.SE.forgetValue(I);
+        I->eraseFromParent();
+        ++NumSunk;
+        spostate++;
+    }
+    return spostate;
+}
+
+//Versioning per l'alias: un accesso con indirizzo invariante che domina le uscite (un load da spostare o uno store da
+//promuovere) resta nel loop se l'alias analysis non esclude che altri accessi del loop, con un puntatore base diverso,
+//tocchino la stessa memoria. Se gli intervalli di tutti si calcolano prima del loop, il loop viene duplicato dietro un
+//controllo a runtime: l'originale, eseguito solo se gli intervalli sono disgiunti, ha i metadati noalias e il resto del
+//pass lo tratta normalmente, la copia resta com'è. Solo senza MemorySSA, che il versioning non aggiorna
+bool versionaPerAlias(Loop &L, LoopStandardAnalysisResults &LAR, LPMUpdater &LU, OptimizationRemarkEmitter &ORE){
+    if(!Versioning || LAR.MSSA || RuntimeAliasCheck::isDisabled(&L) || !L.getLoopPreheader() || !L.hasDedicatedExits())
+        return false;
+    SmallVector<Instruction*> accessi;
+    for(BasicBlock *BB : L.blocks()){
+        for(Instruction &I : *BB){
+            if(!I.mayReadOrWriteMemory())
+                continue;
+            bool semplice=isa<LoadInst>(I) ? cast<LoadInst>(I).isSimple() : isa<StoreInst>(I) && cast<StoreInst>(I).isSimple();
+            if(!semplice)
+                return false;
+            accessi.push_back(&I);
+        }
+    }
+
+    SmallVector<BasicBlock*> BBuscita;
+    L.getExitingBlocks(BBuscita);
+    RuntimeAliasCheck controllo(&L, LAR.SE, LAR.DT);
+    for(Instruction *C : accessi){
+        Value *ptr=getLoadStorePointerOperand(C);
+        if(!LAR.SE.isLoopInvariant(LAR.SE.getSCEV(ptr), &L) || !dominaUscite(LAR.DT, C, BBuscita))
+            continue;
+        //gli accessi allo stesso puntatore li gestisce la promozione, le coppie di load non contano
+        MemoryLocation loc=MemoryLocation::get(C);
+        SmallVector<Instruction*,8> conflitti;
+        for(Instruction *O : accessi){
+            if(O==C || (isa<LoadInst>(C) && isa<LoadInst>(O)) || getLoadStorePointerOperand(O)==ptr)
+                continue;
+            if(LAR.AA.alias(loc, MemoryLocation::get(O))!=AliasResult::NoAlias)
+                conflitti.push_back(O);
+        }
+        if(!conflitti.empty() && !controllo.addChecks(C, conflitti))
+            ORE.emit([&](){
+                return OptimizationRemarkMissed(DEBUG_TYPE, "NotVersioned", C)<<ore::NV("Inst", C)
+                       <<" resta nel loop: la sovrapposizione con gli altri accessi non si può controllare a runtime";
+            });
+    }
+    if(!controllo.getNumChecks())
+        return false;
+    DomTreeUpdater DTU(LAR.DT, DomTreeUpdater::UpdateStrategy::Eager);
+    SmallVector<Loop*,2> copie=controllo.versionLoops(LAR.LI, DTU);
+    if(copie.empty())
+        return false;
+
+    //la copia è un nuovo loop fratello: il loop pass manager la visiterà, in loop-simplify e LCSSA form
+    RuntimeAliasCheck::disable(&L);
+    formDedicatedExitBlocks(&L, &LAR.DT, &LAR.LI, nullptr, true);
+    formDedicatedExitBlocks(copie.front(), &LAR.DT, &LAR.LI, nullptr, true);
+    LU.addSiblingLoops(copie);
+    ORE.emit([&](){
+        return OptimizationRemark(DEBUG_TYPE, "Versioned", L.getStartLoc(), L.getHeader())
+               <<"loop duplicato dietro un controllo a runtime su "<<ore::NV("NumChecks", controllo.getNumChecks())
+               <<" coppie di puntatori";
+    });
+    ++NumVersioned;
+    return true;
+}
+
 
 PreservedAnalyses PassLICM::run(Loop &L, LoopAnalysisManager &LAM, LoopStandardAnalysisResults &LAR, LPMUpdater &LU){
-    auto BBs=L.getBlocks();
-    std::vector<Instruction*> founds;
-
-    //fase di controllo se un'istruzione è loop invariant o no. Nel caso lo fosse, la inserisco in un vettore
-    outs()<<"\nCHECK ISTRUZIONI:\n";
-    for(BasicBlock* BB : BBs){
-        for(auto Inst=BB->begin(); Inst!=BB->end(); Inst++){
-            if(dyn_cast<BinaryOperator>(Inst)){
-                outs()<<"_____________________________________________"<<"\n";
-                outs()<<"ISTRUZIONE: "<<*Inst<<"\n";
-                if(isLoopInvariant(L, *Inst, founds)){
-                    outs()<<"--- LOOP INVARIANT ---\n";
-                    founds.push_back(dyn_cast<Instruction>(Inst));
-                }else{
-                    outs()<<"\n--- NON LOOP INVARIANT ---\n";
+    std::vector<Instruction*> founds;                       // istruzioni loop invariant, ogni definizione prima dei suoi usi
+    bool modificato=false;
+    SmallPtrSet<Instruction*,32> invarianti;                // le stesse, per la ricerca degli operandi
+    OptimizationRemarkEmitter ORE(L.getHeader()->getParent());
+    std::unique_ptr<MemorySSAUpdater> MSSAU;                //solo se il pass gira in loop-mssa(...)
+    if(LAR.MSSA)
+        MSSAU=std::make_unique<MemorySSAUpdater>(LAR.MSSA);
+    bool versionato;
+    {
+        NamedRegionTimer T("versioning", "Versioning con controllo di alias a runtime", TimerGroupName, TimerGroupDesc, TimePassesIsEnabled);
+        versionato=versionaPerAlias(L, LAR, LU, ORE);
+    }
+
+    SmallVector<Instruction*> scritture;                    //istruzioni del loop che possono scrivere in memoria
+    if(!LAR.MSSA)
+        scrittureDelLoop(L, scritture);
+
+    //fase di controllo se un'istruzione è loop invariant o no. I blocchi sono visitati in reverse post-order: in SSA
+    //ogni operando (escluse le PHI, mai invarianti) è definito in un blocco che domina l'uso e che quindi lo precede,
+    //perciò un solo giro arriva già al punto fisso
+    LLVM_DEBUG(dbgs()<<"\nCHECK ISTRUZIONI:\n");
+    {
+        NamedRegionTimer T("invariance", "Ricerca delle istruzioni loop invariant", TimerGroupName, TimerGroupDesc, TimePassesIsEnabled);
+        LoopBlocksRPO RPO(&L);
+        RPO.perform(&LAR.LI);
+        for(BasicBlock* BB : RPO){
+            for(Instruction &Inst : *BB){
+                LoadInst *Load=dyn_cast<LoadInst>(&Inst);
+                if(isCandidate(Inst) || (Load && Load->isSimple())){
+                    LLVM_DEBUG(dbgs()<<"ISTRUZIONE: "<<Inst<<"\n");
+                    //un load è invariante se lo è l'indirizzo e nessuna scrittura del loop può modificare la locazione
+                    if(isLoopInvariant(L, Inst, invarianti) && (!Load || !isClobberedInLoop(L, Load, scritture, LAR.AA, LAR.MSSA))){
+                        LLVM_DEBUG(dbgs()<<"--- LOOP INVARIANT ---\n");
+                        founds.push_back(&Inst);
+                        invarianti.insert(&Inst);
+                        ++NumInvariant;
+                    }else{
+                        LLVM_DEBUG(dbgs()<<"--- NON LOOP INVARIANT ---\n");
+                    }
                 }
-                outs()<<"_____________________________________________"<<"\n";
             }
         }
     }
@@ -137,56 +737,162 @@ PreservedAnalyses PassLICM::run(Loop &L, LoopAnalysisManager &LAM, LoopStandardA
     SmallVector<BasicBlock*> BBuscita;
     SmallVector<BasicBlock*> BBsuccessori;
     L.getExitingBlocks(BBuscita);
-    L.getExitBlocks(BBsuccessori);
-
-    outs()<<"\nISTRUZIONI CANDIDATE ALLA CODE MOTION:\n";
-    for(auto found : founds){
-        outs()<<*found<<"\n";
-    }
-
-    outs()<<"\nPULIZIA:\n";
-    unsigned int i=0;
-    while(i<founds.size()){
-        if(!dominaUscite(DomTree, founds[i], BBuscita)){  //se l'istruzione non domina le uscite ma è morta dopo il loop, non la rimuovo dai candidati. In caso contrario si
-            if(mortoDopoLoop(founds[i], BBsuccessori)){
-                founds[i]->printAsOperand(outs(), false);
-                outs()<<" morta dopo il loop, non rimossa\n";
-            }else{
-                founds[i]->printAsOperand(outs(), false);
-                outs()<<" non fa parte di un BasicBlock che domina tutti i blocchi di uscita\n";
-                founds.erase(founds.begin()+i);
-                i--;
-                outs()<<"--> RIMOSSA DAI CANDIDATI\n";
+    L.getUniqueExitBlocks(BBsuccessori);
+
+    LLVM_DEBUG(dbgs()<<"\nPULIZIA:\n");
+    {
+        NamedRegionTimer T("filter", "Filtro dei candidati alla code motion", TimerGroupName, TimerGroupDesc, TimePassesIsEnabled);
+        std::vector<Instruction*> candidati;                // i candidati che superano il filtro, nello stesso ordine
+        SmallPtrSet<Instruction*,32> spostate;
+        ICFLoopSafetyInfo SafetyInfo;                       //istruzioni del loop che possono non restituire il controllo
+        SafetyInfo.computeLoopSafetyInfo(&L);
+        DenseMap<BasicBlock*,double> frequenze;             // calcolate solo se serve uno spostamento speculativo
+        for(Instruction *found : founds){
+            if(!isLoopInvariant(L, *found, spostate)){      //un operando scartato resta nel loop: spostare l'istruzione romperebbe l'SSA
+                ORE.emit([&](){
+                    return OptimizationRemarkMissed(DEBUG_TYPE, "OperandNotHoisted", found)
+                           <<ore::NV("Inst", found)<<" dipende da un'istruzione che resta nel loop";
+                });
+                ++NumOperandNotHoisted;
                 continue;
             }
-        }else if(!dominaUsi(DomTree,founds[i])){        // se l'istruzione non domina tutti i suoi usi, la rimuovo dai candidati
-            founds[i]->printAsOperand(outs(), false);
-            outs()<<" non fa parte di un BasicBlock che domina tutti gli utilizzi nel loop\n";
-            founds.erase(founds.begin()+i);
-            i--;
-            outs()<<"--> RIMOSSA DAI CANDIDATI\n";
-            continue;
+            if(!dominaUscite(DomTree, found, BBuscita)){  //se l'istruzione non domina le uscite ma è morta dopo il loop, non la rimuovo dai candidati. In caso contrario si
+                if(!mortoDopoLoop(found, BBsuccessori)){
+                    ORE.emit([&](){
+                        return OptimizationRemarkMissed(DEBUG_TYPE, "NotDominatingExits", found)
+                               <<ore::NV("Inst", found)<<" non fa parte di un BasicBlock che domina tutti i blocchi di uscita";
+                    });
+                    ++NumNotDominatingExits;
+                    continue;
+                }
+                if(!isSafeToSpeculativelyExecute(found)){ //nel preheader verrebbe eseguita anche quando il loop non l'avrebbe fatto (es. divisione per 0)
+                    ORE.emit([&](){
+                        return OptimizationRemarkMissed(DEBUG_TYPE, "NotSpeculatable", found)
+                               <<ore::NV("Inst", found)<<" non domina le uscite e non può essere eseguita speculativamente";
+                    });
+                    ++NumNotSpeculatable;
+                    continue;
+                }
+                if(frequenze.empty())
+                    frequenze=stimaFrequenze(L, LAR);
+                if(frequenze.lookup(found->getParent())<SpeculationThreshold){   //nel preheader costerebbe più che nel suo blocco
+                    ORE.emit([&](){
+                        return OptimizationRemarkMissed(DEBUG_TYPE, "ColdBlock", found)
+                               <<ore::NV("Inst", found)<<" non domina le uscite e il suo blocco viene eseguito in media "
+                               <<ore::NV("Frequency", formatv("{0:f2}", frequenze.lookup(found->getParent())).str())<<" volte per ingresso nel loop";
+                    });
+                    ++NumColdBlock;
+                    continue;
+                }
+                ORE.emit([&](){
+                    return OptimizationRemarkAnalysis(DEBUG_TYPE, "DeadAfterLoop", found)
+                           <<ore::NV("Inst", found)<<" non domina le uscite, ma è morta dopo il loop: resta candidata";
+                });
+            }else if(!isSafeToSpeculativelyExecute(found) && !SafetyInfo.isGuaranteedToExecute(*found, &DomTree, &L)){
+                //domina le uscite, ma prima di lei il loop può fermarsi (es. if(!p) abort(); x=*p;): nel preheader
+                //verrebbe eseguita anche quando il loop non ci arriva
+                ORE.emit([&](){
+                    return OptimizationRemarkMissed(DEBUG_TYPE, "NotGuaranteedToExecute", found)
+                           <<ore::NV("Inst", found)<<" non è eseguita sicuramente a ogni ingresso nel loop e non può essere eseguita speculativamente";
+                });
+                ++NumNotGuaranteed;
+                continue;
+            }else if(!dominaUsi(DomTree,found)){        // se l'istruzione non domina tutti i suoi usi, la rimuovo dai candidati
+                ORE.emit([&](){
+                    return OptimizationRemarkMissed(DEBUG_TYPE, "NotDominatingUses", found)
+                           <<ore::NV("Inst", found)<<" non fa parte di un BasicBlock che domina tutti gli utilizzi nel loop";
+                });
+                ++NumNotDominatingUses;
+                continue;
+            }
+            candidati.push_back(found);
+            spostate.insert(found);
         }
-        i++;
+        founds.swap(candidati);
     }
 
-    outs()<<"\nISTRUZIONI FINALI CANDIDATE ALLA CODE MOTION\n";
-    for(auto found : founds){
-        outs()<<*found<<"\n";
-    }
-    
-    outs()<<"CODE MOTION\n";
-    BasicBlock* preHeader=L.getLoopPreheader();
-    Instruction* terminatore=preHeader->getTerminator();
-    if(preHeader) {
-        for(auto i : founds){
-            i->moveBefore(terminatore);
-            outs()<<*i<<"\n";
+    //fase di code motion: ogni istruzione va nel preheader del loop più esterno da cui può uscire, così una sola
+    //invocazione sul loop più interno sposta le espressioni invarianti in tutto il nido
+    LLVM_DEBUG(dbgs()<<"CODE MOTION\n");
+    {
+        NamedRegionTimer T("motion", "Code motion nel preheader", TimerGroupName, TimerGroupDesc, TimePassesIsEnabled);
+        bool creato=false;
+        BasicBlock* preHeader=founds.empty() ? L.getLoopPreheader() : preheaderDedicato(L, LAR, MSSAU.get(), &creato);
+        if(preHeader) {
+            DenseMap<Instruction*,Loop*> destinazione;
+            InfoLoopEsterni info;
+            PressioneRegistri pressione(L, LAR.TTI);
+            std::vector<Instruction*> daSpostare;
+            for(auto i : founds){
+                bool operandiSpostati=true;                 //un operando rimasto per la pressione trattiene anche i suoi usi
+                for(Value *op : i->operands()){
+                    Instruction *O=dyn_cast<Instruction>(op);
+                    operandiSpostati&=!O || !L.contains(O) || destinazione.count(O);
+                }
+                if(!operandiSpostati || !pressione.puoSpostare(i)){
+                    ORE.emit([&](){
+                        return OptimizationRemarkMissed(DEBUG_TYPE, "RegisterPressure", i)
+                               <<ore::NV("Inst", i)<<" resta nel loop: spostarla allungherebbe troppi intervalli di vita";
+                    });
+                    ++NumRegisterPressure;
+                    continue;
+                }
+                pressione.sposta(i);
+                destinazione[i]=loopDestinazione(L, i, destinazione, LAR, MSSAU.get(), info);
+                daSpostare.push_back(i);
+            }
+            modificato=creato || info.PreheaderCreati || !daSpostare.empty();
+            for(auto i : daSpostare){
+                Loop *dest=destinazione[i];
+                BasicBlock *BB=dest->getLoopPreheader();
+                LAR.SE.forgetValue(i);
+                i->moveBefore(BB->getTerminator());
+                if(MSSAU){
+                    if(MemoryUseOrDef *A=LAR.MSSA->getMemoryAccess(i))
+                        MSSAU->moveToPlace(A, BB, MemorySSA::BeforeTerminator);
+                }
+                if(isa<LoadInst>(i))
+                    ++NumLoadsHoisted;
+                if(dest!=&L){
+                    ORE.emit([&](){
+                        return OptimizationRemark(DEBUG_TYPE, "HoistedOuter", i)<<ore::NV("Inst", i)
+                               <<" loop invariant spostata nel preheader del loop a profondità "<<ore::NV("Depth", dest->getLoopDepth());
+                    });
+                    ++NumHoistedOuter;
+                }else{
+                    ORE.emit([&](){
+                        return OptimizationRemark(DEBUG_TYPE, "Hoisted", i)<<ore::NV("Inst", i)<<" loop invariant spostata nel preheader";
+                    });
+                }
+                ++NumHoisted;
+            }
+        } else {
+            ORE.emit([&](){
+                return OptimizationRemarkMissed(DEBUG_TYPE, "NoPreheader", L.getStartLoc(), L.getHeader())
+                       <<"Preheader non esistente e non creabile";
+            });
+            founds.clear();
         }
-        outs()<<"CODE MOTION COMPLETATA\n";
-    } else {
-        outs()<<"Preheader non esistente\n";
     }
 
-    return PreservedAnalyses::all();
+    bool promosse;
+    {
+        NamedRegionTimer T("promotion", "Promozione a registro degli accessi alla memoria", TimerGroupName, TimerGroupDesc, TimePassesIsEnabled);
+        promosse=promuoviInRegistri(L, LAR, MSSAU.get(), BBuscita, BBsuccessori, ORE);
+        if(promosse)
+            LAR.SE.forgetLoop(&L);
+    }
+
+    unsigned affondate;
+    {
+        NamedRegionTimer T("sinking", "Sinking nei blocchi di uscita", TimerGroupName, TimerGroupDesc, TimePassesIsEnabled);
+        affondate=affondaNelleUscite(L, LAR, BBsuccessori, ORE);
+    }
+
+    if(!modificato && !promosse && !affondate && !versionato)
+        return PreservedAnalyses::all();
+    PreservedAnalyses PA=getLoopPassPreservedAnalyses();
+    if(LAR.MSSA)
+        PA.preserve<MemorySSAAnalysis>();
+    return PA;
 }